@@ -44,6 +44,7 @@ public class ColumnSchema {
   private final int desiredBlockSize;
   private final Encoding encoding;
   private final CompressionAlgorithm compressionAlgorithm;
+  private final int compressionLevel;
   private final ColumnTypeAttributes typeAttributes;
   private final int typeSize;
   private final Common.DataType wireType;
@@ -64,7 +65,9 @@ public class ColumnSchema {
     GROUP_VARINT(EncodingType.GROUP_VARINT),
     RLE(EncodingType.RLE),
     DICT_ENCODING(EncodingType.DICT_ENCODING),
-    BIT_SHUFFLE(EncodingType.BIT_SHUFFLE);
+    BIT_SHUFFLE(EncodingType.BIT_SHUFFLE),
+    FOR_DELTA(EncodingType.FOR_DELTA),
+    ALP(EncodingType.ALP);
 
     final EncodingType internalPbType;
 
@@ -89,7 +92,8 @@ public class ColumnSchema {
     NO_COMPRESSION(CompressionType.NO_COMPRESSION),
     SNAPPY(CompressionType.SNAPPY),
     LZ4(CompressionType.LZ4),
-    ZLIB(CompressionType.ZLIB);
+    ZLIB(CompressionType.ZLIB),
+    ZSTD(CompressionType.ZSTD);
 
     final CompressionType internalPbType;
 
@@ -105,7 +109,7 @@ public class ColumnSchema {
 
   private ColumnSchema(String name, Type type, boolean key, boolean nullable,
                        Object defaultValue, int desiredBlockSize, Encoding encoding,
-                       CompressionAlgorithm compressionAlgorithm,
+                       CompressionAlgorithm compressionAlgorithm, int compressionLevel,
                        ColumnTypeAttributes typeAttributes, Common.DataType wireType,
                        String comment) {
     this.name = name;
@@ -116,6 +120,7 @@ public class ColumnSchema {
     this.desiredBlockSize = desiredBlockSize;
     this.encoding = encoding;
     this.compressionAlgorithm = compressionAlgorithm;
+    this.compressionLevel = compressionLevel;
     this.typeAttributes = typeAttributes;
     this.typeSize = type.getSize(typeAttributes);
     this.wireType = wireType;
@@ -187,6 +192,17 @@ public class ColumnSchema {
     return compressionAlgorithm;
   }
 
+  /**
+   * Gets the compression level for this column.
+   * If no level has been explicitly specified for this column,
+   * returns 0 to indicate that the codec's default level will be used.
+   *
+   * @return the compression level, or 0 if none has been configured.
+   */
+  public int getCompressionLevel() {
+    return compressionLevel;
+  }
+
   /**
    * Return the column type attributes for the column, or null if it is not known.
    */
@@ -271,6 +287,7 @@ public class ColumnSchema {
     private int desiredBlockSize = 0;
     private Encoding encoding = null;
     private CompressionAlgorithm compressionAlgorithm = null;
+    private int compressionLevel = 0;
     private ColumnTypeAttributes typeAttributes = null;
     private Common.DataType wireType = null;
     private String comment = "";
@@ -298,6 +315,7 @@ public class ColumnSchema {
       this.desiredBlockSize = that.desiredBlockSize;
       this.encoding = that.encoding;
       this.compressionAlgorithm = that.compressionAlgorithm;
+      this.compressionLevel = that.compressionLevel;
       this.typeAttributes = that.typeAttributes;
       this.wireType = that.wireType;
       this.comment = that.comment;
@@ -382,6 +400,19 @@ public class ColumnSchema {
       return this;
     }
 
+    /**
+     * Set the compression level for this column. Only codecs which support
+     * levels (currently only ZSTD) accept a level other than 0, which selects
+     * the codec's default level. Higher levels trade slower writes for smaller
+     * data on disk.
+     * @param compressionLevel the compression level
+     * @return this instance
+     */
+    public ColumnSchemaBuilder compressionLevel(int compressionLevel) {
+      this.compressionLevel = compressionLevel;
+      return this;
+    }
+
     /**
      * Set the column type attributes for this column.
      */
@@ -432,10 +463,18 @@ public class ColumnSchema {
                           CharUtil.MIN_VARCHAR_LENGTH, CharUtil.MAX_VARCHAR_LENGTH));
         }
       }
+      if (compressionLevel < 0) {
+        throw new IllegalArgumentException(
+            "compression level must not be negative, got " + compressionLevel);
+      }
+      if (compressionLevel != 0 && compressionAlgorithm != CompressionAlgorithm.ZSTD) {
+        throw new IllegalArgumentException(
+            "compression level is only valid for ZSTD compression");
+      }
       return new ColumnSchema(name, type,
                               key, nullable, defaultValue,
                               desiredBlockSize, encoding, compressionAlgorithm,
-                              typeAttributes, wireType, comment);
+                              compressionLevel, typeAttributes, wireType, comment);
     }
   }
 }
@@ -241,6 +241,29 @@ public class AlterTableOptions {
     return this;
   }
 
+  /**
+   * Change the compression level used for a column. Only ZSTD supports
+   * levels other than 0, the codec's default level. Changing a column's
+   * compression algorithm resets its level, so when changing both, call
+   * this after {@link #changeCompressionAlgorithm}.
+   * @param name the name of the column
+   * @param level the new compression level
+   * @return this instance
+   */
+  public AlterTableOptions changeCompressionLevel(String name, int level) {
+    if (level < 0) {
+      throw new IllegalArgumentException("compression level must not be negative, got " + level);
+    }
+    AlterTableRequestPB.Step.Builder step = pb.addAlterSchemaStepsBuilder();
+    step.setType(AlterTableRequestPB.StepType.ALTER_COLUMN);
+    AlterTableRequestPB.AlterColumn.Builder alterBuilder =
+        AlterTableRequestPB.AlterColumn.newBuilder();
+    alterBuilder.setDelta(
+        Common.ColumnSchemaDeltaPB.newBuilder().setName(name).setCompressionLevel(level));
+    step.setAlterColumn(alterBuilder);
+    return this;
+  }
+
   /**
    * Add a range partition to the table with an inclusive lower bound and an exclusive upper bound.
    *
@@ -117,6 +117,9 @@ public class ProtobufHelper {
     if (column.getCompressionAlgorithm() != null) {
       schemaBuilder.setCompression(column.getCompressionAlgorithm().getInternalPbType());
     }
+    if (column.getCompressionLevel() != 0) {
+      schemaBuilder.setCompressionLevel(column.getCompressionLevel());
+    }
     if (column.getDefaultValue() != null) {
       schemaBuilder.setReadDefaultValue(UnsafeByteOperations.unsafeWrap(
           objectToWireFormat(column, column.getDefaultValue())));
@@ -157,12 +160,14 @@ public class ProtobufHelper {
     ColumnSchema.CompressionAlgorithm compressionAlgorithm =
         ColumnSchema.CompressionAlgorithm.valueOf(pb.getCompression().name());
     int desiredBlockSize = pb.getCfileBlockSize();
+    int compressionLevel = pb.getCompressionLevel();
     return new ColumnSchema.ColumnSchemaBuilder(pb.getName(), type)
                            .key(pb.getIsKey())
                            .nullable(pb.getIsNullable())
                            .defaultValue(defaultValue)
                            .encoding(encoding)
                            .compressionAlgorithm(compressionAlgorithm)
+                           .compressionLevel(compressionLevel)
                            .desiredBlockSize(desiredBlockSize)
                            .typeAttributes(typeAttributes)
                            .comment(pb.getComment())
@@ -214,10 +214,17 @@ public class SchemaGenerator {
             Encoding.AUTO_ENCODING,
             Encoding.PLAIN_ENCODING,
             Encoding.BIT_SHUFFLE,
-            Encoding.RLE));
+            Encoding.RLE,
+            Encoding.FOR_DELTA));
         break;
       case FLOAT:
       case DOUBLE:
+        validEncodings.retainAll(Arrays.asList(
+            Encoding.AUTO_ENCODING,
+            Encoding.PLAIN_ENCODING,
+            Encoding.BIT_SHUFFLE,
+            Encoding.ALP));
+        break;
       case DECIMAL:
         validEncodings.retainAll(Arrays.asList(
             Encoding.AUTO_ENCODING,
@@ -26,6 +26,11 @@ import org.junit.Test;
 import org.junit.function.ThrowingRunnable;
 
 import org.apache.kudu.ColumnSchema.ColumnSchemaBuilder;
+import org.apache.kudu.ColumnSchema.CompressionAlgorithm;
+import org.apache.kudu.ColumnSchema.Encoding;
+import org.apache.kudu.Common.EncodingType;
+import org.apache.kudu.Compression.CompressionType;
+import org.apache.kudu.client.ProtobufHelper;
 import org.apache.kudu.test.junit.RetryRule;
 import org.apache.kudu.util.CharUtil;
 import org.apache.kudu.util.DecimalUtil;
@@ -101,6 +106,52 @@ public class TestColumnSchema {
     assertNotEquals(commentInt1, commentInt3);
   }
 
+  @Test
+  public void testEncodingsMatchProtobuf() {
+    // Every encoding the server may report must be readable.
+    for (EncodingType pbType : EncodingType.values()) {
+      if (pbType == EncodingType.UNKNOWN_ENCODING) {
+        continue;
+      }
+      assertEquals(pbType, Encoding.valueOf(pbType.name()).getInternalPbType());
+    }
+  }
+
+  @Test
+  public void testCompressionAlgorithmsMatchProtobuf() {
+    // Every compression type the server may report must be readable.
+    for (CompressionType pbType : CompressionType.values()) {
+      if (pbType == CompressionType.UNKNOWN_COMPRESSION) {
+        continue;
+      }
+      assertEquals(pbType, CompressionAlgorithm.valueOf(pbType.name()).getInternalPbType());
+    }
+  }
+
+  @Test
+  public void testCompressionLevel() throws Exception {
+    ColumnSchema col = new ColumnSchemaBuilder("col1", Type.INT64)
+        .compressionAlgorithm(CompressionAlgorithm.ZSTD)
+        .compressionLevel(9)
+        .build();
+    ColumnSchema fromPb = ProtobufHelper.pbToColumnSchema(
+        ProtobufHelper.columnToPb(Common.ColumnSchemaPB.newBuilder(), 0, col));
+    assertEquals(CompressionAlgorithm.ZSTD, fromPb.getCompressionAlgorithm());
+    assertEquals(9, fromPb.getCompressionLevel());
+
+    Throwable thrown = Assert.assertThrows(IllegalArgumentException.class, new ThrowingRunnable() {
+      @Override
+      public void run() throws Exception {
+        new ColumnSchemaBuilder("col1", Type.INT64)
+            .compressionAlgorithm(CompressionAlgorithm.LZ4)
+            .compressionLevel(3)
+            .build();
+      }
+    });
+    Assert.assertTrue(thrown.getMessage()
+            .contains("compression level is only valid for ZSTD compression"));
+  }
+
   @Test
   public void testOutOfRangeVarchar() throws Exception {
     Throwable thrown = Assert.assertThrows(IllegalArgumentException.class, new ThrowingRunnable() {
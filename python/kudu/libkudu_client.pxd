@@ -135,6 +135,8 @@ cdef extern from "kudu/client/schema.h" namespace "kudu::client" nogil:
         EncodingType_BIT_SHUFFLE " kudu::client::KuduColumnStorageAttributes::BIT_SHUFFLE"
         EncodingType_RLE " kudu::client::KuduColumnStorageAttributes::RLE"
         EncodingType_DICT " kudu::client::KuduColumnStorageAttributes::DICT_ENCODING"
+        EncodingType_FOR_DELTA " kudu::client::KuduColumnStorageAttributes::FOR_DELTA"
+        EncodingType_ALP " kudu::client::KuduColumnStorageAttributes::ALP"
 
     enum CompressionType" kudu::client::KuduColumnStorageAttributes::CompressionType":
         CompressionType_DEFAULT " kudu::client::KuduColumnStorageAttributes::DEFAULT_COMPRESSION"
@@ -142,6 +144,7 @@ cdef extern from "kudu/client/schema.h" namespace "kudu::client" nogil:
         CompressionType_SNAPPY " kudu::client::KuduColumnStorageAttributes::SNAPPY"
         CompressionType_LZ4 " kudu::client::KuduColumnStorageAttributes::LZ4"
         CompressionType_ZLIB " kudu::client::KuduColumnStorageAttributes::ZLIB"
+        CompressionType_ZSTD " kudu::client::KuduColumnStorageAttributes::ZSTD"
 
     cdef struct KuduColumnStorageAttributes:
         KuduColumnStorageAttributes()
@@ -197,6 +200,7 @@ cdef extern from "kudu/client/schema.h" namespace "kudu::client" nogil:
          KuduColumnSpec* RemoveDefault()
 
          KuduColumnSpec* Compression(CompressionType compression)
+         KuduColumnSpec* CompressionLevel(int32_t level)
          KuduColumnSpec* Encoding(EncodingType encoding)
          KuduColumnSpec* BlockSize(int32_t block_size)
 
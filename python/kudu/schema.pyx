@@ -62,6 +62,7 @@ COMPRESSION_NONE = CompressionType_NONE
 COMPRESSION_SNAPPY = CompressionType_SNAPPY
 COMPRESSION_LZ4 = CompressionType_LZ4
 COMPRESSION_ZLIB = CompressionType_ZLIB
+COMPRESSION_ZSTD = CompressionType_ZSTD
 
 cdef dict _compression_types = {
     'default': COMPRESSION_DEFAULT,
@@ -69,6 +70,7 @@ cdef dict _compression_types = {
     'snappy': COMPRESSION_SNAPPY,
     'lz4': COMPRESSION_LZ4,
     'zlib': COMPRESSION_ZLIB,
+    'zstd': COMPRESSION_ZSTD,
 }
 
 cdef dict _compression_type_to_name = _reverse_dict(_compression_types)
@@ -81,6 +83,8 @@ ENCODING_PREFIX = EncodingType_PREFIX
 ENCODING_BIT_SHUFFLE = EncodingType_BIT_SHUFFLE
 ENCODING_RLE = EncodingType_RLE
 ENCODING_DICT = EncodingType_DICT
+ENCODING_FOR_DELTA = EncodingType_FOR_DELTA
+ENCODING_ALP = EncodingType_ALP
 
 cdef dict _encoding_types = {
     'auto': ENCODING_AUTO,
@@ -89,6 +93,8 @@ cdef dict _encoding_types = {
     'bitshuffle': ENCODING_BIT_SHUFFLE,
     'rle': ENCODING_RLE,
     'dict': ENCODING_DICT,
+    'for_delta': ENCODING_FOR_DELTA,
+    'alp': ENCODING_ALP,
 }
 
 cdef dict _encoding_type_to_name = _reverse_dict(_encoding_types)
@@ -306,7 +312,7 @@ cdef class ColumnSpec:
         Parameters
         ----------
         compression : string or int
-          One of {'default', 'none', 'snappy', 'lz4', 'zlib'}
+          One of {'default', 'none', 'snappy', 'lz4', 'zlib', 'zstd'}
           Or see kudu.COMPRESSION_* constants
 
         Returns
@@ -330,6 +336,21 @@ cdef class ColumnSpec:
         self.spec.Compression(type)
         return self
 
+    def compression_level(self, level):
+        """
+        Set the compression level for the column.
+
+        Only codecs which support levels (currently only 'zstd') accept a
+        level other than 0, which selects the codec's default level. Higher
+        levels trade slower writes for smaller data on disk.
+
+        Returns
+        -------
+        self
+        """
+        self.spec.CompressionLevel(level)
+        return self
+
     def encoding(self, encoding):
         """
         Set the encoding type
@@ -337,7 +358,8 @@ cdef class ColumnSpec:
         Parameters
         ----------
         encoding : string or int
-          One of {'auto', 'plain', 'prefix', 'bitshuffle', 'rle', 'dict'}
+          One of {'auto', 'plain', 'prefix', 'bitshuffle', 'rle', 'dict',
+                  'for_delta', 'alp'}
           Or see kudu.ENCODING_* constants
 
         Returns
@@ -505,7 +527,8 @@ cdef class SchemaBuilder:
 
     def add_column(self, name, type_=None, nullable=None, compression=None,
                    encoding=None, primary_key=False, block_size=None,
-                   default=None, precision=None, scale=None, length=None):
+                   default=None, precision=None, scale=None, length=None,
+                   compression_level=None):
         """
         Add a new column to the schema. Returns a ColumnSpec object for further
         configuration and use in a fluid programming style.
@@ -519,10 +542,11 @@ cdef class SchemaBuilder:
           New columns are nullable by default. Set boolean value for explicit
           nullable / not-nullable
         compression : string or int
-          One of {'default', 'none', 'snappy', 'lz4', 'zlib'}
+          One of {'default', 'none', 'snappy', 'lz4', 'zlib', 'zstd'}
           Or see kudu.COMPRESSION_* constants
         encoding : string or int
-          One of {'auto', 'plain', 'prefix', 'bitshuffle', 'rle', 'dict'}
+          One of {'auto', 'plain', 'prefix', 'bitshuffle', 'rle', 'dict',
+                  'for_delta', 'alp'}
           Or see kudu.ENCODING_* constants
         primary_key : boolean, default False
           Use this column as the table primary key
@@ -536,6 +560,8 @@ cdef class SchemaBuilder:
           Use this scale for the decimal column
         length : int
           Use this length for the varchar column
+        compression_level : int, optional
+          Compression level to use for the target column.
 
         Examples
         --------
@@ -562,6 +588,9 @@ cdef class SchemaBuilder:
         if compression is not None:
             result.compression(compression)
 
+        if compression_level is not None:
+            result.compression_level(compression_level)
+
         if encoding is not None:
             result.encoding(encoding)
 
@@ -111,6 +111,10 @@ class TestSchema(unittest.TestCase):
         bar = builder.add_column('bar', 'string')
         bar.compression(kudu.COMPRESSION_ZLIB)
 
+        baz = builder.add_column('baz', 'string', compression='zstd',
+                                 compression_level=9)
+        assert baz is not None
+
         with self.assertRaises(ValueError):
             bar = builder.add_column('qux', 'string', compression='unknown')
 
@@ -134,6 +138,12 @@ class TestSchema(unittest.TestCase):
         bar = builder.add_column('bar', 'string')
         bar.encoding(kudu.ENCODING_PLAIN)
 
+        baz = builder.add_column('baz', 'int64').encoding('for_delta')
+        assert baz is not None
+
+        quux = builder.add_column('quux', 'double').encoding(kudu.ENCODING_ALP)
+        assert quux is not None
+
         with self.assertRaises(ValueError):
             builder.add_column('qux', 'string', encoding='unknown')
 
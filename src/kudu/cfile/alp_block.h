@@ -0,0 +1,505 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Adaptive lossless floating-point (ALP) encoding for FLOAT and DOUBLE
+// blocks. Most real-world floating-point data, such as sensor readings and
+// prices, was originally decimal with a handful of significant digits. Such
+// values are losslessly encoded by scaling them by a power of ten into
+// integers, which are then bit-packed with frame-of-reference encoding.
+// Values which don't survive the round trip are stored verbatim as
+// exceptions.
+//
+// Reference:
+// Afroozeh et al. "ALP: Adaptive Lossless floating-Point Compression",
+// SIGMOD 2024.
+#ifndef KUDU_CFILE_ALP_BLOCK_H
+#define KUDU_CFILE_ALP_BLOCK_H
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/cfile/bshuf_block.h"
+#include "kudu/cfile/cfile_util.h"
+#include "kudu/cfile/for_block.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowid.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace cfile {
+
+namespace alp_internal {
+
+enum Mode : uint8_t {
+  // The values are encoded as scaled integers plus exceptions.
+  kAlp = 0,
+  // The values didn't suit ALP, and are stored as a bitshuffle block.
+  kBitShuffle = 1,
+};
+
+// The number of values sampled from a block to pick the exponent and factor.
+constexpr int kSampleSize = 32;
+
+// 10^0 through 10^18, and the nearest doubles to 10^0 through 10^-18.
+extern const double kPow10[];
+extern const double kNegPow10[];
+
+// Adding and subtracting this rounds a double to the nearest integer, for
+// values of magnitude below 2^51.
+constexpr double kRoundingMagic = 6755399441055744.0;
+constexpr double kMaxScaled = 2251799813685248.0;  // 2^51
+
+template<typename T>
+struct AlpTraits {};
+
+template<>
+struct AlpTraits<double> {
+  static constexpr int kMaxExponent = 18;
+};
+
+template<>
+struct AlpTraits<float> {
+  static constexpr int kMaxExponent = 10;
+};
+
+// Scales 'val' into an integer with exponent 'e' and factor 'f'. Returns
+// false if the result would be out of range. FLOAT values are scaled in
+// double precision too, which makes far more of them round-trip exactly.
+template<typename T>
+inline bool AlpScale(T val, int e, int f, int64_t* digits) {
+  double scaled = static_cast<double>(val) * kPow10[e] * kNegPow10[f];
+  // Also rejects NaN.
+  if (!(std::fabs(scaled) < kMaxScaled)) {
+    return false;
+  }
+  *digits = static_cast<int64_t>(scaled + kRoundingMagic - kRoundingMagic);
+  return true;
+}
+
+// The inverse of AlpScale(). This must be used both to verify encoded values
+// and to decode them, so that they agree exactly.
+template<typename T>
+inline T AlpUnscale(int64_t digits, int e, int f) {
+  return static_cast<T>(static_cast<double>(digits) * kPow10[f] * kNegPow10[e]);
+}
+
+// Returns true if 'val' is encoded exactly by exponent 'e' and factor 'f',
+// setting 'digits' to the encoded integer.
+template<typename T>
+inline bool AlpEncode(T val, int e, int f, int64_t* digits) {
+  if (!AlpScale(val, e, f, digits)) {
+    return false;
+  }
+  T decoded = AlpUnscale<T>(*digits, e, f);
+  // Compare the bits, so -0.0 is not confused with 0.0.
+  return memcmp(&decoded, &val, sizeof(T)) == 0;
+}
+
+} // namespace alp_internal
+
+// AlpBlockBuilder encodes FLOAT and DOUBLE blocks with ALP, or, if that
+// would be larger, as a bitshuffle block.
+//
+// The block format is as follows:
+//
+// 1. Header:
+//
+//    <first_ordinal> [32-bit]
+//      The ordinal offset of the first element in the block.
+//
+//    <num_elements> [32-bit]
+//      The number of elements encoded in the block.
+//
+//    <mode> [8-bit]
+//      0 if the block is ALP-encoded, 1 if it holds a bitshuffle block.
+//
+// 2a. ALP data:
+//
+//    <exponent> [8-bit]
+//    <factor> [8-bit]
+//      Each value is encoded as round(value * 10^exponent / 10^factor).
+//
+//    <num_exceptions> [32-bit]
+//
+//    <digits>
+//      The encoded integers, as FOR mini-blocks (see for_block.h).
+//
+//    <exception positions> [32-bit each]
+//    <exception values> [size of the type each]
+//      The values which couldn't be encoded exactly.
+//
+//    Eight zero bytes of padding.
+//
+// 2b. Bitshuffle data:
+//
+//    A complete bitshuffle block (see bshuf_block.h).
+//
+//   NOTE: all on-disk ints are encoded little-endian
+//
+template<DataType Type>
+class AlpBlockBuilder final : public BlockBuilder {
+ public:
+  explicit AlpBlockBuilder(const WriterOptions* options)
+      : bshuf_builder_(options),
+        options_(options) {
+    Reset();
+  }
+
+  void Reset() OVERRIDE {
+    auto block_size = options_->storage_attributes.cfile_block_size;
+    values_.clear();
+    values_.reserve(block_size / sizeof(CppType));
+    buffer_.clear();
+    bshuf_builder_.Reset();
+    rem_elem_capacity_ = block_size / sizeof(CppType);
+  }
+
+  bool IsBlockFull() const override {
+    return rem_elem_capacity_ == 0;
+  }
+
+  int Add(const uint8_t* vals_void, size_t count) OVERRIDE {
+    int to_add = std::min<int>(rem_elem_capacity_, count);
+    const CppType* vals = reinterpret_cast<const CppType*>(vals_void);
+    values_.insert(values_.end(), vals, vals + to_add);
+    rem_elem_capacity_ -= to_add;
+    return to_add;
+  }
+
+  size_t Count() const OVERRIDE {
+    return values_.size();
+  }
+
+  Status GetFirstKey(void* key) const OVERRIDE {
+    if (values_.empty()) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &values_.front(), sizeof(CppType));
+    return Status::OK();
+  }
+
+  Status GetLastKey(void* key) const OVERRIDE {
+    if (values_.empty()) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &values_.back(), sizeof(CppType));
+    return Status::OK();
+  }
+
+  void Finish(rowid_t ordinal_pos, std::vector<Slice>* slices) OVERRIDE {
+    buffer_.clear();
+    buffer_.resize(kHeaderSize);
+    InlineEncodeFixed32(&buffer_[0], ordinal_pos);
+    InlineEncodeFixed32(&buffer_[4], values_.size());
+    buffer_[8] = alp_internal::kAlp;
+    EncodeAlp();
+
+    // Bitshuffle does better on data without a decimal origin, so use
+    // whichever is smaller. This costs a second encoding pass, but only at
+    // flush and compaction time.
+    std::vector<Slice> bshuf_slices;
+    size_t added = bshuf_builder_.Add(reinterpret_cast<const uint8_t*>(values_.data()),
+                                      values_.size());
+    CHECK_EQ(values_.size(), added);
+    bshuf_builder_.Finish(ordinal_pos, &bshuf_slices);
+    DCHECK_EQ(1, bshuf_slices.size());
+    if (bshuf_slices[0].size() < buffer_.size() - kHeaderSize) {
+      buffer_.resize(kHeaderSize);
+      buffer_[8] = alp_internal::kBitShuffle;
+      *slices = { Slice(buffer_.data(), kHeaderSize), bshuf_slices[0] };
+      return;
+    }
+    *slices = { Slice(buffer_.data(), buffer_.size()) };
+  }
+
+ private:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+  typedef alp_internal::AlpTraits<CppType> Traits;
+
+  static const size_t kHeaderSize = sizeof(uint32_t) * 2 + 1;
+
+  // Picks the exponent and factor which encode a sample of the values most
+  // compactly, and returns them in 'e' and 'f'.
+  void ChooseExponentAndFactor(int* best_e, int* best_f) const {
+    *best_e = 0;
+    *best_f = 0;
+    if (values_.empty()) {
+      return;
+    }
+    const size_t n = values_.size();
+    const size_t num_samples = std::min<size_t>(n, alp_internal::kSampleSize);
+    size_t best_cost = std::numeric_limits<size_t>::max();
+    for (int e = 0; e <= Traits::kMaxExponent; e++) {
+      for (int f = 0; f <= e; f++) {
+        int64_t min_digits = std::numeric_limits<int64_t>::max();
+        int64_t max_digits = std::numeric_limits<int64_t>::min();
+        size_t num_exceptions = 0;
+        for (size_t i = 0; i < num_samples; i++) {
+          int64_t digits;
+          if (alp_internal::AlpEncode(values_[i * n / num_samples], e, f, &digits)) {
+            min_digits = std::min(min_digits, digits);
+            max_digits = std::max(max_digits, digits);
+          } else {
+            num_exceptions++;
+          }
+        }
+        int bit_width = num_exceptions == num_samples ? 0 : for_internal::BitWidth(
+            static_cast<uint64_t>(max_digits) - static_cast<uint64_t>(min_digits));
+        size_t cost = num_samples * bit_width +
+            num_exceptions * (sizeof(uint32_t) + sizeof(CppType)) * 8;
+        if (cost < best_cost) {
+          best_cost = cost;
+          *best_e = e;
+          *best_f = f;
+        }
+      }
+    }
+  }
+
+  void EncodeAlp() {
+    int e;
+    int f;
+    ChooseExponentAndFactor(&e, &f);
+
+    const size_t n = values_.size();
+    digits_.resize(n);
+    exception_positions_.clear();
+    exception_values_.clear();
+    // Exceptions take the digits of the preceding encoded value, so that
+    // they don't widen the frame of reference.
+    int64_t fill = 0;
+    bool have_fill = false;
+    for (size_t i = 0; i < n; i++) {
+      if (alp_internal::AlpEncode(values_[i], e, f, &digits_[i])) {
+        if (!have_fill) {
+          std::fill(digits_.begin(), digits_.begin() + i, digits_[i]);
+          have_fill = true;
+        }
+        fill = digits_[i];
+      } else {
+        digits_[i] = fill;
+        exception_positions_.push_back(i);
+        exception_values_.push_back(values_[i]);
+      }
+    }
+
+    buffer_.resize(kHeaderSize + kAlpHeaderSize);
+    buffer_[kHeaderSize] = e;
+    buffer_[kHeaderSize + 1] = f;
+    InlineEncodeFixed32(&buffer_[kHeaderSize + 2], exception_positions_.size());
+    for_internal::AppendMiniBlocks<uint64_t>(digits_.data(), n, &buffer_);
+    for (uint32_t pos : exception_positions_) {
+      PutFixed32(&buffer_, pos);
+    }
+    buffer_.append(exception_values_.data(), exception_values_.size() * sizeof(CppType));
+    buffer_.resize(buffer_.size() + for_internal::kPaddingBytes);
+    memset(&buffer_[buffer_.size() - for_internal::kPaddingBytes], 0,
+           for_internal::kPaddingBytes);
+  }
+
+  static const size_t kAlpHeaderSize = 2 + sizeof(uint32_t);
+
+  std::vector<CppType> values_;
+  std::vector<int64_t> digits_;
+  std::vector<uint32_t> exception_positions_;
+  std::vector<CppType> exception_values_;
+  faststring buffer_;
+  BShufBlockBuilder<Type> bshuf_builder_;
+  int rem_elem_capacity_;
+  const WriterOptions* options_;
+};
+
+template<DataType Type>
+class AlpBlockDecoder final : public BlockDecoder {
+ public:
+  explicit AlpBlockDecoder(Slice slice)
+      : data_(slice),
+        parsed_(false),
+        ordinal_pos_base_(0),
+        num_elems_(0),
+        cur_idx_(0) {
+  }
+
+  Status ParseHeader() OVERRIDE {
+    CHECK(!parsed_);
+    if (data_.size() < kHeaderSize) {
+      return Status::Corruption(
+          strings::Substitute("not enough bytes for header: ALP block size ($0) "
+                              "less than expected header length ($1)",
+                              data_.size(), kHeaderSize));
+    }
+    ordinal_pos_base_ = DecodeFixed32(&data_[0]);
+    num_elems_ = DecodeFixed32(&data_[4]);
+    switch (data_[8]) {
+      case alp_internal::kAlp:
+        RETURN_NOT_OK(DecodeAlp());
+        break;
+      case alp_internal::kBitShuffle:
+        RETURN_NOT_OK(DecodeBitShuffle());
+        break;
+      default:
+        return Status::Corruption(strings::Substitute("invalid ALP block mode: $0", data_[8]));
+    }
+    parsed_ = true;
+    return Status::OK();
+  }
+
+  void SeekToPositionInBlock(uint pos) OVERRIDE {
+    CHECK(parsed_) << "Must call ParseHeader()";
+    DCHECK_LE(pos, num_elems_);
+    cur_idx_ = pos;
+  }
+
+  Status SeekAtOrAfterValue(const void* value_void, bool* exact) OVERRIDE {
+    DCHECK(parsed_);
+    CppType target = UnalignedLoad<CppType>(value_void);
+    auto it = std::lower_bound(decoded_.begin(), decoded_.end(), target);
+    cur_idx_ = it - decoded_.begin();
+    if (it == decoded_.end()) {
+      *exact = false;
+      return Status::NotFound("after last key in block");
+    }
+    *exact = *it == target;
+    return Status::OK();
+  }
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) OVERRIDE {
+    DCHECK(parsed_);
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+    size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    memcpy(dst->data(), &decoded_[cur_idx_], max_fetch * sizeof(CppType));
+    *n = max_fetch;
+    cur_idx_ += max_fetch;
+    return Status::OK();
+  }
+
+  size_t GetCurrentIndex() const OVERRIDE {
+    DCHECK(parsed_) << "must parse header first";
+    return cur_idx_;
+  }
+
+  rowid_t GetFirstRowId() const OVERRIDE {
+    return ordinal_pos_base_;
+  }
+
+  size_t Count() const OVERRIDE {
+    return num_elems_;
+  }
+
+  bool HasNext() const OVERRIDE {
+    return cur_idx_ < num_elems_;
+  }
+
+ private:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+  typedef alp_internal::AlpTraits<CppType> Traits;
+
+  static const size_t kHeaderSize = sizeof(uint32_t) * 2 + 1;
+  static const size_t kAlpHeaderSize = 2 + sizeof(uint32_t);
+
+  Status DecodeAlp() {
+    if (data_.size() < kHeaderSize + kAlpHeaderSize + for_internal::kPaddingBytes) {
+      return Status::Corruption("ALP block truncated in header");
+    }
+    int e = data_[kHeaderSize];
+    int f = data_[kHeaderSize + 1];
+    if (PREDICT_FALSE(e > Traits::kMaxExponent || f > e)) {
+      return Status::Corruption(strings::Substitute("invalid ALP exponent $0 and factor $1",
+                                                    e, f));
+    }
+    uint32_t num_exceptions = DecodeFixed32(&data_[kHeaderSize + 2]);
+
+    const uint8_t* pos = data_.data() + kHeaderSize + kAlpHeaderSize;
+    const uint8_t* end = data_.data() + data_.size() - for_internal::kPaddingBytes;
+    if (PREDICT_FALSE(num_elems_ > for_internal::MaxMiniBlockEntries<uint64_t>(end - pos))) {
+      return Status::Corruption(strings::Substitute(
+          "ALP block of $0 bytes can't hold $1 elements", data_.size(), num_elems_));
+    }
+    decoded_.resize(num_elems_);
+    std::vector<uint64_t> digits(num_elems_);
+    RETURN_NOT_OK(for_internal::DecodeMiniBlocks(&pos, end, digits.data(), num_elems_));
+    for (uint32_t i = 0; i < num_elems_; i++) {
+      decoded_[i] = alp_internal::AlpUnscale<CppType>(static_cast<int64_t>(digits[i]), e, f);
+    }
+
+    if (PREDICT_FALSE(end - pos !=
+                      static_cast<ptrdiff_t>(num_exceptions *
+                                             (sizeof(uint32_t) + sizeof(CppType))))) {
+      return Status::Corruption("ALP block exceptions size mismatch");
+    }
+    const uint8_t* values = pos + num_exceptions * sizeof(uint32_t);
+    for (uint32_t i = 0; i < num_exceptions; i++) {
+      uint32_t idx = DecodeFixed32(pos + i * sizeof(uint32_t));
+      if (PREDICT_FALSE(idx >= num_elems_)) {
+        return Status::Corruption(strings::Substitute("invalid ALP exception position: $0",
+                                                      idx));
+      }
+      decoded_[idx] = UnalignedLoad<CppType>(values + i * sizeof(CppType));
+    }
+    return Status::OK();
+  }
+
+  Status DecodeBitShuffle() {
+    BShufBlockDecoder<Type> bshuf_decoder(Slice(data_.data() + kHeaderSize,
+                                                data_.size() - kHeaderSize));
+    RETURN_NOT_OK(bshuf_decoder.ParseHeader());
+    if (PREDICT_FALSE(bshuf_decoder.Count() != num_elems_)) {
+      return Status::Corruption(strings::Substitute(
+          "ALP block holds $0 elements, but its bitshuffle block holds $1",
+          num_elems_, bshuf_decoder.Count()));
+    }
+    decoded_.resize(num_elems_);
+    size_t n = num_elems_;
+    return bshuf_decoder.CopyNextValuesToArray(&n, reinterpret_cast<uint8_t*>(decoded_.data()));
+  }
+
+  Slice data_;
+  bool parsed_;
+
+  rowid_t ordinal_pos_base_;
+  uint32_t num_elems_;
+  size_t cur_idx_;
+
+  // All of the block's values, decoded by ParseHeader().
+  std::vector<CppType> decoded_;
+};
+
+} // namespace cfile
+} // namespace kudu
+#endif
@@ -275,7 +275,8 @@ Status BinaryDictBlockDecoder::CopyNextAndEval(size_t* n,
   // Predicates that have no matching words should return no data.
   SelectionVector* codewords_matching_pred = parent_cfile_iter_->GetCodeWordsMatchingPredicate();
   CHECK(codewords_matching_pred != nullptr);
-  if (!codewords_matching_pred->AnySelected()) {
+  const size_t num_matching_codewords = codewords_matching_pred->CountSelected();
+  if (num_matching_codewords == 0) {
     // If nothing is selected, move the data_decoder_ pointer forward and clear
     // the corresponding bits in the selection vector.
     int skip = static_cast<int>(*n);
@@ -285,8 +286,9 @@ Status BinaryDictBlockDecoder::CopyNextAndEval(size_t* n,
     return Status::OK();
   }
 
-  // IsNotNull predicates should return all data.
-  if (ctx->pred()->predicate_type() == PredicateType::IsNotNull) {
+  // Predicates which match every word, such as IsNotNull predicates, should
+  // return all data.
+  if (num_matching_codewords == codewords_matching_pred->nrows()) {
     return CopyNextDecodeStrings(n, dst);
   }
 
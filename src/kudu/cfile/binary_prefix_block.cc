@@ -27,8 +27,11 @@
 #include <glog/logging.h>
 
 #include "kudu/cfile/cfile_util.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/port.h"
@@ -447,6 +450,56 @@ Status BinaryPrefixBlockDecoder::CopyNextValues(size_t *n, ColumnDataView *dst)
   return Status::OK();
 }
 
+Status BinaryPrefixBlockDecoder::CopyNextAndEval(size_t* n,
+                                                 ColumnMaterializationContext* ctx,
+                                                 SelectionVectorView* sel,
+                                                 ColumnDataView* dst) {
+  DCHECK(parsed_);
+  CHECK_EQ(dst->type_info()->physical_type(), BINARY);
+
+  DCHECK_EQ(dst->stride(), sizeof(Slice));
+  DCHECK_LE(*n, dst->nrows());
+
+  ctx->SetDecoderEvalSupported();
+  if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+    *n = 0;
+    return Status::OK();
+  }
+
+  Arena* out_arena = dst->arena();
+  Slice* out = reinterpret_cast<Slice*>(dst->data());
+  const size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+
+  // cur_val_ holds the first row, cached from the last call or seek. Each
+  // following row is decoded in place relative to the previous one.
+  for (size_t i = 0; i < max_fetch; i++) {
+    if (i > 0) {
+      RETURN_NOT_OK(ParseNextValue());
+    }
+    // Rows which have already been cleared need not be evaluated.
+    if (sel->TestBit(i)) {
+      Slice cur(cur_val_);
+      if (ctx->pred()->EvaluateCell<BINARY>(static_cast<const void*>(&cur))) {
+        CHECK(out_arena->RelocateSlice(cur, &out[i]));
+      } else {
+        // Mark that the row will not be returned.
+        sel->ClearBit(i);
+      }
+    }
+    cur_idx_++;
+  }
+
+  // Fetch the next value to be returned.
+  if (cur_idx_ < num_elems_) {
+    RETURN_NOT_OK(ParseNextValue());
+  } else {
+    next_ptr_ = nullptr;
+  }
+
+  *n = max_fetch;
+  return Status::OK();
+}
+
 // Decode the lengths pointed to by 'ptr', doing bounds checking.
 //
 // Returns a pointer to where the value itself starts.
@@ -36,6 +36,8 @@ namespace kudu {
 
 class Arena;
 class ColumnDataView;
+class ColumnMaterializationContext;
+class SelectionVectorView;
 
 namespace cfile {
 
@@ -91,6 +93,13 @@ class BinaryPrefixBlockDecoder final : public BlockDecoder {
                                     bool *exact_match) OVERRIDE;
   Status CopyNextValues(size_t *n, ColumnDataView *dst) OVERRIDE;
 
+  // Values are decoded into a scratch buffer and evaluated there, so only the
+  // rows which match the predicate are copied into the destination arena.
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override;
+
   virtual bool HasNext() const OVERRIDE {
     DCHECK(parsed_);
     return cur_idx_ < num_elems_;
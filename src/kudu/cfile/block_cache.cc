@@ -57,6 +57,21 @@ DEFINE_string(block_cache_type, "DRAM",
               "libmemkind 1.8.0 or newer must be available on the system; "
               "otherwise Kudu will crash.");
 
+DEFINE_string(block_cache_eviction_policy, "LRU",
+              "Which eviction policy to use for the block cache. Valid choices "
+              "are 'LRU', 'SLRU' or 'CLOCK'. LRU, the default, evicts the least "
+              "recently used blocks. SLRU (segmented LRU) keeps blocks which have "
+              "been read more than once in a protected segment sized by "
+              "--cache_slru_protected_ratio, so a large scan touching many blocks "
+              "only once doesn't flush the frequently read ones out of the cache. "
+              "CLOCK approximates LRU, but its lookups don't contend with each "
+              "other, which improves scan throughput with many concurrent "
+              "scanners. SLRU and CLOCK are supported only with "
+              "--block_cache_type=DRAM.");
+TAG_FLAG(block_cache_eviction_policy, advanced);
+TAG_FLAG(block_cache_eviction_policy, experimental);
+
+using std::string;
 using strings::Substitute;
 
 template <class T> class scoped_refptr;
@@ -71,10 +86,20 @@ namespace {
 
 Cache* CreateCache(int64_t capacity) {
   const auto mem_type = BlockCache::GetConfiguredCacheMemoryTypeOrDie();
+  const auto policy = BlockCache::GetConfiguredCacheEvictionPolicyOrDie();
   switch (mem_type) {
     case Cache::MemoryType::DRAM:
-      return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::DRAM>(
-          capacity, "block_cache");
+      switch (policy) {
+        case Cache::EvictionPolicy::SLRU:
+          return NewCache<Cache::EvictionPolicy::SLRU, Cache::MemoryType::DRAM>(
+              capacity, "block_cache");
+        case Cache::EvictionPolicy::CLOCK:
+          return NewCache<Cache::EvictionPolicy::CLOCK, Cache::MemoryType::DRAM>(
+              capacity, "block_cache");
+        default:
+          return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::DRAM>(
+              capacity, "block_cache");
+      }
     case Cache::MemoryType::NVM:
       return NewCache<Cache::EvictionPolicy::LRU, Cache::MemoryType::NVM>(
           capacity, "block_cache");
@@ -84,6 +109,25 @@ Cache* CreateCache(int64_t capacity) {
   }
 }
 
+bool ValidateBlockCacheEvictionPolicy() {
+  string policy;
+  ToUpperCase(FLAGS_block_cache_eviction_policy, &policy);
+  if (policy != "LRU" && policy != "SLRU" && policy != "CLOCK") {
+    LOG(ERROR) << Substitute("Unknown block cache eviction policy: '$0' "
+                             "(expected 'LRU', 'SLRU' or 'CLOCK')",
+                             FLAGS_block_cache_eviction_policy);
+    return false;
+  }
+  string type;
+  ToUpperCase(FLAGS_block_cache_type, &type);
+  if (policy != "LRU" && type != "DRAM") {
+    LOG(ERROR) << Substitute("The $0 block cache eviction policy is supported "
+                             "only with --block_cache_type=DRAM", policy);
+    return false;
+  }
+  return true;
+}
+
 } // anonymous namespace
 
 bool ValidateBlockCacheCapacity() {
@@ -117,6 +161,7 @@ bool ValidateBlockCacheCapacity() {
 
 
 GROUP_FLAG_VALIDATOR(block_cache_capacity_mb, ValidateBlockCacheCapacity);
+GROUP_FLAG_VALIDATOR(block_cache_eviction_policy, ValidateBlockCacheEvictionPolicy);
 
 Cache::MemoryType BlockCache::GetConfiguredCacheMemoryTypeOrDie() {
     ToUpperCase(FLAGS_block_cache_type, &FLAGS_block_cache_type);
@@ -132,6 +177,24 @@ Cache::MemoryType BlockCache::GetConfiguredCacheMemoryTypeOrDie() {
   __builtin_unreachable();
 }
 
+Cache::EvictionPolicy BlockCache::GetConfiguredCacheEvictionPolicyOrDie() {
+  ToUpperCase(FLAGS_block_cache_eviction_policy, &FLAGS_block_cache_eviction_policy);
+  if (FLAGS_block_cache_eviction_policy == "LRU") {
+    return Cache::EvictionPolicy::LRU;
+  }
+  if (FLAGS_block_cache_eviction_policy == "SLRU") {
+    return Cache::EvictionPolicy::SLRU;
+  }
+  if (FLAGS_block_cache_eviction_policy == "CLOCK") {
+    return Cache::EvictionPolicy::CLOCK;
+  }
+
+  LOG(FATAL) << "Unknown block cache eviction policy: '"
+             << FLAGS_block_cache_eviction_policy
+             << "' (expected 'LRU', 'SLRU' or 'CLOCK')";
+  __builtin_unreachable();
+}
+
 BlockCache::BlockCache()
     : BlockCache(FLAGS_block_cache_capacity_mb * 1024 * 1024) {
 }
@@ -80,9 +80,8 @@ Status CompressedBlockBuilder::Compress(const vector<Slice>& data_slices, vector
 
   // Compress
   size_t compressed_size;
-  //RETURN_NOT_OK(codec_->Compress(data_slices,
-  //                               buffer_.data() + kHeaderLength, &compressed_size));
-  compressed_size = data_size;
+  RETURN_NOT_OK(codec_->Compress(data_slices,
+                                 buffer_.data() + kHeaderLength, &compressed_size));
   // If the compression was not effective, then store the uncompressed data, so
   // that at read time we don't need to waste CPU executing the codec.
   // We use a user-provided threshold, but also guarantee that the compression saves
@@ -22,6 +22,7 @@
 #include <memory>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include <gflags/gflags_declare.h>
 #include <glog/logging.h>
@@ -49,6 +50,7 @@ using kudu::fs::CountingReadableBlock;
 using kudu::fs::ReadableBlock;
 using std::shared_ptr;
 using std::unique_ptr;
+using std::vector;
 
 namespace kudu {
 namespace cfile {
@@ -94,6 +96,44 @@ TEST_F(BloomFileTest, TestWriteAndRead) {
   VerifyBloomFile();
 }
 
+// Verify that checking a sorted batch of keys spanning many bloom blocks
+// yields the same results as checking the keys one by one.
+TEST_F(BloomFileTest, TestCheckKeysPresent) {
+  NO_FATALS(WriteTestBloomFile());
+  ASSERT_OK(OpenBloomFile());
+
+  // Interleave the inserted keys with keys which were never inserted (the
+  // inserted keys are bitshifted, so setting the last bit makes a key absent),
+  // and add a few keys past the last inserted one.
+  vector<uint64_t> key_bufs;
+  for (uint64_t i = 0; i < FLAGS_n_keys + 10; i++) {
+    key_bufs.push_back(BigEndian::FromHost64(i << kKeyShift));
+    key_bufs.push_back(BigEndian::FromHost64((i << kKeyShift) | 1));
+  }
+  vector<BloomKeyProbe> probes;
+  probes.reserve(key_bufs.size());
+  for (const auto& key_buf : key_bufs) {
+    probes.emplace_back(Slice(reinterpret_cast<const uint8_t*>(&key_buf), sizeof(key_buf)));
+  }
+  vector<const BloomKeyProbe*> probe_ptrs;
+  for (const auto& probe : probes) {
+    probe_ptrs.push_back(&probe);
+  }
+
+  unique_ptr<bool[]> present(new bool[probes.size()]);
+  ASSERT_OK(bfr()->CheckKeysPresent(probe_ptrs.data(), probe_ptrs.size(),
+                                    nullptr, present.get()));
+  for (int i = 0; i < probes.size(); i++) {
+    SCOPED_TRACE(i);
+    bool expected = false;
+    ASSERT_OK(bfr()->CheckKeyPresent(probes[i], nullptr, &expected));
+    ASSERT_EQ(expected, present[i]);
+    if (i % 2 == 0 && i / 2 < FLAGS_n_keys) {
+      ASSERT_TRUE(present[i]);
+    }
+  }
+}
+
 #ifdef NDEBUG
 TEST_F(BloomFileTest, Benchmark) {
   NO_FATALS(WriteTestBloomFile());
@@ -16,6 +16,7 @@
 // under the License.
 #include "kudu/cfile/bloomfile.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <string>
@@ -288,6 +289,14 @@ Status BloomFileReader::ParseBlockHeader(const Slice& block,
 Status BloomFileReader::CheckKeyPresent(const BloomKeyProbe &probe,
                                         const IOContext* io_context,
                                         bool *maybe_present) {
+  const BloomKeyProbe* probes[] = { &probe };
+  return CheckKeysPresent(probes, 1, io_context, maybe_present);
+}
+
+Status BloomFileReader::CheckKeysPresent(const BloomKeyProbe* const* probes,
+                                         int num_probes,
+                                         const IOContext* io_context,
+                                         bool* maybe_present) {
   DCHECK(init_once_.init_succeeded());
 
   // Since we frequently will access the same BloomFile many times in a row
@@ -305,39 +314,75 @@ Status BloomFileReader::CheckKeyPresent(const BloomKeyProbe &probe,
   DCHECK_EQ(reader_.get(), bci->index_iter.cfile_reader())
       << "Cached index reader does not match expected instance";
 
+  // How many keys ahead of the one being tested to prefetch the bloom filter
+  // bits for.
+  static constexpr int kPrefetchDistance = 8;
+
   IndexTreeIterator* index_iter = &bci->index_iter;
-  Status s = index_iter->SeekAtOrBefore(probe.key());
-  if (PREDICT_FALSE(s.IsNotFound())) {
-    // Seek to before the first entry in the file.
-    *maybe_present = false;
-    return Status::OK();
-  }
-  RETURN_NOT_OK(s);
-
-  // Successfully found the pointer to the bloom block.
-  BlockPointer bblk_ptr = index_iter->GetCurrentBlockPointer();
-
-  // If the previous lookup from this bloom on this thread seeked to a different
-  // block in the BloomFile, we need to read the correct block and re-hydrate the
-  // BloomFilter instance.
-  if (!bci->cur_block_pointer.Equals(bblk_ptr)) {
-    BlockHandle dblk_data;
-    RETURN_NOT_OK(reader_->ReadBlock(io_context, bblk_ptr,
-                                     CFileReader::CACHE_BLOCK, &dblk_data));
-
-    // Parse the header in the block.
-    BloomBlockHeaderPB hdr;
-    Slice bloom_data;
-    RETURN_NOT_OK(ParseBlockHeader(dblk_data.data(), &hdr, &bloom_data));
-
-    // Save the data back into our threadlocal cache.
-    bci->cur_bloom = BloomFilter(bloom_data, hdr.num_hash_functions());
-    bci->cur_block_pointer = bblk_ptr;
-    bci->cur_block_handle = std::move(dblk_data);
-  }
+  int i = 0;
+  while (i < num_probes) {
+    DCHECK(i == 0 || probes[i - 1]->key().compare(probes[i]->key()) <= 0)
+        << "probes must be sorted by key";
+    Status s = index_iter->SeekAtOrBefore(probes[i]->key());
+    if (PREDICT_FALSE(s.IsNotFound())) {
+      // Seek to before the first entry in the file.
+      maybe_present[i++] = false;
+      continue;
+    }
+    RETURN_NOT_OK(s);
+
+    // Successfully found the pointer to the bloom block.
+    BlockPointer bblk_ptr = index_iter->GetCurrentBlockPointer();
+
+    // Find the run of keys which fall into the same bloom block: those before
+    // the first key of the next block. Stepping the index iterator is needed
+    // only if there are more keys to check.
+    int run_end = i + 1;
+    if (run_end < num_probes) {
+      if (index_iter->HasNext()) {
+        RETURN_NOT_OK(index_iter->Next());
+        Slice next_block_key = index_iter->GetCurrentKey();
+        while (run_end < num_probes &&
+               probes[run_end]->key().compare(next_block_key) < 0) {
+          run_end++;
+        }
+      } else {
+        run_end = num_probes;
+      }
+    }
+
+    // If the previous lookup from this bloom on this thread seeked to a different
+    // block in the BloomFile, we need to read the correct block and re-hydrate the
+    // BloomFilter instance.
+    if (!bci->cur_block_pointer.Equals(bblk_ptr)) {
+      BlockHandle dblk_data;
+      RETURN_NOT_OK(reader_->ReadBlock(io_context, bblk_ptr,
+                                       CFileReader::CACHE_BLOCK, &dblk_data));
+
+      // Parse the header in the block.
+      BloomBlockHeaderPB hdr;
+      Slice bloom_data;
+      RETURN_NOT_OK(ParseBlockHeader(dblk_data.data(), &hdr, &bloom_data));
+
+      // Save the data back into our threadlocal cache.
+      bci->cur_bloom = BloomFilter(bloom_data, hdr.num_hash_functions());
+      bci->cur_block_pointer = bblk_ptr;
+      bci->cur_block_handle = std::move(dblk_data);
+    }
 
-  // Actually check the bloom filter.
-  *maybe_present = bci->cur_bloom.MayContainKey(probe);
+    // Actually check the bloom filter, prefetching the bits for the keys
+    // further in the run.
+    const BloomFilter& bloom = bci->cur_bloom;
+    for (int k = i + 1; k < std::min(run_end, i + kPrefetchDistance); k++) {
+      bloom.Prefetch(*probes[k]);
+    }
+    for (; i < run_end; i++) {
+      if (i + kPrefetchDistance < run_end) {
+        bloom.Prefetch(*probes[i + kPrefetchDistance]);
+      }
+      maybe_present[i] = bloom.MayContainKey(*probes[i]);
+    }
+  }
   return Status::OK();
 }
 
@@ -117,6 +117,18 @@ class BloomFileReader {
                          const fs::IOContext* io_context,
                          bool* maybe_present);
 
+  // Check if each of the given keys may be present in the file, setting
+  // maybe_present[i] for probes[i]. The probes must be sorted by key.
+  //
+  // This is equivalent to calling CheckKeyPresent() for each key, but the
+  // bloom block is located and loaded once for each run of keys falling
+  // into the same block, and the bloom filter bits for the keys of a run
+  // are prefetched ahead of testing them.
+  Status CheckKeysPresent(const BloomKeyProbe* const* probes,
+                          int num_probes,
+                          const fs::IOContext* io_context,
+                          bool* maybe_present);
+
   // Can be called before Init().
   uint64_t FileSize() const {
     return reader_->file_size();
@@ -22,6 +22,7 @@
 #include <ctime>
 #include <functional>
 #include <initializer_list>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -41,7 +42,9 @@
 #include "kudu/cfile/cfile_writer.h"
 #include "kudu/cfile/index_btree.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/cfile/zone_map.h"
 #include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/encoded_key.h"
@@ -866,6 +869,7 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestAppendRaw) {
   TestReadWriteRawBlocks(SNAPPY, 1000);
   TestReadWriteRawBlocks(LZ4, 1000);
   TestReadWriteRawBlocks(ZLIB, 1000);
+  TestReadWriteRawBlocks(ZSTD, 1000);
 }
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestChecksumFlags) {
@@ -928,6 +932,7 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestNullInts) {
   TestNullTypes(&generator, BIT_SHUFFLE, LZ4);
   TestNullTypes(&generator, RLE, NO_COMPRESSION);
   TestNullTypes(&generator, RLE, LZ4);
+  TestNullTypes(&generator, BIT_SHUFFLE, ZSTD);
 }
 
 TEST_P(TestCFileBothCacheMemoryTypes, TestNullFloats) {
@@ -1100,6 +1105,102 @@ TEST_P(TestCFileBothCacheMemoryTypes, TestValidateBlockCacheCapacity) {
   }
 }
 
+TEST_P(TestCFileBothCacheMemoryTypes, TestZoneMaps) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+
+  const int kNumRows = 10000;
+  BlockId block_id;
+  UInt32DataGenerator<true> generator;
+  WriteTestFile(&generator, PLAIN_ENCODING, NO_COMPRESSION, kNumRows,
+                SMALL_BLOCKSIZE | WRITE_ZONE_MAPS, &block_id);
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+
+  // Compute the expected file-level statistics.
+  int expected_nulls = 0;
+  uint32_t expected_min = std::numeric_limits<uint32_t>::max();
+  uint32_t expected_max = 0;
+  for (int i = 0; i < kNumRows; i++) {
+    if (generator.TestValueShouldBeNull(i)) {
+      expected_nulls++;
+      continue;
+    }
+    uint32_t v = generator.BuildTestValue(0, i);
+    expected_min = std::min(expected_min, v);
+    expected_max = std::max(expected_max, v);
+  }
+
+  const ZoneMapPB* zone_map = reader->zone_map();
+  ASSERT_NE(nullptr, zone_map);
+  ASSERT_EQ(kNumRows, zone_map->num_rows());
+  ASSERT_EQ(expected_nulls, zone_map->null_count());
+  ASSERT_EQ(sizeof(uint32_t), zone_map->min_value().size());
+  ASSERT_EQ(sizeof(uint32_t), zone_map->max_value().size());
+  uint32_t min_value;
+  uint32_t max_value;
+  memcpy(&min_value, zone_map->min_value().data(), sizeof(min_value));
+  memcpy(&max_value, zone_map->max_value().data(), sizeof(max_value));
+  ASSERT_EQ(expected_min, min_value);
+  ASSERT_EQ(expected_max, max_value);
+
+  // The per-block zone maps should cover the file without gaps.
+  const BlockZoneMapsPB* block_zone_maps;
+  ASSERT_OK(reader->GetBlockZoneMaps(nullptr, &block_zone_maps));
+  ASSERT_GT(block_zone_maps->zone_maps_size(), 1);
+  int64_t next_row = 0;
+  int64_t total_nulls = 0;
+  for (const auto& block_zone_map : block_zone_maps->zone_maps()) {
+    ASSERT_EQ(next_row, block_zone_map.first_row());
+    next_row += block_zone_map.num_rows();
+    total_nulls += block_zone_map.null_count();
+  }
+  ASSERT_EQ(kNumRows, next_row);
+  ASSERT_EQ(expected_nulls, total_nulls);
+
+  // Predicates that no value in the file can satisfy are excluded by the
+  // file-level zone map.
+  ColumnSchema col("c", UINT32, true);
+  uint32_t too_big = expected_max + 1;
+  ASSERT_FALSE(ZoneMapMayMatch(ColumnPredicate::Equality(col, &too_big), *zone_map));
+  ASSERT_FALSE(ZoneMapMayMatch(ColumnPredicate::Range(col, &too_big, nullptr), *zone_map));
+  ASSERT_TRUE(ZoneMapMayMatch(ColumnPredicate::IsNull(col), *zone_map));
+  ASSERT_TRUE(ZoneMapMayMatch(ColumnPredicate::IsNotNull(col), *zone_map));
+
+  // Since the values increase with the row index, an equality predicate on
+  // a non-null value matches exactly the block which contains it.
+  const int kRow = 5000;
+  ASSERT_FALSE(generator.TestValueShouldBeNull(kRow));
+  uint32_t target = generator.BuildTestValue(0, kRow);
+  auto pred = ColumnPredicate::Equality(col, &target);
+  int matching_blocks = 0;
+  for (const auto& block_zone_map : block_zone_maps->zone_maps()) {
+    if (ZoneMapMayMatch(pred, block_zone_map)) {
+      matching_blocks++;
+      ASSERT_LE(block_zone_map.first_row(), kRow);
+      ASSERT_GT(block_zone_map.first_row() + block_zone_map.num_rows(), kRow);
+    }
+  }
+  ASSERT_EQ(1, matching_blocks);
+}
+
+TEST_P(TestCFileBothCacheMemoryTypes, TestNoZoneMapsByDefault) {
+  RETURN_IF_NO_NVM_CACHE(GetParam());
+
+  BlockId block_id;
+  UInt32DataGenerator<false> generator;
+  WriteTestFile(&generator, PLAIN_ENCODING, NO_COMPRESSION, 1000,
+                NO_FLAGS, &block_id);
+
+  unique_ptr<ReadableBlock> block;
+  ASSERT_OK(fs_manager_->OpenBlock(block_id, &block));
+  unique_ptr<CFileReader> reader;
+  ASSERT_OK(CFileReader::Open(std::move(block), ReaderOptions(), &reader));
+  ASSERT_EQ(nullptr, reader->zone_map());
+}
+
 class TestCFileDifferentCodecs : public TestCFile,
                                  public testing::WithParamInterface<CompressionType> {
 };
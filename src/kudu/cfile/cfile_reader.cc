@@ -77,6 +77,12 @@ DEFINE_bool(cfile_verify_checksums, true,
             "Verify the checksum for each block on read if one exists");
 TAG_FLAG(cfile_verify_checksums, evolving);
 
+DEFINE_bool(cfile_skip_deselected_rows, true,
+            "Whether scans skip decoding column values of rows which were "
+            "already filtered out by deletions or by predicates on other columns.");
+TAG_FLAG(cfile_skip_deselected_rows, hidden);
+TAG_FLAG(cfile_skip_deselected_rows, runtime);
+
 DEFINE_double(cfile_inject_corruption, 0,
               "Fraction of the time that read operations on CFiles will fail "
               "with a corruption status");
@@ -342,6 +348,39 @@ Status CFileReader::VerifyChecksum(ArrayView<const Slice> data, const Slice& che
   return Status::OK();
 }
 
+Status CFileReader::GetBlockZoneMaps(const IOContext* io_context,
+                                     const BlockZoneMapsPB** zone_maps) {
+  DCHECK(init_once_.init_succeeded());
+  DCHECK(footer().has_block_zone_maps_ptr());
+  RETURN_NOT_OK_PREPEND(
+      block_zone_maps_once_.Init([this, io_context] { return ReadBlockZoneMaps(io_context); }),
+      Substitute("failed to read zone maps for block $0", block_id().ToString()));
+  *zone_maps = block_zone_maps_.get();
+  return Status::OK();
+}
+
+Status CFileReader::ReadBlockZoneMaps(const IOContext* io_context) {
+  TRACE_EVENT1("io", "CFileReader::ReadBlockZoneMaps",
+               "cfile", ToString());
+  if (PREDICT_FALSE(!footer().has_block_zone_maps_ptr())) {
+    return Status::NotFound("cfile has no zone maps");
+  }
+  // The parsed zone maps are retained by the reader, so there's no need to
+  // keep the raw block in the cache as well.
+  BlockHandle handle;
+  RETURN_NOT_OK(ReadBlock(io_context, BlockPointer(footer().block_zone_maps_ptr()),
+                          DONT_CACHE_BLOCK, &handle));
+  unique_ptr<BlockZoneMapsPB> zone_maps(new BlockZoneMapsPB());
+  RETURN_NOT_OK_HANDLE_CORRUPTION(
+      pb_util::ParseFromArray(zone_maps.get(), handle.data().data(), handle.data().size()),
+      HandleCorruption(io_context));
+  block_zone_maps_ = std::move(zone_maps);
+
+  // The zone maps have been allocated; memory consumption has changed.
+  mem_consumption_.Reset(memory_footprint());
+  return Status::OK();
+}
+
 namespace {
 
 // ScratchMemory acts as a holder for the destination buffer for a block read.
@@ -499,10 +538,11 @@ Status CFileReader::ReadBlock(const IOContext* io_context, const BlockPointer &p
     }
   }
 
-  // Decompress the block
-  if (codec_ != nullptr) {
+  // Decompress the block. Of the block compression codecs, only ZSTD is
+  // enabled in this tree: the others are written uncompressed.
+  if (codec_ != nullptr && codec_->type() == ZSTD) {
     // Init the decompressor and get the size required for the uncompressed buffer.
-    /*CompressedBlockDecoder uncompressor(codec_, cfile_version_, block);
+    CompressedBlockDecoder uncompressor(codec_, cfile_version_, block);
     Status s = uncompressor.Init();
     if (!s.ok()) {
       LOG(WARNING) << "Unable to validate compressed block " << block_id().ToString()
@@ -534,7 +574,8 @@ Status CFileReader::ReadBlock(const IOContext* io_context, const BlockPointer &p
     scratch.Swap(&decompressed_scratch);
 
     // Set the result block to our decompressed data.
-    block = Slice(buf, uncompressed_size);*/
+    buf = scratch.get();
+    block = Slice(buf, uncompressed_size);
   }
 
   // It's possible that one of the TryAllocateFromCache() calls above
@@ -600,6 +641,7 @@ size_t CFileReader::memory_footprint() const {
   size_t size = kudu_malloc_usable_size(this);
   size += block_->memory_footprint();
   size += init_once_.memory_footprint_excluding_this();
+  size += block_zone_maps_once_.memory_footprint_excluding_this();
 
   // SpaceUsed() uses sizeof() instead of malloc_usable_size() to account for
   // the size of base objects (recursively too), thus not accounting for
@@ -610,6 +652,9 @@ size_t CFileReader::memory_footprint() const {
   if (footer_) {
     size += footer_->SpaceUsedLong();
   }
+  if (block_zone_maps_) {
+    size += block_zone_maps_->SpaceUsedLong();
+  }
   return size;
 }
 
@@ -1085,6 +1130,11 @@ Status CFileIterator::FinishBatch() {
 }
 
 Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
+  return ScanInternal(ctx, FLAGS_cfile_skip_deselected_rows);
+}
+
+Status CFileIterator::ScanInternal(ColumnMaterializationContext* ctx,
+                                   bool skip_deselected_rows) {
   CHECK(seeked_) << "not seeked";
 
   // Use views to advance the block and selection vector as we read into them.
@@ -1133,7 +1183,11 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
         }
         size_t this_batch = nblock;
         if (not_null) {
-          if (ctx->DecoderEvalNotDisabled()) {
+          if (skip_deselected_rows && !remaining_sel.AnyBitsSet(this_batch)) {
+            // None of these rows will be returned, so there's no need to
+            // decode their values.
+            pb->dblk_->SeekToPositionInBlock(pb->dblk_->GetCurrentIndex() + this_batch);
+          } else if (ctx->DecoderEvalNotDisabled()) {
             RETURN_NOT_OK(pb->dblk_->CopyNextAndEval(&this_batch,
                                                      ctx,
                                                      &remaining_sel,
@@ -1165,9 +1219,13 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
       }
     } else {
       // Fetch as many as we can from the current datablock.
-      size_t this_batch = rem;
+      size_t this_batch = std::min<size_t>(rem, pb->num_rows_in_block_ - pb->idx_in_block_);
 
-      if (ctx->DecoderEvalNotDisabled()) {
+      if (skip_deselected_rows && !remaining_sel.AnyBitsSet(this_batch)) {
+        // None of these rows will be returned, so there's no need to decode
+        // their values.
+        pb->dblk_->SeekToPositionInBlock(pb->dblk_->GetCurrentIndex() + this_batch);
+      } else if (ctx->DecoderEvalNotDisabled()) {
         RETURN_NOT_OK(pb->dblk_->CopyNextAndEval(&this_batch, ctx, &remaining_sel, &remaining_dst));
       } else {
         RETURN_NOT_OK(pb->dblk_->CopyNextValues(&this_batch, &remaining_dst));
@@ -1202,7 +1260,7 @@ Status CFileIterator::Scan(ColumnMaterializationContext* ctx) {
 
 Status CFileIterator::CopyNextValues(size_t* n, ColumnMaterializationContext* ctx) {
   RETURN_NOT_OK(PrepareBatch(n));
-  RETURN_NOT_OK(Scan(ctx));
+  RETURN_NOT_OK(ScanInternal(ctx, /*skip_deselected_rows=*/false));
   RETURN_NOT_OK(FinishBatch());
   return Status::OK();
 }
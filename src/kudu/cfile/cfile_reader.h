@@ -177,6 +177,20 @@ class CFileReader {
   // Returns true if the file has checksums on the header, footer, and data blocks.
   bool has_checksums() const;
 
+  // Returns the zone map summarizing all the values in the file, or nullptr
+  // if the file was written without zone maps.
+  const ZoneMapPB* zone_map() const {
+    return footer().has_zone_map() ? &footer().zone_map() : nullptr;
+  }
+
+  // Sets '*zone_maps' to the zone maps of each data block in the file,
+  // reading them from disk on the first call. The returned zone maps remain
+  // valid for the lifetime of the reader.
+  //
+  // REQUIRES: zone_map() != nullptr.
+  Status GetBlockZoneMaps(const fs::IOContext* io_context,
+                          const BlockZoneMapsPB** zone_maps);
+
   // Can be called before Init().
   std::string ToString() const { return block_->id().ToString(); }
 
@@ -198,6 +212,9 @@ class CFileReader {
   Status ReadAndParseFooter();
   Status VerifyChecksum(ArrayView<const Slice> data, const Slice& checksum) const;
 
+  // Callback used in 'block_zone_maps_once_' to read the per-block zone maps.
+  Status ReadBlockZoneMaps(const fs::IOContext* io_context);
+
   // Returns the memory usage of the object including the object itself.
   size_t memory_footprint() const;
 
@@ -217,6 +234,10 @@ class CFileReader {
 
   KuduOnceLambda init_once_;
 
+  // Per-data-block zone maps, lazily loaded by GetBlockZoneMaps().
+  std::unique_ptr<BlockZoneMapsPB> block_zone_maps_;
+  KuduOnceLambda block_zone_maps_once_;
+
   ScopedTrackedConsumption mem_consumption_;
 };
 
@@ -266,6 +287,8 @@ class ColumnIterator {
   // calls to Scan() will re-read the same values.
   // If decoder eval is supported and allowed, will additionally evaluate the
   // column predicate.
+  // Rows which are already deselected in the ctx's selection vector may be
+  // skipped, in which case their cells in the block are left unspecified.
   virtual Status Scan(ColumnMaterializationContext* ctx) = 0;
 
   // Finish processing the current batch, advancing the iterators
@@ -370,6 +393,8 @@ class CFileIterator : public ColumnIterator {
   // arena.
   // This does _not_ advance the position in the underlying file. Multiple
   // calls to Scan() will re-read the same values.
+  // Runs of rows which are already deselected in the ctx's selection vector
+  // are skipped over without being decoded.
   Status Scan(ColumnMaterializationContext* ctx) override;
 
   // Finish processing the current batch, advancing the iterators
@@ -381,6 +406,8 @@ class CFileIterator : public ColumnIterator {
   bool HasNext() const;
 
   // Convenience method to prepare a batch, scan it, and finish it.
+  // Unlike Scan(), this copies every value regardless of the ctx's selection
+  // vector.
   Status CopyNextValues(size_t* n, ColumnMaterializationContext* ctx);
 
   const IteratorStats &io_statistics() const OVERRIDE {
@@ -445,6 +472,11 @@ class CFileIterator : public ColumnIterator {
   // Seek the given PreparedBlock to the given index within it.
   void SeekToPositionInBlock(PreparedBlock *pb, uint32_t idx_in_block);
 
+  // Implementation of Scan(). If 'skip_deselected_rows' is true, data block
+  // runs in which no row is selected in the ctx's selection vector are
+  // skipped rather than decoded.
+  Status ScanInternal(ColumnMaterializationContext* ctx, bool skip_deselected_rows);
+
   // Read the data block currently pointed to by idx_iter_
   // into the given PreparedBlock structure.
   //
@@ -47,6 +47,7 @@ WriterOptions::WriterOptions()
     write_posidx(false),
     write_validx(false),
     optimize_index_keys(true),
+    write_zone_maps(false),
     validx_key_encoder(boost::none) {
 }
 
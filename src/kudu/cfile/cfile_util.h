@@ -52,6 +52,12 @@ enum IncompatibleFeatures {
   SUPPORTED = NONE | CHECKSUM
 };
 
+// Used to set the CFileFooterPB bitset tracking compatible features
+enum CompatibleFeatures {
+  // Per-file and per-data-block min/max/null-count statistics.
+  ZONE_MAPS = 1 << 0
+};
+
 typedef std::function<void(const void*, faststring*)> ValidxKeyEncoder;
 
 struct WriterOptions {
@@ -79,6 +85,10 @@ struct WriterOptions {
   // instead of entire keys.
   bool optimize_index_keys;
 
+  // Whether the file should carry zone maps (min/max/null-count statistics)
+  // for each data block and for the file as a whole.
+  bool write_zone_maps;
+
   // Column storage attributes.
   //
   // Default: all default values as specified in the constructor in
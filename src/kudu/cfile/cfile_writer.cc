@@ -34,6 +34,7 @@
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/index_btree.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/cfile/zone_map.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/key_encoder.h"
 #include "kudu/common/schema.h"
@@ -61,6 +62,12 @@ DEFINE_bool(cfile_write_checksums, true,
             "Write CRC32 checksums for each block");
 TAG_FLAG(cfile_write_checksums, evolving);
 
+DEFINE_bool(cfile_write_zone_maps, true,
+            "Write min/max/null-count statistics for each data block of "
+            "columns configured to carry them, allowing scans to skip blocks "
+            "which cannot match their predicates");
+TAG_FLAG(cfile_write_zone_maps, evolving);
+
 using google::protobuf::RepeatedPtrField;
 using kudu::fs::BlockCreationTransaction;
 using kudu::fs::BlockManager;
@@ -138,6 +145,12 @@ CFileWriter::CFileWriter(WriterOptions options,
 
     validx_builder_.reset(new IndexTreeBuilder(&options_, this));
   }
+
+  if (options_.write_zone_maps && FLAGS_cfile_write_zone_maps) {
+    block_zone_map_.reset(new ZoneMapBuilder(typeinfo_));
+    file_zone_map_.reset(new ZoneMapBuilder(typeinfo_));
+    block_zone_maps_.reset(new BlockZoneMapsPB());
+  }
 }
 
 CFileWriter::~CFileWriter() {
@@ -153,6 +166,14 @@ Status CFileWriter::Start() {
     RETURN_NOT_OK(GetCompressionCodec(compression_, &codec));
     block_compressor_.reset(new CompressedBlockBuilder(codec));
   }*/
+  // Of the block compression codecs, only ZSTD is enabled in this tree.
+  if (compression_ == ZSTD) {
+    const CompressionCodec* codec;
+    RETURN_NOT_OK(GetCompressionCodec(compression_,
+                                      options_.storage_attributes.compression_level,
+                                      &codec));
+    block_compressor_.reset(new CompressedBlockBuilder(codec));
+  }
 
   CFileHeaderPB header;
   FlushMetadataToPB(header.mutable_metadata());
@@ -238,6 +259,10 @@ Status CFileWriter::FinishAndReleaseBlock(BlockCreationTransaction* transaction)
     footer.mutable_validx_info()->CopyFrom(validx_info);
   }
 
+  if (block_zone_maps_) {
+    RETURN_NOT_OK_PREPEND(FinishZoneMaps(&footer), "Couldn't write zone maps");
+  }
+
   // Optionally append extra information to the end of cfile.
   // Example: dictionary block for dictionary encoding
   RETURN_NOT_OK(data_block_->AppendExtraInfo(this, &footer));
@@ -306,6 +331,9 @@ Status CFileWriter::AppendEntries(const void *entries, size_t count) {
     int n = data_block_->Add(ptr, rem);
     DCHECK_GE(n, 0);
 
+    if (block_zone_map_) {
+      block_zone_map_->AddValues(ptr, n);
+    }
     ptr += typeinfo_->size() * n;
     rem -= n;
     value_count_ += n;
@@ -336,6 +364,9 @@ Status CFileWriter::AppendNullableEntries(const uint8_t *bitmap,
         int n = data_block_->Add(ptr, rem);
         DCHECK_GE(n, 0);
 
+        if (block_zone_map_) {
+          block_zone_map_->AddValues(ptr, n);
+        }
         non_null_bitmap_builder_->AddRun(true, n);
         ptr += n * typeinfo_->size();
         value_count_ += n;
@@ -348,6 +379,9 @@ Status CFileWriter::AppendNullableEntries(const uint8_t *bitmap,
       } while (rem > 0);
     } else {
       non_null_bitmap_builder_->AddRun(false, nitems);
+      if (block_zone_map_) {
+        block_zone_map_->AddNulls(nitems);
+      }
       ptr += nitems * typeinfo_->size();
       value_count_ += nitems;
     }
@@ -403,6 +437,15 @@ Status CFileWriter::FinishCurDataBlock() {
     non_null_bitmap_builder_->Reset();
   }
 
+  if (block_zone_map_) {
+    DCHECK_EQ(num_elems_in_block, block_zone_map_->num_rows());
+    ZoneMapPB* zone_map = block_zone_maps_->add_zone_maps();
+    block_zone_map_->ToPB(zone_map);
+    zone_map->set_first_row(first_elem_ord);
+    file_zone_map_->Merge(*block_zone_map_);
+    block_zone_map_->Reset();
+  }
+
   if (validx_builder_ != nullptr) {
     RETURN_NOT_OK(data_block_->GetLastKey(key_tmp_space));
     (*options_.validx_key_encoder)(key_tmp_space, &last_key_);
@@ -412,6 +455,17 @@ Status CFileWriter::FinishCurDataBlock() {
   return s;
 }
 
+Status CFileWriter::FinishZoneMaps(CFileFooterPB* footer) {
+  faststring buf;
+  pb_util::SerializeToString(*block_zone_maps_, &buf);
+  BlockPointer ptr;
+  RETURN_NOT_OK(AddBlock({ Slice(buf) }, &ptr, "zone map block"));
+  ptr.CopyToPB(footer->mutable_block_zone_maps_ptr());
+  file_zone_map_->ToPB(footer->mutable_zone_map());
+  footer->set_compatible_features(footer->compatible_features() | CompatibleFeatures::ZONE_MAPS);
+  return Status::OK();
+}
+
 Status CFileWriter::AppendRawBlock(const vector<Slice>& data_slices,
                                    size_t ordinal_pos,
                                    const void *validx_curr,
@@ -462,13 +516,12 @@ Status CFileWriter::AddBlock(const vector<Slice> &data_slices,
 
   if (block_compressor_ != nullptr) {
     // Write compressed block
-    /*Status s = block_compressor_->Compress(data_slices, &out_slices);
+    Status s = block_compressor_->Compress(data_slices, &out_slices);
     if (!s.ok()) {
       LOG(WARNING) << "Unable to compress block at offset " << off_
                    << ": " << s.ToString();
       return s;
-    }*/
-    out_slices = data_slices;
+    }
   } else {
     out_slices = data_slices;
   }
@@ -43,10 +43,13 @@ namespace cfile {
 
 class BlockBuilder;
 class BlockPointer;
+class BlockZoneMapsPB;
+class CFileFooterPB;
 class CompressedBlockBuilder;
 class FileMetadataPairPB;
 class IndexTreeBuilder;
 class TypeEncodingInfo;
+class ZoneMapBuilder;
 
 // Magic used in header/footer
 extern const char kMagicStringV1[];
@@ -191,6 +194,10 @@ class CFileWriter {
 
   Status FinishCurDataBlock();
 
+  // Write out the per-block zone maps and fill in the zone map fields of
+  // 'footer'.
+  Status FinishZoneMaps(CFileFooterPB* footer);
+
   // Flush the current unflushed_metadata_ entries into the given protobuf
   // field, clearing the buffer.
   void FlushMetadataToPB(google::protobuf::RepeatedPtrField<FileMetadataPairPB> *field);
@@ -228,6 +235,13 @@ class CFileWriter {
   std::unique_ptr<NullBitmapBuilder> non_null_bitmap_builder_;
   std::unique_ptr<CompressedBlockBuilder> block_compressor_;
 
+  // Zone map statistics for the current data block and for the whole file,
+  // along with the zone maps of the data blocks written so far. Only set if
+  // the writer was configured to write zone maps.
+  std::unique_ptr<ZoneMapBuilder> block_zone_map_;
+  std::unique_ptr<ZoneMapBuilder> file_zone_map_;
+  std::unique_ptr<BlockZoneMapsPB> block_zone_maps_;
+
   enum State {
     kWriterInitialized,
     kWriterWriting,
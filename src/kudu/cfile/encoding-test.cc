@@ -19,9 +19,11 @@
 
 #include <algorithm>
 #include <climits>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
 #include <limits>
@@ -34,18 +36,23 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/cfile/alp_block.h"
 #include "kudu/cfile/binary_plain_block.h"
 #include "kudu/cfile/binary_prefix_block.h"
 #include "kudu/cfile/block_encodings.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/type_encodings.h"
+#include "kudu/common/column_materialization_context.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding-inl.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/group_varint-inl.h"
 #include "kudu/util/hexdump.h"
@@ -108,6 +115,28 @@ class TestEncoding : public KuduTest {
     return bd;
   }
 
+  // Decodes the remaining values of 'bd' into 'dst' with CopyNextAndEval(),
+  // in batches of random sizes. Rows of 'sel' which don't match 'pred' are
+  // cleared; the values of the rows left selected are copied into 'dst'.
+  static void CopyAllAndEval(BlockDecoder* bd,
+                             const ColumnPredicate& pred,
+                             ColumnBlock* dst,
+                             SelectionVector* sel) {
+    ColumnMaterializationContext ctx(0, &pred, dst, sel);
+    SelectionVectorView sel_view(sel);
+    size_t dec_count = 0;
+    while (bd->HasNext()) {
+      size_t n = std::min(dst->nrows() - dec_count, static_cast<size_t>((random() % 30) + 1));
+      ColumnDataView dst_data(dst, dec_count);
+      ASSERT_OK(bd->CopyNextAndEval(&n, &ctx, &sel_view, &dst_data));
+      ASSERT_GT(n, 0);
+      sel_view.Advance(n);
+      dec_count += n;
+    }
+    ASSERT_FALSE(ctx.DecoderEvalNotSupported());
+    ASSERT_EQ(dst->nrows(), dec_count);
+  }
+
   // Insert a given number of strings into the provided BlockBuilder.
   //
   // The strings are generated using the provided 'formatter' function.
@@ -476,7 +505,8 @@ class TestEncoding : public KuduTest {
                               << "decoding all rows";
 
     for (uint i = 0; i < size; i++) {
-      if (src[i] != decoded[i]) {
+      // Compare the bits, so that NaNs and negative zeros are checked too.
+      if (memcmp(&src[i], &decoded[i], sizeof(CppType)) != 0) {
         FAIL()<< "Fail at index " << i <<
               " inserted=" << src[i] << " got=" << decoded[i];
       }
@@ -699,6 +729,46 @@ class TestEncoding : public KuduTest {
     }
   }
 
+  // Tests that evaluating a predicate while decoding a BINARY block yields the
+  // same rows as evaluating it after decoding.
+  void TestBinaryBlockDecoderEval(EncodingType encoding) {
+    auto sbb = CreateBlockBuilderOrDie(BINARY, encoding);
+    // Long shared prefixes and runs of duplicate values.
+    const auto& GenTestString = [](int i) {
+      return StringPrintf("common_prefix_%06d", i / 3);
+    };
+    const int kCount = 1000;
+    Slice s = CreateBinaryBlock(sbb.get(), kCount, GenTestString);
+    auto sbd = CreateBlockDecoderOrDie(BINARY, encoding, s);
+    ASSERT_OK(sbd->ParseHeader());
+
+    const string lower = GenTestString(100);
+    const string upper = GenTestString(700);
+    const Slice lower_slice(lower);
+    const Slice upper_slice(upper);
+    ColumnPredicate pred = ColumnPredicate::Range(
+        ColumnSchema("c", STRING), &lower_slice, &upper_slice);
+
+    vector<Slice> decoded(kCount);
+    ColumnBlock dst_block(GetTypeInfo(BINARY), nullptr, &decoded[0], kCount, &arena_);
+    SelectionVector sel(kCount);
+    sel.SetAllTrue();
+    // Rows deselected beforehand must stay deselected.
+    for (int i = 0; i < kCount; i += 5) {
+      sel.SetRowUnselected(i);
+    }
+    NO_FATALS(CopyAllAndEval(sbd.get(), pred, &dst_block, &sel));
+
+    for (int i = 0; i < kCount; i++) {
+      const string expected = GenTestString(i);
+      const bool expected_selected = i % 5 != 0 && expected >= lower && expected < upper;
+      ASSERT_EQ(expected_selected, sel.IsRowSelected(i)) << "row " << i;
+      if (expected_selected) {
+        ASSERT_EQ(expected, decoded[i].ToString());
+      }
+    }
+  }
+
   Arena arena_;
   faststring contiguous_buf_;
   WriterOptions default_write_options_;
@@ -780,6 +850,62 @@ TEST_F(TestEncoding, TestBShufDoubleBlockEncoder) {
   TestEncodeDecodeTemplateBlockEncoder<DOUBLE>(doubles.get(), kSize, BIT_SHUFFLE);
 }
 
+// Test for ALP blocks, with data which suits ALP, data which needs
+// exceptions, and data which falls back to bitshuffle.
+TEST_F(TestEncoding, TestAlpDoubleBlockEncoder) {
+  const int kSize = 10000;
+  Random rng(SeedRandom());
+
+  // Readings with two decimal places.
+  vector<double> readings;
+  for (int i = 0; i < kSize; i++) {
+    readings.push_back(std::round(2000 + rng.Uniform(100000)) / 100);
+  }
+  TestEncodeDecodeTemplateBlockEncoder<DOUBLE>(readings.data(), kSize, ALP);
+  auto bb = CreateBlockBuilderOrDie(DOUBLE, ALP);
+  bb->Add(reinterpret_cast<const uint8_t*>(readings.data()), kSize);
+  Slice s = FinishAndMakeContiguous(bb.get(), 0);
+  // Each value fits in 17 bits.
+  ASSERT_LT(s.size(), kSize * 3);
+
+  // Values which don't scale to integers are stored as exceptions.
+  vector<double> specials = { 0.0, -0.0, std::numeric_limits<double>::quiet_NaN(),
+                              std::numeric_limits<double>::infinity(),
+                              -std::numeric_limits<double>::infinity(),
+                              std::numeric_limits<double>::denorm_min(),
+                              std::numeric_limits<double>::max() };
+  for (int i = 0; i < 1000; i++) {
+    specials.push_back(i * 0.25);
+  }
+  TestEncodeDecodeTemplateBlockEncoder<DOUBLE>(specials.data(), specials.size(), ALP);
+
+  // Random doubles fall back to bitshuffle.
+  vector<double> randoms;
+  for (int i = 0; i < kSize; i++) {
+    randoms.push_back(static_cast<double>(rng.Next64()) / rng.Next64());
+  }
+  TestEncodeDecodeTemplateBlockEncoder<DOUBLE>(randoms.data(), kSize, ALP);
+
+  // ALP must be chosen explicitly.
+  ASSERT_EQ(BIT_SHUFFLE, TypeEncodingInfo::GetDefaultEncoding(GetTypeInfo(DOUBLE)));
+}
+
+TEST_F(TestEncoding, TestAlpFloatBlockEncoder) {
+  const int kSize = 10000;
+  Random rng(SeedRandom());
+  vector<float> readings;
+  for (int i = 0; i < kSize; i++) {
+    readings.push_back(rng.Uniform(100000) / 10.0f);
+  }
+  readings.push_back(std::numeric_limits<float>::quiet_NaN());
+  readings.push_back(-0.0f);
+  TestEncodeDecodeTemplateBlockEncoder<FLOAT>(readings.data(), readings.size(), ALP);
+}
+
+TEST_F(TestEncoding, TestAlpEmptyBlockEncodeDecode) {
+  TestEmptyBlockEncodeDecode(DOUBLE, ALP);
+}
+
 TEST_F(TestEncoding, TestRleIntBlockEncoder) {
   auto ibb = CreateBlockBuilderOrDie(UINT32, RLE);
   Random rand(SeedRandom());
@@ -800,6 +926,73 @@ TEST_F(TestEncoding, TestRleIntBlockEncoder) {
   ASSERT_EQ(14UL, s.size());
 }
 
+TEST_F(TestEncoding, TestForDeltaTimestampBlockEncoder) {
+  // Microsecond timestamps arriving roughly every 10ms, with jitter.
+  const int kSize = 10000;
+  Random rng(SeedRandom());
+  vector<int64_t> timestamps;
+  int64_t ts = 1600000000000000L;
+  for (int i = 0; i < kSize; i++) {
+    ts += 10000 + rng.Uniform(100);
+    timestamps.push_back(ts);
+  }
+
+  for (auto encoding : { BIT_SHUFFLE, FOR_DELTA }) {
+    auto bb = CreateBlockBuilderOrDie(INT64, encoding);
+    ASSERT_EQ(kSize, bb->Add(reinterpret_cast<const uint8_t*>(timestamps.data()), kSize));
+    Slice s = FinishAndMakeContiguous(bb.get(), 12345);
+    LOG(INFO) << EncodingType_Name(encoding) << " encoded size for " << kSize
+              << " timestamps: " << s.size();
+    if (encoding == FOR_DELTA) {
+      // Each delta fits in 7 bits, so the block takes under a byte per value.
+      ASSERT_LT(s.size(), kSize);
+    }
+  }
+  TestEncodeDecodeTemplateBlockEncoder<INT64>(timestamps.data(), kSize, FOR_DELTA);
+
+  // Timestamps default to FOR_DELTA, other 64-bit integers don't.
+  ASSERT_EQ(FOR_DELTA, TypeEncodingInfo::GetDefaultEncoding(GetTypeInfo(UNIXTIME_MICROS)));
+  ASSERT_EQ(BIT_SHUFFLE, TypeEncodingInfo::GetDefaultEncoding(GetTypeInfo(INT64)));
+  const TypeEncodingInfo* tei;
+  ASSERT_OK(TypeEncodingInfo::Get(GetTypeInfo(UNIXTIME_MICROS), AUTO_ENCODING, &tei));
+  ASSERT_EQ(FOR_DELTA, tei->encoding_type());
+}
+
+TEST_F(TestEncoding, TestForDeltaEmptyBlockEncodeDecode) {
+  TestEmptyBlockEncodeDecode(INT64, FOR_DELTA);
+}
+
+// Test that FOR and ALP blocks whose element count is more than their
+// mini-blocks can hold are rejected as corrupt, rather than trusted.
+TEST_F(TestEncoding, TestMiniBlockElementCountCorruption) {
+  const auto check_corrupt_count = [&](DataType type, EncodingType encoding, Slice block) {
+    faststring buf;
+    buf.append(block.data(), block.size());
+    InlineEncodeFixed32(&buf[4], std::numeric_limits<uint32_t>::max());
+    auto bd = CreateBlockDecoderOrDie(type, encoding, Slice(buf));
+    Status s = bd->ParseHeader();
+    ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "can't hold");
+  };
+
+  // Constant values are stored in mini-blocks of zero bit width.
+  const int kSize = 1000;
+  vector<int64_t> ints(kSize, 12345);
+  auto ibb = CreateBlockBuilderOrDie(INT64, FOR_DELTA);
+  ibb->Add(reinterpret_cast<const uint8_t*>(ints.data()), kSize);
+  NO_FATALS(check_corrupt_count(INT64, FOR_DELTA, FinishAndMakeContiguous(ibb.get(), 0)));
+
+  vector<double> readings;
+  for (int i = 0; i < kSize; i++) {
+    readings.push_back(i / 100.0);
+  }
+  auto abb = CreateBlockBuilderOrDie(DOUBLE, ALP);
+  abb->Add(reinterpret_cast<const uint8_t*>(readings.data()), kSize);
+  Slice alp_block = FinishAndMakeContiguous(abb.get(), 0);
+  ASSERT_EQ(alp_internal::kAlp, alp_block[8]);
+  NO_FATALS(check_corrupt_count(DOUBLE, ALP, alp_block));
+}
+
 TEST_F(TestEncoding, TestPlainBitMapRoundTrip) {
   TestBoolBlockRoundTrip(PLAIN_ENCODING);
 }
@@ -811,6 +1004,48 @@ TEST_F(TestEncoding, TestRleBitMapRoundTrip) {
 // Test seeking to a value in a small block.
 // Regression test for a bug seen in development where this would
 // infinite loop when there are no 'restarts' in a given block.
+// Tests that the RLE-encoded BOOL decoder evaluates predicates a run at a
+// time, yielding the same rows as evaluating them after decoding.
+TEST_F(TestEncoding, TestRleBitMapDecoderEval) {
+  vector<uint8_t> to_insert;
+  for (int i = 0; i < 10003; ) {
+    int run_size = static_cast<int>(random() % 100) + 1;
+    bool val = random() % 2;
+    to_insert.insert(to_insert.end(), run_size, val);
+    i += run_size;
+  }
+  auto bb = CreateBlockBuilderOrDie(BOOL, RLE);
+  bb->Add(to_insert.data(), to_insert.size());
+  Slice s = FinishAndMakeContiguous(bb.get(), 0);
+
+  for (bool target : { false, true }) {
+    auto bd = CreateBlockDecoderOrDie(BOOL, RLE, s);
+    ASSERT_OK(bd->ParseHeader());
+    ColumnPredicate pred = ColumnPredicate::Equality(ColumnSchema("c", BOOL), &target);
+    vector<uint8_t> decoded(to_insert.size());
+    ColumnBlock dst_block(GetTypeInfo(BOOL), nullptr, &decoded[0], to_insert.size(), &arena_);
+    SelectionVector sel(to_insert.size());
+    sel.SetAllTrue();
+    NO_FATALS(CopyAllAndEval(bd.get(), pred, &dst_block, &sel));
+
+    for (size_t i = 0; i < to_insert.size(); i++) {
+      const bool expected_selected = static_cast<bool>(to_insert[i]) == target;
+      ASSERT_EQ(expected_selected, sel.IsRowSelected(i)) << "row " << i;
+      if (expected_selected) {
+        ASSERT_EQ(target, static_cast<bool>(decoded[i]));
+      }
+    }
+  }
+}
+
+TEST_F(TestEncoding, TestBinaryPrefixBlockDecoderEval) {
+  TestBinaryBlockDecoderEval(PREFIX_ENCODING);
+}
+
+TEST_F(TestEncoding, TestBinaryPlainBlockDecoderEval) {
+  TestBinaryBlockDecoderEval(PLAIN_ENCODING);
+}
+
 TEST_F(TestEncoding, TestBinaryPrefixBlockBuilderSeekByValueSmallBlock) {
   TestBinarySeekByValueSmallBlock(PREFIX_ENCODING);
 }
@@ -876,7 +1111,7 @@ class IntEncodingTest : public TestEncoding, public ::testing::WithParamInterfac
   }
 };
 INSTANTIATE_TEST_CASE_P(Encodings, IntEncodingTest,
-                        ::testing::Values(RLE, PLAIN_ENCODING, BIT_SHUFFLE));
+                        ::testing::Values(RLE, PLAIN_ENCODING, BIT_SHUFFLE, FOR_DELTA));
 
 TEST_P(IntEncodingTest, TestSeekAllTypes) {
   this->template DoIntSeekTest<UINT8>(100, 1000, true);
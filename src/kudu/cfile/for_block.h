@@ -0,0 +1,490 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+//
+// Frame-of-reference (FOR) encoding for integer blocks, optionally applied
+// to the deltas between consecutive values rather than to the values
+// themselves. This suits monotonically increasing columns such as
+// UNIXTIME_MICROS event times and sequence ids: subtracting the minimum
+// delta of each mini-block turns a fixed stride into zero-bit residuals,
+// which is what delta-of-delta encoding achieves, while keeping decoding to
+// a single prefix sum.
+#ifndef KUDU_CFILE_FOR_BLOCK_H
+#define KUDU_CFILE_FOR_BLOCK_H
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/block_encodings.h"
+#include "kudu/cfile/cfile_util.h"
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowid.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/bits.h"
+#include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/coding.h"
+#include "kudu/util/coding-inl.h"
+#include "kudu/util/faststring.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+namespace cfile {
+
+namespace for_internal {
+
+// The number of values sharing a reference value and a bit width.
+constexpr int kMiniBlockSize = 128;
+
+// Zero bytes appended to each block so that values can be unpacked with
+// unaligned 64-bit loads without reading past the end of the block.
+constexpr int kPaddingBytes = 8;
+
+enum Mode : uint8_t {
+  // The values are stored relative to the minimum of their mini-block.
+  kFrameOfReference = 0,
+  // The deltas between consecutive values are stored relative to the
+  // minimum delta of their mini-block.
+  kDelta = 1,
+};
+
+inline int PackedBytes(int num_values, int bit_width) {
+  return (num_values * bit_width + 7) / 8;
+}
+
+// Returns the number of bits needed to represent 'range'.
+inline int BitWidth(uint64_t range) {
+  return range == 0 ? 0 : Bits::Log2Floor64(range) + 1;
+}
+
+// ORs the low 'bit_width' bits of 'val' into 'dst' at bit offset 'bit_pos'.
+// 'val' must not have any higher bits set.
+inline void PackValue(uint64_t val, int bit_width, size_t bit_pos, uint8_t* dst) {
+  uint8_t* p = dst + (bit_pos >> 3);
+  int shift = bit_pos & 7;
+  UnalignedStore(p, UnalignedLoad<uint64_t>(p) | (val << shift));
+  if (bit_width + shift > 64) {
+    p[8] |= static_cast<uint8_t>(val >> (64 - shift));
+  }
+}
+
+// Returns the 'bit_width'-bit value at bit offset 'bit_pos' of 'src'.
+inline uint64_t UnpackValue(const uint8_t* src, int bit_width, size_t bit_pos) {
+  const uint8_t* p = src + (bit_pos >> 3);
+  int shift = bit_pos & 7;
+  uint64_t val = UnalignedLoad<uint64_t>(p) >> shift;
+  if (bit_width + shift > 64) {
+    val |= static_cast<uint64_t>(p[8]) << (64 - shift);
+  }
+  return bit_width == 64 ? val : val & ((1ULL << bit_width) - 1);
+}
+
+// Returns the minimum of 'len' entries starting at 'entries', and sets
+// 'bit_width' to the number of bits needed to store them relative to it.
+// 'U' is the unsigned type used to compute differences.
+template<typename U, typename T>
+T MinAndBitWidth(const T* entries, int len, int* bit_width) {
+  auto min_max = std::minmax_element(entries, entries + len);
+  *bit_width = BitWidth(static_cast<U>(static_cast<U>(*min_max.second) -
+                                       static_cast<U>(*min_max.first)));
+  return *min_max.first;
+}
+
+// Returns the number of bytes needed to encode 'n' entries as mini-blocks of
+// 'U' references.
+template<typename U, typename T>
+size_t MiniBlocksSize(const T* entries, size_t n) {
+  size_t size = 0;
+  for (size_t start = 0; start < n; start += kMiniBlockSize) {
+    int len = std::min<size_t>(kMiniBlockSize, n - start);
+    int bit_width;
+    MinAndBitWidth<U>(entries + start, len, &bit_width);
+    size += sizeof(U) + 1 + PackedBytes(len, bit_width);
+  }
+  return size;
+}
+
+// Appends 'n' entries to 'buf' as mini-blocks of 'U' references.
+template<typename U, typename T>
+void AppendMiniBlocks(const T* entries, size_t n, faststring* buf) {
+  for (size_t start = 0; start < n; start += kMiniBlockSize) {
+    int len = std::min<size_t>(kMiniBlockSize, n - start);
+    int bit_width;
+    U ref = MinAndBitWidth<U>(entries + start, len, &bit_width);
+
+    size_t pos = buf->size();
+    int packed_bytes = PackedBytes(len, bit_width);
+    // Reserve room for the trailing bytes touched by PackValue().
+    buf->resize(pos + sizeof(U) + 1 + packed_bytes + kPaddingBytes + 1);
+    memset(&(*buf)[pos], 0, buf->size() - pos);
+    memcpy(&(*buf)[pos], &ref, sizeof(ref));
+    (*buf)[pos + sizeof(ref)] = bit_width;
+
+    uint8_t* packed = &(*buf)[pos + sizeof(U) + 1];
+    if (bit_width > 0) {
+      for (int i = 0; i < len; i++) {
+        U residual = static_cast<U>(entries[start + i]) - ref;
+        PackValue(residual, bit_width, i * bit_width, packed);
+      }
+    }
+    buf->resize(pos + sizeof(U) + 1 + packed_bytes);
+  }
+}
+
+// Returns the largest number of entries that 'size' bytes of mini-blocks of
+// 'U' references can hold. Every mini-block has a header, even if its bit
+// width is zero, so a block whose entry count exceeds this is corrupt.
+template<typename U>
+inline uint64_t MaxMiniBlockEntries(size_t size) {
+  return static_cast<uint64_t>(size / (sizeof(U) + 1)) * kMiniBlockSize;
+}
+
+// Unpacks 'count' entries from the mini-blocks at '*pos' into 'out', adding
+// each mini-block's reference to its entries, and advances '*pos' past them.
+// 'end' must be followed by at least kPaddingBytes readable bytes.
+template<typename U>
+Status DecodeMiniBlocks(const uint8_t** pos, const uint8_t* end, U* out, uint32_t count) {
+  const uint8_t* p = *pos;
+  for (uint32_t start = 0; start < count; start += kMiniBlockSize) {
+    int len = std::min<uint32_t>(kMiniBlockSize, count - start);
+    if (PREDICT_FALSE(end - p < static_cast<ptrdiff_t>(sizeof(U) + 1))) {
+      return Status::Corruption("block truncated in mini-block header");
+    }
+    U ref;
+    memcpy(&ref, p, sizeof(ref));
+    int bit_width = p[sizeof(ref)];
+    p += sizeof(U) + 1;
+    if (PREDICT_FALSE(bit_width > static_cast<int>(sizeof(U) * 8))) {
+      return Status::Corruption(strings::Substitute("invalid bit width: $0", bit_width));
+    }
+    int packed_bytes = PackedBytes(len, bit_width);
+    if (PREDICT_FALSE(end - p < packed_bytes)) {
+      return Status::Corruption("block truncated in mini-block data");
+    }
+
+    U* dst = out + start;
+    if (bit_width == 0) {
+      std::fill(dst, dst + len, ref);
+    } else {
+      for (int i = 0; i < len; i++) {
+        dst[i] = ref + static_cast<U>(UnpackValue(p, bit_width, i * bit_width));
+      }
+    }
+    p += packed_bytes;
+  }
+  *pos = p;
+  return Status::OK();
+}
+
+} // namespace for_internal
+
+// ForBlockBuilder encodes integer blocks with frame-of-reference bit
+// packing, either of the values or of the deltas between consecutive
+// values, whichever yields the smaller block.
+//
+// The block format is as follows:
+//
+// 1. Header:
+//
+//    <first_ordinal> [32-bit]
+//      The ordinal offset of the first element in the block.
+//
+//    <num_elements> [32-bit]
+//      The number of elements encoded in the block.
+//
+//    <mode> [8-bit]
+//      0 if the values themselves are encoded, 1 if the deltas between
+//      consecutive values are encoded.
+//
+//    <first_value> [size of the type]
+//      The first value of the block. In delta mode, the remaining values
+//      are reconstructed by adding the deltas to it.
+//
+// 2. Mini-blocks
+//
+//    The encoded sequence (the 'num_elements' values, or the
+//    'num_elements' - 1 deltas) is split into mini-blocks of up to 128
+//    entries, each of which is laid out as:
+//
+//    <reference> [size of the type]
+//      The minimum entry of the mini-block. For deltas, the minimum is
+//      taken over the deltas interpreted as signed integers.
+//
+//    <bit_width> [8-bit]
+//      The number of bits used for each packed entry.
+//
+//    <packed entries>
+//      The entries minus the reference, packed little-endian into
+//      'bit_width' bits each and padded to a whole number of bytes.
+//
+// 3. Eight zero bytes of padding.
+//
+//   NOTE: all on-disk ints are encoded little-endian
+//
+template<DataType Type>
+class ForBlockBuilder final : public BlockBuilder {
+ public:
+  explicit ForBlockBuilder(const WriterOptions* options)
+      : options_(options) {
+    Reset();
+  }
+
+  void Reset() OVERRIDE {
+    auto block_size = options_->storage_attributes.cfile_block_size;
+    values_.clear();
+    values_.reserve(block_size / sizeof(CppType));
+    buffer_.clear();
+    finished_ = false;
+    rem_elem_capacity_ = block_size / sizeof(CppType);
+  }
+
+  bool IsBlockFull() const override {
+    return rem_elem_capacity_ == 0;
+  }
+
+  int Add(const uint8_t* vals_void, size_t count) OVERRIDE {
+    DCHECK(!finished_);
+    int to_add = std::min<int>(rem_elem_capacity_, count);
+    const CppType* vals = reinterpret_cast<const CppType*>(vals_void);
+    values_.insert(values_.end(), vals, vals + to_add);
+    rem_elem_capacity_ -= to_add;
+    return to_add;
+  }
+
+  size_t Count() const OVERRIDE {
+    return values_.size();
+  }
+
+  Status GetFirstKey(void* key) const OVERRIDE {
+    if (values_.empty()) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &values_.front(), sizeof(CppType));
+    return Status::OK();
+  }
+
+  Status GetLastKey(void* key) const OVERRIDE {
+    if (values_.empty()) {
+      return Status::NotFound("no keys in data block");
+    }
+    memcpy(key, &values_.back(), sizeof(CppType));
+    return Status::OK();
+  }
+
+  void Finish(rowid_t ordinal_pos, std::vector<Slice>* slices) OVERRIDE {
+    using for_internal::kDelta;
+    using for_internal::kFrameOfReference;
+
+    const size_t n = values_.size();
+    deltas_.clear();
+    for (size_t i = 1; i < n; i++) {
+      deltas_.push_back(static_cast<SignedCppType>(
+          static_cast<UnsignedCppType>(values_[i]) - static_cast<UnsignedCppType>(values_[i - 1])));
+    }
+    const bool use_deltas =
+        for_internal::MiniBlocksSize<UnsignedCppType>(deltas_.data(), deltas_.size()) <
+        for_internal::MiniBlocksSize<UnsignedCppType>(values_.data(), values_.size());
+
+    buffer_.clear();
+    buffer_.resize(kHeaderSize);
+    InlineEncodeFixed32(&buffer_[0], ordinal_pos);
+    InlineEncodeFixed32(&buffer_[4], n);
+    buffer_[8] = use_deltas ? kDelta : kFrameOfReference;
+    UnsignedCppType first = n == 0 ? 0 : static_cast<UnsignedCppType>(values_[0]);
+    memcpy(&buffer_[9], &first, sizeof(first));
+    if (use_deltas) {
+      for_internal::AppendMiniBlocks<UnsignedCppType>(deltas_.data(), deltas_.size(), &buffer_);
+    } else {
+      for_internal::AppendMiniBlocks<UnsignedCppType>(values_.data(), values_.size(), &buffer_);
+    }
+    buffer_.resize(buffer_.size() + for_internal::kPaddingBytes);
+    memset(&buffer_[buffer_.size() - for_internal::kPaddingBytes], 0,
+           for_internal::kPaddingBytes);
+
+    finished_ = true;
+    *slices = { Slice(buffer_.data(), buffer_.size()) };
+  }
+
+ private:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+  typedef typename std::make_unsigned<CppType>::type UnsignedCppType;
+  typedef typename std::make_signed<CppType>::type SignedCppType;
+  static_assert(sizeof(CppType) <= sizeof(uint64_t), "FOR encoding supports up to 64-bit types");
+
+  static const size_t kHeaderSize = sizeof(uint32_t) * 2 + 1 + sizeof(CppType);
+
+  std::vector<CppType> values_;
+  std::vector<SignedCppType> deltas_;
+  faststring buffer_;
+  int rem_elem_capacity_;
+  bool finished_;
+  const WriterOptions* options_;
+};
+
+template<DataType Type>
+class ForBlockDecoder final : public BlockDecoder {
+ public:
+  explicit ForBlockDecoder(Slice slice)
+      : data_(slice),
+        parsed_(false),
+        ordinal_pos_base_(0),
+        num_elems_(0),
+        cur_idx_(0) {
+  }
+
+  Status ParseHeader() OVERRIDE {
+    CHECK(!parsed_);
+    if (data_.size() < kHeaderSize + for_internal::kPaddingBytes) {
+      return Status::Corruption(
+          strings::Substitute("not enough bytes for header: FOR block size ($0) "
+                              "less than expected header length ($1)",
+                              data_.size(), kHeaderSize + for_internal::kPaddingBytes));
+    }
+    ordinal_pos_base_ = DecodeFixed32(&data_[0]);
+    num_elems_ = DecodeFixed32(&data_[4]);
+    uint8_t mode = data_[8];
+    if (mode != for_internal::kFrameOfReference && mode != for_internal::kDelta) {
+      return Status::Corruption(strings::Substitute("invalid FOR block mode: $0", mode));
+    }
+    // In delta mode, the first value is stored in the header.
+    const uint64_t max_elems =
+        for_internal::MaxMiniBlockEntries<UnsignedCppType>(
+            data_.size() - kHeaderSize - for_internal::kPaddingBytes) +
+        (mode == for_internal::kDelta ? 1 : 0);
+    if (PREDICT_FALSE(num_elems_ > max_elems)) {
+      return Status::Corruption(strings::Substitute(
+          "FOR block of $0 bytes can't hold $1 elements", data_.size(), num_elems_));
+    }
+
+    decoded_.resize(num_elems_);
+    if (num_elems_ > 0) {
+      const uint8_t* pos = data_.data() + kHeaderSize;
+      const uint8_t* end = data_.data() + data_.size() - for_internal::kPaddingBytes;
+      if (mode == for_internal::kDelta) {
+        memcpy(&decoded_[0], &data_[9], sizeof(UnsignedCppType));
+        RETURN_NOT_OK(for_internal::DecodeMiniBlocks(&pos, end, decoded_.data() + 1,
+                                                     num_elems_ - 1));
+        // Running sum over the deltas.
+        for (uint32_t i = 1; i < num_elems_; i++) {
+          decoded_[i] += decoded_[i - 1];
+        }
+      } else {
+        RETURN_NOT_OK(for_internal::DecodeMiniBlocks(&pos, end, decoded_.data(), num_elems_));
+      }
+      if (PREDICT_FALSE(pos != end)) {
+        return Status::Corruption("unexpected trailing data in FOR block");
+      }
+    }
+
+    parsed_ = true;
+    return Status::OK();
+  }
+
+  void SeekToPositionInBlock(uint pos) OVERRIDE {
+    CHECK(parsed_) << "Must call ParseHeader()";
+    DCHECK_LE(pos, num_elems_);
+    cur_idx_ = pos;
+  }
+
+  Status SeekAtOrAfterValue(const void* value_void, bool* exact) OVERRIDE {
+    DCHECK(parsed_);
+    CppType target = UnalignedLoad<CppType>(value_void);
+    uint32_t left = 0;
+    uint32_t right = num_elems_;
+    while (left != right) {
+      uint32_t mid = left + (right - left) / 2;
+      CppType mid_key = static_cast<CppType>(decoded_[mid]);
+      if (mid_key == target) {
+        cur_idx_ = mid;
+        *exact = true;
+        return Status::OK();
+      }
+      if (mid_key > target) {
+        right = mid;
+      } else {
+        left = mid + 1;
+      }
+    }
+
+    *exact = false;
+    cur_idx_ = left;
+    if (cur_idx_ == num_elems_) {
+      return Status::NotFound("after last key in block");
+    }
+    return Status::OK();
+  }
+
+  Status CopyNextValues(size_t* n, ColumnDataView* dst) OVERRIDE {
+    DCHECK(parsed_);
+    DCHECK_EQ(dst->stride(), sizeof(CppType));
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+    size_t max_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    memcpy(dst->data(), &decoded_[cur_idx_], max_fetch * sizeof(CppType));
+    *n = max_fetch;
+    cur_idx_ += max_fetch;
+    return Status::OK();
+  }
+
+  size_t GetCurrentIndex() const OVERRIDE {
+    DCHECK(parsed_) << "must parse header first";
+    return cur_idx_;
+  }
+
+  rowid_t GetFirstRowId() const OVERRIDE {
+    return ordinal_pos_base_;
+  }
+
+  size_t Count() const OVERRIDE {
+    return num_elems_;
+  }
+
+  bool HasNext() const OVERRIDE {
+    return cur_idx_ < num_elems_;
+  }
+
+ private:
+  typedef typename TypeTraits<Type>::cpp_type CppType;
+  typedef typename std::make_unsigned<CppType>::type UnsignedCppType;
+
+  static const size_t kHeaderSize = sizeof(uint32_t) * 2 + 1 + sizeof(CppType);
+
+  Slice data_;
+  bool parsed_;
+
+  rowid_t ordinal_pos_base_;
+  uint32_t num_elems_;
+  size_t cur_idx_;
+
+  // All of the block's values, decoded by ParseHeader().
+  std::vector<UnsignedCppType> decoded_;
+};
+
+} // namespace cfile
+} // namespace kudu
+#endif
@@ -154,7 +154,7 @@ class PlainBitMapBlockDecoder final : public BlockDecoder {
       return;
     }
 
-    DCHECK_LT(pos, num_elems_);
+    DCHECK_LE(pos, num_elems_);
 
     reader_.SeekToBit(pos);
 
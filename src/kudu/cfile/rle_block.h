@@ -193,6 +193,49 @@ class RleBitMapBlockDecoder final : public BlockDecoder {
     return Status::OK();
   }
 
+  // Evaluates the predicate once per run of identical values, and only
+  // materializes the runs that match it.
+  Status CopyNextAndEval(size_t* n,
+                         ColumnMaterializationContext* ctx,
+                         SelectionVectorView* sel,
+                         ColumnDataView* dst) override {
+    DCHECK(parsed_);
+
+    DCHECK_LE(*n, dst->nrows());
+    DCHECK_EQ(dst->stride(), sizeof(bool));
+
+    ctx->SetDecoderEvalSupported();
+    if (PREDICT_FALSE(*n == 0 || cur_idx_ >= num_elems_)) {
+      *n = 0;
+      return Status::OK();
+    }
+
+    const size_t bits_to_fetch = std::min(*n, static_cast<size_t>(num_elems_ - cur_idx_));
+    size_t remaining = bits_to_fetch;
+    bool* data_ptr = reinterpret_cast<bool*>(dst->data());
+    size_t row_offset = 0;
+    while (remaining > 0) {
+      bool val = false;
+      const size_t num_read = rle_decoder_.GetNextRun(&val, remaining);
+      DCHECK_GT(num_read, 0);
+      DCHECK_LE(num_read, remaining);
+      if (ctx->pred()->EvaluateCell<BOOL>(static_cast<const void*>(&val))) {
+        std::fill(data_ptr, data_ptr + num_read, val);
+      } else {
+        // Mark that the rows will not be returned.
+        sel->ClearBits(num_read, row_offset);
+      }
+      data_ptr += num_read;
+      remaining -= num_read;
+      row_offset += num_read;
+    }
+
+    cur_idx_ += bits_to_fetch;
+    *n = bits_to_fetch;
+
+    return Status::OK();
+  }
+
   virtual Status SeekAtOrAfterValue(const void *value,
                                     bool *exact_match) OVERRIDE {
     return Status::NotSupported("BOOL keys are not supported!");
@@ -21,11 +21,13 @@
 #include <unordered_map>
 #include <utility>
 
+#include "kudu/cfile/alp_block.h" // IWYU pragma: keep
 #include "kudu/cfile/binary_dict_block.h" // IWYU pragma: keep
 #include "kudu/cfile/binary_plain_block.h" // IWYU pragma: keep
 #include "kudu/cfile/binary_prefix_block.h" // IWYU pragma: keep
 #include "kudu/cfile/block_encodings.h"
 #include "kudu/cfile/bshuf_block.h" // IWYU pragma: keep
+#include "kudu/cfile/for_block.h" // IWYU pragma: keep
 #include "kudu/cfile/plain_bitmap_block.h" // IWYU pragma: keep
 #include "kudu/cfile/plain_block.h" // IWYU pragma: keep
 #include "kudu/cfile/rle_block.h" // IWYU pragma: keep
@@ -118,6 +120,14 @@ template<DataType IntType>
 struct DataTypeEncodingTraits<IntType, RLE>
     : public EncodingTraits<RleIntBlockBuilder<IntType>, RleIntBlockDecoder<IntType>> {};
 
+template<DataType IntType>
+struct DataTypeEncodingTraits<IntType, FOR_DELTA>
+    : public EncodingTraits<ForBlockBuilder<IntType>, ForBlockDecoder<IntType>> {};
+
+template<DataType FloatType>
+struct DataTypeEncodingTraits<FloatType, ALP>
+    : public EncodingTraits<AlpBlockBuilder<FloatType>, AlpBlockDecoder<FloatType>> {};
+
 template<typename TypeEncodingTraitsClass>
 TypeEncodingInfo::TypeEncodingInfo(TypeEncodingTraitsClass /*t*/)
     : encoding_type_(TypeEncodingTraitsClass::kEncodingType),
@@ -175,31 +185,41 @@ class TypeEncodingResolver {
     AddMapping<UINT8, BIT_SHUFFLE>();
     AddMapping<UINT8, PLAIN_ENCODING>();
     AddMapping<UINT8, RLE>();
+    AddMapping<UINT8, FOR_DELTA>();
     AddMapping<INT8, BIT_SHUFFLE>();
     AddMapping<INT8, PLAIN_ENCODING>();
     AddMapping<INT8, RLE>();
+    AddMapping<INT8, FOR_DELTA>();
     AddMapping<UINT16, BIT_SHUFFLE>();
     AddMapping<UINT16, PLAIN_ENCODING>();
     AddMapping<UINT16, RLE>();
+    AddMapping<UINT16, FOR_DELTA>();
     AddMapping<INT16, BIT_SHUFFLE>();
     AddMapping<INT16, PLAIN_ENCODING>();
     AddMapping<INT16, RLE>();
+    AddMapping<INT16, FOR_DELTA>();
     AddMapping<UINT32, BIT_SHUFFLE>();
     AddMapping<UINT32, RLE>();
     AddMapping<UINT32, PLAIN_ENCODING>();
+    AddMapping<UINT32, FOR_DELTA>();
     AddMapping<INT32, BIT_SHUFFLE>();
     AddMapping<INT32, PLAIN_ENCODING>();
     AddMapping<INT32, RLE>();
+    AddMapping<INT32, FOR_DELTA>();
     AddMapping<UINT64, BIT_SHUFFLE>();
     AddMapping<UINT64, PLAIN_ENCODING>();
     AddMapping<UINT64, RLE>();
+    AddMapping<UINT64, FOR_DELTA>();
     AddMapping<INT64, BIT_SHUFFLE>();
     AddMapping<INT64, PLAIN_ENCODING>();
     AddMapping<INT64, RLE>();
+    AddMapping<INT64, FOR_DELTA>();
     AddMapping<FLOAT, BIT_SHUFFLE>();
     AddMapping<FLOAT, PLAIN_ENCODING>();
+    AddMapping<FLOAT, ALP>();
     AddMapping<DOUBLE, BIT_SHUFFLE>();
     AddMapping<DOUBLE, PLAIN_ENCODING>();
+    AddMapping<DOUBLE, ALP>();
     AddMapping<BINARY, DICT_ENCODING>();
     AddMapping<BINARY, PLAIN_ENCODING>();
     AddMapping<BINARY, PREFIX_ENCODING>();
@@ -234,12 +254,20 @@ class TypeEncodingResolver {
 Status TypeEncodingInfo::Get(const TypeInfo* typeinfo,
                              EncodingType encoding,
                              const TypeEncodingInfo** out) {
+  if (encoding == AUTO_ENCODING) {
+    encoding = GetDefaultEncoding(typeinfo);
+  }
   return Singleton<TypeEncodingResolver>::get()->GetTypeEncodingInfo(typeinfo->physical_type(),
                                                                      encoding,
                                                                      out);
 }
 
 const EncodingType TypeEncodingInfo::GetDefaultEncoding(const TypeInfo* typeinfo) {
+  // Timestamps are usually close to monotonically increasing within a
+  // rowset, which suits delta encoding far better than bitshuffle.
+  if (typeinfo->type() == UNIXTIME_MICROS) {
+    return FOR_DELTA;
+  }
   return Singleton<TypeEncodingResolver>::get()->GetDefaultEncoding(typeinfo->physical_type());
 }
 
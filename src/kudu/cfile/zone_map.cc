@@ -0,0 +1,227 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/cfile/zone_map.h"
+
+#include <cmath>
+#include <ostream>
+
+#include <glog/logging.h>
+
+#include "kudu/cfile/cfile.pb.h"
+#include "kudu/common/column_predicate.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/port.h"
+#include "kudu/util/slice.h"
+
+using std::string;
+
+namespace kudu {
+namespace cfile {
+
+namespace {
+
+template<typename T>
+bool IsNaN(const T& /* value */) {
+  return false;
+}
+
+bool IsNaN(float value) {
+  return std::isnan(value);
+}
+
+bool IsNaN(double value) {
+  return std::isnan(value);
+}
+
+} // anonymous namespace
+
+ZoneMapBuilder::ZoneMapBuilder(const TypeInfo* typeinfo)
+    : typeinfo_(typeinfo) {
+  Reset();
+}
+
+void ZoneMapBuilder::Reset() {
+  num_rows_ = 0;
+  null_count_ = 0;
+  has_bounds_ = false;
+  bounds_valid_ = true;
+  min_.clear();
+  max_.clear();
+}
+
+void ZoneMapBuilder::AddValues(const void* cells, size_t count) {
+  num_rows_ += count;
+  if (PREDICT_FALSE(!bounds_valid_ || count == 0)) {
+    return;
+  }
+  switch (typeinfo_->physical_type()) {
+    case BOOL: return AddValuesForType<BOOL>(cells, count);
+    case INT8: return AddValuesForType<INT8>(cells, count);
+    case INT16: return AddValuesForType<INT16>(cells, count);
+    case INT32: return AddValuesForType<INT32>(cells, count);
+    case INT64: return AddValuesForType<INT64>(cells, count);
+    case INT128: return AddValuesForType<INT128>(cells, count);
+    case UINT8: return AddValuesForType<UINT8>(cells, count);
+    case UINT16: return AddValuesForType<UINT16>(cells, count);
+    case UINT32: return AddValuesForType<UINT32>(cells, count);
+    case UINT64: return AddValuesForType<UINT64>(cells, count);
+    case FLOAT: return AddValuesForType<FLOAT>(cells, count);
+    case DOUBLE: return AddValuesForType<DOUBLE>(cells, count);
+    case BINARY: return AddValuesForType<BINARY>(cells, count);
+    default: LOG(FATAL) << "unknown physical type: " << typeinfo_->name();
+  }
+}
+
+template<DataType PhysicalType>
+void ZoneMapBuilder::AddValuesForType(const void* cells, size_t count) {
+  typedef DataTypeTraits<PhysicalType> traits;
+  typedef typename traits::cpp_type cpp_type;
+
+  // Find the bounds of this batch first, so that the stored bounds (and any
+  // string copies) are only touched once per batch.
+  const cpp_type* values = reinterpret_cast<const cpp_type*>(cells);
+  const cpp_type* batch_min = nullptr;
+  const cpp_type* batch_max = nullptr;
+  for (size_t i = 0; i < count; i++) {
+    const cpp_type* cell = &values[i];
+    if (PhysicalType == BINARY) {
+      if (PREDICT_FALSE(reinterpret_cast<const Slice*>(cell)->size() > kMaxBoundLength)) {
+        bounds_valid_ = false;
+        return;
+      }
+    } else if (PREDICT_FALSE(IsNaN(*cell))) {
+      bounds_valid_ = false;
+      return;
+    }
+    if (batch_min == nullptr || traits::Compare(cell, batch_min) < 0) {
+      batch_min = cell;
+    }
+    if (batch_max == nullptr || traits::Compare(cell, batch_max) > 0) {
+      batch_max = cell;
+    }
+  }
+  UpdateBounds(batch_min);
+  UpdateBounds(batch_max);
+}
+
+void ZoneMapBuilder::UpdateBounds(const void* cell) {
+  if (!has_bounds_) {
+    SetBound(cell, &min_);
+    SetBound(cell, &max_);
+    has_bounds_ = true;
+    return;
+  }
+  if (CompareBound(min_, cell) > 0) {
+    SetBound(cell, &min_);
+  }
+  if (CompareBound(max_, cell) < 0) {
+    SetBound(cell, &max_);
+  }
+}
+
+int ZoneMapBuilder::CompareBound(const string& bound, const void* cell) const {
+  if (typeinfo_->physical_type() == BINARY) {
+    Slice bound_slice(bound);
+    return typeinfo_->Compare(&bound_slice, cell);
+  }
+  return typeinfo_->Compare(bound.data(), cell);
+}
+
+void ZoneMapBuilder::SetBound(const void* cell, string* bound) const {
+  if (typeinfo_->physical_type() == BINARY) {
+    const Slice* slice = reinterpret_cast<const Slice*>(cell);
+    bound->assign(reinterpret_cast<const char*>(slice->data()), slice->size());
+  } else {
+    bound->assign(reinterpret_cast<const char*>(cell), typeinfo_->size());
+  }
+}
+
+void ZoneMapBuilder::Merge(const ZoneMapBuilder& other) {
+  DCHECK_EQ(typeinfo_->physical_type(), other.typeinfo_->physical_type());
+  num_rows_ += other.num_rows_;
+  null_count_ += other.null_count_;
+  if (!other.bounds_valid_) {
+    bounds_valid_ = false;
+  }
+  if (!bounds_valid_ || !other.has_bounds_) {
+    return;
+  }
+  if (typeinfo_->physical_type() == BINARY) {
+    Slice other_min(other.min_);
+    Slice other_max(other.max_);
+    UpdateBounds(&other_min);
+    UpdateBounds(&other_max);
+  } else {
+    UpdateBounds(other.min_.data());
+    UpdateBounds(other.max_.data());
+  }
+}
+
+void ZoneMapBuilder::ToPB(ZoneMapPB* pb) const {
+  pb->set_num_rows(num_rows_);
+  pb->set_null_count(null_count_);
+  if (has_bounds_ && bounds_valid_) {
+    pb->set_min_value(min_);
+    pb->set_max_value(max_);
+  } else {
+    pb->clear_min_value();
+    pb->clear_max_value();
+  }
+}
+
+bool ZoneMapMayMatch(const ColumnPredicate& pred, const ZoneMapPB& zone_map) {
+  if (PREDICT_FALSE(!zone_map.has_num_rows() || !zone_map.has_null_count())) {
+    return true;
+  }
+  const int64_t non_null_count = zone_map.num_rows() - zone_map.null_count();
+  switch (pred.predicate_type()) {
+    case PredicateType::None:
+      return false;
+    case PredicateType::IsNull:
+      return zone_map.null_count() > 0;
+    case PredicateType::IsNotNull:
+      return non_null_count > 0;
+    default:
+      break;
+  }
+
+  // The remaining predicate types only match non-null values.
+  if (non_null_count <= 0) {
+    return false;
+  }
+  if (!zone_map.has_min_value() || !zone_map.has_max_value()) {
+    return true;
+  }
+
+  const TypeInfo* type_info = pred.column().type_info();
+  if (type_info->physical_type() == BINARY) {
+    Slice min(zone_map.min_value());
+    Slice max(zone_map.max_value());
+    return pred.MayMatchRange(&min, &max);
+  }
+  if (PREDICT_FALSE(zone_map.min_value().size() != type_info->size() ||
+                    zone_map.max_value().size() != type_info->size())) {
+    // The stored bounds don't match the type; don't trust them.
+    return true;
+  }
+  return pred.MayMatchRange(zone_map.min_value().data(), zone_map.max_value().data());
+}
+
+} // namespace cfile
+} // namespace kudu
@@ -0,0 +1,110 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/gutil/macros.h"
+
+namespace kudu {
+
+class ColumnPredicate;
+class TypeInfo;
+
+namespace cfile {
+
+class ZoneMapPB;
+
+// Accumulates the statistics stored in a ZoneMapPB: the number of rows and
+// nulls, along with the minimum and maximum non-null values.
+//
+// Bounds are not tracked for binary values longer than kMaxBoundLength, nor
+// for floating point NaNs, since neither can be usefully compared against
+// predicates. A zone map without bounds can still be used to skip data
+// based on its null count.
+class ZoneMapBuilder {
+ public:
+  // Binary values longer than this disable bound tracking for the zone.
+  static constexpr size_t kMaxBoundLength = 256;
+
+  explicit ZoneMapBuilder(const TypeInfo* typeinfo);
+
+  // Add 'count' non-null cells laid out contiguously starting at 'cells'.
+  // For binary types, the cells are Slices.
+  void AddValues(const void* cells, size_t count);
+
+  // Add 'count' null cells.
+  void AddNulls(size_t count) {
+    num_rows_ += count;
+    null_count_ += count;
+  }
+
+  // Fold the statistics accumulated by 'other' into this builder. Both
+  // builders must be over the same type.
+  void Merge(const ZoneMapBuilder& other);
+
+  // Copy the accumulated statistics into 'pb'.
+  void ToPB(ZoneMapPB* pb) const;
+
+  // Clear all the accumulated statistics.
+  void Reset();
+
+  uint64_t num_rows() const { return num_rows_; }
+
+ private:
+  template<DataType PhysicalType>
+  void AddValuesForType(const void* cells, size_t count);
+
+  // Update the bounds with a single value, pointed to by 'cell'.
+  void UpdateBounds(const void* cell);
+
+  // Compare a stored bound against the value pointed to by 'cell'.
+  int CompareBound(const std::string& bound, const void* cell) const;
+
+  // Store the value pointed to by 'cell' into 'bound'.
+  void SetBound(const void* cell, std::string* bound) const;
+
+  const TypeInfo* const typeinfo_;
+
+  uint64_t num_rows_;
+  uint64_t null_count_;
+
+  // Whether at least one non-null value has been added.
+  bool has_bounds_;
+
+  // Whether the bounds are still meaningful. Once false, stays false until
+  // Reset().
+  bool bounds_valid_;
+
+  // The minimum and maximum values, in the representation described in
+  // ZoneMapPB.
+  std::string min_;
+  std::string max_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZoneMapBuilder);
+};
+
+// Returns false if none of the rows summarized by 'zone_map' can satisfy
+// 'pred', meaning that they can be skipped entirely. Returns true otherwise,
+// including when the zone map holds too little information to decide.
+bool ZoneMapMayMatch(const ColumnPredicate& pred, const ZoneMapPB& zone_map);
+
+} // namespace cfile
+} // namespace kudu
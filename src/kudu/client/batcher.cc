@@ -17,6 +17,7 @@
 
 #include "kudu/client/batcher.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <mutex>
@@ -61,6 +62,7 @@
 #include "kudu/tserver/tserver_service.proxy.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/status.h"
 
 namespace kudu {
 namespace rpc {
@@ -81,6 +83,7 @@ using kudu::security::SignedTokenPB;
 using kudu::tserver::WriteRequestPB;
 using kudu::tserver::WriteResponsePB;
 using kudu::tserver::WriteResponsePB_PerRowErrorPB;
+using std::pair;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -307,6 +310,30 @@ WriteRpc::WriteRpc(const scoped_refptr<Batcher>& batcher,
   FetchCachedAuthzToken();
   RowOperationsPB* requested = req_.mutable_row_operations();
 
+  // For bulk loads, send the rows sorted by primary key: the tablet servers
+  // only write them straight to disk if they are sorted. The per-row errors
+  // in the response refer to the ops by their index in 'ops_', so it's
+  // sorted as well.
+  if (batcher->bulk_load()) {
+    req_.set_bulk_load(true);
+    vector<pair<string, InFlightOp*>> keyed_ops;
+    keyed_ops.reserve(ops_.size());
+    for (InFlightOp* op : ops_) {
+      string key;
+      // Ops without a full primary key are failed by the server regardless.
+      WARN_NOT_OK(op->write_op->row().EncodeRowKey(&key), "unable to encode row key");
+      keyed_ops.emplace_back(std::move(key), op);
+    }
+    std::stable_sort(keyed_ops.begin(), keyed_ops.end(),
+                     [](const pair<string, InFlightOp*>& a,
+                        const pair<string, InFlightOp*>& b) {
+                       return a.first < b.first;
+                     });
+    for (int i = 0; i < keyed_ops.size(); i++) {
+      ops_[i] = keyed_ops[i].second;
+    }
+  }
+
   // Add the rows
   int ctr = 0;
   RowOperationsPBEncoder enc(requested);
@@ -581,11 +608,13 @@ void WriteRpc::GotNewAuthzTokenRetryCb(const Status& status) {
 Batcher::Batcher(KuduClient* client,
                  scoped_refptr<ErrorCollector> error_collector,
                  sp::weak_ptr<KuduSession> session,
-                 kudu::client::KuduSession::ExternalConsistencyMode consistency_mode)
+                 kudu::client::KuduSession::ExternalConsistencyMode consistency_mode,
+                 bool bulk_load)
   : state_(kGatheringOps),
     client_(client),
     weak_session_(std::move(session)),
     consistency_mode_(consistency_mode),
+    bulk_load_(bulk_load),
     error_collector_(std::move(error_collector)),
     had_errors_(false),
     flush_callback_(nullptr),
@@ -69,7 +69,8 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
   Batcher(KuduClient* client,
           scoped_refptr<ErrorCollector> error_collector,
           client::sp::weak_ptr<KuduSession> session,
-          kudu::client::KuduSession::ExternalConsistencyMode consistency_mode);
+          kudu::client::KuduSession::ExternalConsistencyMode consistency_mode,
+          bool bulk_load);
 
   // Abort the current batch. Any writes that were buffered and not yet sent are
   // discarded. Those that were sent may still be delivered.  If there is a pending Flush
@@ -110,6 +111,11 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
     return consistency_mode_;
   }
 
+  // Returns whether the session sends its writes as bulk loads.
+  bool bulk_load() const {
+    return bulk_load_;
+  }
+
   // Get time of the first operation in the batch.  If no operations are in
   // there yet, the returned MonoTime object is not initialized
   // (i.e. MonoTime::Initialized() returns false).
@@ -186,6 +192,9 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
   // The consistency mode set in the session.
   kudu::client::KuduSession::ExternalConsistencyMode consistency_mode_;
 
+  // Whether the writes are sent as bulk loads.
+  const bool bulk_load_;
+
   // Errors are reported into this error collector.
   scoped_refptr<ErrorCollector> error_collector_;
 
@@ -82,6 +82,7 @@
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/gutil/walltime.h"
 #include "kudu/integration-tests/data_gen_util.h"
 #include "kudu/master/catalog_manager.h"
 #include "kudu/master/master.h"
@@ -96,6 +97,7 @@
 #include "kudu/server/rpc_server.h"
 #include "kudu/tablet/tablet.h"
 #include "kudu/tablet/tablet_metadata.h"
+#include "kudu/tablet/tablet_metrics.h"
 #include "kudu/tablet/tablet_replica.h"
 #include "kudu/tserver/mini_tablet_server.h"
 #include "kudu/tserver/scanners.h"
@@ -150,6 +152,7 @@ DECLARE_int32(scanner_inject_latency_on_each_batch_ms);
 DECLARE_int32(scanner_max_batch_size_bytes);
 DECLARE_int32(scanner_ttl_ms);
 DECLARE_int32(table_locations_ttl_ms);
+DECLARE_int32(ttl_expiry_interval_secs);
 DECLARE_int64(live_row_count_for_testing);
 DECLARE_int64(on_disk_size_for_testing);
 DECLARE_string(location_mapping_cmd);
@@ -1260,6 +1263,138 @@ TEST_F(ClientTest, TestScanEmptyProjection) {
   }
 }
 
+// Test scans which push aggregations down to the tablet servers.
+TEST_F(ClientTest, TestAggregateScan) {
+  NO_FATALS(InsertTestRows(client_table_.get(), FLAGS_test_scan_num_rows));
+  const int64_t n = FLAGS_test_scan_num_rows;
+
+  // Without group-by columns, a single row is produced.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetProjectedColumnNames({ "int_val", "string_val" }));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, ""));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::SUM, "int_val"));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::MIN, "int_val"));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::MAX, "int_val"));
+    ASSERT_OK(scanner.Open());
+    vector<KuduPartialRow*> results;
+    Status s = scanner.GetAggregateResults(&results);
+    ASSERT_TRUE(s.IsIllegalState()) << s.ToString();
+    KuduScanBatch batch;
+    while (scanner.HasMoreRows()) {
+      ASSERT_OK(scanner.NextBatch(&batch));
+      ASSERT_EQ(0, batch.NumRows());
+    }
+    ASSERT_OK(scanner.GetAggregateResults(&results));
+    ElementDeleter deleter(&results);
+    ASSERT_EQ(1, results.size());
+    int64_t count;
+    int64_t sum;
+    int32_t min;
+    int32_t max;
+    ASSERT_OK(results[0]->GetInt64("count(*)", &count));
+    ASSERT_OK(results[0]->GetInt64("sum(int_val)", &sum));
+    ASSERT_OK(results[0]->GetInt32("min(int_val)", &min));
+    ASSERT_OK(results[0]->GetInt32("max(int_val)", &max));
+    ASSERT_EQ(n, count);
+    ASSERT_EQ(n * (n - 1), sum);
+    ASSERT_EQ(0, min);
+    ASSERT_EQ(2 * (n - 1), max);
+  }
+
+  // Aggregating over no rows still produces a single row.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddConjunctPredicate(client_table_->NewComparisonPredicate(
+        "key", KuduPredicate::GREATER_EQUAL, KuduValue::FromInt(n))));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, ""));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::SUM, "int_val"));
+    ASSERT_OK(scanner.Open());
+    KuduScanBatch batch;
+    while (scanner.HasMoreRows()) {
+      ASSERT_OK(scanner.NextBatch(&batch));
+    }
+    vector<KuduPartialRow*> results;
+    ASSERT_OK(scanner.GetAggregateResults(&results));
+    ElementDeleter deleter(&results);
+    ASSERT_EQ(1, results.size());
+    int64_t count;
+    ASSERT_OK(results[0]->GetInt64("count(*)", &count));
+    ASSERT_EQ(0, count);
+    ASSERT_TRUE(results[0]->IsNull("sum(int_val)"));
+  }
+
+  // With a group-by column, a row is produced per group.
+  {
+    const int kNumGroups = 5;
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddConjunctPredicate(client_table_->NewComparisonPredicate(
+        "key", KuduPredicate::LESS, KuduValue::FromInt(kNumGroups))));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, "string_val"));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::MAX, "key"));
+    ASSERT_OK(scanner.AddGroupByColumn("string_val"));
+    ASSERT_OK(scanner.Open());
+    KuduScanBatch batch;
+    while (scanner.HasMoreRows()) {
+      ASSERT_OK(scanner.NextBatch(&batch));
+    }
+    vector<KuduPartialRow*> results;
+    ASSERT_OK(scanner.GetAggregateResults(&results));
+    ElementDeleter deleter(&results);
+    ASSERT_EQ(kNumGroups, results.size());
+    for (const auto* row : results) {
+      Slice group;
+      int64_t count;
+      int32_t max_key;
+      ASSERT_OK(row->GetString("string_val", &group));
+      ASSERT_OK(row->GetInt64("count(string_val)", &count));
+      ASSERT_OK(row->GetInt32("max(key)", &max_key));
+      ASSERT_EQ(1, count);
+      ASSERT_EQ(StringPrintf("hello %d", max_key), group.ToString());
+    }
+  }
+
+  // Aggregating scans may not be fault-tolerant, and aggregates can't be
+  // added once the scanner is open.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.SetFaultTolerant());
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, ""));
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.Open());
+    Status s = scanner.AddAggregate(KuduScanner::COUNT, "");
+    ASSERT_TRUE(s.IsIllegalState()) << s.ToString();
+  }
+
+  // The same aggregate can't be added twice, though the same function may be
+  // applied to different columns.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, ""));
+    ASSERT_OK(scanner.AddAggregate(KuduScanner::COUNT, "int_val"));
+    Status s = scanner.AddAggregate(KuduScanner::COUNT, "");
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "Duplicate aggregate: COUNT(*)");
+    s = scanner.AddAggregate(KuduScanner::COUNT, "int_val");
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "Duplicate aggregate: COUNT(int_val)");
+    ASSERT_OK(scanner.Open());
+  }
+
+  // Group-by columns are useless without aggregates.
+  {
+    KuduScanner scanner(client_table_.get());
+    ASSERT_OK(scanner.AddGroupByColumn("string_val"));
+    Status s = scanner.Open();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "Group-by columns require at least one aggregate");
+  }
+}
+
 TEST_F(ClientTest, TestProjectInvalidColumn) {
   KuduScanner scanner(client_table_.get());
   Status s = scanner.SetProjectedColumnNames({ "column-doesnt-exist" });
@@ -2475,6 +2610,55 @@ TEST_F(ClientTest, TestInsertSingleRowManualBatch) {
   FlushSessionOrDie(session);
 }
 
+// Test that rows written in bulk load mode are inserted no matter the order
+// they are applied in, and that at least some of them skip the MemRowSet.
+TEST_F(ClientTest, TestBulkLoad) {
+  constexpr int kNumRows = 1000;
+  shared_ptr<KuduSession> session = client_->NewSession();
+  ASSERT_OK(session->SetFlushMode(KuduSession::MANUAL_FLUSH));
+  ASSERT_OK(session->SetBulkLoadMode(true));
+  session->SetTimeoutMillis(60000);
+
+  // The rows are applied in descending key order; the client sorts them.
+  for (int i = kNumRows - 1; i >= 0; i--) {
+    ASSERT_OK(session->Apply(BuildTestInsert(client_table_.get(), i).release()));
+  }
+  // The mode can't be changed while writes are buffered.
+  Status s = session->SetBulkLoadMode(false);
+  ASSERT_TRUE(s.IsIllegalState()) << s.ToString();
+  FlushSessionOrDie(session);
+  ASSERT_EQ(kNumRows, CountRowsFromClient(client_table_.get()));
+
+  int64_t rows_bulk_loaded = 0;
+  for (int i = 0; i < cluster_->num_tablet_servers(); i++) {
+    vector<scoped_refptr<TabletReplica>> replicas;
+    cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletReplicas(&replicas);
+    for (const auto& replica : replicas) {
+      if (replica->tablet() && replica->tablet()->metrics()) {
+        rows_bulk_loaded += replica->tablet()->metrics()->rows_bulk_loaded->value();
+      }
+    }
+  }
+  ASSERT_GT(rows_bulk_loaded, 0);
+
+  // Inserting the same rows again fails for each row, as usual.
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(session->Apply(BuildTestInsert(client_table_.get(), i).release()));
+  }
+  s = session->Flush();
+  ASSERT_TRUE(s.IsIOError()) << s.ToString();
+  vector<KuduError*> errors;
+  ElementDeleter drop(&errors);
+  bool overflowed;
+  session->GetPendingErrors(&errors, &overflowed);
+  ASSERT_FALSE(overflowed);
+  ASSERT_EQ(10, errors.size());
+  for (const KuduError* error : errors) {
+    ASSERT_TRUE(error->status().IsAlreadyPresent()) << error->status().ToString();
+  }
+  ASSERT_EQ(kNumRows, CountRowsFromClient(client_table_.get()));
+}
+
 static void DoTestInsertIgnoreVerifyRows(const shared_ptr<KuduTable>& tbl, int num_rows) {
   vector<string> rows;
   KuduScanner scanner(tbl.get());
@@ -4855,6 +5039,195 @@ TEST_F(ClientTest, TestCreateTableWithInvalidEncodings) {
                       "DICT_ENCODING not supported for type INT32");
 }
 
+TEST_F(ClientTest, TestCreateTableWithInvalidCompressionLevels) {
+  // A level on a codec which doesn't support levels is rejected by the client.
+  {
+    KuduSchema schema;
+    KuduSchemaBuilder schema_builder;
+    schema_builder.AddColumn("key")->Type(KuduColumnSchema::INT32)->NotNull()->PrimaryKey()
+        ->Compression(KuduColumnStorageAttributes::LZ4)->CompressionLevel(3);
+    Status s = schema_builder.Build(&schema);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "compression level is only valid for ZSTD compression");
+  }
+
+  // An out-of-range ZSTD level is rejected by the master.
+  KuduSchema schema;
+  KuduSchemaBuilder schema_builder;
+  schema_builder.AddColumn("key")->Type(KuduColumnSchema::INT32)->NotNull()->PrimaryKey()
+      ->Compression(KuduColumnStorageAttributes::ZSTD)->CompressionLevel(1000);
+  ASSERT_OK(schema_builder.Build(&schema));
+  unique_ptr<KuduTableCreator> table_creator(client_->NewTableCreator());
+  Status s = table_creator->table_name("foobar")
+      .schema(&schema)
+      .set_range_partition_columns({ "key" })
+      .Create();
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "invalid compression level for column 'key'");
+}
+
+TEST_F(ClientTest, TestAlterTableWithInvalidCompressionLevels) {
+  const auto alter_int_val = [&](KuduColumnStorageAttributes::CompressionType* compression,
+                                 int32_t level) {
+    unique_ptr<KuduTableAlterer> table_alterer(client_->NewTableAlterer(kTableName));
+    KuduColumnSpec* spec = table_alterer->AlterColumn("int_val")->CompressionLevel(level);
+    if (compression) {
+      spec->Compression(*compression);
+    }
+    return table_alterer->Alter();
+  };
+
+  // Rejected by the client: the new codec doesn't support levels.
+  KuduColumnStorageAttributes::CompressionType compression = KuduColumnStorageAttributes::LZ4;
+  Status s = alter_int_val(&compression, 3);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "compression level is only valid for ZSTD compression");
+
+  // Rejected by the master: the column's current codec doesn't support levels.
+  s = alter_int_val(nullptr, 3);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "invalid compression level for column 'int_val'");
+
+  // Rejected by the master: the level is out of range for ZSTD.
+  compression = KuduColumnStorageAttributes::ZSTD;
+  s = alter_int_val(&compression, 1000);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "invalid compression level for column 'int_val'");
+
+  // A valid level is accepted, and switching to another codec afterwards
+  // reverts the column to the default level.
+  ASSERT_OK(alter_int_val(&compression, 9));
+  {
+    unique_ptr<KuduTableAlterer> table_alterer(client_->NewTableAlterer(kTableName));
+    table_alterer->AlterColumn("int_val")->Compression(KuduColumnStorageAttributes::LZ4);
+    ASSERT_OK(table_alterer->Alter());
+  }
+  KuduSchema schema;
+  ASSERT_OK(client_->GetTableSchema(kTableName, &schema));
+  Schema internal_schema = KuduSchema::ToSchema(schema);
+  const ColumnSchema& col = internal_schema.column(internal_schema.find_column("int_val"));
+  ASSERT_EQ(LZ4, col.attributes().compression);
+  ASSERT_EQ(0, col.attributes().compression_level);
+}
+
+TEST_F(ClientTest, TestTableTtlColumnValidation) {
+  const string kTtlTableName = "ttl_table";
+  const string kTtlColumnKey = "kudu.table.ttl_column";
+  KuduSchema schema;
+  {
+    KuduSchemaBuilder schema_builder;
+    schema_builder.AddColumn("key")->Type(KuduColumnSchema::INT32)->NotNull()->PrimaryKey();
+    schema_builder.AddColumn("ts")->Type(KuduColumnSchema::UNIXTIME_MICROS)->Nullable();
+    schema_builder.AddColumn("val")->Type(KuduColumnSchema::INT32)->Nullable();
+    ASSERT_OK(schema_builder.Build(&schema));
+  }
+  const auto create_table = [&](const string& ttl_column) {
+    unique_ptr<KuduTableCreator> table_creator(client_->NewTableCreator());
+    return table_creator->table_name(kTtlTableName)
+        .schema(&schema)
+        .set_range_partition_columns({ "key" })
+        .num_replicas(1)
+        .extra_configs({ { kTtlColumnKey, ttl_column } })
+        .Create();
+  };
+  const auto ttl_column = [&](string* column) {
+    client::sp::shared_ptr<KuduTable> table;
+    RETURN_NOT_OK(client_->OpenTable(kTtlTableName, &table));
+    *column = FindWithDefault(table->extra_configs(), kTtlColumnKey, "");
+    return Status::OK();
+  };
+
+  // The TTL column must exist and be a timestamp.
+  Status s = create_table("missing");
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "TTL column 'missing' does not exist");
+  s = create_table("val");
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), "TTL column 'val' must be of type UNIXTIME_MICROS");
+  ASSERT_OK(create_table("ts"));
+
+  // The same holds when the TTL column is changed by an alter.
+  {
+    unique_ptr<KuduTableAlterer> table_alterer(client_->NewTableAlterer(kTtlTableName));
+    s = table_alterer->AlterExtraConfig({ { kTtlColumnKey, "val" } })->Alter();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "TTL column 'val' must be of type UNIXTIME_MICROS");
+  }
+
+  // Renaming the TTL column carries the setting along.
+  {
+    unique_ptr<KuduTableAlterer> table_alterer(client_->NewTableAlterer(kTtlTableName));
+    table_alterer->AlterColumn("ts")->RenameTo("ts2");
+    ASSERT_OK(table_alterer->Alter());
+  }
+  string column;
+  ASSERT_OK(ttl_column(&column));
+  ASSERT_EQ("ts2", column);
+
+  // The TTL column can't be dropped unless it's unset in the same alter.
+  {
+    unique_ptr<KuduTableAlterer> table_alterer(client_->NewTableAlterer(kTtlTableName));
+    s = table_alterer->DropColumn("ts2")->Alter();
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "TTL column 'ts2' does not exist");
+  }
+  {
+    unique_ptr<KuduTableAlterer> table_alterer(client_->NewTableAlterer(kTtlTableName));
+    ASSERT_OK(table_alterer->DropColumn("ts2")
+                  ->AlterExtraConfig({ { kTtlColumnKey, "" } })
+                  ->Alter());
+  }
+  ASSERT_OK(ttl_column(&column));
+  ASSERT_EQ("", column);
+}
+
+// Test that the leader replica deletes rows whose TTL column value is older
+// than the table's TTL, and leaves newer rows and rows with a null alone.
+TEST_F(ClientTest, TestExpiredRowsAreDeleted) {
+  FLAGS_ttl_expiry_interval_secs = 0;
+  const string kTtlTableName = "ttl_table";
+  KuduSchema schema;
+  {
+    KuduSchemaBuilder schema_builder;
+    schema_builder.AddColumn("key")->Type(KuduColumnSchema::INT32)->NotNull()->PrimaryKey();
+    schema_builder.AddColumn("ts")->Type(KuduColumnSchema::UNIXTIME_MICROS)->Nullable();
+    ASSERT_OK(schema_builder.Build(&schema));
+  }
+  {
+    unique_ptr<KuduTableCreator> table_creator(client_->NewTableCreator());
+    ASSERT_OK(table_creator->table_name(kTtlTableName)
+                  .schema(&schema)
+                  .set_range_partition_columns({ "key" })
+                  .num_replicas(1)
+                  .extra_configs({ { "kudu.table.ttl_column", "ts" },
+                                   { "kudu.table.ttl_sec", "3600" } })
+                  .Create());
+  }
+  client::sp::shared_ptr<KuduTable> table;
+  ASSERT_OK(client_->OpenTable(kTtlTableName, &table));
+
+  // Even keys are two hours old, odd keys are current and the last row has
+  // no timestamp at all.
+  const int kNumRows = 10;
+  const int64_t now_micros = GetCurrentTimeMicros();
+  client::sp::shared_ptr<KuduSession> session = client_->NewSession();
+  for (int i = 0; i <= kNumRows; i++) {
+    unique_ptr<KuduInsert> insert(table->NewInsert());
+    KuduPartialRow* row = insert->mutable_row();
+    ASSERT_OK(row->SetInt32("key", i));
+    if (i < kNumRows) {
+      const int64_t age_micros = i % 2 == 0 ? 2 * 3600 * 1000000LL : 0;
+      ASSERT_OK(row->SetUnixTimeMicros("ts", now_micros - age_micros));
+    }
+    ASSERT_OK(session->Apply(insert.release()));
+  }
+  ASSERT_OK(session->Flush());
+
+  ASSERT_EVENTUALLY([&] {
+    ASSERT_EQ(kNumRows / 2 + 1, CountRowsFromClient(table.get()));
+  });
+}
+
 TEST_F(ClientTest, TestCreateTableWithTooManyColumns) {
   unique_ptr<KuduTableCreator> table_creator(client_->NewTableCreator());
   KuduSchema schema;
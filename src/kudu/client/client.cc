@@ -20,12 +20,14 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <mutex>
 #include <ostream>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/optional/optional.hpp>
@@ -62,6 +64,7 @@
 #include "kudu/common/partial_row.h"
 #include "kudu/common/partition.h"
 #include "kudu/common/partition_pruner.h"
+#include "kudu/common/row_aggregator.h"
 #include "kudu/common/row_operations.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
@@ -91,12 +94,14 @@
 #include "kudu/util/async_util.h"
 #include "kudu/util/debug-util.h"
 #include "kudu/util/init.h"
+#include "kudu/util/int128.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/logging_callback.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/net/net_util.h"
 #include "kudu/util/oid_generator.h"
 #include "kudu/util/scoped_cleanup.h"
+#include "kudu/util/string_case.h"
 #include "kudu/util/version_info.h"
 
 namespace kudu {
@@ -1173,6 +1178,10 @@ Status KuduSession::SetExternalConsistencyMode(ExternalConsistencyMode m) {
   return data_->SetExternalConsistencyMode(m);
 }
 
+Status KuduSession::SetBulkLoadMode(bool enabled) {
+  return data_->SetBulkLoadMode(enabled);
+}
+
 Status KuduSession::SetMutationBufferSpace(size_t size) {
   return data_->SetBufferBytesLimit(size);
 }
@@ -1586,6 +1595,20 @@ Status KuduScanner::SetRowFormatFlags(uint64_t flags) {
   return data_->mutable_configuration()->SetRowFormatFlags(flags);
 }
 
+Status KuduScanner::AddAggregate(AggregateFunction function, const string& col_name) {
+  if (data_->open_) {
+    return Status::IllegalState("Aggregates must be added before Open()");
+  }
+  return data_->mutable_configuration()->AddAggregate(function, col_name);
+}
+
+Status KuduScanner::AddGroupByColumn(const string& col_name) {
+  if (data_->open_) {
+    return Status::IllegalState("Group-by columns must be added before Open()");
+  }
+  return data_->mutable_configuration()->AddGroupByColumn(col_name);
+}
+
 Status KuduScanner::SetLimit(int64_t limit) {
   if (data_->open_) {
     return Status::IllegalState("Limit must be set before Open()");
@@ -1614,6 +1637,101 @@ struct CloseCallback {
     delete this;
   }
 };
+
+// Builds the schema of the rows returned by KuduScanner::GetAggregateResults().
+Status BuildAggregateResultSchema(const AggregateSpecPB& spec,
+                                  const Schema& projection,
+                                  Schema* result_schema) {
+  vector<ColumnSchema> cols;
+  for (const auto& col_name : spec.group_by_columns()) {
+    const ColumnSchema& col = projection.column(projection.find_column(col_name));
+    cols.emplace_back(col.name(), col.type_info()->type(), /*is_nullable=*/true,
+                      nullptr, nullptr, ColumnStorageAttributes(), col.type_attributes());
+  }
+  for (const auto& agg_pb : spec.aggregates()) {
+    string name = Substitute("$0($1)",
+                             AggregateSpecPB::AggregateFunction_Name(agg_pb.function()),
+                             agg_pb.has_column() ? agg_pb.column() : "*");
+    ToLowerCase(&name);
+    if (agg_pb.function() == AggregateSpecPB::COUNT) {
+      cols.emplace_back(std::move(name), INT64);
+      continue;
+    }
+    const ColumnSchema& col = projection.column(projection.find_column(agg_pb.column()));
+    if (agg_pb.function() == AggregateSpecPB::SUM) {
+      DataType physical_type = col.type_info()->physical_type();
+      cols.emplace_back(std::move(name),
+                        physical_type == FLOAT || physical_type == DOUBLE ? DOUBLE : INT64,
+                        /*is_nullable=*/true);
+    } else {
+      cols.emplace_back(std::move(name), col.type_info()->type(), /*is_nullable=*/true,
+                        nullptr, nullptr, ColumnStorageAttributes(), col.type_attributes());
+    }
+  }
+  return result_schema->Reset(std::move(cols), 0);
+}
+
+// Sets column 'col_idx' of 'row' to a value from an aggregation result.
+Status SetAggregateResultCell(const AggregateResultPB::ValuePB& value_pb,
+                              int col_idx,
+                              KuduPartialRow* row) {
+  const ColumnSchema& col = row->schema()->column(col_idx);
+  if (value_pb.has_int_value()) {
+    return row->SetInt64(col_idx, value_pb.int_value());
+  }
+  if (value_pb.has_double_value()) {
+    return row->SetDouble(col_idx, value_pb.double_value());
+  }
+  if (!value_pb.has_cell()) {
+    return row->SetNull(col_idx);
+  }
+  const string& cell = value_pb.cell();
+  switch (col.type_info()->type()) {
+    case STRING:
+      return row->SetStringCopy(col_idx, cell);
+    case BINARY:
+      return row->SetBinaryCopy(col_idx, cell);
+    case VARCHAR:
+      return row->SetVarchar(col_idx, cell);
+    default:
+      break;
+  }
+  if (PREDICT_FALSE(cell.size() != col.type_info()->size())) {
+    return Status::Corruption("unexpected size of aggregate result value", col.name());
+  }
+  // Copy the value to ensure it is suitably aligned.
+  int128_t val = 0;
+  memcpy(&val, cell.data(), cell.size());
+  switch (col.type_info()->type()) {
+    case BOOL:
+      return row->SetBool(col_idx, *reinterpret_cast<const bool*>(&val));
+    case INT8:
+      return row->SetInt8(col_idx, *reinterpret_cast<const int8_t*>(&val));
+    case INT16:
+      return row->SetInt16(col_idx, *reinterpret_cast<const int16_t*>(&val));
+    case INT32:
+      return row->SetInt32(col_idx, *reinterpret_cast<const int32_t*>(&val));
+    case INT64:
+      return row->SetInt64(col_idx, *reinterpret_cast<const int64_t*>(&val));
+    case UNIXTIME_MICROS:
+      return row->SetUnixTimeMicros(col_idx, *reinterpret_cast<const int64_t*>(&val));
+    case DATE:
+      return row->SetDate(col_idx, *reinterpret_cast<const int32_t*>(&val));
+    case FLOAT:
+      return row->SetFloat(col_idx, *reinterpret_cast<const float*>(&val));
+    case DOUBLE:
+      return row->SetDouble(col_idx, *reinterpret_cast<const double*>(&val));
+    case DECIMAL32:
+      return row->SetUnscaledDecimal(col_idx, *reinterpret_cast<const int32_t*>(&val));
+    case DECIMAL64:
+      return row->SetUnscaledDecimal(col_idx, *reinterpret_cast<const int64_t*>(&val));
+    case DECIMAL128:
+      return row->SetUnscaledDecimal(col_idx, val);
+    default:
+      return Status::InvalidArgument("unexpected type of aggregate result column",
+                                     col.ToString());
+  }
+}
 } // anonymous namespace
 
 string KuduScanner::ToString() const {
@@ -1634,6 +1752,23 @@ Status KuduScanner::Open() {
                                 data_->table_->partition_schema(),
                                 data_->configuration().spec());
 
+  if (data_->configuration().has_aggregates()) {
+    if (data_->configuration().is_fault_tolerant()) {
+      return Status::InvalidArgument("Aggregating scans may not be fault-tolerant");
+    }
+    if (data_->configuration().spec().has_limit()) {
+      return Status::InvalidArgument("Aggregating scans may not have a limit");
+    }
+    RETURN_NOT_OK(RowAggregator::Create(data_->configuration().aggregate_spec(),
+                                        *data_->configuration().projection(),
+                                        &data_->aggregator_));
+    RETURN_NOT_OK(BuildAggregateResultSchema(data_->configuration().aggregate_spec(),
+                                             *data_->configuration().projection(),
+                                             &data_->aggregate_result_schema_));
+  } else if (data_->configuration().aggregate_spec().group_by_columns_size() > 0) {
+    return Status::InvalidArgument("Group-by columns require at least one aggregate");
+  }
+
   if (data_->configuration().spec().CanShortCircuit() ||
       !data_->partition_pruner_.HasMorePartitionKeyRanges()) {
     VLOG(2) << "Short circuiting scan " << data_->DebugString();
@@ -1706,6 +1841,48 @@ bool KuduScanner::HasMoreRows() const {
        data_->MoreTablets());                      // more tablets to scan, possibly with more data
 }
 
+Status KuduScanner::GetAggregateResults(vector<KuduPartialRow*>* results) {
+  if (!data_->aggregator_) {
+    return Status::IllegalState("Scanner is not open or has no aggregates");
+  }
+  if (HasMoreRows()) {
+    return Status::IllegalState("Aggregate results are available once all rows are scanned");
+  }
+
+  const AggregateSpecPB& spec = data_->configuration().aggregate_spec();
+  AggregateResultPB result_pb;
+  data_->aggregator_->ToPB(&result_pb);
+  if (spec.group_by_columns().empty() && result_pb.groups().empty()) {
+    // No rows matched: aggregating over the empty set still produces a single
+    // row, in which counts are zero and every other aggregate is NULL.
+    auto* group_pb = result_pb.add_groups();
+    for (const auto& agg_pb : spec.aggregates()) {
+      auto* value_pb = group_pb->add_aggregate_values();
+      if (agg_pb.function() == AggregateSpecPB::COUNT) {
+        value_pb->set_int_value(0);
+      }
+    }
+  }
+
+  vector<unique_ptr<KuduPartialRow>> rows;
+  for (const auto& group_pb : result_pb.groups()) {
+    unique_ptr<KuduPartialRow> row(new KuduPartialRow(&data_->aggregate_result_schema_));
+    int col_idx = 0;
+    for (const auto& value_pb : group_pb.group_by_values()) {
+      RETURN_NOT_OK(SetAggregateResultCell(value_pb, col_idx++, row.get()));
+    }
+    for (const auto& value_pb : group_pb.aggregate_values()) {
+      RETURN_NOT_OK(SetAggregateResultCell(value_pb, col_idx++, row.get()));
+    }
+    rows.emplace_back(std::move(row));
+  }
+  results->clear();
+  for (auto& row : rows) {
+    results->push_back(row.release());
+  }
+  return Status::OK();
+}
+
 Status KuduScanner::NextBatch(vector<KuduRowResult>* rows) {
   if (PREDICT_FALSE(data_->configuration().row_format_flags() != KuduScanner::NO_FLAGS)) {
     return Status::IllegalState(
@@ -1739,6 +1739,22 @@ class KUDU_EXPORT KuduSession : public sp::enable_shared_from_this<KuduSession>
   Status SetExternalConsistencyMode(ExternalConsistencyMode m)
     WARN_UNUSED_RESULT;
 
+  /// Set whether the session's writes are sent as bulk loads.
+  ///
+  /// In bulk load mode, the rows of each batch sent to a tablet server are
+  /// sorted by primary key, and the tablet servers are allowed to write them
+  /// straight into new on-disk rowsets instead of their in-memory stores.
+  /// This only happens for batches consisting of inserts of keys that don't
+  /// overlap any data already in the tablet, e.g. when loading an empty
+  /// table; other batches are applied as usual. The outcome of every
+  /// operation is the same either way, but the order in which the operations
+  /// of a batch are applied is not preserved.
+  ///
+  /// @param [in] enabled
+  ///   Whether to enable bulk load mode. It is disabled by default.
+  /// @return Operation result status.
+  Status SetBulkLoadMode(bool enabled) WARN_UNUSED_RESULT;
+
   /// Set the amount of buffer space used by this session for outbound writes.
   ///
   /// The effect of the buffer size varies based on the flush mode of
@@ -2475,6 +2491,68 @@ class KUDU_EXPORT KuduScanner {
   ///   Row format modifier flags to set.
   /// @return Operation result status.
   Status SetRowFormatFlags(uint64_t flags);
+
+  /// Aggregate functions which the tablet servers can evaluate over the
+  /// scanned rows. See AddAggregate().
+  enum AggregateFunction {
+    /// The number of non-null values in a column, or the number of rows if
+    /// no column is given.
+    COUNT,
+    /// The sum of the non-null values in an integer or floating point column.
+    /// Integers are summed as 64-bit values, wrapping on overflow.
+    SUM,
+    /// The minimum non-null value in a column.
+    MIN,
+    /// The maximum non-null value in a column.
+    MAX
+  };
+
+  /// Add an aggregate to evaluate over the rows matched by the scan.
+  ///
+  /// Once an aggregate is added, the tablet servers aggregate the matching
+  /// rows instead of returning them: NextBatch() yields empty batches, and
+  /// once HasMoreRows() returns false the results are available through
+  /// GetAggregateResults(). The aggregated column must be part of the
+  /// projection, and the same aggregate may not be added twice.
+  ///
+  /// Aggregating scans may not be fault-tolerant nor have a limit.
+  ///
+  /// NOTE: older versions of the Kudu server do not support this feature.
+  ///
+  /// @param [in] function
+  ///   The aggregate function to evaluate.
+  /// @param [in] col_name
+  ///   The name of the column to aggregate. May be empty only for COUNT.
+  /// @return Operation result status.
+  Status AddAggregate(AggregateFunction function, const std::string& col_name)
+      WARN_UNUSED_RESULT;
+
+  /// Group the rows of an aggregating scan by the values of a column, which
+  /// must be part of the projection. Each group is aggregated separately.
+  /// This is intended for low-cardinality columns. Opening a scanner with
+  /// group-by columns but no aggregates fails.
+  ///
+  /// @param [in] col_name
+  ///   The name of the column to group by.
+  /// @return Operation result status.
+  Status AddGroupByColumn(const std::string& col_name) WARN_UNUSED_RESULT;
+
+  /// Get the results of an aggregating scan, once all of its rows have been
+  /// scanned.
+  ///
+  /// Each result row holds the values of the group-by columns, named after
+  /// the columns themselves, followed by the values of the aggregates in the
+  /// order they were added, named e.g. "count(*)" or "sum(col)". COUNT yields
+  /// a non-null INT64 value, SUM yields INT64 or DOUBLE, and MIN and MAX
+  /// yield values of the aggregated column's type. Group-by columns, SUM, MIN
+  /// and MAX may be NULL. Scans without group-by columns produce a single row.
+  ///
+  /// @param [out] results
+  ///   One row per group. The caller takes ownership of the rows, which must
+  ///   not outlive the scanner.
+  /// @return Operation result status.
+  Status GetAggregateResults(std::vector<KuduPartialRow*>* results)
+      WARN_UNUSED_RESULT;
   ///@}
 
   /// Set the maximum number of rows the scanner should return.
@@ -213,6 +213,46 @@ Status ScanConfiguration::SetLimit(int64_t limit) {
   return Status::OK();
 }
 
+Status ScanConfiguration::AddAggregate(KuduScanner::AggregateFunction function,
+                                       const string& col_name) {
+  AggregateSpecPB::AggregateFunction pb_function;
+  switch (function) {
+    case KuduScanner::COUNT:
+      pb_function = AggregateSpecPB::COUNT;
+      break;
+    case KuduScanner::SUM:
+      pb_function = AggregateSpecPB::SUM;
+      break;
+    case KuduScanner::MIN:
+      pb_function = AggregateSpecPB::MIN;
+      break;
+    case KuduScanner::MAX:
+      pb_function = AggregateSpecPB::MAX;
+      break;
+    default:
+      return Status::InvalidArgument(
+          strings::Substitute("Invalid aggregate function: $0", function));
+  }
+  for (const auto& agg : aggregate_spec_.aggregates()) {
+    if (agg.function() == pb_function && agg.column() == col_name) {
+      return Status::InvalidArgument(strings::Substitute(
+          "Duplicate aggregate: $0($1)", AggregateSpecPB::AggregateFunction_Name(pb_function),
+          col_name.empty() ? "*" : col_name));
+    }
+  }
+  auto* agg = aggregate_spec_.add_aggregates();
+  agg->set_function(pb_function);
+  if (!col_name.empty()) {
+    agg->set_column(col_name);
+  }
+  return Status::OK();
+}
+
+Status ScanConfiguration::AddGroupByColumn(const string& col_name) {
+  aggregate_spec_.add_group_by_columns(col_name);
+  return Status::OK();
+}
+
 Status ScanConfiguration::AddIsDeletedColumn() {
   CHECK(has_start_timestamp());
   CHECK(has_snapshot_timestamp());
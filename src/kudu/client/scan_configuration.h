@@ -25,6 +25,7 @@
 
 #include "kudu/client/client.h"
 #include "kudu/client/schema.h"
+#include "kudu/common/common.pb.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/gutil/port.h"
 #include "kudu/util/auto_release_pool.h"
@@ -99,6 +100,11 @@ class ScanConfiguration {
 
   Status SetLimit(int64_t limit);
 
+  Status AddAggregate(KuduScanner::AggregateFunction function,
+                      const std::string& col_name) WARN_UNUSED_RESULT;
+
+  Status AddGroupByColumn(const std::string& col_name) WARN_UNUSED_RESULT;
+
   // Adds an IS_DELETED virtual column to the projection.
   //
   // Can only be used with diff scans.
@@ -184,6 +190,14 @@ class ScanConfiguration {
     return row_format_flags_;
   }
 
+  bool has_aggregates() const {
+    return aggregate_spec_.aggregates_size() > 0;
+  }
+
+  const AggregateSpecPB& aggregate_spec() const {
+    return aggregate_spec_;
+  }
+
   Arena* arena() {
     return &arena_;
   }
@@ -236,6 +250,9 @@ class ScanConfiguration {
   AutoReleasePool pool_;
 
   uint64_t row_format_flags_;
+
+  // The aggregations to push down to the tablet servers, if any.
+  AggregateSpecPB aggregate_spec_;
 };
 
 } // namespace client
@@ -373,6 +373,9 @@ ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
   if (configuration().row_format_flags() & KuduScanner::COLUMNAR_LAYOUT) {
     controller_.RequireServerFeature(TabletServerFeatures::COLUMNAR_LAYOUT_FEATURE);
   }
+  if (configuration().has_aggregates()) {
+    controller_.RequireServerFeature(TabletServerFeatures::AGGREGATE_PUSHDOWN);
+  }
 
   if (next_req_.has_new_scan_request()) {
     // Only new scan requests require authz tokens. Scan continuations rely on
@@ -396,6 +399,12 @@ ScanRpcStatus KuduScanner::Data::SendScanRpc(const MonoTime& overall_deadline,
     num_rows_returned_ += last_response_.has_data() ? last_response_.data().num_rows() : 0;
     num_rows_returned_ += last_response_.has_columnar_data() ?
         last_response_.columnar_data().num_rows() : 0;
+    if (aggregator_ && last_response_.has_aggregate_result()) {
+      Status s = aggregator_->MergeFromPB(last_response_.aggregate_result());
+      if (PREDICT_FALSE(!s.ok())) {
+        return ScanRpcStatus{ScanRpcStatus::OTHER_TS_ERROR, s};
+      }
+    }
   }
   return scan_status;
 }
@@ -459,6 +468,10 @@ Status KuduScanner::Data::OpenTablet(const string& partition_key,
 
   scan->set_cache_blocks(configuration_.spec().cache_blocks());
 
+  if (configuration_.has_aggregates()) {
+    *scan->mutable_aggregate_spec() = configuration_.aggregate_spec();
+  }
+
   // For consistent operations, propagate the timestamp among all operations
   // performed the context of the same client. For READ_YOUR_WRITES scan, use
   // the propagation timestamp from the scan config.
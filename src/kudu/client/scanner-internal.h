@@ -35,6 +35,8 @@
 #include "kudu/client/scan_configuration.h"
 #include "kudu/client/shared_ptr.h" // IWYU pragma: keep
 #include "kudu/common/partition_pruner.h"
+#include "kudu/common/row_aggregator.h"
+#include "kudu/common/schema.h"
 #include "kudu/common/wire_protocol.pb.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/ref_counted.h"
@@ -46,7 +48,6 @@
 namespace kudu {
 
 class MonoTime;
-class Schema;
 
 namespace tserver {
 class TabletServerServiceProxy;
@@ -263,6 +264,13 @@ class KuduScanner::Data {
   // The scanner's cumulative resource metrics since the scan was started.
   ResourceMetrics resource_metrics_;
 
+  // For aggregating scans, folds together the partial results returned by
+  // every scan response. Set when the scanner is opened.
+  std::unique_ptr<RowAggregator> aggregator_;
+
+  // The schema of the rows returned by GetAggregateResults().
+  Schema aggregate_result_schema_;
+
   // Returns a text description of the scan suitable for debug printing.
   //
   // This method will not return sensitive predicate information, so it's
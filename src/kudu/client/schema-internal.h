@@ -80,6 +80,7 @@ class KuduColumnSpec::Data {
   boost::optional<uint16_t> length;
   boost::optional<KuduColumnStorageAttributes::EncodingType> encoding;
   boost::optional<KuduColumnStorageAttributes::CompressionType> compression;
+  boost::optional<int32_t> compression_level;
   boost::optional<int32_t> block_size;
   boost::optional<bool> nullable;
   bool primary_key;
@@ -133,6 +133,8 @@ class KUDU_EXPORT KuduColumnStorageAttributes {
     RLE = 4,
     DICT_ENCODING = 5,
     BIT_SHUFFLE = 6,
+    FOR_DELTA = 7,
+    ALP = 8,
 
     /// @deprecated GROUP_VARINT is not supported for valid types, and
     /// will fall back to another encoding on the server side.
@@ -146,6 +148,7 @@ class KUDU_EXPORT KuduColumnStorageAttributes {
     SNAPPY = 2,
     LZ4 = 3,
     ZLIB = 4,
+    ZSTD = 5,
   };
 
 
@@ -357,6 +360,19 @@ class KUDU_EXPORT KuduColumnSpec {
   /// @return Pointer to the modified object.
   KuduColumnSpec* Compression(KuduColumnStorageAttributes::CompressionType compression);
 
+  /// Set the compression level for the column.
+  ///
+  /// Only codecs which support levels (currently only ZSTD) accept a level
+  /// other than 0; higher levels trade slower writes for smaller data on
+  /// disk. Decompression speed is largely independent of the level. Creating
+  /// or altering a table fails with InvalidArgument if the level is not
+  /// valid for the column's codec.
+  ///
+  /// @param [in] level
+  ///   The compression level to use, or 0 for the codec's default level.
+  /// @return Pointer to the modified object.
+  KuduColumnSpec* CompressionLevel(int32_t level);
+
   /// Set the preferred encoding for the column.
   ///
   /// @note Not all encodings are supported for all column types.
@@ -57,6 +57,7 @@ KuduSession::Data::Data(shared_ptr<KuduClient> client,
       messenger_(std::move(messenger)),
       error_collector_(new ErrorCollector()),
       external_consistency_mode_(CLIENT_PROPAGATED),
+      bulk_load_(false),
       flush_interval_(MonoDelta::FromMilliseconds(1000)),
       flush_task_active_(false),
       flush_mode_(AUTO_FLUSH_SYNC),
@@ -120,6 +121,17 @@ Status KuduSession::Data::SetExternalConsistencyMode(
   return Status::OK();
 }
 
+Status KuduSession::Data::SetBulkLoadMode(bool enabled) {
+  std::lock_guard<Mutex> l(mutex_);
+  if (HasPendingOperationsUnlocked()) {
+    // NOTE: this is an artificial restriction, for the same reason as above.
+    return Status::IllegalState(
+        "Cannot change bulk load mode when writes are buffered");
+  }
+  bulk_load_ = enabled;
+  return Status::OK();
+}
+
 Status KuduSession::Data::SetFlushMode(FlushMode mode) {
   {
     std::lock_guard<Mutex> l(mutex_);
@@ -470,12 +482,13 @@ Status KuduSession::Data::ApplyWriteOp(KuduWriteOperation* write_op) {
         condition_.Wait();
       }
       DCHECK(!batcher_);
-      // Thread-safety note: the external_consistecy_mode_ and timeout_ms_
-      // are not supposed to be accessed or modified from any other thread
-      // no thread-safety is advertised for the kudu::KuduSession interface.
+      // Thread-safety note: the external_consistecy_mode_, bulk_load_ and
+      // timeout_ms_ are not supposed to be accessed or modified from any other
+      // thread: no thread-safety is advertised for the kudu::KuduSession
+      // interface.
       scoped_refptr<Batcher> batcher(
           new Batcher(client_.get(), error_collector_, session_,
-                      external_consistency_mode_));
+                      external_consistency_mode_, bulk_load_));
       if (timeout_.Initialized()) {
         batcher->SetTimeout(timeout_);
       }
@@ -81,6 +81,9 @@ class KuduSession::Data {
   // Set external consistency mode for the session.
   Status SetExternalConsistencyMode(KuduSession::ExternalConsistencyMode m);
 
+  // Set whether the session's writes are sent as bulk loads.
+  Status SetBulkLoadMode(bool enabled);
+
   // Set limit on buffer space consumed by buffered write operations.
   Status SetBufferBytesLimit(size_t size);
 
@@ -184,6 +187,9 @@ class KuduSession::Data {
 
   kudu::client::KuduSession::ExternalConsistencyMode external_consistency_mode_;
 
+  // Whether the session's writes are sent as bulk loads.
+  bool bulk_load_;
+
   // Timeout for the next batch.
   MonoDelta timeout_;
 
@@ -22,6 +22,7 @@
 #include <cstdlib>
 #include <functional>
 #include <initializer_list>
+#include <limits>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -50,6 +51,8 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+DECLARE_bool(disable_column_predicate_avx2);
+
 using std::vector;
 
 namespace kudu {
@@ -1494,6 +1497,107 @@ TEST_F(TestColumnPredicateDeathTest, TestMergeRequiresNameAndType) {
   }, "COMPARE_NAME_AND_TYPE");
 }
 
+// Tests that the AVX2 predicate kernels produce the same results as the
+// generic implementation. On CPUs without AVX2, both use the latter.
+template<typename TypeParam>
+class ColumnPredicateAvx2Test : public KuduTest {
+ protected:
+  typedef typename TypeParam::cpp_type cpp_type;
+  static constexpr auto kColType = TypeParam::physical_type;
+
+  ColumnPredicateAvx2Test() : rand_(SeedRandom()) {
+    // Boundary values of the type, so that unsigned values with the high bit
+    // set and NaN are exercised along with small values.
+    pool_ = { 0, 1, 2, 3,
+              std::numeric_limits<cpp_type>::max(),
+              static_cast<cpp_type>(std::numeric_limits<cpp_type>::max() - 1),
+              std::numeric_limits<cpp_type>::lowest(),
+              static_cast<cpp_type>(std::numeric_limits<cpp_type>::lowest() + 1) };
+    if (std::numeric_limits<cpp_type>::has_quiet_NaN) {
+      pool_.push_back(std::numeric_limits<cpp_type>::quiet_NaN());
+    }
+  }
+
+  const cpp_type* RandomValue() {
+    return &pool_[rand_.Uniform(pool_.size())];
+  }
+
+  void VerifyPredicate(const ColumnPredicate& pred, const ColumnBlock& block) {
+    // Predicates may simplify to None, which can't be evaluated.
+    if (pred.predicate_type() == PredicateType::None) {
+      return;
+    }
+    SCOPED_TRACE(pred.ToString());
+    SelectionVector expected(block.nrows());
+    SelectionVector actual(block.nrows());
+    expected.SetAllTrue();
+    actual.SetAllTrue();
+    // Deselect some rows up front: the kernels must not select them again.
+    for (int i = 0; i < block.nrows(); i += 11) {
+      expected.SetRowUnselected(i);
+      actual.SetRowUnselected(i);
+    }
+    FLAGS_disable_column_predicate_avx2 = true;
+    pred.Evaluate(block, &expected);
+    FLAGS_disable_column_predicate_avx2 = false;
+    pred.Evaluate(block, &actual);
+    ASSERT_TRUE(expected == actual);
+  }
+
+  Random rand_;
+  vector<cpp_type> pool_;
+};
+
+using avx2_test_types = ::testing::Types<
+  DataTypeTraits<INT8>,
+  DataTypeTraits<INT16>,
+  DataTypeTraits<INT32>,
+  DataTypeTraits<INT64>,
+  DataTypeTraits<UINT8>,
+  DataTypeTraits<UINT16>,
+  DataTypeTraits<UINT32>,
+  DataTypeTraits<UINT64>,
+  DataTypeTraits<FLOAT>,
+  DataTypeTraits<DOUBLE>>;
+
+TYPED_TEST_CASE(ColumnPredicateAvx2Test, avx2_test_types);
+
+TYPED_TEST(ColumnPredicateAvx2Test, TestMatchesScalar) {
+  constexpr auto kColType = TestFixture::kColType;
+  using cpp_type = typename TestFixture::cpp_type;
+  // Not a multiple of the rows evaluated per AVX2 iteration, nor of 8.
+  constexpr int kNumRows = 1000;
+
+  for (bool nullable : { false, true }) {
+    ColumnSchema cs("c", kColType, nullable);
+    ScopedColumnBlock<kColType> b(kNumRows, /*allow_nulls=*/nullable);
+    for (int i = 0; i < kNumRows; i++) {
+      b[i] = *this->RandomValue();
+      if (nullable) {
+        b.SetCellIsNull(i, this->rand_.OneIn(10));
+      }
+    }
+
+    for (int iter = 0; iter < 50; iter++) {
+      const cpp_type* lower = this->RandomValue();
+      const cpp_type* upper = this->RandomValue();
+      NO_FATALS(this->VerifyPredicate(ColumnPredicate::Range(cs, nullptr, upper), b));
+      NO_FATALS(this->VerifyPredicate(ColumnPredicate::Range(cs, lower, nullptr), b));
+      NO_FATALS(this->VerifyPredicate(ColumnPredicate::Range(cs, lower, upper), b));
+      NO_FATALS(this->VerifyPredicate(ColumnPredicate::Equality(cs, lower), b));
+
+      // IN lists both small enough and too large for the AVX2 kernels.
+      for (int list_size : { 2, 5, 40 }) {
+        vector<const void*> values;
+        for (int i = 0; i < list_size; i++) {
+          values.push_back(this->RandomValue());
+        }
+        NO_FATALS(this->VerifyPredicate(ColumnPredicate::InList(cs, &values), b));
+      }
+    }
+  }
+}
+
 template<typename TypeParam>
 class ColumnPredicateBenchmark : public KuduTest {
   protected:
@@ -17,27 +17,41 @@
 
 #include "kudu/common/column_predicate.h"
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <type_traits>
 
 #include <boost/optional/optional.hpp>
+#include <gflags/gflags.h>
 
 #include "kudu/common/columnblock.h"
 #include "kudu/common/key_util.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/types.h"
+#include "kudu/gutil/cpu.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/join.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/alignment.h"
 #include "kudu/util/bitmap.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/memory/arena.h"
 
+DEFINE_bool(disable_column_predicate_avx2, false,
+            "Disable the AVX2 kernels used to evaluate column predicates. This flag has "
+            "no effect if the CPU doesn't support AVX2 at run-time.");
+TAG_FLAG(disable_column_predicate_avx2, hidden);
+
 using std::move;
 using std::string;
 using std::vector;
@@ -665,13 +679,18 @@ namespace {
 // Returns the number of elements of 'cb' that were processed. This function
 // only processes multiples of 8, so if cb.nrows() is not a multiple of 8, the
 // last few elements may need to be processed by the caller.
+//
+// Rows before 'start_idx', which must be a multiple of 8, are assumed to have
+// already been evaluated, though they are still masked against the null bitmap.
 template <DataType PhysicalType, typename P>
 ATTRIBUTE_NOINLINE
-int ApplyPredicatePrimitive(const ColumnBlock& block, uint8_t* __restrict__ sel_bitmap, P p) {
+int ApplyPredicatePrimitive(const ColumnBlock& block, int start_idx,
+                            uint8_t* __restrict__ sel_bitmap, P p) {
   using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
-  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
+  DCHECK_EQ(0, start_idx % 8);
+  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data()) + start_idx;
   const int n_chunks = block.nrows() / 8;
-  for (int i = 0; i < n_chunks; i++) {
+  for (int i = start_idx / 8; i < n_chunks; i++) {
     uint8_t res_8 = 0;
     for (int j = 0; j < 8; j++) {
       res_8 |= p(data++) << j;
@@ -687,16 +706,18 @@ int ApplyPredicatePrimitive(const ColumnBlock& block, uint8_t* __restrict__ sel_
 }
 
 
+// Applies the predicate 'p' to the rows of 'block' from 'start_idx' onwards.
+// See ApplyPredicatePrimitive() for the meaning of 'start_idx'.
 template <DataType PhysicalType, typename P>
-void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p) {
+void ApplyPredicate(const ColumnBlock& block, SelectionVector* sel, P p, int start_idx = 0) {
   using cpp_type = typename DataTypeTraits<PhysicalType>::cpp_type;
-  int start_idx = 0;
   if (std::is_fundamental<cpp_type>::value) {
-    start_idx = ApplyPredicatePrimitive<PhysicalType>(block, sel->mutable_bitmap(), p);
+    start_idx = ApplyPredicatePrimitive<PhysicalType>(block, start_idx, sel->mutable_bitmap(), p);
     if (PREDICT_TRUE(start_idx == block.nrows())) return;
     // If we couldn't process the whole block unrolled by 8, fall through to the
     // remainder.
   }
+  DCHECK_EQ(0, start_idx % 8);
 
   const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
   if (block.is_nullable()) {
@@ -727,6 +748,335 @@ void ApplyNullPredicate(const ColumnBlock& block, uint8_t* __restrict__ sel_vec)
     sel_vec[i] &= non_null_byte;
   }
 }
+
+////////////////////////////////////////////////////////////
+// AVX2 predicate kernels
+////////////////////////////////////////////////////////////
+
+// The AVX2 kernels evaluate predicates 32 rows at a time, producing four bytes
+// of the selection vector per iteration instead of comparing cells one by one.
+// Like ApplyPredicatePrimitive(), they ignore nulls, which the caller masks out
+// afterwards.
+//
+// The kernels are disabled on GCC4 because it doesn't support per-function
+// enabling of intrinsics.
+#if defined(__x86_64__) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define KUDU_COLUMN_PREDICATE_AVX2 1
+#endif
+
+const bool kHasAvx2 = base::CPU().has_avx2();
+
+// The number of rows evaluated per iteration of the AVX2 kernels.
+constexpr int kAvx2RowsPerIteration = 32;
+
+// The largest IN list evaluated by the AVX2 kernels, which compare each cell
+// against every value of the list.
+constexpr int kMaxAvx2InListSize = 16;
+
+// Vectorized operations on the cells of a physical type. Specializations
+// supporting AVX2 define:
+// - 'vec', the type of a 256-bit vector of kLanes cells,
+// - Load() and Broadcast(), which load cells into a vector,
+// - Lt() and Eq(), which compare vectors lane-wise with the same semantics as
+//   DataTypeTraits::Compare() (in particular, NaN is equal to any value),
+// - And(), AndNot() (~a & b), Or() and Not(), on comparison results,
+// - MoveMask(), which packs comparison results into the low kLanes bits.
+template<DataType PhysicalType>
+struct Avx2Ops {
+  static constexpr bool kSupported = false;
+};
+
+#ifdef KUDU_COLUMN_PREDICATE_AVX2
+
+#define AVX2_INLINE inline __attribute__((always_inline, target("avx2")))
+
+// Comparisons of signed integers of a given width.
+template<int kWidth>
+struct Avx2IntWidth;
+
+template<>
+struct Avx2IntWidth<1> {
+  typedef int8_t signed_type;
+  static AVX2_INLINE __m256i Broadcast(signed_type v) { return _mm256_set1_epi8(v); }
+  static AVX2_INLINE __m256i Gt(__m256i a, __m256i b) { return _mm256_cmpgt_epi8(a, b); }
+  static AVX2_INLINE __m256i Eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+  static AVX2_INLINE uint32_t MoveMask(__m256i m) { return _mm256_movemask_epi8(m); }
+};
+
+template<>
+struct Avx2IntWidth<2> {
+  typedef int16_t signed_type;
+  static AVX2_INLINE __m256i Broadcast(signed_type v) { return _mm256_set1_epi16(v); }
+  static AVX2_INLINE __m256i Gt(__m256i a, __m256i b) { return _mm256_cmpgt_epi16(a, b); }
+  static AVX2_INLINE __m256i Eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+  static AVX2_INLINE uint32_t MoveMask(__m256i m) {
+    // Narrow the 16-bit lanes to bytes. The packing operates within each
+    // 128-bit half, so the 64-bit quarters holding the packed bytes of each
+    // half are then moved next to each other.
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(m, m), 0xd8);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(packed)) & 0xffff;
+  }
+};
+
+template<>
+struct Avx2IntWidth<4> {
+  typedef int32_t signed_type;
+  static AVX2_INLINE __m256i Broadcast(signed_type v) { return _mm256_set1_epi32(v); }
+  static AVX2_INLINE __m256i Gt(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+  static AVX2_INLINE __m256i Eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+  static AVX2_INLINE uint32_t MoveMask(__m256i m) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(m));
+  }
+};
+
+template<>
+struct Avx2IntWidth<8> {
+  typedef int64_t signed_type;
+  static AVX2_INLINE __m256i Broadcast(signed_type v) { return _mm256_set1_epi64x(v); }
+  static AVX2_INLINE __m256i Gt(__m256i a, __m256i b) { return _mm256_cmpgt_epi64(a, b); }
+  static AVX2_INLINE __m256i Eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi64(a, b); }
+  static AVX2_INLINE uint32_t MoveMask(__m256i m) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(m));
+  }
+};
+
+// AVX2 only compares signed integers, so unsigned integers are compared after
+// flipping their sign bit, which preserves their order.
+template<typename CppType>
+struct Avx2IntOps {
+  typedef Avx2IntWidth<sizeof(CppType)> W;
+  typedef typename W::signed_type signed_type;
+  typedef CppType cpp_type;
+  typedef __m256i vec;
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = sizeof(vec) / sizeof(CppType);
+
+  static AVX2_INLINE signed_type Bias() {
+    return std::is_signed<CppType>::value ? 0 : std::numeric_limits<signed_type>::min();
+  }
+  static AVX2_INLINE vec Load(const cpp_type* p) {
+    vec v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return std::is_signed<CppType>::value ? v : _mm256_xor_si256(v, W::Broadcast(Bias()));
+  }
+  static AVX2_INLINE vec Broadcast(cpp_type v) {
+    return W::Broadcast(static_cast<signed_type>(static_cast<signed_type>(v) ^ Bias()));
+  }
+  static AVX2_INLINE vec Lt(vec a, vec b) { return W::Gt(b, a); }
+  static AVX2_INLINE vec Eq(vec a, vec b) { return W::Eq(a, b); }
+  static AVX2_INLINE vec And(vec a, vec b) { return _mm256_and_si256(a, b); }
+  static AVX2_INLINE vec AndNot(vec a, vec b) { return _mm256_andnot_si256(a, b); }
+  static AVX2_INLINE vec Or(vec a, vec b) { return _mm256_or_si256(a, b); }
+  static AVX2_INLINE vec Not(vec a) { return _mm256_xor_si256(a, _mm256_set1_epi32(-1)); }
+  static AVX2_INLINE uint32_t MoveMask(vec m) { return W::MoveMask(m); }
+};
+
+template<> struct Avx2Ops<INT8> : public Avx2IntOps<int8_t> {};
+template<> struct Avx2Ops<INT16> : public Avx2IntOps<int16_t> {};
+template<> struct Avx2Ops<INT32> : public Avx2IntOps<int32_t> {};
+template<> struct Avx2Ops<INT64> : public Avx2IntOps<int64_t> {};
+template<> struct Avx2Ops<UINT8> : public Avx2IntOps<uint8_t> {};
+template<> struct Avx2Ops<UINT16> : public Avx2IntOps<uint16_t> {};
+template<> struct Avx2Ops<UINT32> : public Avx2IntOps<uint32_t> {};
+template<> struct Avx2Ops<UINT64> : public Avx2IntOps<uint64_t> {};
+
+// Ordered comparisons are false if either side is NaN, and unordered ones are
+// true, which matches the results of DataTypeTraits::Compare().
+template<>
+struct Avx2Ops<FLOAT> {
+  typedef float cpp_type;
+  typedef __m256 vec;
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 8;
+
+  static AVX2_INLINE vec Load(const cpp_type* p) { return _mm256_loadu_ps(p); }
+  static AVX2_INLINE vec Broadcast(cpp_type v) { return _mm256_set1_ps(v); }
+  static AVX2_INLINE vec Lt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static AVX2_INLINE vec Eq(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_UQ); }
+  static AVX2_INLINE vec And(vec a, vec b) { return _mm256_and_ps(a, b); }
+  static AVX2_INLINE vec AndNot(vec a, vec b) { return _mm256_andnot_ps(a, b); }
+  static AVX2_INLINE vec Or(vec a, vec b) { return _mm256_or_ps(a, b); }
+  static AVX2_INLINE vec Not(vec a) {
+    return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+  }
+  static AVX2_INLINE uint32_t MoveMask(vec m) { return _mm256_movemask_ps(m); }
+};
+
+template<>
+struct Avx2Ops<DOUBLE> {
+  typedef double cpp_type;
+  typedef __m256d vec;
+  static constexpr bool kSupported = true;
+  static constexpr int kLanes = 4;
+
+  static AVX2_INLINE vec Load(const cpp_type* p) { return _mm256_loadu_pd(p); }
+  static AVX2_INLINE vec Broadcast(cpp_type v) { return _mm256_set1_pd(v); }
+  static AVX2_INLINE vec Lt(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static AVX2_INLINE vec Eq(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_EQ_UQ); }
+  static AVX2_INLINE vec And(vec a, vec b) { return _mm256_and_pd(a, b); }
+  static AVX2_INLINE vec AndNot(vec a, vec b) { return _mm256_andnot_pd(a, b); }
+  static AVX2_INLINE vec Or(vec a, vec b) { return _mm256_or_pd(a, b); }
+  static AVX2_INLINE vec Not(vec a) {
+    return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi32(-1)));
+  }
+  static AVX2_INLINE uint32_t MoveMask(vec m) { return _mm256_movemask_pd(m); }
+};
+
+// Vectorized predicates, constructed from the values of the predicate.
+template<typename Ops>
+struct Avx2LessThan {
+  typedef Ops ops;
+  AVX2_INLINE Avx2LessThan(const typename Ops::cpp_type* values, int /*num_values*/)
+      : upper(Ops::Broadcast(values[0])) {}
+  AVX2_INLINE typename Ops::vec operator()(typename Ops::vec cells) const {
+    return Ops::Lt(cells, upper);
+  }
+  const typename Ops::vec upper;
+};
+
+template<typename Ops>
+struct Avx2AtLeast {
+  typedef Ops ops;
+  AVX2_INLINE Avx2AtLeast(const typename Ops::cpp_type* values, int /*num_values*/)
+      : lower(Ops::Broadcast(values[0])) {}
+  AVX2_INLINE typename Ops::vec operator()(typename Ops::vec cells) const {
+    return Ops::Not(Ops::Lt(cells, lower));
+  }
+  const typename Ops::vec lower;
+};
+
+template<typename Ops>
+struct Avx2Range {
+  typedef Ops ops;
+  AVX2_INLINE Avx2Range(const typename Ops::cpp_type* values, int /*num_values*/)
+      : lower(Ops::Broadcast(values[0])),
+        upper(Ops::Broadcast(values[1])) {}
+  AVX2_INLINE typename Ops::vec operator()(typename Ops::vec cells) const {
+    return Ops::AndNot(Ops::Lt(cells, lower), Ops::Lt(cells, upper));
+  }
+  const typename Ops::vec lower;
+  const typename Ops::vec upper;
+};
+
+template<typename Ops>
+struct Avx2InList {
+  typedef Ops ops;
+  AVX2_INLINE Avx2InList(const typename Ops::cpp_type* values, int num_values)
+      : num_values(num_values) {
+    DCHECK_LE(num_values, kMaxAvx2InListSize);
+    for (int i = 0; i < num_values; i++) {
+      this->values[i] = Ops::Broadcast(values[i]);
+    }
+  }
+  AVX2_INLINE typename Ops::vec operator()(typename Ops::vec cells) const {
+    typename Ops::vec match = Ops::Eq(cells, values[0]);
+    for (int i = 1; i < num_values; i++) {
+      match = Ops::Or(match, Ops::Eq(cells, values[i]));
+    }
+    return match;
+  }
+  const int num_values;
+  typename Ops::vec values[kMaxAvx2InListSize];
+};
+
+#undef AVX2_INLINE
+
+// Evaluates the predicate 'Pred', constructed from 'values', on the leading
+// rows of 'data', ANDing the results into 'sel_bitmap'. Returns the number of
+// rows evaluated, which is 'nrows' rounded down to a multiple of
+// kAvx2RowsPerIteration.
+template<typename Pred>
+__attribute__((target("avx2")))
+ATTRIBUTE_NOINLINE
+int ApplyPredicateAvx2Impl(const typename Pred::ops::cpp_type* __restrict__ data,
+                           int nrows,
+                           const typename Pred::ops::cpp_type* values,
+                           int num_values,
+                           uint8_t* __restrict__ sel_bitmap) {
+  typedef typename Pred::ops Ops;
+  static_assert(kAvx2RowsPerIteration % Ops::kLanes == 0,
+                "rows per iteration must be a multiple of the lanes per vector");
+  const Pred pred(values, num_values);
+  const int n_iters = nrows / kAvx2RowsPerIteration;
+  for (int i = 0; i < n_iters; i++) {
+    uint32_t res_32 = 0;
+    for (int j = 0; j < kAvx2RowsPerIteration / Ops::kLanes; j++) {
+      res_32 |= Ops::MoveMask(pred(Ops::Load(data))) << (j * Ops::kLanes);
+      data += Ops::kLanes;
+    }
+    // The selection vector is little-endian: row k is bit k % 8 of byte k / 8.
+    uint32_t sel_32 = UnalignedLoad<uint32_t>(sel_bitmap);
+    UnalignedStore<uint32_t>(sel_bitmap, sel_32 & res_32);
+    sel_bitmap += sizeof(uint32_t);
+  }
+  return n_iters * kAvx2RowsPerIteration;
+}
+
+#endif // KUDU_COLUMN_PREDICATE_AVX2
+
+// Evaluates a Range, Equality or InList predicate on the leading rows of
+// 'block' through an AVX2 kernel, if one is available for the predicate and
+// the CPU supports AVX2. Returns the number of rows evaluated, which is a
+// multiple of 8; like ApplyPredicatePrimitive(), nulls are not masked out.
+template<DataType PhysicalType>
+int ApplyPredicateAvx2(const ColumnBlock& block,
+                       PredicateType predicate_type,
+                       const void* lower,
+                       const void* upper,
+                       const vector<const void*>& values,
+                       uint8_t* sel_bitmap,
+                       std::true_type /* supported */) {
+#ifdef KUDU_COLUMN_PREDICATE_AVX2
+  typedef Avx2Ops<PhysicalType> Ops;
+  typedef typename Ops::cpp_type cpp_type;
+  if (!kHasAvx2 || FLAGS_disable_column_predicate_avx2) {
+    return 0;
+  }
+  const cpp_type* data = reinterpret_cast<const cpp_type*>(block.data());
+  const int nrows = block.nrows();
+  cpp_type args[kMaxAvx2InListSize];
+  switch (predicate_type) {
+    case PredicateType::Range:
+      if (lower == nullptr) {
+        args[0] = *static_cast<const cpp_type*>(upper);
+        return ApplyPredicateAvx2Impl<Avx2LessThan<Ops>>(data, nrows, args, 1, sel_bitmap);
+      }
+      args[0] = *static_cast<const cpp_type*>(lower);
+      if (upper == nullptr) {
+        return ApplyPredicateAvx2Impl<Avx2AtLeast<Ops>>(data, nrows, args, 1, sel_bitmap);
+      }
+      args[1] = *static_cast<const cpp_type*>(upper);
+      return ApplyPredicateAvx2Impl<Avx2Range<Ops>>(data, nrows, args, 2, sel_bitmap);
+    case PredicateType::Equality:
+      args[0] = *static_cast<const cpp_type*>(lower);
+      return ApplyPredicateAvx2Impl<Avx2InList<Ops>>(data, nrows, args, 1, sel_bitmap);
+    case PredicateType::InList:
+      if (values.empty() || values.size() > kMaxAvx2InListSize) {
+        return 0;
+      }
+      for (size_t i = 0; i < values.size(); i++) {
+        args[i] = *static_cast<const cpp_type*>(values[i]);
+      }
+      return ApplyPredicateAvx2Impl<Avx2InList<Ops>>(
+          data, nrows, args, values.size(), sel_bitmap);
+    default:
+      return 0;
+  }
+#else
+  return 0;
+#endif
+}
+
+template<DataType PhysicalType>
+int ApplyPredicateAvx2(const ColumnBlock& /*block*/,
+                       PredicateType /*predicate_type*/,
+                       const void* /*lower*/,
+                       const void* /*upper*/,
+                       const vector<const void*>& /*values*/,
+                       uint8_t* /*sel_bitmap*/,
+                       std::false_type /* supported */) {
+  return 0;
+}
+
 } // anonymous namespace
 
 template <DataType PhysicalType>
@@ -735,6 +1085,12 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
   using traits = DataTypeTraits<PhysicalType>;
   using cpp_type = typename traits::cpp_type;
 
+  // Evaluate what we can through the AVX2 kernels first, leaving the remaining
+  // rows and the null bitmap to the generic implementation.
+  const int start_idx = ApplyPredicateAvx2<PhysicalType>(
+      block, predicate_type(), lower_, upper_, values_, sel->mutable_bitmap(),
+      std::integral_constant<bool, Avx2Ops<PhysicalType>::kSupported>());
+
   switch (predicate_type()) {
     case PredicateType::Range: {
       cpp_type local_lower = lower_ ? *static_cast<const cpp_type*>(lower_) : cpp_type();
@@ -743,16 +1099,16 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       if (lower_ == nullptr) {
         ApplyPredicate<PhysicalType>(block, sel, [local_upper] (const void* cell) {
             return traits::Compare(cell, &local_upper) < 0;
-        });
+        }, start_idx);
       } else if (upper_ == nullptr) {
         ApplyPredicate<PhysicalType>(block, sel, [local_lower] (const void* cell) {
             return traits::Compare(cell, &local_lower) >= 0;
-        });
+        }, start_idx);
       } else {
         ApplyPredicate<PhysicalType>(block, sel, [local_lower, local_upper] (const void* cell) {
             return traits::Compare(cell, &local_upper) < 0 &&
                    traits::Compare(cell, &local_lower) >= 0;
-        });
+        }, start_idx);
       }
       return;
     };
@@ -760,7 +1116,7 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
       cpp_type local_lower = lower_ ? *static_cast<const cpp_type*>(lower_) : cpp_type();
       ApplyPredicate<PhysicalType>(block, sel, [local_lower] (const void* cell) {
             return traits::Compare(cell, &local_lower) == 0;
-      });
+      }, start_idx);
       return;
     };
     case PredicateType::IsNotNull: {
@@ -782,7 +1138,7 @@ void ColumnPredicate::EvaluateForPhysicalType(const ColumnBlock& block,
                                   [] (const void* lhs, const void* rhs) {
                                     return traits::Compare(lhs, rhs) < 0;
                                   });
-      });
+      }, start_idx);
       return;
     };
     case PredicateType::None: LOG(FATAL) << "NONE predicate evaluation";
@@ -937,6 +1293,36 @@ bool ColumnPredicate::CheckValueInBloomFilter(const void* value) const {
   return EvaluateCell(column_.type_info()->physical_type(), value);
 }
 
+bool ColumnPredicate::MayMatchRange(const void* min, const void* max) const {
+  const TypeInfo* type_info = column_.type_info();
+  switch (predicate_type_) {
+    case PredicateType::None:
+    case PredicateType::IsNull:
+      return false;
+    case PredicateType::IsNotNull:
+      return true;
+    case PredicateType::Equality:
+      return type_info->Compare(lower_, min) >= 0 && type_info->Compare(lower_, max) <= 0;
+    case PredicateType::Range:
+    case PredicateType::InBloomFilter:
+      // Bloom filter predicates may carry optional range bounds; the filters
+      // themselves cannot be checked against a range of values.
+      return (lower_ == nullptr || type_info->Compare(lower_, max) <= 0) &&
+             (upper_ == nullptr || type_info->Compare(upper_, min) > 0);
+    case PredicateType::InList: {
+      // Find the first value in the (sorted) list which is not less than 'min',
+      // and check whether it is also within the upper end of the range.
+      auto it = std::lower_bound(values_.begin(), values_.end(), min,
+                                 [type_info](const void* lhs, const void* rhs) {
+                                   return type_info->Compare(lhs, rhs) < 0;
+                                 });
+      return it != values_.end() && type_info->Compare(*it, max) <= 0;
+    }
+  }
+  LOG(FATAL) << "unknown predicate type";
+  return true;
+}
+
 namespace {
 int SelectivityRank(const ColumnPredicate& predicate) {
   int rank;
@@ -225,6 +225,15 @@ class ColumnPredicate {
   // Otherwise, use EvaluateCell<DataType>.
   bool EvaluateCell(DataType type, const void* cell) const;
 
+  // Returns false if no non-null value within the inclusive range [min, max]
+  // can satisfy the predicate, and true otherwise. Null handling is left to
+  // the caller: IS NULL predicates always return false here, since the range
+  // only describes non-null values.
+  //
+  // This is conservative: a return value of true does not guarantee that any
+  // value in the range matches.
+  bool MayMatchRange(const void* min, const void* max) const;
+
   // Print the predicate for debugging.
   std::string ToString() const;
 
@@ -0,0 +1,299 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/common/row_aggregator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/common.pb.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+using std::map;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+
+class RowAggregatorTest : public KuduTest {
+ protected:
+  RowAggregatorTest()
+      : schema_({ ColumnSchema("key", INT32),
+                  ColumnSchema("grp", STRING, true),
+                  ColumnSchema("val", INT64, true),
+                  ColumnSchema("d", DOUBLE) }, 1),
+        arena_(1024),
+        group_names_({ "a", "b", "c" }) {
+  }
+
+  // Fills 'block' with rows [offset, offset + block->nrows()). Row i is in
+  // group i % 4, where group 3 is NULL, has 'val' equal to i (NULL for every
+  // fifth row) and 'd' equal to i / 2. Every seventh row is deselected.
+  void FillBlock(int offset, RowBlock* block) {
+    ColumnBlock key_col = block->column_block(0);
+    ColumnBlock grp_col = block->column_block(1);
+    ColumnBlock val_col = block->column_block(2);
+    ColumnBlock d_col = block->column_block(3);
+    for (int r = 0; r < block->nrows(); r++) {
+      int32_t i = offset + r;
+      key_col.SetCellValue(r, &i);
+
+      int grp = i % 4;
+      grp_col.SetCellIsNull(r, grp == 3);
+      if (grp != 3) {
+        Slice s(group_names_[grp]);
+        grp_col.SetCellValue(r, &s);
+      }
+
+      int64_t val = i;
+      val_col.SetCellIsNull(r, i % 5 == 0);
+      val_col.SetCellValue(r, &val);
+
+      double d = i / 2.0;
+      d_col.SetCellValue(r, &d);
+
+      block->selection_vector()->SetRowSelected(r);
+      if (i % 7 == 0) {
+        block->selection_vector()->SetRowUnselected(r);
+      }
+    }
+  }
+
+  static AggregateSpecPB MakeSpec() {
+    AggregateSpecPB spec;
+    auto add = [&](AggregateSpecPB::AggregateFunction f, const char* col) {
+      auto* agg = spec.add_aggregates();
+      agg->set_function(f);
+      if (col) {
+        agg->set_column(col);
+      }
+    };
+    add(AggregateSpecPB::COUNT, nullptr);
+    add(AggregateSpecPB::COUNT, "val");
+    add(AggregateSpecPB::SUM, "val");
+    add(AggregateSpecPB::MIN, "val");
+    add(AggregateSpecPB::MAX, "val");
+    add(AggregateSpecPB::SUM, "d");
+    add(AggregateSpecPB::MAX, "grp");
+    return spec;
+  }
+
+  // Aggregates rows [start, end) into 'aggregator', in blocks of 100 rows.
+  void AggregateRows(int start, int end, RowAggregator* aggregator) {
+    for (int offset = start; offset < end; offset += 100) {
+      RowBlock block(&schema_, std::min(100, end - offset), &arena_);
+      FillBlock(offset, &block);
+      aggregator->AddRowBlock(block);
+    }
+  }
+
+  // Computes the expected results for rows [0, num_rows), keyed by group.
+  struct Expected {
+    int64_t count = 0;
+    int64_t val_count = 0;
+    int64_t val_sum = 0;
+    int64_t val_min = INT64_MAX;
+    int64_t val_max = INT64_MIN;
+    double d_sum = 0;
+  };
+  static map<int, Expected> ComputeExpected(int num_rows, bool grouped) {
+    map<int, Expected> expected;
+    for (int i = 0; i < num_rows; i++) {
+      if (i % 7 == 0) continue;
+      Expected& e = expected[grouped ? i % 4 : 0];
+      e.count++;
+      e.d_sum += i / 2.0;
+      if (i % 5 == 0) continue;
+      e.val_count++;
+      e.val_sum += i;
+      e.val_min = std::min<int64_t>(e.val_min, i);
+      e.val_max = std::max<int64_t>(e.val_max, i);
+    }
+    return expected;
+  }
+
+  static int64_t DecodeInt64(const AggregateResultPB::ValuePB& value) {
+    CHECK_EQ(sizeof(int64_t), value.cell().size());
+    int64_t ret;
+    memcpy(&ret, value.cell().data(), sizeof(ret));
+    return ret;
+  }
+
+  void VerifyGroup(const Expected& e, const AggregateResultPB::GroupPB& group) {
+    ASSERT_EQ(7, group.aggregate_values_size());
+    EXPECT_EQ(e.count, group.aggregate_values(0).int_value());
+    EXPECT_EQ(e.val_count, group.aggregate_values(1).int_value());
+    EXPECT_EQ(e.val_sum, group.aggregate_values(2).int_value());
+    EXPECT_EQ(e.val_min, DecodeInt64(group.aggregate_values(3)));
+    EXPECT_EQ(e.val_max, DecodeInt64(group.aggregate_values(4)));
+    EXPECT_DOUBLE_EQ(e.d_sum, group.aggregate_values(5).double_value());
+  }
+
+  // Returns the index of the group-by value of 'group' in 'group_names_', or
+  // 3 if it is NULL.
+  int GroupIndex(const AggregateResultPB::GroupPB& group) {
+    CHECK_EQ(1, group.group_by_values_size());
+    if (!group.group_by_values(0).has_cell()) {
+      return 3;
+    }
+    for (int i = 0; i < group_names_.size(); i++) {
+      if (group.group_by_values(0).cell() == group_names_[i]) {
+        return i;
+      }
+    }
+    LOG(FATAL) << "unexpected group: " << group.group_by_values(0).cell();
+  }
+
+  void VerifyGroupedResult(int num_rows, const AggregateResultPB& pb) {
+    auto expected = ComputeExpected(num_rows, /*grouped=*/true);
+    ASSERT_EQ(expected.size(), pb.groups_size());
+    for (const auto& group : pb.groups()) {
+      int idx = GroupIndex(group);
+      SCOPED_TRACE(idx);
+      NO_FATALS(VerifyGroup(expected[idx], group));
+      // MAX(grp) is the group's own value, or NULL for the NULL group.
+      if (idx == 3) {
+        EXPECT_FALSE(group.aggregate_values(6).has_cell());
+      } else {
+        EXPECT_EQ(group_names_[idx], group.aggregate_values(6).cell());
+      }
+    }
+  }
+
+  const Schema schema_;
+  Arena arena_;
+  const vector<string> group_names_;
+};
+
+TEST_F(RowAggregatorTest, TestUngrouped) {
+  const int kNumRows = 1000;
+  unique_ptr<RowAggregator> aggregator;
+  ASSERT_OK(RowAggregator::Create(MakeSpec(), schema_, &aggregator));
+  NO_FATALS(AggregateRows(0, kNumRows, aggregator.get()));
+  ASSERT_EQ(1, aggregator->num_groups());
+
+  AggregateResultPB pb;
+  aggregator->ToPB(&pb);
+  ASSERT_EQ(1, pb.groups_size());
+  ASSERT_EQ(0, pb.groups(0).group_by_values_size());
+  NO_FATALS(VerifyGroup(ComputeExpected(kNumRows, /*grouped=*/false)[0], pb.groups(0)));
+  EXPECT_EQ("c", pb.groups(0).aggregate_values(6).cell());
+
+  aggregator->Clear();
+  ASSERT_EQ(0, aggregator->num_groups());
+  ASSERT_EQ(0, aggregator->EstimatedResultSize());
+}
+
+TEST_F(RowAggregatorTest, TestGrouped) {
+  const int kNumRows = 1000;
+  AggregateSpecPB spec = MakeSpec();
+  spec.add_group_by_columns("grp");
+  unique_ptr<RowAggregator> aggregator;
+  ASSERT_OK(RowAggregator::Create(spec, schema_, &aggregator));
+  NO_FATALS(AggregateRows(0, kNumRows, aggregator.get()));
+  ASSERT_EQ(4, aggregator->num_groups());
+
+  AggregateResultPB pb;
+  aggregator->ToPB(&pb);
+  NO_FATALS(VerifyGroupedResult(kNumRows, pb));
+}
+
+// Partial results produced over disjoint sets of rows should merge into the
+// same results as aggregating all of the rows at once.
+TEST_F(RowAggregatorTest, TestMerge) {
+  const int kNumRows = 1000;
+  AggregateSpecPB spec = MakeSpec();
+  spec.add_group_by_columns("grp");
+
+  unique_ptr<RowAggregator> merged;
+  ASSERT_OK(RowAggregator::Create(spec, schema_, &merged));
+  for (int start = 0; start < kNumRows; start += 300) {
+    unique_ptr<RowAggregator> partial;
+    ASSERT_OK(RowAggregator::Create(spec, schema_, &partial));
+    NO_FATALS(AggregateRows(start, std::min(start + 300, kNumRows), partial.get()));
+    AggregateResultPB pb;
+    partial->ToPB(&pb);
+    ASSERT_OK(merged->MergeFromPB(pb));
+  }
+
+  AggregateResultPB pb;
+  merged->ToPB(&pb);
+  NO_FATALS(VerifyGroupedResult(kNumRows, pb));
+
+  // Results which don't match the spec are rejected.
+  AggregateResultPB bad_pb;
+  bad_pb.add_groups()->add_group_by_values();
+  Status s = merged->MergeFromPB(bad_pb);
+  ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+}
+
+TEST_F(RowAggregatorTest, TestInvalidSpecs) {
+  unique_ptr<RowAggregator> aggregator;
+  {
+    AggregateSpecPB spec;
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    AggregateSpecPB spec;
+    auto* agg = spec.add_aggregates();
+    agg->set_function(AggregateSpecPB::SUM);
+    agg->set_column("grp");
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "SUM is not supported");
+  }
+  {
+    AggregateSpecPB spec;
+    spec.add_aggregates()->set_function(AggregateSpecPB::MIN);
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    AggregateSpecPB spec;
+    auto* agg = spec.add_aggregates();
+    agg->set_function(AggregateSpecPB::MAX);
+    agg->set_column("missing");
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+  {
+    AggregateSpecPB spec;
+    spec.add_aggregates()->set_function(AggregateSpecPB::COUNT);
+    spec.add_group_by_columns("missing");
+    Status s = RowAggregator::Create(spec, schema_, &aggregator);
+    ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  }
+}
+
+} // namespace kudu
@@ -0,0 +1,543 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/common/row_aggregator.h"
+
+#include <cstring>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/int128.h"
+#include "kudu/util/slice.h"
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+
+namespace {
+
+// The approximate serialized size of each aggregate value and group-by value,
+// used for EstimatedResultSize().
+constexpr size_t kValueOverhead = 16;
+
+bool IsSummable(DataType type) {
+  switch (type) {
+    case INT8:
+    case INT16:
+    case INT32:
+    case INT64:
+    case UINT8:
+    case UINT16:
+    case UINT32:
+    case UINT64:
+    case FLOAT:
+    case DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsFloatingPoint(DataType physical_type) {
+  return physical_type == FLOAT || physical_type == DOUBLE;
+}
+
+// Adds two int64 values, wrapping on overflow.
+int64_t WrappingAdd(int64_t a, int64_t b) {
+  return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+// Compares two MIN/MAX bounds of the given type, each in the encoding of
+// AggregateResultPB::ValuePB.
+int CompareBounds(const TypeInfo* type_info, const string& a, const string& b) {
+  if (type_info->physical_type() == BINARY) {
+    return Slice(a).compare(Slice(b));
+  }
+  // Copy the values to ensure they are suitably aligned.
+  int128_t a_val;
+  int128_t b_val;
+  DCHECK_EQ(type_info->size(), a.size());
+  DCHECK_EQ(type_info->size(), b.size());
+  memcpy(&a_val, a.data(), a.size());
+  memcpy(&b_val, b.data(), b.size());
+  return type_info->Compare(&a_val, &b_val);
+}
+
+} // anonymous namespace
+
+Status RowAggregator::Create(const AggregateSpecPB& spec,
+                             const Schema& schema,
+                             unique_ptr<RowAggregator>* aggregator) {
+  if (spec.aggregates().empty()) {
+    return Status::InvalidArgument("aggregation spec has no aggregates");
+  }
+
+  vector<Aggregate> aggregates;
+  for (const auto& agg_pb : spec.aggregates()) {
+    Aggregate agg;
+    agg.function = agg_pb.function();
+    agg.col_idx = -1;
+    agg.type_info = nullptr;
+    if (agg_pb.has_column()) {
+      agg.col_idx = schema.find_column(agg_pb.column());
+      if (agg.col_idx == Schema::kColumnNotFound) {
+        return Status::InvalidArgument(
+            "aggregated column not found in the projection", agg_pb.column());
+      }
+      agg.type_info = schema.column(agg.col_idx).type_info();
+    }
+    switch (agg.function) {
+      case AggregateSpecPB::COUNT:
+        break;
+      case AggregateSpecPB::SUM:
+        if (agg.type_info && !IsSummable(agg.type_info->type())) {
+          return Status::InvalidArgument(
+              Substitute("SUM is not supported for column $0 of type $1",
+                         agg_pb.column(), agg.type_info->name()));
+        }
+        FALLTHROUGH_INTENDED;
+      case AggregateSpecPB::MIN:
+      case AggregateSpecPB::MAX:
+        if (!agg.type_info) {
+          return Status::InvalidArgument(
+              Substitute("$0 requires a column",
+                         AggregateSpecPB::AggregateFunction_Name(agg.function)));
+        }
+        break;
+      default:
+        return Status::InvalidArgument("unknown aggregate function");
+    }
+    aggregates.emplace_back(agg);
+  }
+
+  vector<int> group_by_cols;
+  vector<const TypeInfo*> group_by_types;
+  for (const auto& col_name : spec.group_by_columns()) {
+    int col_idx = schema.find_column(col_name);
+    if (col_idx == Schema::kColumnNotFound) {
+      return Status::InvalidArgument("group-by column not found in the projection", col_name);
+    }
+    group_by_cols.emplace_back(col_idx);
+    group_by_types.emplace_back(schema.column(col_idx).type_info());
+  }
+
+  aggregator->reset(new RowAggregator(std::move(aggregates),
+                                      std::move(group_by_cols),
+                                      std::move(group_by_types)));
+  return Status::OK();
+}
+
+RowAggregator::RowAggregator(vector<Aggregate> aggregates,
+                             vector<int> group_by_cols,
+                             vector<const TypeInfo*> group_by_types)
+    : aggregates_(std::move(aggregates)),
+      group_by_cols_(std::move(group_by_cols)),
+      group_by_types_(std::move(group_by_types)),
+      result_size_(0) {
+}
+
+size_t RowAggregator::FindOrCreateGroup(const string& key) {
+  auto it = group_indexes_.find(key);
+  if (it != group_indexes_.end()) {
+    return it->second;
+  }
+  size_t idx = groups_.size();
+  group_indexes_.emplace(key, idx);
+  Group group;
+  group.key = key;
+  group.states.resize(aggregates_.size());
+  groups_.emplace_back(std::move(group));
+  result_size_ += key.size() + kValueOverhead * (aggregates_.size() + group_by_cols_.size());
+  return idx;
+}
+
+// Each group-by value is encoded as a byte which is zero for NULL, followed
+// for non-NULL values by the length of the value and the value itself. Keys
+// are never persisted, so the length is in host byte order.
+void RowAggregator::EncodeGroupKeyCell(const ColumnBlock& col, size_t row, string* key) {
+  if (col.is_nullable() && col.is_null(row)) {
+    key->push_back('\0');
+    return;
+  }
+  key->push_back('\1');
+  Slice value;
+  if (col.type_info()->physical_type() == BINARY) {
+    value = *reinterpret_cast<const Slice*>(col.cell_ptr(row));
+  } else {
+    value = Slice(col.cell_ptr(row), col.stride());
+  }
+  uint32_t len = value.size();
+  key->append(reinterpret_cast<const char*>(&len), sizeof(len));
+  key->append(reinterpret_cast<const char*>(value.data()), value.size());
+}
+
+Status RowAggregator::EncodeGroupKeyValue(const TypeInfo* type_info,
+                                          const AggregateResultPB::ValuePB& value,
+                                          string* key) const {
+  if (!value.has_cell()) {
+    key->push_back('\0');
+    return Status::OK();
+  }
+  const string& cell = value.cell();
+  if (type_info->physical_type() != BINARY && cell.size() != type_info->size()) {
+    return Status::Corruption(Substitute("invalid group-by value of size $0 for type $1",
+                                         cell.size(), type_info->name()));
+  }
+  key->push_back('\1');
+  uint32_t len = cell.size();
+  key->append(reinterpret_cast<const char*>(&len), sizeof(len));
+  key->append(cell);
+  return Status::OK();
+}
+
+void RowAggregator::AddRowBlock(const RowBlock& block) {
+  sel_rows_ = block.selection_vector()->GetSelectedRows().ToRowIndexes();
+  if (sel_rows_.empty()) {
+    return;
+  }
+  const size_t num_sel = sel_rows_.size();
+
+  // Resolve the group of each selected row.
+  if (group_by_cols_.empty()) {
+    sel_groups_.assign(num_sel, FindOrCreateGroup(""));
+  } else {
+    vector<ColumnBlock> group_by_blocks;
+    group_by_blocks.reserve(group_by_cols_.size());
+    for (int col_idx : group_by_cols_) {
+      group_by_blocks.emplace_back(block.column_block(col_idx));
+    }
+    sel_groups_.resize(num_sel);
+    string key;
+    for (size_t k = 0; k < num_sel; k++) {
+      key.clear();
+      for (const auto& col : group_by_blocks) {
+        EncodeGroupKeyCell(col, sel_rows_[k], &key);
+      }
+      sel_groups_[k] = FindOrCreateGroup(key);
+    }
+  }
+
+  for (size_t i = 0; i < aggregates_.size(); i++) {
+    const Aggregate& agg = aggregates_[i];
+    if (agg.col_idx < 0) {
+      CountColumn(i, nullptr);
+      continue;
+    }
+    ColumnBlock col = block.column_block(agg.col_idx);
+    if (agg.function == AggregateSpecPB::COUNT) {
+      CountColumn(i, &col);
+      continue;
+    }
+
+    const bool is_sum = agg.function == AggregateSpecPB::SUM;
+    switch (agg.type_info->physical_type()) {
+#define DISPATCH_NUMERIC(type)                                       \
+      case type:                                                     \
+        if (is_sum) {                                                \
+          SumColumn<DataTypeTraits<type>::cpp_type>(i, col);         \
+        } else {                                                     \
+          MinMaxColumn<DataTypeTraits<type>::cpp_type>(i, col);      \
+        }                                                            \
+        break;
+      DISPATCH_NUMERIC(INT8);
+      DISPATCH_NUMERIC(INT16);
+      DISPATCH_NUMERIC(INT32);
+      DISPATCH_NUMERIC(INT64);
+      DISPATCH_NUMERIC(UINT8);
+      DISPATCH_NUMERIC(UINT16);
+      DISPATCH_NUMERIC(UINT32);
+      DISPATCH_NUMERIC(UINT64);
+      DISPATCH_NUMERIC(FLOAT);
+      DISPATCH_NUMERIC(DOUBLE);
+#undef DISPATCH_NUMERIC
+      case BOOL:
+        DCHECK(!is_sum);
+        MinMaxColumn<bool>(i, col);
+        break;
+      case INT128:
+        DCHECK(!is_sum);
+        MinMaxColumn<int128_t>(i, col);
+        break;
+      case BINARY:
+        DCHECK(!is_sum);
+        MinMaxBinaryColumn(i, col);
+        break;
+      default:
+        LOG(FATAL) << "unexpected physical type: " << agg.type_info->physical_type();
+    }
+  }
+}
+
+void RowAggregator::CountColumn(size_t agg_idx, const ColumnBlock* col) {
+  const size_t num_sel = sel_rows_.size();
+  const bool skip_nulls = col && col->is_nullable();
+  if (group_by_cols_.empty()) {
+    int64_t count = num_sel;
+    if (skip_nulls) {
+      for (uint16_t row : sel_rows_) {
+        count -= col->is_null(row);
+      }
+    }
+    StateForSelectedRow(0, agg_idx)->count += count;
+    return;
+  }
+  for (size_t k = 0; k < num_sel; k++) {
+    if (skip_nulls && col->is_null(sel_rows_[k])) continue;
+    StateForSelectedRow(k, agg_idx)->count++;
+  }
+}
+
+template<typename CppType>
+void RowAggregator::SumColumn(size_t agg_idx, const ColumnBlock& col) {
+  const CppType* cells = reinterpret_cast<const CppType*>(col.data());
+  const size_t num_sel = sel_rows_.size();
+  const bool nullable = col.is_nullable();
+  const bool is_float = IsFloatingPoint(col.type_info()->physical_type());
+
+  if (group_by_cols_.empty()) {
+    // Accumulate the whole block locally, so the loop over the cells is as
+    // tight as possible.
+    int64_t int_sum = 0;
+    double double_sum = 0;
+    bool has_value = false;
+    for (uint16_t row : sel_rows_) {
+      if (nullable && col.is_null(row)) continue;
+      if (is_float) {
+        double_sum += cells[row];
+      } else {
+        int_sum = WrappingAdd(int_sum, static_cast<int64_t>(cells[row]));
+      }
+      has_value = true;
+    }
+    if (has_value) {
+      AggregateState* state = StateForSelectedRow(0, agg_idx);
+      state->int_sum = WrappingAdd(state->int_sum, int_sum);
+      state->double_sum += double_sum;
+      state->has_value = true;
+    }
+    return;
+  }
+
+  for (size_t k = 0; k < num_sel; k++) {
+    uint16_t row = sel_rows_[k];
+    if (nullable && col.is_null(row)) continue;
+    AggregateState* state = StateForSelectedRow(k, agg_idx);
+    if (is_float) {
+      state->double_sum += cells[row];
+    } else {
+      state->int_sum = WrappingAdd(state->int_sum, static_cast<int64_t>(cells[row]));
+    }
+    state->has_value = true;
+  }
+}
+
+template<typename CppType>
+void RowAggregator::MinMaxColumn(size_t agg_idx, const ColumnBlock& col) {
+  const CppType* cells = reinterpret_cast<const CppType*>(col.data());
+  const size_t num_sel = sel_rows_.size();
+  const bool nullable = col.is_nullable();
+  const bool is_min = aggregates_[agg_idx].function == AggregateSpecPB::MIN;
+
+  // Folds 'value' into 'state', which stores its bound as raw bytes.
+  auto update = [is_min](const CppType& value, AggregateState* state) {
+    if (state->has_value) {
+      CppType bound;
+      memcpy(&bound, state->bound.data(), sizeof(bound));
+      if (is_min ? !(value < bound) : !(bound < value)) {
+        return;
+      }
+    }
+    state->bound.assign(reinterpret_cast<const char*>(&value), sizeof(value));
+    state->has_value = true;
+  };
+
+  if (group_by_cols_.empty()) {
+    bool has_value = false;
+    CppType local_bound = CppType();
+    for (uint16_t row : sel_rows_) {
+      if (nullable && col.is_null(row)) continue;
+      const CppType& value = cells[row];
+      if (!has_value || (is_min ? value < local_bound : local_bound < value)) {
+        local_bound = value;
+        has_value = true;
+      }
+    }
+    if (has_value) {
+      update(local_bound, StateForSelectedRow(0, agg_idx));
+    }
+    return;
+  }
+
+  for (size_t k = 0; k < num_sel; k++) {
+    uint16_t row = sel_rows_[k];
+    if (nullable && col.is_null(row)) continue;
+    update(cells[row], StateForSelectedRow(k, agg_idx));
+  }
+}
+
+void RowAggregator::MinMaxBinaryColumn(size_t agg_idx, const ColumnBlock& col) {
+  const Slice* cells = reinterpret_cast<const Slice*>(col.data());
+  const size_t num_sel = sel_rows_.size();
+  const bool nullable = col.is_nullable();
+  const bool is_min = aggregates_[agg_idx].function == AggregateSpecPB::MIN;
+  for (size_t k = 0; k < num_sel; k++) {
+    uint16_t row = sel_rows_[k];
+    if (nullable && col.is_null(row)) continue;
+    const Slice& value = cells[row];
+    AggregateState* state = StateForSelectedRow(k, agg_idx);
+    if (state->has_value) {
+      int cmp = value.compare(Slice(state->bound));
+      if (is_min ? cmp >= 0 : cmp <= 0) {
+        continue;
+      }
+      result_size_ -= state->bound.size();
+    }
+    state->bound = value.ToString();
+    state->has_value = true;
+    result_size_ += state->bound.size();
+  }
+}
+
+Status RowAggregator::MergeValue(const Aggregate& agg,
+                                 const AggregateResultPB::ValuePB& value,
+                                 AggregateState* state) {
+  switch (agg.function) {
+    case AggregateSpecPB::COUNT:
+      state->count += value.int_value();
+      return Status::OK();
+    case AggregateSpecPB::SUM:
+      if (value.has_int_value()) {
+        state->int_sum = WrappingAdd(state->int_sum, value.int_value());
+        state->has_value = true;
+      } else if (value.has_double_value()) {
+        state->double_sum += value.double_value();
+        state->has_value = true;
+      }
+      return Status::OK();
+    case AggregateSpecPB::MIN:
+    case AggregateSpecPB::MAX: {
+      if (!value.has_cell()) {
+        return Status::OK();
+      }
+      const string& cell = value.cell();
+      if (agg.type_info->physical_type() != BINARY && cell.size() != agg.type_info->size()) {
+        return Status::Corruption(Substitute("invalid $0 value of size $1 for type $2",
+                                             AggregateSpecPB::AggregateFunction_Name(agg.function),
+                                             cell.size(), agg.type_info->name()));
+      }
+      if (state->has_value) {
+        int cmp = CompareBounds(agg.type_info, cell, state->bound);
+        if (agg.function == AggregateSpecPB::MIN ? cmp >= 0 : cmp <= 0) {
+          return Status::OK();
+        }
+        result_size_ -= state->bound.size();
+      }
+      state->bound = cell;
+      state->has_value = true;
+      result_size_ += state->bound.size();
+      return Status::OK();
+    }
+    default:
+      LOG(FATAL) << "unexpected aggregate function: " << agg.function;
+  }
+  return Status::OK();
+}
+
+Status RowAggregator::MergeFromPB(const AggregateResultPB& pb) {
+  string key;
+  for (const auto& group_pb : pb.groups()) {
+    if (group_pb.group_by_values_size() != static_cast<int>(group_by_cols_.size()) ||
+        group_pb.aggregate_values_size() != static_cast<int>(aggregates_.size())) {
+      return Status::Corruption("aggregate result does not match the aggregation spec");
+    }
+    key.clear();
+    for (int i = 0; i < group_pb.group_by_values_size(); i++) {
+      RETURN_NOT_OK(EncodeGroupKeyValue(group_by_types_[i], group_pb.group_by_values(i), &key));
+    }
+    Group* group = &groups_[FindOrCreateGroup(key)];
+    for (int i = 0; i < group_pb.aggregate_values_size(); i++) {
+      RETURN_NOT_OK(MergeValue(aggregates_[i], group_pb.aggregate_values(i), &group->states[i]));
+    }
+  }
+  return Status::OK();
+}
+
+void RowAggregator::ToPB(AggregateResultPB* pb) const {
+  pb->Clear();
+  for (const auto& group : groups_) {
+    auto* group_pb = pb->add_groups();
+
+    // Decode the group-by values from the key.
+    const char* p = group.key.data();
+    for (size_t i = 0; i < group_by_cols_.size(); i++) {
+      auto* value_pb = group_pb->add_group_by_values();
+      if (*p++ == '\0') {
+        continue;
+      }
+      uint32_t len;
+      memcpy(&len, p, sizeof(len));
+      p += sizeof(len);
+      value_pb->set_cell(p, len);
+      p += len;
+    }
+    DCHECK_EQ(group.key.data() + group.key.size(), p);
+
+    for (size_t i = 0; i < aggregates_.size(); i++) {
+      const Aggregate& agg = aggregates_[i];
+      const AggregateState& state = group.states[i];
+      auto* value_pb = group_pb->add_aggregate_values();
+      switch (agg.function) {
+        case AggregateSpecPB::COUNT:
+          value_pb->set_int_value(state.count);
+          break;
+        case AggregateSpecPB::SUM:
+          if (!state.has_value) break;
+          if (IsFloatingPoint(agg.type_info->physical_type())) {
+            value_pb->set_double_value(state.double_sum);
+          } else {
+            value_pb->set_int_value(state.int_sum);
+          }
+          break;
+        case AggregateSpecPB::MIN:
+        case AggregateSpecPB::MAX:
+          if (state.has_value) {
+            value_pb->set_cell(state.bound);
+          }
+          break;
+        default:
+          LOG(FATAL) << "unexpected aggregate function: " << agg.function;
+      }
+    }
+  }
+}
+
+void RowAggregator::Clear() {
+  group_indexes_.clear();
+  groups_.clear();
+  result_size_ = 0;
+}
+
+} // namespace kudu
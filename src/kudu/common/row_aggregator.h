@@ -0,0 +1,155 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kudu/common/common.pb.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class ColumnBlock;
+class RowBlock;
+class Schema;
+class TypeInfo;
+
+// Evaluates the aggregations described by an AggregateSpecPB.
+//
+// On the tablet server, rows are fed in with AddRowBlock() and the partial
+// results are periodically drained into a scan response with ToPB() and
+// Clear(). On the client, the partial results from every response are folded
+// together with MergeFromPB().
+//
+// Row blocks are processed a column at a time: the group of each selected
+// row is resolved once per block, after which each aggregate makes a single
+// pass over its column.
+class RowAggregator {
+ public:
+  // Creates an aggregator for 'spec' over rows of 'schema'. Returns
+  // InvalidArgument if the spec refers to columns missing from 'schema', or
+  // applies an aggregate to a column of an unsupported type.
+  static Status Create(const AggregateSpecPB& spec,
+                       const Schema& schema,
+                       std::unique_ptr<RowAggregator>* aggregator);
+
+  // Aggregates the selected rows of 'block'. The leading columns of the
+  // block's schema must match the schema passed to Create().
+  void AddRowBlock(const RowBlock& block);
+
+  // Folds in partial results produced by another aggregator created from the
+  // same spec and schema. Returns Corruption if 'pb' is malformed.
+  Status MergeFromPB(const AggregateResultPB& pb);
+
+  // Writes the results aggregated so far into 'pb'.
+  void ToPB(AggregateResultPB* pb) const;
+
+  // Discards all results aggregated so far.
+  void Clear();
+
+  size_t num_groups() const {
+    return groups_.size();
+  }
+
+  // Returns the approximate size of the results, once serialized by ToPB().
+  size_t EstimatedResultSize() const {
+    return result_size_;
+  }
+
+ private:
+  struct Aggregate {
+    AggregateSpecPB::AggregateFunction function;
+    // The index of the aggregated column, or -1 for COUNT over all rows.
+    int col_idx;
+    const TypeInfo* type_info;
+  };
+
+  struct AggregateState {
+    int64_t count = 0;
+    int64_t int_sum = 0;
+    double double_sum = 0;
+    // Whether any non-null value has been aggregated into the SUM, MIN or MAX.
+    bool has_value = false;
+    // The current MIN or MAX, in the encoding of AggregateResultPB::ValuePB.
+    std::string bound;
+  };
+
+  struct Group {
+    // The values of the group-by columns, encoded as described in
+    // EncodeGroupKey().
+    std::string key;
+    std::vector<AggregateState> states;
+  };
+
+  RowAggregator(std::vector<Aggregate> aggregates,
+                std::vector<int> group_by_cols,
+                std::vector<const TypeInfo*> group_by_types);
+
+  // Returns the index of the group with the given key, creating it if needed.
+  size_t FindOrCreateGroup(const std::string& key);
+
+  // Appends the encoding of the group-by value for row 'row' of 'col' to 'key'.
+  static void EncodeGroupKeyCell(const ColumnBlock& col, size_t row, std::string* key);
+
+  // Appends the encoding of a group-by value from 'value' to 'key'.
+  Status EncodeGroupKeyValue(const TypeInfo* type_info,
+                             const AggregateResultPB::ValuePB& value,
+                             std::string* key) const;
+
+  // Aggregates the selected rows of 'col' into the states of aggregate
+  // 'agg_idx'. Each template handles a single family of aggregate functions.
+  template<typename CppType>
+  void SumColumn(size_t agg_idx, const ColumnBlock& col);
+  template<typename CppType>
+  void MinMaxColumn(size_t agg_idx, const ColumnBlock& col);
+  void MinMaxBinaryColumn(size_t agg_idx, const ColumnBlock& col);
+  void CountColumn(size_t agg_idx, const ColumnBlock* col);
+
+  // Returns the state of aggregate 'agg_idx' for the k-th selected row of the
+  // current block.
+  AggregateState* StateForSelectedRow(size_t k, size_t agg_idx) {
+    return &groups_[sel_groups_[k]].states[agg_idx];
+  }
+
+  // Folds 'value' into 'state', for aggregate 'agg'.
+  Status MergeValue(const Aggregate& agg,
+                    const AggregateResultPB::ValuePB& value,
+                    AggregateState* state);
+
+  const std::vector<Aggregate> aggregates_;
+  const std::vector<int> group_by_cols_;
+  const std::vector<const TypeInfo*> group_by_types_;
+
+  std::unordered_map<std::string, size_t> group_indexes_;
+  std::vector<Group> groups_;
+  size_t result_size_;
+
+  // Scratch space for AddRowBlock(): the indexes of the selected rows of the
+  // current block, and the group of each one.
+  std::vector<uint16_t> sel_rows_;
+  std::vector<size_t> sel_groups_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowAggregator);
+};
+
+} // namespace kudu
@@ -220,6 +220,14 @@ class SelectionVectorView {
     DCHECK_LE(offset + nrows, sel_vec_->nrows() - row_offset_);
     BitmapChangeBits(sel_vec_->mutable_bitmap(), row_offset_ + offset, nrows, false);
   }
+  // Returns true if any of "nrows" bits from the supplied "offset" in the
+  // current view are set.
+  bool AnyBitsSet(size_t nrows, size_t offset = 0) const {
+    DCHECK_LE(offset + nrows, sel_vec_->nrows() - row_offset_);
+    size_t idx;
+    return BitmapFindFirstSet(sel_vec_->bitmap(), row_offset_ + offset,
+                              row_offset_ + offset + nrows, &idx);
+  }
  private:
   SelectionVector* sel_vec_;
   size_t row_offset_;
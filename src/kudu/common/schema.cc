@@ -110,9 +110,12 @@ string ColumnTypeAttributes::ToStringForType(DataType type) const {
 string ColumnStorageAttributes::ToString() const {
   const string cfile_block_size_str =
       cfile_block_size == 0 ? "" : Substitute(" $0", cfile_block_size);
-  return Substitute("$0 $1$2",
+  const string compression_level_str =
+      compression_level == 0 ? "" : Substitute(" level $0", compression_level);
+  return Substitute("$0 $1$2$3",
                     EncodingType_Name(encoding),
                     CompressionType_Name(compression),
+                    compression_level_str,
                     cfile_block_size_str);
 }
 
@@ -145,11 +148,19 @@ Status ColumnSchema::ApplyDelta(const ColumnSchemaDelta& col_delta) {
     attributes_.encoding = *col_delta.encoding;
   }
   if (col_delta.compression) {
+    // A level only means something to the codec it was chosen for, so
+    // switching codecs without naming a new level reverts to the default.
+    if (*col_delta.compression != attributes_.compression && !col_delta.compression_level) {
+      attributes_.compression_level = 0;
+    }
     attributes_.compression = *col_delta.compression;
   }
   if (col_delta.cfile_block_size) {
     attributes_.cfile_block_size = *col_delta.cfile_block_size;
   }
+  if (col_delta.compression_level) {
+    attributes_.compression_level = *col_delta.compression_level;
+  }
   if (col_delta.new_comment) {
     comment_ = col_delta.new_comment.value();
   }
@@ -146,13 +146,15 @@ struct ColumnStorageAttributes {
   ColumnStorageAttributes()
     : encoding(AUTO_ENCODING),
       compression(DEFAULT_COMPRESSION),
-      cfile_block_size(0) {
+      cfile_block_size(0),
+      compression_level(0) {
   }
 
   ColumnStorageAttributes(EncodingType enc, CompressionType cmp)
     : encoding(enc),
       compression(cmp),
-      cfile_block_size(0) {
+      cfile_block_size(0),
+      compression_level(0) {
   }
 
   std::string ToString() const;
@@ -163,6 +165,10 @@ struct ColumnStorageAttributes {
   // The preferred block size for cfile blocks. If 0, uses the
   // server-wide default.
   int32_t cfile_block_size;
+
+  // The compression level, for codecs which support levels. If 0, uses the
+  // codec's default level.
+  int32_t compression_level;
 };
 
 // A struct representing changes to a ColumnSchema.
@@ -194,6 +200,7 @@ public:
   boost::optional<EncodingType> encoding;
   boost::optional<CompressionType> compression;
   boost::optional<int32_t> cfile_block_size;
+  boost::optional<int32_t> compression_level;
 
   boost::optional<std::string> new_comment;
 };
@@ -754,6 +754,28 @@ TEST_F(WireProtocolTest, TestColumnDefaultValue) {
   ASSERT_EQ(write_default_u32, *static_cast<const uint32_t *>(col5fpb->write_default_value()));
 }
 
+TEST_F(WireProtocolTest, TestColumnStorageAttributes) {
+  ColumnStorageAttributes attrs(BIT_SHUFFLE, ZSTD);
+  attrs.compression_level = 9;
+  ColumnSchema col("col", INT64, false, nullptr, nullptr, attrs);
+  ColumnSchemaPB pb;
+  ColumnSchemaToPB(col, &pb);
+  boost::optional<ColumnSchema> colfpb;
+  ASSERT_OK(ColumnSchemaFromPB(pb, &colfpb));
+  ASSERT_EQ(ZSTD, colfpb->attributes().compression);
+  ASSERT_EQ(9, colfpb->attributes().compression_level);
+
+  // The level may be changed by altering the column.
+  ColumnSchemaDelta delta("col");
+  delta.compression_level = 19;
+  ColumnSchemaDeltaPB delta_pb;
+  ColumnSchemaDeltaToPB(delta, &delta_pb);
+  ASSERT_OK(colfpb->ApplyDelta(ColumnSchemaDeltaFromPB(delta_pb)));
+  ASSERT_EQ(ZSTD, colfpb->attributes().compression);
+  ASSERT_EQ(19, colfpb->attributes().compression_level);
+  ASSERT_EQ("BIT_SHUFFLE ZSTD level 19", colfpb->attributes().ToString());
+}
+
 // Regression test for KUDU-2378; the call to ColumnSchemaFromPB yielded a crash.
 TEST_F(WireProtocolTest, TestCrashOnAlignedLoadOf128BitReadDefault) {
   ColumnSchemaPB pb;
@@ -56,6 +56,7 @@
 #include "kudu/util/pb_util.h"
 #include "kudu/util/safe_math.h"
 #include "kudu/util/slice.h"
+#include "kudu/util/string_case.h"
 
 namespace kudu {
 class BlockBloomFilterPB;
@@ -240,6 +241,9 @@ void ColumnSchemaToPB(const ColumnSchema& col_schema, ColumnSchemaPB *pb, int fl
     pb->set_encoding(col_schema.attributes().encoding);
     pb->set_compression(col_schema.attributes().compression);
     pb->set_cfile_block_size(col_schema.attributes().cfile_block_size);
+    if (col_schema.attributes().compression_level != 0) {
+      pb->set_compression_level(col_schema.attributes().compression_level);
+    }
   }
   if (col_schema.has_read_default()) {
     if (col_schema.type_info()->physical_type() == BINARY) {
@@ -321,6 +325,9 @@ Status ColumnSchemaFromPB(const ColumnSchemaPB& pb, boost::optional<ColumnSchema
   if (pb.has_cfile_block_size()) {
     attributes.cfile_block_size = pb.cfile_block_size();
   }
+  if (pb.has_compression_level()) {
+    attributes.compression_level = pb.compression_level();
+  }
 
   // According to the URL below, the default value for strings that are optional
   // in protobuf is the empty string. So, it's safe to use pb.comment() directly
@@ -354,6 +361,9 @@ void ColumnSchemaDeltaToPB(const ColumnSchemaDelta& col_delta, ColumnSchemaDelta
   if (col_delta.cfile_block_size) {
     pb->set_block_size(*col_delta.cfile_block_size);
   }
+  if (col_delta.compression_level) {
+    pb->set_compression_level(*col_delta.compression_level);
+  }
   if (col_delta.new_comment) {
     pb->set_new_comment(*col_delta.new_comment);
   }
@@ -379,6 +389,9 @@ ColumnSchemaDelta ColumnSchemaDeltaFromPB(const ColumnSchemaDeltaPB& pb) {
   if (pb.has_block_size()) {
     col_delta.cfile_block_size = boost::optional<int32_t>(pb.block_size());
   }
+  if (pb.has_compression_level()) {
+    col_delta.compression_level = boost::optional<int32_t>(pb.compression_level());
+  }
   if (pb.has_new_comment()) {
     col_delta.new_comment = boost::optional<string>(pb.new_comment());
   }
@@ -649,6 +662,11 @@ Status ColumnPredicateFromPB(const Schema& schema,
 
 const char kTableHistoryMaxAgeSec[] = "kudu.table.history_max_age_sec";
 const char kTableMaintenancePriority[] = "kudu.table.maintenance_priority";
+const char kTableCompactionPolicy[] = "kudu.table.compaction_policy";
+// The UNIXTIME_MICROS column which the TTL applies to. It may be nullable, but
+// rows with a null in it never expire. See TableExtraConfigPB::ttl_column.
+const char kTableTtlColumn[] = "kudu.table.ttl_column";
+const char kTableTtlSec[] = "kudu.table.ttl_sec";
 Status ExtraConfigPBToMap(const TableExtraConfigPB& pb, map<string, string>* configs) {
   Map<string, string> tmp;
   RETURN_NOT_OK(ExtraConfigPBToPBMap(pb, &tmp));
@@ -665,6 +683,19 @@ Status ParseInt32Config(const string& name, const string& value, int32_t* result
   return Status::OK();
 }
 
+static Status ParseCompactionPolicyConfig(const string& name,
+                                          const string& value,
+                                          TableExtraConfigPB::CompactionPolicy* result) {
+  CHECK(result);
+  string upper;
+  ToUpperCase(value, &upper);
+  if (!TableExtraConfigPB::CompactionPolicy_Parse(upper, result) ||
+      *result == TableExtraConfigPB::UNKNOWN_COMPACTION_POLICY) {
+    return Status::InvalidArgument(Substitute("unable to parse $0", name), value);
+  }
+  return Status::OK();
+}
+
 Status ExtraConfigPBFromPBMap(const Map<string, string>& configs, TableExtraConfigPB* pb) {
   TableExtraConfigPB result;
   for (const auto& config : configs) {
@@ -682,6 +713,25 @@ Status ExtraConfigPBFromPBMap(const Map<string, string>& configs, TableExtraConf
         RETURN_NOT_OK(ParseInt32Config(name, value, &maintenance_priority));
         result.set_maintenance_priority(maintenance_priority);
       }
+    } else if (name == kTableCompactionPolicy) {
+      if (!value.empty()) {
+        TableExtraConfigPB::CompactionPolicy policy;
+        RETURN_NOT_OK(ParseCompactionPolicyConfig(name, value, &policy));
+        result.set_compaction_policy(policy);
+      }
+    } else if (name == kTableTtlColumn) {
+      if (!value.empty()) {
+        result.set_ttl_column(value);
+      }
+    } else if (name == kTableTtlSec) {
+      if (!value.empty()) {
+        int32_t ttl_sec;
+        RETURN_NOT_OK(ParseInt32Config(name, value, &ttl_sec));
+        if (ttl_sec <= 0) {
+          return Status::InvalidArgument(Substitute("$0 must be positive", name), value);
+        }
+        result.set_ttl_sec(ttl_sec);
+      }
     } else {
       LOG(WARNING) << "Unknown extra configuration property: " << name;
     }
@@ -698,6 +748,17 @@ Status ExtraConfigPBToPBMap(const TableExtraConfigPB& pb, Map<string, string>* c
   if (pb.has_maintenance_priority()) {
     result[kTableMaintenancePriority] = std::to_string(pb.maintenance_priority());
   }
+  if (pb.has_compaction_policy()) {
+    string policy = TableExtraConfigPB::CompactionPolicy_Name(pb.compaction_policy());
+    ToLowerCase(&policy);
+    result[kTableCompactionPolicy] = std::move(policy);
+  }
+  if (pb.has_ttl_column()) {
+    result[kTableTtlColumn] = pb.ttl_column();
+  }
+  if (pb.has_ttl_sec()) {
+    result[kTableTtlSec] = std::to_string(pb.ttl_sec());
+  }
   *configs = std::move(result);
   return Status::OK();
 }
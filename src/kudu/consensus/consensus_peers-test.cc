@@ -17,11 +17,15 @@
 
 #include "kudu/consensus/consensus_peers.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -44,7 +48,9 @@
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/rpc/messenger.h"
+#include "kudu/rpc/response_callback.h"
 #include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/locks.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/status.h"
@@ -55,6 +61,9 @@
 METRIC_DECLARE_entity(tablet);
 METRIC_DECLARE_entity(server);
 
+DECLARE_int32(consensus_max_inflight_requests_per_peer);
+DECLARE_int32(raft_heartbeat_interval_ms);
+
 using kudu::log::Log;
 using kudu::log::LogOptions;
 using kudu::rpc::Messenger;
@@ -62,6 +71,7 @@ using kudu::rpc::MessengerBuilder;
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
+using std::vector;
 
 namespace kudu {
 namespace consensus {
@@ -366,6 +376,171 @@ TEST_F(ConsensusPeersTest, TestDontSendOneRpcPerWriteWhenPeerIsDown) {
   ASSERT_LT(mock_proxy->update_count(), 5);
 }
 
+// A proxy emulating a follower which lets the test decide when the requests
+// in flight get their responses, and which supports more than one request in
+// flight at a time.
+class PipelinedPeerProxy : public PeerProxy {
+ public:
+  PipelinedPeerProxy()
+      : last_received_(MinimumOpId()),
+        max_inflight_(0),
+        num_pipelined_(0) {
+  }
+
+  void UpdateAsync(const ConsensusRequestPB& request,
+                   ConsensusResponsePB* response,
+                   rpc::RpcController* /*controller*/,
+                   const rpc::ResponseCallback& callback) override {
+    std::lock_guard<simple_spinlock> l(lock_);
+    InflightRequest req;
+    req.preceding_id = request.preceding_id();
+    if (request.ops_size() > 0) {
+      req.last_id = request.ops(request.ops_size() - 1).id();
+    }
+    req.caller_term = request.caller_term();
+    req.response = response;
+    req.callback = callback;
+    inflight_.emplace_back(std::move(req));
+    max_inflight_ = std::max<int>(max_inflight_, inflight_.size());
+    if (request.pipelined()) {
+      num_pipelined_++;
+    }
+  }
+
+  void RequestConsensusVoteAsync(const VoteRequestPB& /*request*/,
+                                 VoteResponsePB* /*response*/,
+                                 rpc::RpcController* /*controller*/,
+                                 const rpc::ResponseCallback& callback) override {
+    callback();
+  }
+
+  void StartElectionAsync(const RunLeaderElectionRequestPB& /*request*/,
+                          RunLeaderElectionResponsePB* /*response*/,
+                          rpc::RpcController* /*controller*/,
+                          const rpc::ResponseCallback& callback) override {
+    callback();
+  }
+
+  string PeerName() const override {
+    return "PipelinedPeerProxy";
+  }
+
+  // Respond to all the requests in flight, in the order they were sent.
+  void RespondToAll() {
+    vector<InflightRequest> inflight;
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      inflight.swap(inflight_);
+      for (auto& req : inflight) {
+        ASSERT_OPID_EQ(last_received_, req.preceding_id);
+        if (req.last_id.IsInitialized()) {
+          last_received_ = req.last_id;
+        }
+        ConsensusStatusPB* status = req.response->mutable_status();
+        req.response->set_responder_uuid(kFollowerUuid);
+        req.response->set_responder_term(req.caller_term);
+        *status->mutable_last_received() = last_received_;
+        *status->mutable_last_received_current_leader() = last_received_;
+        status->set_last_committed_idx(last_received_.index());
+      }
+    }
+    for (auto& req : inflight) {
+      req.callback();
+    }
+  }
+
+  int num_inflight() const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    return inflight_.size();
+  }
+
+  int max_inflight() const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    return max_inflight_;
+  }
+
+  int num_pipelined() const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    return num_pipelined_;
+  }
+
+  OpId last_received() const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    return last_received_;
+  }
+
+ private:
+  struct InflightRequest {
+    OpId preceding_id;
+    OpId last_id;
+    int64_t caller_term;
+    ConsensusResponsePB* response;
+    rpc::ResponseCallback callback;
+  };
+
+  mutable simple_spinlock lock_;
+  vector<InflightRequest> inflight_;
+  OpId last_received_;
+  int max_inflight_;
+  int num_pipelined_;
+};
+
+// Test that a healthy follower gets up to
+// --consensus_max_inflight_requests_per_peer requests at a time, and that
+// the pipelined requests carry consecutive batches of ops.
+TEST_F(ConsensusPeersTest, TestPipelinedRequests) {
+  constexpr int kMaxInflight = 3;
+  FLAGS_consensus_max_inflight_requests_per_peer = kMaxInflight;
+  // Keep heartbeats from adding requests behind the test's back.
+  FLAGS_raft_heartbeat_interval_ms = 60 * 1000;
+
+  message_queue_->SetLeaderMode(kMinimumOpIdIndex,
+                                kMinimumTerm,
+                                BuildRaftConfigPBForTests(3));
+
+  auto proxy = new PipelinedPeerProxy();
+  shared_ptr<Peer> peer;
+  ASSERT_OK(Peer::NewRemotePeer(FakeRaftPeerPB(kFollowerUuid),
+                                kTabletId,
+                                kLeaderUuid,
+                                message_queue_.get(),
+                                raft_pool_token_.get(),
+                                unique_ptr<PeerProxy>(proxy),
+                                messenger_,
+                                &peer));
+
+  // The first exchange is a status-only request which is never pipelined.
+  ASSERT_OK(peer->SignalRequest(true));
+  ASSERT_EVENTUALLY([&]() {
+    ASSERT_EQ(1, proxy->num_inflight());
+  });
+  NO_FATALS(proxy->RespondToAll());
+
+  // Every op appended to the queue is sent right away in its own request,
+  // without waiting for the responses to the previous ones.
+  for (int i = 1; i <= kMaxInflight; i++) {
+    AppendReplicateMessagesToQueue(message_queue_.get(), clock_.get(), i, 1);
+    ASSERT_EVENTUALLY([&]() {
+      ASSERT_OK(peer->SignalRequest());
+      ASSERT_EQ(i, proxy->num_inflight());
+    });
+  }
+
+  // Once the window is full, no further request is sent.
+  AppendReplicateMessagesToQueue(message_queue_.get(), clock_.get(), kMaxInflight + 1, 1);
+  ASSERT_OK(peer->SignalRequest());
+  SleepFor(MonoDelta::FromMilliseconds(100));
+  ASSERT_EQ(kMaxInflight, proxy->num_inflight());
+
+  // Draining the window lets the remaining op through.
+  ASSERT_EVENTUALLY([&]() {
+    NO_FATALS(proxy->RespondToAll());
+    ASSERT_GE(message_queue_->GetCommittedIndex(), kMaxInflight + 1);
+  });
+  ASSERT_EQ(kMaxInflight + 1, proxy->last_received().index());
+  ASSERT_EQ(kMaxInflight, proxy->max_inflight());
+  ASSERT_GE(proxy->num_pipelined(), kMaxInflight - 1);
+}
+
 }  // namespace consensus
 }  // namespace kudu
-
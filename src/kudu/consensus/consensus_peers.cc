@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 
+#include <boost/optional/optional.hpp>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
@@ -36,6 +37,7 @@
 #include "kudu/consensus/consensus.proxy.h"
 #include "kudu/consensus/consensus_queue.h"
 #include "kudu/consensus/metadata.pb.h"
+#include "kudu/consensus/multi_raft_batcher.h"
 #include "kudu/consensus/opid_util.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
@@ -59,6 +61,14 @@ DEFINE_int32(consensus_rpc_timeout_ms, 30000,
              "Timeout used for all consensus internal RPC communications.");
 TAG_FLAG(consensus_rpc_timeout_ms, advanced);
 
+DEFINE_int32(consensus_max_inflight_requests_per_peer, 1,
+             "Maximum number of UpdateConsensus() requests a leader keeps in "
+             "flight to each follower. With a value greater than one, the leader "
+             "sends new batches of ops to a healthy follower without waiting for "
+             "the responses to earlier batches, hiding the network round trip "
+             "when replicating a heavy write load over a high-latency link.");
+TAG_FLAG(consensus_max_inflight_requests_per_peer, experimental);
+
 DEFINE_int32(raft_get_node_instance_timeout_ms, 30000,
              "Timeout for retrieving node instance data over RPC.");
 TAG_FLAG(raft_get_node_instance_timeout_ms, hidden);
@@ -82,6 +92,7 @@ DEFINE_bool(enable_tablet_copy, true,
             "replica. For testing purposes only.");
 TAG_FLAG(enable_tablet_copy, unsafe);
 
+DECLARE_bool(enable_multi_raft_heartbeat_batching);
 DECLARE_int32(raft_heartbeat_interval_ms);
 
 using kudu::pb_util::SecureShortDebugString;
@@ -110,7 +121,8 @@ Status Peer::NewRemotePeer(RaftPeerPB peer_pb,
                            ThreadPoolToken* raft_pool_token,
                            unique_ptr<PeerProxy> proxy,
                            shared_ptr<Messenger> messenger,
-                           shared_ptr<Peer>* peer) {
+                           shared_ptr<Peer>* peer,
+                           shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher) {
 
   auto new_peer(Peer::make_shared(
       std::move(peer_pb),
@@ -119,7 +131,8 @@ Status Peer::NewRemotePeer(RaftPeerPB peer_pb,
       queue,
       raft_pool_token,
       std::move(proxy),
-      std::move(messenger)));
+      std::move(messenger),
+      std::move(heartbeat_batcher)));
   RETURN_NOT_OK(new_peer->Init());
   *peer = std::move(new_peer);
   return Status::OK();
@@ -131,13 +144,19 @@ Peer::Peer(RaftPeerPB peer_pb,
            PeerMessageQueue* queue,
            ThreadPoolToken* raft_pool_token,
            unique_ptr<PeerProxy> proxy,
-           shared_ptr<Messenger> messenger)
+           shared_ptr<Messenger> messenger,
+           shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher)
     : tablet_id_(std::move(tablet_id)),
       leader_uuid_(std::move(leader_uuid)),
       peer_pb_(std::move(peer_pb)),
       proxy_(std::move(proxy)),
+      heartbeat_batcher_(std::move(heartbeat_batcher)),
       queue_(queue),
       failed_attempts_(0),
+      processing_response_(false),
+      last_sent_index_(kMinimumOpIdIndex),
+      last_sent_committed_index_(kMinimumOpIdIndex),
+      tc_pending_(false),
       messenger_(std::move(messenger)),
       raft_pool_token_(raft_pool_token),
       request_pending_(false),
@@ -176,9 +195,9 @@ Status Peer::SignalRequest(bool even_if_queue_empty) {
     return Status::IllegalState("Peer was closed.");
   }
 
-  // Only allow one request at a time. No sense waking up the
-  // raft thread pool if the task will just abort anyway.
-  if (request_pending_) {
+  // Only allow one request at a time, unless requests may be pipelined. No
+  // sense waking up the raft thread pool if the task will just abort anyway.
+  if (request_pending_ && FLAGS_consensus_max_inflight_requests_per_peer <= 1) {
     return Status::OK();
   }
 
@@ -198,9 +217,14 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
     return;
   }
 
-  // Only allow one request at a time.
+  // Only allow one request at a time, unless the next batch of ops may be
+  // pipelined behind the requests in flight.
+  boost::optional<int64_t> pipeline_after_index;
   if (request_pending_) {
-    return;
+    if (!CanPipelineUnlocked()) {
+      return;
+    }
+    pipeline_after_index = last_sent_index_;
   }
 
   // For the first request sent by the peer, we send it even if the queue is empty,
@@ -225,14 +249,17 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
     return;
   }
 
-  // The peer has no pending request nor is sending: send the request.
+  // The peer has no pending request nor is sending, or the request is
+  // pipelined: send the request.
+  auto req = std::make_shared<UpdateRequest>();
+  ConsensusRequestPB& request = req->request;
   bool needs_tablet_copy = false;
-  int64_t commit_index_before = request_.has_committed_index() ?
-      request_.committed_index() : kMinimumOpIdIndex;
-  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request_,
-                                    &replicate_msg_refs_, &needs_tablet_copy);
-  int64_t commit_index_after = request_.has_committed_index() ?
-      request_.committed_index() : kMinimumOpIdIndex;
+  int64_t commit_index_before = last_sent_committed_index_;
+  Status s = queue_->RequestForPeer(peer_pb_.permanent_uuid(), &request,
+                                    &req->replicate_msg_refs, &needs_tablet_copy,
+                                    pipeline_after_index);
+  int64_t commit_index_after = request.has_committed_index() ?
+      request.committed_index() : kMinimumOpIdIndex;
 
   if (PREDICT_FALSE(!s.ok())) {
     VLOG_WITH_PREFIX_UNLOCKED(1) << s.ToString();
@@ -240,15 +267,20 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
   }
 
   if (PREDICT_FALSE(needs_tablet_copy)) {
+    if (pipeline_after_index) {
+      // Wait for the requests in flight to finish first.
+      return;
+    }
     Status s = PrepareTabletCopyRequest();
     if (s.ok()) {
-      controller_.Reset();
-      request_pending_ = true;
+      tc_controller_.Reset();
+      tc_pending_ = true;
+      UpdateRequestPendingUnlocked();
       l.unlock();
       // Capture a shared_ptr reference into the RPC callback so that we're guaranteed
       // that this object outlives the RPC.
       shared_ptr<Peer> s_this = shared_from_this();
-      proxy_->StartTabletCopyAsync(tc_request_, &tc_response_, &controller_,
+      proxy_->StartTabletCopyAsync(tc_request_, &tc_response_, &tc_controller_,
                                    [s_this]() {
                                      s_this->ProcessTabletCopyResponse();
                                    });
@@ -259,16 +291,21 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
     return;
   }
 
-  request_.set_tablet_id(tablet_id_);
-  request_.set_caller_uuid(leader_uuid_);
-  request_.set_dest_uuid(peer_pb_.permanent_uuid());
+  request.set_tablet_id(tablet_id_);
+  request.set_caller_uuid(leader_uuid_);
+  request.set_dest_uuid(peer_pb_.permanent_uuid());
 
-  bool req_has_ops = request_.ops_size() > 0 || (commit_index_after > commit_index_before);
+  bool req_has_ops = request.ops_size() > 0 || (commit_index_after > commit_index_before);
   // If the queue is empty, check if we were told to send a status-only
   // message, if not just return.
   if (PREDICT_FALSE(!req_has_ops && !even_if_queue_empty)) {
     return;
   }
+  // There's no point in pipelining a request without ops: the requests in
+  // flight already assert the leader's liveness.
+  if (pipeline_after_index && request.ops_size() == 0) {
+    return;
+  }
 
   if (req_has_ops) {
     // If we're actually sending ops there's no need to heartbeat for a while.
@@ -278,21 +315,50 @@ void Peer::SendNextRequest(bool even_if_queue_empty) {
   MAYBE_FAULT(FLAGS_fault_crash_on_leader_request_fraction);
 
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Sending to peer " << peer_pb().permanent_uuid() << ": "
-      << SecureShortDebugString(request_);
+      << SecureShortDebugString(request);
 
-  controller_.Reset();
-  request_pending_ = true;
+  last_sent_index_ = request.ops_size() > 0 ?
+      request.ops(request.ops_size() - 1).id().index() : request.preceding_id().index();
+  last_sent_committed_index_ = commit_index_after;
+  inflight_.push_back(req);
+  UpdateRequestPendingUnlocked();
   l.unlock();
 
-  // Capture a shared_ptr reference into the RPC callback so that we're guaranteed
-  // that this object outlives the RPC.
+  // Capture shared_ptr references into the RPC callback so that we're guaranteed
+  // that this object and the request outlive the RPC. Pipelined requests may
+  // leave in a different order than they were generated in; the follower
+  // tolerates that by waiting briefly for the preceding ops to arrive.
   shared_ptr<Peer> s_this = shared_from_this();
-  proxy_->UpdateAsync(request_, &response_, &controller_,
-                      [s_this]() {
-                        s_this->ProcessResponse();
+  if (!req_has_ops && heartbeat_batcher_ &&
+      FLAGS_enable_multi_raft_heartbeat_batching && heartbeat_batcher_->supported()) {
+    // An idle heartbeat: coalesce it with the heartbeats of other tablets to
+    // the same server.
+    heartbeat_batcher_->AddRequest(request, &req->response,
+                                   [s_this, req](const Status& s) {
+                                     s_this->ProcessResponse(req, s);
+                                   });
+    return;
+  }
+  proxy_->UpdateAsync(request, &req->response, &req->controller,
+                      [s_this, req]() {
+                        s_this->ProcessResponse(req, req->controller.status());
                       });
 }
 
+bool Peer::CanPipelineUnlocked() {
+  DCHECK(peer_lock_.is_locked());
+  return FLAGS_consensus_max_inflight_requests_per_peer > 1 &&
+      !tc_pending_ &&
+      failed_attempts_ == 0 &&
+      !inflight_.empty() &&
+      static_cast<int>(inflight_.size()) < FLAGS_consensus_max_inflight_requests_per_peer;
+}
+
+void Peer::UpdateRequestPendingUnlocked() {
+  DCHECK(peer_lock_.is_locked());
+  request_pending_ = !inflight_.empty() || processing_response_ || tc_pending_;
+}
+
 void Peer::StartElection() {
   // The async proxy contract is such that the response and RPC controller must
   // stay in scope until the callback is invoked. Unlike other Peer methods, we
@@ -321,93 +387,110 @@ void Peer::StartElection() {
     });
 }
 
-void Peer::ProcessResponse() {
+void Peer::ProcessResponse(const shared_ptr<UpdateRequest>& req,
+                           const Status& rpc_status) {
   // Note: This method runs on the reactor thread.
   std::unique_lock<simple_spinlock> lock(peer_lock_);
   if (PREDICT_FALSE(closed_)) {
     return;
   }
   CHECK(request_pending_);
+  req->response_received = true;
+  req->rpc_status = rpc_status;
+  MaybeProcessNextResponseUnlocked();
+}
 
-  MAYBE_FAULT(FLAGS_fault_crash_after_leader_request_fraction);
-
-  // Process RpcController errors.
-  const auto controller_status = controller_.status();
-  if (!controller_status.ok()) {
-    auto ps = controller_status.IsRemoteError() ?
-        PeerStatus::REMOTE_ERROR : PeerStatus::RPC_LAYER_ERROR;
-    queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), ps, controller_status);
-    ProcessResponseErrorUnlocked(controller_status);
-    return;
-  }
+void Peer::MaybeProcessNextResponseUnlocked() {
+  DCHECK(peer_lock_.is_locked());
+  while (!processing_response_ && !inflight_.empty() && inflight_.front()->response_received) {
+    shared_ptr<UpdateRequest> req = std::move(inflight_.front());
+    inflight_.pop_front();
+    const ConsensusResponsePB& response = req->response;
+
+    MAYBE_FAULT(FLAGS_fault_crash_after_leader_request_fraction);
+
+    // Process RPC errors.
+    const auto& controller_status = req->rpc_status;
+    if (!controller_status.ok()) {
+      auto ps = controller_status.IsRemoteError() ?
+          PeerStatus::REMOTE_ERROR : PeerStatus::RPC_LAYER_ERROR;
+      queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), ps, controller_status);
+      ProcessResponseErrorUnlocked(response, controller_status);
+      continue;
+    }
 
-  // Process CANNOT_PREPARE.
-  // TODO(todd): there is no integration test coverage of this code path. Likely a bug in
-  // this path is responsible for KUDU-1779.
-  if (response_.status().has_error() &&
-      response_.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE) {
-    Status response_status = StatusFromPB(response_.status().error().status());
-    queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), PeerStatus::CANNOT_PREPARE,
-                             response_status);
-    ProcessResponseErrorUnlocked(response_status);
-    return;
-  }
+    // Process CANNOT_PREPARE.
+    // TODO(todd): there is no integration test coverage of this code path. Likely a bug in
+    // this path is responsible for KUDU-1779.
+    if (response.status().has_error() &&
+        response.status().error().code() == consensus::ConsensusErrorPB::CANNOT_PREPARE) {
+      Status response_status = StatusFromPB(response.status().error().status());
+      queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), PeerStatus::CANNOT_PREPARE,
+                               response_status);
+      ProcessResponseErrorUnlocked(response, response_status);
+      continue;
+    }
 
-  // Process tserver-level errors.
-  if (response_.has_error()) {
-    Status response_status = StatusFromPB(response_.error().status());
-    PeerStatus ps;
-    TabletServerErrorPB resp_error = response_.error();
-    switch (response_.error().code()) {
-      // We treat WRONG_SERVER_UUID as failed.
-      case TabletServerErrorPB::WRONG_SERVER_UUID: FALLTHROUGH_INTENDED;
-      case TabletServerErrorPB::TABLET_FAILED:
-        ps = PeerStatus::TABLET_FAILED;
-        break;
-      case TabletServerErrorPB::TABLET_NOT_FOUND:
-        ps = PeerStatus::TABLET_NOT_FOUND;
-        break;
-      default:
-        // Unknown kind of error.
-        ps = PeerStatus::REMOTE_ERROR;
+    // Process tserver-level errors.
+    if (response.has_error()) {
+      Status response_status = StatusFromPB(response.error().status());
+      PeerStatus ps;
+      switch (response.error().code()) {
+        // We treat WRONG_SERVER_UUID as failed.
+        case TabletServerErrorPB::WRONG_SERVER_UUID: FALLTHROUGH_INTENDED;
+        case TabletServerErrorPB::TABLET_FAILED:
+          ps = PeerStatus::TABLET_FAILED;
+          break;
+        case TabletServerErrorPB::TABLET_NOT_FOUND:
+          ps = PeerStatus::TABLET_NOT_FOUND;
+          break;
+        default:
+          // Unknown kind of error.
+          ps = PeerStatus::REMOTE_ERROR;
+      }
+      queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), ps, response_status);
+      ProcessResponseErrorUnlocked(response, response_status);
+      continue;
     }
-    queue_->UpdatePeerStatus(peer_pb_.permanent_uuid(), ps, response_status);
-    ProcessResponseErrorUnlocked(response_status);
-    return;
-  }
 
-  // The queue's handling of the peer response may generate IO (reads against
-  // the WAL) and SendNextRequest() may do the same thing. So we run the rest
-  // of the response handling logic on our thread pool and not on the reactor
-  // thread.
-  //
-  // Capture a weak_ptr reference into the submitted functor so that we can
-  // safely handle the functor outliving its peer.
-  weak_ptr<Peer> w_this = shared_from_this();
-  Status s = raft_pool_token_->Submit([w_this]() {
-    if (auto p = w_this.lock()) {
-      p->DoProcessResponse();
+    // The queue's handling of the peer response may generate IO (reads against
+    // the WAL) and SendNextRequest() may do the same thing. So we run the rest
+    // of the response handling logic on our thread pool and not on the reactor
+    // thread.
+    //
+    // Capture a weak_ptr reference into the submitted functor so that we can
+    // safely handle the functor outliving its peer.
+    weak_ptr<Peer> w_this = shared_from_this();
+    Status s = raft_pool_token_->Submit([w_this, req]() {
+      if (auto p = w_this.lock()) {
+        p->DoProcessResponse(req);
+      }
+    });
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to process peer response: " << s.ToString()
+          << ": " << SecureShortDebugString(response);
+      continue;
     }
-  });
-  if (PREDICT_FALSE(!s.ok())) {
-    LOG_WITH_PREFIX_UNLOCKED(WARNING) << "Unable to process peer response: " << s.ToString()
-        << ": " << SecureShortDebugString(response_);
-    request_pending_ = false;
+    processing_response_ = true;
   }
+  UpdateRequestPendingUnlocked();
 }
 
-void Peer::DoProcessResponse() {
+void Peer::DoProcessResponse(const shared_ptr<UpdateRequest>& req) {
   VLOG_WITH_PREFIX_UNLOCKED(2) << "Response from peer " << peer_pb().permanent_uuid() << ": "
-      << SecureShortDebugString(response_);
+      << SecureShortDebugString(req->response);
 
   const auto send_more_immediately =
-      queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), response_);
+      queue_->ResponseFromPeer(peer_pb_.permanent_uuid(), req->response);
 
   {
     std::unique_lock<simple_spinlock> lock(peer_lock_);
-    CHECK(request_pending_);
+    CHECK(processing_response_);
     failed_attempts_ = 0;
-    request_pending_ = false;
+    processing_response_ = false;
+    // Responses to requests pipelined behind this one may have arrived
+    // while this one was being handled.
+    MaybeProcessNextResponseUnlocked();
   }
 
   if (send_more_immediately) {
@@ -430,11 +513,12 @@ void Peer::ProcessTabletCopyResponse() {
   if (PREDICT_FALSE(closed_)) {
     return;
   }
-  CHECK(request_pending_);
-  request_pending_ = false;
+  CHECK(tc_pending_);
+  tc_pending_ = false;
+  UpdateRequestPendingUnlocked();
 
   // If the response is OK, or ALREADY_INPROGRESS, then consider the RPC successful.
-  const auto controller_status = controller_.status();
+  const auto controller_status = tc_controller_.status();
   bool success =
     controller_status.ok() &&
     (!tc_response_.has_error() ||
@@ -454,14 +538,15 @@ void Peer::ProcessTabletCopyResponse() {
   }
 }
 
-void Peer::ProcessResponseErrorUnlocked(const Status& status) {
+void Peer::ProcessResponseErrorUnlocked(const ConsensusResponsePB& response,
+                                        const Status& status) {
   DCHECK(peer_lock_.is_locked());
   failed_attempts_++;
   string resp_err_info;
-  if (response_.has_error()) {
+  if (response.has_error()) {
     resp_err_info = Substitute(" Error code: $0 ($1).",
-                               TabletServerErrorPB::Code_Name(response_.error().code()),
-                               response_.error().code());
+                               TabletServerErrorPB::Code_Name(response.error().code()),
+                               response.error().code());
   }
   // We log the warning at the first failure, then every
   // 'kNumRetriesBetweenLoggingFailedRequest' retries.
@@ -479,7 +564,6 @@ void Peer::ProcessResponseErrorUnlocked(const Status& status) {
                  failed_attempts_,
                  kNumRetriesBetweenLoggingFailedRequest);
   }
-  request_pending_ = false;
 }
 
 string Peer::LogPrefixUnlocked() const {
@@ -507,9 +591,6 @@ Peer::~Peer() {
   if (heartbeater_) {
     heartbeater_->Stop();
   }
-
-  // We don't own the ops (the queue does).
-  request_.mutable_ops()->ExtractSubrange(0, request_.ops_size(), nullptr);
 }
 
 RpcPeerProxy::RpcPeerProxy(HostPort hostport,
@@ -549,6 +630,14 @@ void RpcPeerProxy::StartTabletCopyAsync(const StartTabletCopyRequestPB& request,
   consensus_proxy_->StartTabletCopyAsync(request, response, controller, callback);
 }
 
+void RpcPeerProxy::MultiRaftUpdateAsync(const MultiRaftConsensusRequestPB& request,
+                                        MultiRaftConsensusResponsePB* response,
+                                        rpc::RpcController* controller,
+                                        const rpc::ResponseCallback& callback) {
+  controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  consensus_proxy_->MultiRaftUpdateConsensusAsync(request, response, controller, callback);
+}
+
 string RpcPeerProxy::PeerName() const {
   return hostport_.ToString();
 }
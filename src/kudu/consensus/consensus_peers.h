@@ -18,6 +18,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -46,22 +47,32 @@ class PeriodicTimer;
 }
 
 namespace consensus {
+class MultiRaftHeartbeatBatcher;
 class PeerMessageQueue;
 class PeerProxy;
 
 // A remote peer in consensus.
 //
-// Leaders use peers to update the remote replicas. Each peer
-// may have at most one outstanding request at a time. If a
+// Leaders use peers to update the remote replicas. By default each
+// peer may have at most one outstanding request at a time. If a
 // request is signaled when there is already one outstanding,
 // the request will be generated once the outstanding one finishes.
 //
+// With --consensus_max_inflight_requests_per_peer greater than one, a
+// peer whose last exchange succeeded may send further batches of ops while
+// earlier requests are still in flight, each picking up where the previous
+// one left off. Responses are always handled in the order the requests were
+// sent. Any failure stops the pipelining until the in-flight requests drain.
+//
 // Peers are owned by the consensus implementation and do not keep
-// state aside from the most recent request and response.
+// state aside from the requests in flight and their responses.
 //
 // Peers are also responsible for sending periodic heartbeats
 // to assert liveness of the leader. The peer constructs a heartbeater
-// thread to trigger these heartbeats.
+// thread to trigger these heartbeats. If the peer was given a heartbeat
+// batcher and --enable_multi_raft_heartbeat_batching is set, heartbeats
+// that carry neither ops nor a new commit index are sent through the batcher,
+// together with the heartbeats of other tablets to the same server.
 //
 // The actual request construction is delegated to a PeerMessageQueue
 // object, and performed on a thread pool (since it may do IO). When a
@@ -110,14 +121,19 @@ class Peer :
   // log entries) are assembled on 'raft_pool_token'.
   // Response handling may also involve IO related to log-entry lookups and is
   // also done on 'raft_pool_token'.
-  static Status NewRemotePeer(RaftPeerPB peer_pb,
-                              std::string tablet_id,
-                              std::string leader_uuid,
-                              PeerMessageQueue* queue,
-                              ThreadPoolToken* raft_pool_token,
-                              std::unique_ptr<PeerProxy> proxy,
-                              std::shared_ptr<rpc::Messenger> messenger,
-                              std::shared_ptr<Peer>* peer);
+  //
+  // If not null, 'heartbeat_batcher' is the batcher of the server hosting the
+  // peer, through which idle heartbeats may be sent.
+  static Status NewRemotePeer(
+      RaftPeerPB peer_pb,
+      std::string tablet_id,
+      std::string leader_uuid,
+      PeerMessageQueue* queue,
+      ThreadPoolToken* raft_pool_token,
+      std::unique_ptr<PeerProxy> proxy,
+      std::shared_ptr<rpc::Messenger> messenger,
+      std::shared_ptr<Peer>* peer,
+      std::shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher = nullptr);
 
  protected:
   Peer(RaftPeerPB peer_pb,
@@ -126,20 +142,56 @@ class Peer :
        PeerMessageQueue* queue,
        ThreadPoolToken* raft_pool_token,
        std::unique_ptr<PeerProxy> proxy,
-       std::shared_ptr<rpc::Messenger> messenger);
+       std::shared_ptr<rpc::Messenger> messenger,
+       std::shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher);
 
  private:
+  // An UpdateConsensus request sent to the peer, along with its response.
+  struct UpdateRequest {
+    ~UpdateRequest() {
+      // We don't own the ops (the queue does).
+      request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
+    }
+
+    ConsensusRequestPB request;
+    ConsensusResponsePB response;
+    rpc::RpcController controller;
+
+    // Reference-counted pointers to the ReplicateMsgs in 'request'. We may
+    // have loaded these messages from the LogCache, in which case we are
+    // potentially sharing the same object as other peers. Since the PB request
+    // itself can't hold reference counts, this holds them.
+    std::vector<ReplicateRefPtr> replicate_msg_refs;
+
+    // Whether the RPC for 'request' has completed, and its status.
+    bool response_received = false;
+    Status rpc_status;
+  };
+
   void SendNextRequest(bool even_if_queue_empty);
 
-  // Signals that a response was received from the peer.
+  // Returns true if another request may be sent while the ones in
+  // 'inflight_' are outstanding.
+  bool CanPipelineUnlocked();
+
+  // Signals that a response was received from the peer, through an RPC
+  // which completed with 'rpc_status'.
   //
   // This method is called from the reactor thread and calls
   // DoProcessResponse() on raft_pool_token_ to do any work that requires IO or
   // lock-taking.
-  void ProcessResponse();
+  void ProcessResponse(const std::shared_ptr<UpdateRequest>& req,
+                       const Status& rpc_status);
+
+  // Hands the responses at the front of 'inflight_' to the queue, in the order
+  // the requests were sent, one at a time.
+  void MaybeProcessNextResponseUnlocked();
 
   // Run on 'raft_pool_token'. Does response handling that requires IO or may block.
-  void DoProcessResponse();
+  void DoProcessResponse(const std::shared_ptr<UpdateRequest>& req);
+
+  // Recomputes 'request_pending_' from the state of the outstanding requests.
+  void UpdateRequestPendingUnlocked();
 
   // Fetch the desired tablet copy request from the queue and set up
   // tc_request_ appropriately.
@@ -152,7 +204,8 @@ class Peer :
   void ProcessTabletCopyResponse();
 
   // Signals there was an error sending the request to the peer.
-  void ProcessResponseErrorUnlocked(const Status& status);
+  void ProcessResponseErrorUnlocked(const ConsensusResponsePB& response,
+                                    const Status& status);
 
   std::string LogPrefixUnlocked() const;
 
@@ -165,24 +218,36 @@ class Peer :
 
   std::unique_ptr<PeerProxy> proxy_;
 
+  // Batcher coalescing the heartbeats to the peer's server with those of
+  // other tablets. May be null.
+  const std::shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher_;
+
   PeerMessageQueue* queue_;
   uint64_t failed_attempts_;
 
-  // The latest consensus update request and response.
-  ConsensusRequestPB request_;
-  ConsensusResponsePB response_;
+  // The consensus update requests sent to the peer whose responses have not
+  // been handled yet, in the order they were sent.
+  std::deque<std::shared_ptr<UpdateRequest>> inflight_;
+
+  // Whether the response to a request already removed from 'inflight_' is
+  // being handled on 'raft_pool_token_'.
+  bool processing_response_;
+
+  // The index of the last op sent to the peer, or the preceding op index of
+  // the last request if it carried no ops. Pipelined requests carry the ops
+  // following it.
+  int64_t last_sent_index_;
+
+  // The committed index sent with the last request.
+  int64_t last_sent_committed_index_;
 
   // The latest tablet copy request and response.
   StartTabletCopyRequestPB tc_request_;
   StartTabletCopyResponsePB tc_response_;
+  rpc::RpcController tc_controller_;
 
-  // Reference-counted pointers to any ReplicateMsgs which are in-flight to the peer. We
-  // may have loaded these messages from the LogCache, in which case we are potentially
-  // sharing the same object as other peers. Since the PB request_ itself can't hold
-  // reference counts, this holds them.
-  std::vector<ReplicateRefPtr> replicate_msg_refs_;
-
-  rpc::RpcController controller_;
+  // Whether a tablet copy request is outstanding.
+  bool tc_pending_;
 
   std::shared_ptr<rpc::Messenger> messenger_;
 
@@ -195,7 +260,8 @@ class Peer :
   std::shared_ptr<rpc::PeriodicTimer> heartbeater_;
 
   // Lock that protects Peer state changes, initialization, etc. It's necessary
-  // to hold 'peer_lock_' if setting 'request_pending_', 'closed_', and
+  // to hold 'peer_lock_' to access the outstanding request state above, and
+  // if setting 'request_pending_', 'closed_', and
   // 'has_sent_first_request_' fields below. To read 'has_sent_first_request_',
   // it's necessary to hold 'peer_lock_'. To read the 'closed_' and
   // 'request_pending_' fields, there is no need to hold 'peer_lock_' unless
@@ -203,6 +269,8 @@ class Peer :
   // concurrently.
   simple_spinlock peer_lock_;
 
+  // Whether any update or tablet copy request is outstanding, or a response
+  // is being handled.
   std::atomic<bool> request_pending_;
   std::atomic<bool> closed_;
   bool has_sent_first_request_;
@@ -240,6 +308,15 @@ class PeerProxy {
     LOG(DFATAL) << "Not implemented";
   }
 
+  // Sends a batch of requests, asynchronously, to replicas hosted by the
+  // peer's server.
+  virtual void MultiRaftUpdateAsync(const MultiRaftConsensusRequestPB& /*request*/,
+                                    MultiRaftConsensusResponsePB* /*response*/,
+                                    rpc::RpcController* /*controller*/,
+                                    const rpc::ResponseCallback& /*callback*/) {
+    LOG(DFATAL) << "Not implemented";
+  }
+
   // Remote endpoint or description of the peer.
   virtual std::string PeerName() const = 0;
 };
@@ -283,6 +360,11 @@ class RpcPeerProxy : public PeerProxy {
                             rpc::RpcController* controller,
                             const rpc::ResponseCallback& callback) override;
 
+  void MultiRaftUpdateAsync(const MultiRaftConsensusRequestPB& request,
+                            MultiRaftConsensusResponsePB* response,
+                            rpc::RpcController* controller,
+                            const rpc::ResponseCallback& callback) override;
+
   std::string PeerName() const override;
 
  private:
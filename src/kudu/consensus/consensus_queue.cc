@@ -630,7 +630,8 @@ HealthReportPB::HealthStatus PeerMessageQueue::PeerHealthStatus(const TrackedPee
 Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         ConsensusRequestPB* request,
                                         vector<ReplicateRefPtr>* msg_refs,
-                                        bool* needs_tablet_copy) {
+                                        bool* needs_tablet_copy,
+                                        boost::optional<int64_t> pipeline_after_index) {
   // Maintain a thread-safe copy of necessary members.
   OpId preceding_id;
   int64_t current_term;
@@ -647,6 +648,10 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                          "queue is not in leader mode", uuid));
     }
     peer_copy = *peer;
+    if (pipeline_after_index && peer_copy.last_exchange_status != PeerStatus::OK) {
+      return Status::IllegalState(Substitute("cannot pipeline requests to peer $0: "
+                                             "last exchange with it was not successful", uuid));
+    }
 
     // Clear the requests without deleting the entries, as they may be in use by other peers.
     request->mutable_ops()->ExtractSubrange(0, request->ops_size(), nullptr);
@@ -660,6 +665,11 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     request->set_all_replicated_index(queue_state_.all_replicated_index);
     request->set_last_idx_appended_to_leader(queue_state_.last_appended.index());
     request->set_caller_term(current_term);
+    if (pipeline_after_index) {
+      request->set_pipelined(true);
+    } else {
+      request->clear_pipelined();
+    }
     unreachable_time = MonoTime::Now() - peer_copy.last_communication_time;
   }
 
@@ -695,8 +705,11 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     vector<ReplicateRefPtr> messages;
     int64_t max_batch_size = FLAGS_consensus_max_batch_size_bytes - request->ByteSizeLong();
 
-    // We try to get the follower's next_index from our log.
-    Status s = log_cache_.ReadOps(peer_copy.next_index - 1,
+    // We try to get the follower's next_index from our log. Pipelined requests
+    // pick up where the requests in flight left off instead.
+    const int64_t after_index = pipeline_after_index ?
+        *pipeline_after_index : peer_copy.next_index - 1;
+    Status s = log_cache_.ReadOps(after_index,
                                   max_batch_size,
                                   &messages,
                                   &preceding_id);
@@ -271,10 +271,18 @@ class PeerMessageQueue {
   // instance of ConsensusRequestPB to RequestForPeer(): the buffer will
   // replace the old entries with new ones without de-allocating the old
   // ones if they are still required.
+  //
+  // If 'pipeline_after_index' is set, the request is to be sent while earlier
+  // requests to the peer, whose last op has that index, are still in flight.
+  // The request then carries the ops following that index rather than the
+  // peer's next index, and is marked as pipelined. Returns IllegalState if
+  // the peer's last exchange was not successful, in which case the peer's
+  // position in the log is uncertain and requests must not be pipelined.
   Status RequestForPeer(const std::string& uuid,
                         ConsensusRequestPB* request,
                         std::vector<ReplicateRefPtr>* msg_refs,
-                        bool* needs_tablet_copy);
+                        bool* needs_tablet_copy,
+                        boost::optional<int64_t> pipeline_after_index = boost::none);
 
   // Fill in a StartTabletCopyRequest for the specified peer.
   // If that peer should not initiate Tablet Copy, returns a non-OK status.
@@ -24,6 +24,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -44,6 +45,8 @@
 #include "kudu/consensus/log_util.h"
 #include "kudu/consensus/opid.pb.h"
 #include "kudu/consensus/opid_util.h"
+#include "kudu/consensus/ref_counted_replicate.h"
+#include "kudu/consensus/shared_wal_syncer.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
@@ -53,6 +56,7 @@
 #include "kudu/util/env.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/file_cache.h"
+#include "kudu/util/locks.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/random.h"
 #include "kudu/util/status.h"
@@ -63,6 +67,8 @@
 DEFINE_int32(num_batches, 10000,
              "Number of batches to write to/read from the Log in TestWriteManyBatches");
 
+DECLARE_bool(log_group_fsync);
+DECLARE_bool(log_pipeline_sync);
 DECLARE_int32(log_min_segments_to_retain);
 DECLARE_int32(log_max_segments_to_retain);
 DECLARE_double(log_inject_io_error_on_preallocate_fraction);
@@ -82,6 +88,7 @@ using consensus::MakeOpId;
 using consensus::NO_OP;
 using consensus::OpId;
 using consensus::ReplicateMsg;
+using consensus::ReplicateRefPtr;
 using consensus::WRITE_OP;
 using strings::Substitute;
 
@@ -176,7 +183,7 @@ class LogTestOptionalCompression : public LogTest,
     FLAGS_log_compression_codec = name;
   }
 };
-INSTANTIATE_TEST_CASE_P(Codecs, LogTestOptionalCompression, ::testing::Values(NO_COMPRESSION, LZ4));
+INSTANTIATE_TEST_CASE_P(Codecs, LogTestOptionalCompression, ::testing::Values(NO_COMPRESSION, LZ4, ZSTD));
 
 // If we write more than one entry in a batch, we should be able to
 // read all of those entries back.
@@ -248,6 +255,66 @@ TEST_P(LogTestOptionalCompression, TestFsync) {
   ASSERT_OK(log_->Close());
 }
 
+// Tests that appends are synced through the WAL filesystem's shared syncer
+// when group fsync is enabled.
+TEST_F(LogTest, TestGroupFsync) {
+  if (!env_->IsFilesystemSyncSupported()) {
+    LOG(WARNING) << "Skipping test: filesystem syncs are not supported";
+    return;
+  }
+  FLAGS_log_group_fsync = true;
+  options_.force_fsync_all = true;
+  ASSERT_OK(BuildLog());
+  shared_ptr<SharedWalSyncer> syncer;
+  ASSERT_OK(SharedWalSyncer::GetForWalRoot(env_, fs_manager_->GetWalsRootDir(), &syncer));
+  const int64_t orig_syncs = syncer->num_syncs();
+
+  OpId opid = MakeOpId(0, 1);
+  AppendNoOp(&opid);
+  ASSERT_GT(syncer->num_syncs(), orig_syncs);
+
+  ASSERT_OK(log_->Close());
+}
+
+// Tests that with pipelined syncs, the callbacks of appended entries all run,
+// successfully and in log order, including across segment roll-overs.
+TEST_F(LogTest, TestPipelineSync) {
+  FLAGS_log_pipeline_sync = true;
+  options_.force_fsync_all = true;
+  options_.segment_size_mb = 1;
+  ASSERT_OK(BuildLog());
+
+  // Enough data to fill a few segments.
+  const int kNumEntries = 500;
+  const string payload(8 * 1024, 'x');
+  simple_spinlock lock;
+  vector<int64_t> completed;
+  OpId opid = MakeOpId(1, 1);
+  for (int i = 0; i < kNumEntries; i++) {
+    ReplicateRefPtr replicate =
+        consensus::make_scoped_refptr_replicate(new ReplicateMsg());
+    replicate->get()->mutable_id()->CopyFrom(opid);
+    replicate->get()->set_op_type(NO_OP);
+    replicate->get()->set_timestamp(clock_->Now().ToUint64());
+    replicate->get()->mutable_noop_request()->set_payload_for_tests(payload);
+    opid.set_index(opid.index() + 1);
+    ASSERT_OK(log_->AsyncAppendReplicates(
+        { replicate }, [&lock, &completed, replicate](const Status& s) {
+          CHECK_OK(s);
+          std::lock_guard<simple_spinlock> l(lock);
+          completed.push_back(replicate->get()->id().index());
+        }));
+  }
+  ASSERT_OK(log_->WaitUntilAllFlushed());
+  {
+    std::lock_guard<simple_spinlock> l(lock);
+    ASSERT_EQ(kNumEntries, completed.size());
+    ASSERT_TRUE(std::is_sorted(completed.begin(), completed.end()));
+  }
+  ASSERT_GT(log_->reader()->num_segments(), 1);
+  ASSERT_OK(log_->Close());
+}
+
 // Regression test for part of KUDU-735:
 // if a log is not preallocated, we should properly track its on-disk size as we append to
 // it.
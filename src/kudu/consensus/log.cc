@@ -34,6 +34,7 @@
 #include "kudu/consensus/log_metrics.h"
 #include "kudu/consensus/log_reader.h"
 #include "kudu/consensus/log_util.h"
+#include "kudu/consensus/shared_wal_syncer.h"
 #include "kudu/fs/fs_manager.h"
 #include "kudu/gutil/atomicops.h"
 #include "kudu/gutil/dynamic_annotations.h"
@@ -85,6 +86,25 @@ DEFINE_int32(group_commit_queue_size_bytes, 4 * 1024 * 1024,
 TAG_FLAG(group_commit_queue_size_bytes, advanced);
 
 
+DEFINE_bool(log_group_fsync, false,
+            "Whether the WALs of all tablets should make their appends durable "
+            "with syncs shared across the whole WAL filesystem (syncfs(2)), rather "
+            "than with an fsync() of each tablet's log segment. Concurrent syncs "
+            "from many tablets are then coalesced into one, which greatly reduces "
+            "the fsync rate of servers hosting many tablets. Only applies if "
+            "--log_force_fsync_all is set, and is only supported on Linux 5.8 or "
+            "later, where syncfs(2) reports writeback errors. Best used when the "
+            "WAL directory is on a filesystem of its own, since every sync also "
+            "flushes any other data written to that filesystem.");
+TAG_FLAG(log_group_fsync, experimental);
+
+DEFINE_bool(log_pipeline_sync, false,
+            "Whether each log should sync a group of appended entries and run "
+            "their callbacks on a separate thread, while the append thread "
+            "compresses, checksums and writes the next group. This overlaps "
+            "the fsync latency of one group commit with the writes of the next.");
+TAG_FLAG(log_pipeline_sync, experimental);
+
 DEFINE_int32(log_thread_idle_threshold_ms, 1000,
              "Number of milliseconds after which the log append thread decides that a "
              "log is idle, and considers shutting down. Used by tests.");
@@ -97,6 +117,11 @@ DEFINE_string(log_compression_codec, "LZ4",
               "Codec to use for compressing WAL segments.");
 TAG_FLAG(log_compression_codec, experimental);
 
+DEFINE_int32(log_compression_level, 0,
+             "Compression level to use for WAL segments, for codecs which support "
+             "levels (currently only ZSTD). 0 selects the codec's default level.");
+TAG_FLAG(log_compression_level, experimental);
+
 // Fault/latency injection flags.
 // -----------------------------
 DEFINE_bool(log_inject_latency, false,
@@ -175,9 +200,23 @@ static bool ValidateLogsToRetain(const char* flagname, int value) {
 }
 DEFINE_validator(log_min_segments_to_retain, &ValidateLogsToRetain);
 
+// Validate that group fsync is only enabled where filesystem syncs report
+// writeback errors; otherwise a failed writeback would go unnoticed.
+static bool ValidateLogGroupFsync(const char* flagname, bool value) {
+  if (!value || kudu::Env::Default()->IsFilesystemSyncSupported()) {
+    return true;
+  }
+  LOG(ERROR) << strings::Substitute(
+      "$0 is not supported on this platform: it requires Linux 5.8 or later "
+      "(kernel release: $1)", flagname, kudu::Env::Default()->GetKernelRelease());
+  return false;
+}
+DEFINE_validator(log_group_fsync, &ValidateLogGroupFsync);
+
 using kudu::consensus::CommitMsg;
 using kudu::consensus::OpId;
 using kudu::consensus::ReplicateRefPtr;
+using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::vector;
@@ -250,6 +289,15 @@ class Log::AppendThread {
   // Handle the actual appending of a group of entries.
   void HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_batches);
 
+  // Make a group of written entries durable, if 'needs_sync' is true, and
+  // then run their callbacks. 'file' is the file of the segment the entries
+  // were written to, or null to sync the active segment. 'start_time' is when
+  // handling of the group began.
+  void SyncAndRunCallbacks(vector<unique_ptr<LogEntryBatch>> entry_batches,
+                           bool needs_sync,
+                           const shared_ptr<RWFile>& file,
+                           MonoTime start_time);
+
   string LogPrefix() const;
 
   Log* const log_;
@@ -267,6 +315,11 @@ class Log::AppendThread {
   // Pool with a single thread, which handles shutting down the thread
   // when idle.
   unique_ptr<ThreadPool> append_pool_;
+
+  // Pool with a single thread, which syncs each group of entries and runs
+  // their callbacks while the append thread writes the next group. Only
+  // created if --log_pipeline_sync is set.
+  unique_ptr<ThreadPool> sync_pool_;
 };
 
 
@@ -286,6 +339,12 @@ Status Log::AppendThread::Init() {
                 // handles waiting for work while idle.
                 .set_idle_timeout(MonoDelta::FromSeconds(0))
                 .Build(&append_pool_));
+  if (FLAGS_log_pipeline_sync) {
+    RETURN_NOT_OK(ThreadPoolBuilder("wal-sync")
+                  .set_min_threads(0)
+                  .set_max_threads(1)
+                  .Build(&sync_pool_));
+  }
   return Status::OK();
 }
 
@@ -368,8 +427,7 @@ void Log::AppendThread::HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_ba
     log_->ctx_.metrics->entry_batches_per_group->Increment(entry_batches.size());
   }
   TRACE_EVENT1("log", "batch", "batch_size", entry_batches.size());
-
-  SCOPED_LATENCY_METRIC(log_->ctx_.metrics, group_commit_latency);
+  const MonoTime start_time = MonoTime::Now();
 
   bool is_all_commits = true;
   for (auto& entry_batch : entry_batches) {
@@ -388,9 +446,35 @@ void Log::AppendThread::HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_ba
     }
   }
 
+  if (!sync_pool_) {
+    SyncAndRunCallbacks(std::move(entry_batches), !is_all_commits, nullptr, start_time);
+    return;
+  }
+
+  // Keep at most one group in flight on the sync thread. This runs the
+  // callbacks of consecutive groups in log order, and bounds the memory held
+  // by entries that were written but aren't yet durable.
+  sync_pool_->Wait();
+
+  // Entries written after this point may be appended to a new segment, so
+  // the group must sync the file it was written to. If the segment has been
+  // rolled over in the meantime, finishing it already synced it.
+  shared_ptr<RWFile> file = log_->segment_allocator_.active_segment_file();
+
+  // std::function must be copyable, hence the shared_ptr.
+  auto batches = std::make_shared<vector<unique_ptr<LogEntryBatch>>>(std::move(entry_batches));
+  CHECK_OK(sync_pool_->Submit([this, batches, is_all_commits, file, start_time]() {
+    this->SyncAndRunCallbacks(std::move(*batches), !is_all_commits, file, start_time);
+  }));
+}
+
+void Log::AppendThread::SyncAndRunCallbacks(vector<unique_ptr<LogEntryBatch>> entry_batches,
+                                            bool needs_sync,
+                                            const shared_ptr<RWFile>& file,
+                                            MonoTime start_time) {
   Status s;
-  if (!is_all_commits) {
-    s = log_->Sync();
+  if (needs_sync) {
+    s = file ? log_->segment_allocator_.SyncFile(file.get()) : log_->Sync();
   }
   if (PREDICT_FALSE(!s.ok())) {
     LOG_WITH_PREFIX(ERROR) << "Error syncing log: " << s.ToString();
@@ -409,6 +493,10 @@ void Log::AppendThread::HandleBatches(vector<unique_ptr<LogEntryBatch>> entry_ba
     // callback of a later batch may want to use that memory.
     entry_batch.reset();
   }
+  if (log_->ctx_.metrics) {
+    log_->ctx_.metrics->group_commit_latency->Increment(
+        (MonoTime::Now() - start_time).ToMicroseconds());
+  }
 }
 
 void Log::AppendThread::Shutdown() {
@@ -417,6 +505,10 @@ void Log::AppendThread::Shutdown() {
     append_pool_->Wait();
     append_pool_->Shutdown();
   }
+  if (sync_pool_) {
+    sync_pool_->Wait();
+    sync_pool_->Shutdown();
+  }
 }
 
 string Log::AppendThread::LogPrefix() const {
@@ -445,9 +537,15 @@ Status SegmentAllocator::Init(
     scoped_refptr<ReadableLogSegment>* new_readable_segment) {
   // Init the compression codec.
   RETURN_NOT_OK_PREPEND(GetCompressionCodec(
-      GetCompressionCodecType(FLAGS_log_compression_codec), &codec_),
+      GetCompressionCodecType(FLAGS_log_compression_codec),
+      FLAGS_log_compression_level, &codec_),
                         "could not instantiate compression codec");
   active_segment_sequence_number_ = sequence_number;
+  if (opts_->force_fsync_all && FLAGS_log_group_fsync) {
+    RETURN_NOT_OK(SharedWalSyncer::GetForWalRoot(ctx_->fs_manager->env(),
+                                                 ctx_->fs_manager->GetWalsRootDir(),
+                                                 &shared_syncer_));
+  }
   RETURN_NOT_OK(ThreadPoolBuilder("log-alloc")
       .set_max_threads(1)
       .Build(&allocation_pool_));
@@ -491,6 +589,10 @@ Status SegmentAllocator::AllocateOrRollOverIfNecessary(
 }
 
 Status SegmentAllocator::Sync() {
+  return SyncFile(active_segment_->file().get());
+}
+
+Status SegmentAllocator::SyncFile(RWFile* file) {
   TRACE_EVENT0("log", "Sync");
   SCOPED_LATENCY_METRIC(ctx_->metrics, sync_latency);
 
@@ -507,7 +609,11 @@ Status SegmentAllocator::Sync() {
 
   if (opts_->force_fsync_all) {
     LOG_SLOW_EXECUTION(WARNING, 50, Substitute("$0Fsync log took a long time", LogPrefix())) {
-      RETURN_NOT_OK(active_segment_->Sync());
+      if (shared_syncer_) {
+        RETURN_NOT_OK(shared_syncer_->Sync());
+      } else {
+        RETURN_NOT_OK(file->Sync());
+      }
       if (hooks_) {
         RETURN_NOT_OK_PREPEND(hooks_->PostSyncIfFsyncEnabled(),
                               "PostSyncIfFsyncEnabled hook failed");
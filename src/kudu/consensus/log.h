@@ -65,6 +65,7 @@ class LogEntryBatch;
 class LogFaultHooks;
 class LogIndex;
 class LogReader;
+class SharedWalSyncer;
 struct LogEntryBatchLogicalSize;
 struct RetentionIndexes;
 
@@ -136,6 +137,16 @@ class SegmentAllocator {
   // Fsyncs the currently active segment to disk.
   Status Sync();
 
+  // Like Sync(), but fsyncs 'file', the file of a segment which may no longer
+  // be the active one. Unlike Sync(), may be called concurrently with writes
+  // to and roll-overs of the active segment.
+  Status SyncFile(RWFile* file);
+
+  // Returns the file of the currently active segment.
+  std::shared_ptr<RWFile> active_segment_file() const {
+    return active_segment_->file();
+  }
+
   // Syncs the current segment and writes out the footer.
   //
   // If 'finished_segment' is not null, it will contain a new ReadableLogSegment
@@ -211,6 +222,10 @@ class SegmentAllocator {
   // Hooks used to inject faults into the allocator.
   std::shared_ptr<LogFaultHooks> hooks_;
 
+  // If set, makes appends durable in place of fsyncing the active segment.
+  // See --log_group_fsync.
+  std::shared_ptr<SharedWalSyncer> shared_syncer_;
+
   // Descriptors for the segment file that should be used as the next active
   // segment.
   std::shared_ptr<RWFile> next_segment_file_;
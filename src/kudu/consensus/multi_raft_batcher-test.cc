@@ -0,0 +1,241 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/consensus/multi_raft_batcher.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/wire_protocol.h"
+#include "kudu/consensus/consensus.pb.h"
+#include "kudu/consensus/consensus_peers.h"
+#include "kudu/consensus/metadata.pb.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/rpc/messenger.h"
+#include "kudu/rpc/response_callback.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/countdown_latch.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/net/dns_resolver.h"
+#include "kudu/util/net/net_util.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_int32(multi_raft_heartbeat_max_batch_size);
+DECLARE_int32(multi_raft_heartbeat_window_ms);
+
+using kudu::rpc::Messenger;
+using kudu::rpc::MessengerBuilder;
+using kudu::tserver::TabletServerErrorPB;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace consensus {
+
+const char* kDestUuid = "peer-1";
+
+// A proxy which answers each batched request right away with a response
+// naming the request's tablet, or with 'error' if it is set.
+class FakeMultiRaftPeerProxy : public PeerProxy {
+ public:
+  void UpdateAsync(const ConsensusRequestPB& /*request*/,
+                   ConsensusResponsePB* /*response*/,
+                   rpc::RpcController* /*controller*/,
+                   const rpc::ResponseCallback& /*callback*/) override {
+    LOG(FATAL) << "Heartbeats should be batched";
+  }
+
+  void RequestConsensusVoteAsync(const VoteRequestPB& /*request*/,
+                                 VoteResponsePB* /*response*/,
+                                 rpc::RpcController* /*controller*/,
+                                 const rpc::ResponseCallback& callback) override {
+    callback();
+  }
+
+  void StartElectionAsync(const RunLeaderElectionRequestPB& /*request*/,
+                          RunLeaderElectionResponsePB* /*response*/,
+                          rpc::RpcController* /*controller*/,
+                          const rpc::ResponseCallback& callback) override {
+    callback();
+  }
+
+  void MultiRaftUpdateAsync(const MultiRaftConsensusRequestPB& request,
+                            MultiRaftConsensusResponsePB* response,
+                            rpc::RpcController* /*controller*/,
+                            const rpc::ResponseCallback& callback) override {
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      CHECK_EQ(kDestUuid, request.dest_uuid());
+      batch_sizes_.push_back(request.consensus_requests_size());
+      if (error_.has_code()) {
+        *response->mutable_error() = error_;
+      } else {
+        for (const auto& req : request.consensus_requests()) {
+          response->add_consensus_responses()->set_responder_uuid(req.tablet_id());
+        }
+      }
+    }
+    callback();
+  }
+
+  string PeerName() const override {
+    return "FakeMultiRaftPeerProxy";
+  }
+
+  void set_error(const TabletServerErrorPB& error) {
+    std::lock_guard<simple_spinlock> l(lock_);
+    error_ = error;
+  }
+
+  vector<int> batch_sizes() const {
+    std::lock_guard<simple_spinlock> l(lock_);
+    return batch_sizes_;
+  }
+
+ private:
+  mutable simple_spinlock lock_;
+  TabletServerErrorPB error_;
+  vector<int> batch_sizes_;
+};
+
+class MultiRaftBatcherTest : public KuduTest {
+ public:
+  void SetUp() override {
+    KuduTest::SetUp();
+    ASSERT_OK(MessengerBuilder("test").Build(&messenger_));
+    proxy_ = new FakeMultiRaftPeerProxy();
+    batcher_ = std::make_shared<MultiRaftHeartbeatBatcher>(
+        kDestUuid, HostPort("127.0.0.1", 0), unique_ptr<PeerProxy>(proxy_), messenger_);
+  }
+
+  void TearDown() override {
+    if (messenger_) {
+      messenger_->Shutdown();
+    }
+    KuduTest::TearDown();
+  }
+
+ protected:
+  // Hands a heartbeat for each of 'num_tablets' tablets to the batcher, and
+  // waits for all their callbacks to run.
+  void SendHeartbeats(int num_tablets, vector<ConsensusResponsePB>* responses) {
+    responses->clear();
+    responses->resize(num_tablets);
+    vector<Status> statuses(num_tablets);
+    CountDownLatch latch(num_tablets);
+    for (int i = 0; i < num_tablets; i++) {
+      ConsensusRequestPB req;
+      req.set_tablet_id(Substitute("tablet-$0", i));
+      req.set_caller_uuid("peer-0");
+      req.set_caller_term(1);
+      req.set_dest_uuid(kDestUuid);
+      batcher_->AddRequest(req, &(*responses)[i], [&statuses, &latch, i](const Status& s) {
+        statuses[i] = s;
+        latch.CountDown();
+      });
+    }
+    ASSERT_TRUE(latch.WaitFor(MonoDelta::FromSeconds(30)));
+    for (const auto& s : statuses) {
+      ASSERT_OK(s);
+    }
+  }
+
+  shared_ptr<Messenger> messenger_;
+  FakeMultiRaftPeerProxy* proxy_;
+  shared_ptr<MultiRaftHeartbeatBatcher> batcher_;
+};
+
+// Heartbeats handed to the batcher within its window are sent in one RPC,
+// and each gets the response to its own request.
+TEST_F(MultiRaftBatcherTest, TestCoalescesHeartbeats) {
+  FLAGS_multi_raft_heartbeat_window_ms = 1000;
+  constexpr int kNumTablets = 10;
+  vector<ConsensusResponsePB> responses;
+  NO_FATALS(SendHeartbeats(kNumTablets, &responses));
+  ASSERT_EQ(vector<int>({ kNumTablets }), proxy_->batch_sizes());
+  for (int i = 0; i < kNumTablets; i++) {
+    ASSERT_FALSE(responses[i].has_error());
+    ASSERT_EQ(Substitute("tablet-$0", i), responses[i].responder_uuid());
+  }
+}
+
+// A full batch is sent right away, without waiting for the window to close.
+TEST_F(MultiRaftBatcherTest, TestMaxBatchSize) {
+  FLAGS_multi_raft_heartbeat_window_ms = 60 * 1000;
+  FLAGS_multi_raft_heartbeat_max_batch_size = 4;
+  vector<ConsensusResponsePB> responses;
+  NO_FATALS(SendHeartbeats(8, &responses));
+  ASSERT_EQ(vector<int>({ 4, 4 }), proxy_->batch_sizes());
+}
+
+// An error affecting the whole batch is reported in the response to each of
+// its requests.
+TEST_F(MultiRaftBatcherTest, TestBatchError) {
+  TabletServerErrorPB error;
+  error.set_code(TabletServerErrorPB::WRONG_SERVER_UUID);
+  StatusToPB(Status::InvalidArgument("wrong uuid"), error.mutable_status());
+  proxy_->set_error(error);
+
+  vector<ConsensusResponsePB> responses;
+  NO_FATALS(SendHeartbeats(3, &responses));
+  for (const auto& resp : responses) {
+    ASSERT_TRUE(resp.has_error());
+    ASSERT_EQ(TabletServerErrorPB::WRONG_SERVER_UUID, resp.error().code());
+  }
+  ASSERT_TRUE(batcher_->supported());
+}
+
+// A server's batcher is shared until the server's address changes, and is
+// then replaced by one sending to the new address.
+TEST_F(MultiRaftBatcherTest, TestBatcherFollowsAddressChanges) {
+  DnsResolver dns_resolver;
+  MultiRaftManager manager(messenger_, &dns_resolver);
+  RaftPeerPB peer_pb;
+  peer_pb.set_permanent_uuid(kDestUuid);
+  peer_pb.mutable_last_known_addr()->set_host("127.0.0.1");
+  peer_pb.mutable_last_known_addr()->set_port(10000);
+
+  shared_ptr<MultiRaftHeartbeatBatcher> first;
+  shared_ptr<MultiRaftHeartbeatBatcher> second;
+  ASSERT_OK(manager.GetBatcher(peer_pb, &first));
+  ASSERT_OK(manager.GetBatcher(peer_pb, &second));
+  ASSERT_EQ(first, second);
+
+  peer_pb.mutable_last_known_addr()->set_port(10001);
+  ASSERT_OK(manager.GetBatcher(peer_pb, &second));
+  ASSERT_NE(first, second);
+  ASSERT_EQ(HostPort("127.0.0.1", 10001), second->dest_addr());
+
+  shared_ptr<MultiRaftHeartbeatBatcher> third;
+  ASSERT_OK(manager.GetBatcher(peer_pb, &third));
+  ASSERT_EQ(second, third);
+}
+
+} // namespace consensus
+} // namespace kudu
@@ -0,0 +1,241 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/consensus/multi_raft_batcher.h"
+
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "kudu/common/wire_protocol.h"
+#include "kudu/consensus/consensus.pb.h"
+#include "kudu/consensus/metadata.pb.h"
+#include "kudu/gutil/map-util.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/rpc/messenger.h"
+#include "kudu/rpc/rpc_controller.h"
+#include "kudu/rpc/rpc_header.pb.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/monotime.h"
+
+DEFINE_bool(enable_multi_raft_heartbeat_batching, false,
+            "Whether the heartbeats that Raft leaders send to idle followers "
+            "are coalesced into one MultiRaftUpdateConsensus RPC per remote "
+            "server, rather than sent as one UpdateConsensus RPC per tablet. "
+            "Requests carrying ops or a new commit index are never batched.");
+TAG_FLAG(enable_multi_raft_heartbeat_batching, experimental);
+TAG_FLAG(enable_multi_raft_heartbeat_batching, runtime);
+
+DEFINE_int32(multi_raft_heartbeat_window_ms, 50,
+             "How long a batched heartbeat may wait for other heartbeats to "
+             "the same server before the batch is sent.");
+TAG_FLAG(multi_raft_heartbeat_window_ms, experimental);
+TAG_FLAG(multi_raft_heartbeat_window_ms, runtime);
+
+DEFINE_int32(multi_raft_heartbeat_max_batch_size, 512,
+             "Maximum number of heartbeats sent in one MultiRaftUpdateConsensus "
+             "RPC.");
+TAG_FLAG(multi_raft_heartbeat_max_batch_size, experimental);
+TAG_FLAG(multi_raft_heartbeat_max_batch_size, runtime);
+
+DEFINE_int32(multi_raft_heartbeat_unsupported_retry_secs, 300,
+             "How long heartbeats to a server which doesn't support "
+             "MultiRaftUpdateConsensus are sent one tablet at a time before "
+             "batching them is tried again, in case the server was upgraded.");
+TAG_FLAG(multi_raft_heartbeat_unsupported_retry_secs, experimental);
+TAG_FLAG(multi_raft_heartbeat_unsupported_retry_secs, runtime);
+
+using kudu::rpc::ErrorStatusPB;
+using kudu::rpc::Messenger;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using std::weak_ptr;
+using strings::Substitute;
+
+namespace kudu {
+namespace consensus {
+
+struct MultiRaftHeartbeatBatcher::Batch {
+  MultiRaftConsensusRequestPB request;
+  MultiRaftConsensusResponsePB response;
+  rpc::RpcController controller;
+
+  // The destination and callback of the response to each request in
+  // 'request', in the same order.
+  vector<ConsensusResponsePB*> responses;
+  vector<StatusCallback> callbacks;
+};
+
+MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(string dest_uuid,
+                                                     HostPort dest_addr,
+                                                     unique_ptr<PeerProxy> proxy,
+                                                     shared_ptr<Messenger> messenger)
+    : dest_uuid_(std::move(dest_uuid)),
+      dest_addr_(std::move(dest_addr)),
+      proxy_(std::move(proxy)),
+      messenger_(std::move(messenger)),
+      unsupported_until_(MonoTime::Min()) {
+}
+
+void MultiRaftHeartbeatBatcher::AddRequest(const ConsensusRequestPB& request,
+                                           ConsensusResponsePB* response,
+                                           StatusCallback callback) {
+  shared_ptr<Batch> full_batch;
+  bool schedule_flush = false;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    if (!pending_) {
+      pending_ = std::make_shared<Batch>();
+      schedule_flush = true;
+    }
+    *pending_->request.add_consensus_requests() = request;
+    pending_->responses.push_back(response);
+    pending_->callbacks.emplace_back(std::move(callback));
+    if (static_cast<int>(pending_->responses.size()) >=
+        FLAGS_multi_raft_heartbeat_max_batch_size) {
+      full_batch = std::move(pending_);
+      pending_.reset();
+      schedule_flush = false;
+    }
+  }
+
+  if (full_batch) {
+    SendBatch(std::move(full_batch));
+    return;
+  }
+  if (schedule_flush) {
+    // Capture a weak_ptr reference into the functor so it can safely handle
+    // outliving the batcher. If the reactor can't run the functor, e.g.
+    // because the messenger is shutting down, the batch is still sent so that
+    // its callbacks run with the error the RPC fails with.
+    weak_ptr<MultiRaftHeartbeatBatcher> w = shared_from_this();
+    messenger_->ScheduleOnReactor(
+        [w](const Status& /*s*/) {
+          if (auto b = w.lock()) {
+            b->Flush();
+          }
+        },
+        MonoDelta::FromMilliseconds(FLAGS_multi_raft_heartbeat_window_ms));
+  }
+}
+
+void MultiRaftHeartbeatBatcher::Flush() {
+  shared_ptr<Batch> batch;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    batch = std::move(pending_);
+    pending_.reset();
+  }
+  if (batch) {
+    SendBatch(std::move(batch));
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendBatch(shared_ptr<Batch> batch) {
+  batch->request.set_dest_uuid(dest_uuid_);
+  VLOG(2) << Substitute("Sending $0 heartbeats to $1 ($2)",
+                        batch->responses.size(), dest_uuid_, proxy_->PeerName());
+
+  // Capture shared_ptr references into the RPC callback so that we're
+  // guaranteed that this object and the batch outlive the RPC.
+  shared_ptr<MultiRaftHeartbeatBatcher> s_this = shared_from_this();
+  const MultiRaftConsensusRequestPB& request = batch->request;
+  MultiRaftConsensusResponsePB* response = &batch->response;
+  rpc::RpcController* controller = &batch->controller;
+  proxy_->MultiRaftUpdateAsync(request, response, controller,
+                               [s_this, batch]() {
+                                 s_this->BatchDone(batch);
+                               });
+}
+
+void MultiRaftHeartbeatBatcher::BatchDone(const shared_ptr<Batch>& batch) {
+  Status s = batch->controller.status();
+  if (PREDICT_FALSE(!s.ok())) {
+    const ErrorStatusPB* err = batch->controller.error_response();
+    if (err && err->has_code() && err->code() == ErrorStatusPB::ERROR_NO_SUCH_METHOD) {
+      // The remote server predates MultiRaftUpdateConsensus: its peers go
+      // back to sending heartbeats one tablet at a time for a while.
+      LOG(INFO) << Substitute("Server $0 ($1) does not support batched heartbeats: $2",
+                              dest_uuid_, proxy_->PeerName(), s.ToString());
+      unsupported_until_ = MonoTime::Now() +
+          MonoDelta::FromSeconds(FLAGS_multi_raft_heartbeat_unsupported_retry_secs);
+    }
+  } else if (batch->response.has_error()) {
+    // None of the requests were handled: hand the error out to all of them.
+    for (ConsensusResponsePB* response : batch->responses) {
+      response->Clear();
+      *response->mutable_error() = batch->response.error();
+    }
+  } else if (PREDICT_FALSE(batch->response.consensus_responses_size() !=
+                           static_cast<int>(batch->responses.size()))) {
+    s = Status::RemoteError(Substitute("got $0 responses to $1 batched requests",
+                                       batch->response.consensus_responses_size(),
+                                       batch->responses.size()));
+  } else {
+    for (int i = 0; i < batch->response.consensus_responses_size(); i++) {
+      batch->responses[i]->Swap(batch->response.mutable_consensus_responses(i));
+    }
+  }
+
+  for (const auto& callback : batch->callbacks) {
+    callback(s);
+  }
+}
+
+MultiRaftManager::MultiRaftManager(shared_ptr<Messenger> messenger,
+                                   DnsResolver* dns_resolver)
+    : proxy_factory_(std::move(messenger), dns_resolver) {
+}
+
+Status MultiRaftManager::GetBatcher(const RaftPeerPB& peer_pb,
+                                    shared_ptr<MultiRaftHeartbeatBatcher>* batcher) {
+  const string& uuid = peer_pb.permanent_uuid();
+  HostPort addr = HostPortFromPB(peer_pb.last_known_addr());
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    shared_ptr<MultiRaftHeartbeatBatcher> existing = FindPtrOrNull(batchers_, uuid);
+    if (existing && existing->dest_addr() == addr) {
+      *batcher = std::move(existing);
+      return Status::OK();
+    }
+  }
+
+  // Creating the proxy may resolve the server's address, so it's done without
+  // holding 'lock_'. If another thread raced with this one for the same
+  // address, its batcher wins. Replicas still holding a replaced batcher keep
+  // using it until they fetch a new one.
+  unique_ptr<PeerProxy> proxy;
+  RETURN_NOT_OK(proxy_factory_.NewProxy(peer_pb, &proxy));
+  auto new_batcher = std::make_shared<MultiRaftHeartbeatBatcher>(
+      uuid, addr, std::move(proxy), proxy_factory_.messenger());
+  std::lock_guard<simple_spinlock> l(lock_);
+  shared_ptr<MultiRaftHeartbeatBatcher>& cur = batchers_[uuid];
+  if (!cur || !(cur->dest_addr() == addr)) {
+    cur = std::move(new_batcher);
+  }
+  *batcher = cur;
+  return Status::OK();
+}
+
+} // namespace consensus
+} // namespace kudu
@@ -0,0 +1,140 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kudu/consensus/consensus_peers.h"
+#include "kudu/gutil/macros.h"
+#include "kudu/util/locks.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/net/net_util.h"
+#include "kudu/util/status.h"
+#include "kudu/util/status_callback.h"
+
+namespace kudu {
+class DnsResolver;
+
+namespace rpc {
+class Messenger;
+} // namespace rpc
+
+namespace consensus {
+class ConsensusRequestPB;
+class ConsensusResponsePB;
+class RaftPeerPB;
+
+// Coalesces the status-only UpdateConsensus requests, i.e. the heartbeats,
+// that the Raft leaders hosted by this server send to the replicas hosted by
+// one remote server into MultiRaftUpdateConsensus RPCs.
+//
+// A heartbeat handed to the batcher is sent along with the other heartbeats
+// handed to it within the next --multi_raft_heartbeat_window_ms, or as soon as
+// --multi_raft_heartbeat_max_batch_size heartbeats are pending. On a server
+// hosting thousands of replicas this replaces thousands of tiny RPCs per
+// heartbeat period with a handful per remote server.
+//
+// This class is thread-safe.
+class MultiRaftHeartbeatBatcher :
+    public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
+ public:
+  // Heartbeats are sent to the server with UUID 'dest_uuid' at 'dest_addr'
+  // through 'proxy'.
+  MultiRaftHeartbeatBatcher(std::string dest_uuid,
+                            HostPort dest_addr,
+                            std::unique_ptr<PeerProxy> proxy,
+                            std::shared_ptr<rpc::Messenger> messenger);
+
+  // Queues 'request' to be sent with the next batch. Once the batch's RPC
+  // completes, 'callback' is run on a reactor thread with the status of the
+  // RPC; if it is OK, 'response' holds the remote replica's response.
+  // 'response' must stay alive until then.
+  void AddRequest(const ConsensusRequestPB& request,
+                  ConsensusResponsePB* response,
+                  StatusCallback callback);
+
+  // Returns false if the remote server recently turned out not to support
+  // MultiRaftUpdateConsensus, in which case heartbeats must be sent to it one
+  // replica at a time. Batching is tried again after
+  // --multi_raft_heartbeat_unsupported_retry_secs, in case the server has
+  // been upgraded since.
+  bool supported() const { return MonoTime::Now() >= unsupported_until_.load(); }
+
+  const HostPort& dest_addr() const { return dest_addr_; }
+
+ private:
+  struct Batch;
+
+  // Sends the pending heartbeats, if any.
+  void Flush();
+
+  void SendBatch(std::shared_ptr<Batch> batch);
+
+  // Dispatches the responses of 'batch' to the callbacks of its requests.
+  void BatchDone(const std::shared_ptr<Batch>& batch);
+
+  const std::string dest_uuid_;
+  const HostPort dest_addr_;
+  const std::unique_ptr<PeerProxy> proxy_;
+  const std::shared_ptr<rpc::Messenger> messenger_;
+
+  // Heartbeats aren't batched before this time.
+  std::atomic<MonoTime> unsupported_until_;
+
+  // Protects 'pending_'.
+  simple_spinlock lock_;
+
+  // The heartbeats waiting to be sent, or nullptr if there are none.
+  std::shared_ptr<Batch> pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiRaftHeartbeatBatcher);
+};
+
+// Hands out the heartbeat batcher of each remote server, creating them on
+// demand. One instance is shared by all the replicas hosted by a server.
+//
+// This class is thread-safe.
+class MultiRaftManager {
+ public:
+  MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger,
+                   DnsResolver* dns_resolver);
+
+  // Returns in 'batcher' the batcher of the server hosting 'peer_pb'. If the
+  // server's address changed since its batcher was created, the batcher is
+  // replaced by one sending to the new address.
+  Status GetBatcher(const RaftPeerPB& peer_pb,
+                    std::shared_ptr<MultiRaftHeartbeatBatcher>* batcher);
+
+ private:
+  RpcPeerProxyFactory proxy_factory_;
+
+  // Protects 'batchers_'.
+  simple_spinlock lock_;
+
+  // Batchers keyed by the permanent UUID of their remote server. Each sends to
+  // the last known address of its server when it was created.
+  std::unordered_map<std::string, std::shared_ptr<MultiRaftHeartbeatBatcher>> batchers_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiRaftManager);
+};
+
+} // namespace consensus
+} // namespace kudu
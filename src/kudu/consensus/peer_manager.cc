@@ -27,10 +27,12 @@
 #include "kudu/consensus/consensus_peers.h"
 #include "kudu/consensus/log.h"
 #include "kudu/consensus/metadata.pb.h"
+#include "kudu/consensus/multi_raft_batcher.h"
 #include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/pb_util.h"
+#include "kudu/util/status.h"
 
 using kudu::log::Log;
 using kudu::pb_util::SecureShortDebugString;
@@ -47,13 +49,15 @@ PeerManager::PeerManager(string tablet_id,
                          PeerProxyFactory* peer_proxy_factory,
                          PeerMessageQueue* queue,
                          ThreadPoolToken* raft_pool_token,
-                         scoped_refptr<log::Log> log)
+                         scoped_refptr<log::Log> log,
+                         MultiRaftManager* multi_raft_manager)
     : tablet_id_(std::move(tablet_id)),
       local_uuid_(std::move(local_uuid)),
       peer_proxy_factory_(peer_proxy_factory),
       queue_(queue),
       raft_pool_token_(raft_pool_token),
-      log_(std::move(log)) {
+      log_(std::move(log)),
+      multi_raft_manager_(multi_raft_manager) {
 }
 
 PeerManager::~PeerManager() {
@@ -78,6 +82,14 @@ Status PeerManager::UpdateRaftConfig(const RaftConfigPB& config) {
     RETURN_NOT_OK_PREPEND(peer_proxy_factory_->NewProxy(peer_pb, &peer_proxy),
                           "Could not obtain a remote proxy to the peer.");
 
+    shared_ptr<MultiRaftHeartbeatBatcher> heartbeat_batcher;
+    if (multi_raft_manager_) {
+      // Without a batcher the peer still works, sending each heartbeat on its own.
+      WARN_NOT_OK(multi_raft_manager_->GetBatcher(peer_pb, &heartbeat_batcher),
+                  Substitute("$0Could not get a heartbeat batcher for peer $1",
+                             GetLogPrefix(), peer_pb.permanent_uuid()));
+    }
+
     shared_ptr<Peer> remote_peer;
     RETURN_NOT_OK(Peer::NewRemotePeer(peer_pb,
                                       tablet_id_,
@@ -86,7 +98,8 @@ Status PeerManager::UpdateRaftConfig(const RaftConfigPB& config) {
                                       raft_pool_token_,
                                       std::move(peer_proxy),
                                       peer_proxy_factory_->messenger(),
-                                      &remote_peer));
+                                      &remote_peer,
+                                      std::move(heartbeat_batcher)));
     peers_.emplace(peer_pb.permanent_uuid(), std::move(remote_peer));
   }
 
@@ -36,6 +36,7 @@ class Log;
 
 namespace consensus {
 
+class MultiRaftManager;
 class Peer;
 class PeerMessageQueue;
 class PeerProxyFactory;
@@ -47,12 +48,16 @@ class PeerManager {
  public:
   // All of the raw pointer arguments are not owned by the PeerManager
   // and must live at least as long as the PeerManager.
+  //
+  // If 'multi_raft_manager' is not null, the peers may send their idle
+  // heartbeats through the batchers it hands out.
   PeerManager(std::string tablet_id,
               std::string local_uuid,
               PeerProxyFactory* peer_proxy_factory,
               PeerMessageQueue* queue,
               ThreadPoolToken* raft_pool_token,
-              scoped_refptr<log::Log> log);
+              scoped_refptr<log::Log> log,
+              MultiRaftManager* multi_raft_manager = nullptr);
 
   ~PeerManager();
 
@@ -78,6 +83,7 @@ class PeerManager {
   PeerMessageQueue* queue_;
   ThreadPoolToken* raft_pool_token_;
   scoped_refptr<log::Log> log_;
+  MultiRaftManager* multi_raft_manager_;
   PeersMap peers_;
   mutable simple_spinlock lock_;
 
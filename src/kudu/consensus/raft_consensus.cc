@@ -56,10 +56,13 @@
 #include "kudu/gutil/walltime.h"
 #include "kudu/rpc/periodic.h"
 #include "kudu/util/async_util.h"
+#include "kudu/util/condition_variable.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/metrics.h"
+#include "kudu/util/monotime.h"
+#include "kudu/util/mutex.h"
 #include "kudu/util/pb_util.h"
 #include "kudu/util/process_memory.h"
 #include "kudu/util/random.h"
@@ -130,6 +133,13 @@ DEFINE_bool(raft_prepare_replacement_before_eviction, true,
 TAG_FLAG(raft_prepare_replacement_before_eviction, advanced);
 TAG_FLAG(raft_prepare_replacement_before_eviction, experimental);
 
+DEFINE_int32(consensus_pipelined_request_wait_ms, 100,
+             "Maximum amount of time a follower waits for the ops preceding a "
+             "pipelined UpdateConsensus() request to be appended to its log "
+             "before handling the request anyway. Pipelined requests may "
+             "arrive ahead of the requests the leader sent before them.");
+TAG_FLAG(consensus_pipelined_request_wait_ms, advanced);
+
 DECLARE_int32(memory_limit_warn_threshold_percentage);
 
 // Metrics
@@ -185,6 +195,7 @@ RaftConsensus::RaftConsensus(
       local_peer_pb_(std::move(local_peer_pb)),
       cmeta_manager_(DCHECK_NOTNULL(std::move(cmeta_manager))),
       server_ctx_(std::move(server_ctx)),
+      appended_cond_(&appended_lock_),
       state_(kNew),
       rng_(GetRandomSeed32()),
       leader_is_ready_(false),
@@ -287,7 +298,8 @@ Status RaftConsensus::Start(const ConsensusBootstrapInfo& info,
                                                        peer_proxy_factory_.get(),
                                                        queue.get(),
                                                        raft_pool_token_.get(),
-                                                       log_));
+                                                       log_,
+                                                       server_ctx_.multi_raft_manager));
 
   unique_ptr<PendingRounds> pending(new PendingRounds(
       LogPrefixThreadSafe(), time_manager_.get()));
@@ -1068,6 +1080,17 @@ void RaftConsensus::TryStartElectionOnPeerTask(const string& peer_uuid) {
 
 Status RaftConsensus::Update(const ConsensusRequestPB* request,
                              ConsensusResponsePB* response) {
+  return DoUpdate(request, response, /*wait_if_busy=*/true);
+}
+
+Status RaftConsensus::TryUpdate(const ConsensusRequestPB* request,
+                                ConsensusResponsePB* response) {
+  return DoUpdate(request, response, /*wait_if_busy=*/false);
+}
+
+Status RaftConsensus::DoUpdate(const ConsensusRequestPB* request,
+                               ConsensusResponsePB* response,
+                               bool wait_if_busy) {
   ++update_calls_for_tests_;
 
   if (PREDICT_FALSE(FLAGS_follower_reject_update_consensus_requests)) {
@@ -1079,9 +1102,37 @@ Status RaftConsensus::Update(const ConsensusRequestPB* request,
 
   VLOG_WITH_PREFIX(2) << "Replica received request: " << SecureShortDebugString(*request);
 
-  // see var declaration
-  std::lock_guard<simple_spinlock> lock(update_lock_);
-  Status s = UpdateReplica(request, response);
+  // A pipelined request may overtake the request sent just before it. Give
+  // the earlier request a chance to append its ops so that this one does not
+  // fail the log matching check and force the leader to resend. Callers that
+  // can't wait get the log matching error instead.
+  if (wait_if_busy && request->pipelined() && request->has_preceding_id()) {
+    const int64_t preceding_index = request->preceding_id().index();
+    const MonoTime deadline = MonoTime::Now() +
+        MonoDelta::FromMilliseconds(FLAGS_consensus_pipelined_request_wait_ms);
+    MutexLock l(appended_lock_);
+    while (queue_->GetLastOpIdInLog().index() < preceding_index) {
+      if (!appended_cond_.WaitUntil(deadline)) {
+        break;
+      }
+    }
+  }
+
+  Status s;
+  {
+    // see var declaration
+    std::unique_lock<simple_spinlock> lock(update_lock_, std::defer_lock);
+    if (wait_if_busy) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      return Status::ServiceUnavailable("replica is busy handling another update");
+    }
+    s = UpdateReplica(request, response);
+  }
+  {
+    MutexLock l(appended_lock_);
+    appended_cond_.Broadcast();
+  }
   if (PREDICT_FALSE(VLOG_IS_ON(1))) {
     if (request->ops().empty()) {
       VLOG_WITH_PREFIX(1)
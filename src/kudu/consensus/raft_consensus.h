@@ -42,10 +42,12 @@
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/tablet/metadata.pb.h"
 #include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/condition_variable.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/make_shared.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
+#include "kudu/util/mutex.h"
 #include "kudu/util/random.h"
 #include "kudu/util/status_callback.h"
 
@@ -67,6 +69,7 @@ namespace consensus {
 class ConsensusMetadataManager;
 class ConsensusRound;
 class ConsensusRoundHandler;
+class MultiRaftManager;
 class PeerManager;
 class PeerProxyFactory;
 class PendingRounds;
@@ -86,6 +89,10 @@ struct ServerContext {
 
   // Threadpool on which to run Raft tasks.
   ThreadPool* raft_pool;
+
+  // Hands out the batchers coalescing the heartbeats sent to each remote
+  // server. If null, heartbeats are sent one tablet at a time.
+  MultiRaftManager* multi_raft_manager;
 };
 
 struct ConsensusOptions {
@@ -285,6 +292,14 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   Status Update(const ConsensusRequestPB* request,
                 ConsensusResponsePB* response);
 
+  // Like Update(), but if this replica is busy handling another update,
+  // returns Status::ServiceUnavailable() right away rather than waiting for
+  // it. Used for heartbeats batched with those of other replicas, so that a
+  // slow replica doesn't hold up the others: its leader just retries with
+  // the next heartbeat.
+  Status TryUpdate(const ConsensusRequestPB* request,
+                   ConsensusResponsePB* response);
+
   // Messages sent from CANDIDATEs to voting peers to request their vote
   // in leader election.
   //
@@ -361,6 +376,11 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
     return update_calls_for_tests_;
   }
 
+  // Lets tests make this replica look busy handling an update.
+  simple_spinlock* update_lock_for_tests() {
+    return &update_lock_;
+  }
+
   //------------------------------------------------------------
   // PeerMessageQueueObserver implementation
   //------------------------------------------------------------
@@ -511,6 +531,11 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   // 'lock_' must be held for configuration change before calling.
   Status BecomeReplicaUnlocked(boost::optional<MonoDelta> fd_delta = boost::none);
 
+  // Implements Update() and TryUpdate().
+  Status DoUpdate(const ConsensusRequestPB* request,
+                  ConsensusResponsePB* response,
+                  bool wait_if_busy);
+
   // Updates the state in a replica by storing the received operations in the log
   // and triggering the required ops. This method won't return until all
   // operations have been stored in the log and all Prepares() have been completed,
@@ -853,6 +878,12 @@ class RaftConsensus : public std::enable_shared_from_this<RaftConsensus>,
   // 'update_lock_' lock must be taken first.
   mutable simple_spinlock update_lock_;
 
+  // Signalled whenever an Update() call finishes, so that a pipelined request
+  // that arrived ahead of its predecessor can wait for the predecessor's ops
+  // to be appended rather than being rejected with a log matching error.
+  Mutex appended_lock_;
+  ConditionVariable appended_cond_;
+
   // Coarse-grained lock that protects all mutable data members.
   mutable simple_spinlock lock_;
 
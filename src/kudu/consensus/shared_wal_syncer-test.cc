@@ -0,0 +1,155 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/consensus/shared_wal_syncer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "kudu/util/env.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_double(env_inject_eio);
+DECLARE_string(env_inject_eio_globs);
+
+using std::shared_ptr;
+using std::string;
+using std::thread;
+using std::unique_ptr;
+using std::vector;
+
+namespace kudu {
+namespace log {
+
+class SharedWalSyncerTest : public KuduTest {
+ protected:
+  // Creates a syncer for a new WAL root at 'root'. Returns false if
+  // filesystem syncs aren't supported, in which case the test should be
+  // skipped.
+  bool CreateSyncer(const string& root, unique_ptr<SharedWalSyncer>* syncer) {
+    CHECK_OK(env_->CreateDir(root));
+    unique_ptr<FilesystemSyncer> fs_syncer;
+    Status s = env_->NewFilesystemSyncer(root, &fs_syncer);
+    if (s.IsNotSupported()) {
+      LOG(WARNING) << "Skipping test: " << s.ToString();
+      return false;
+    }
+    CHECK_OK(s);
+    syncer->reset(new SharedWalSyncer(root, std::move(fs_syncer)));
+    return true;
+  }
+};
+
+TEST_F(SharedWalSyncerTest, TestSyncerIsSharedPerWalRoot) {
+  const string root_a = GetTestPath("a");
+  const string root_b = GetTestPath("b");
+  ASSERT_OK(env_->CreateDir(root_a));
+  ASSERT_OK(env_->CreateDir(root_b));
+  shared_ptr<SharedWalSyncer> syncer_a;
+  Status s = SharedWalSyncer::GetForWalRoot(env_, root_a, &syncer_a);
+  if (!env_->IsFilesystemSyncSupported()) {
+    // The flag validator refuses --log_group_fsync in this case, but the
+    // syncer must refuse to be created too.
+    ASSERT_TRUE(s.IsNotSupported()) << s.ToString();
+    return;
+  }
+  ASSERT_OK(s);
+  shared_ptr<SharedWalSyncer> syncer;
+  ASSERT_OK(SharedWalSyncer::GetForWalRoot(env_, root_a, &syncer));
+  ASSERT_EQ(syncer_a, syncer);
+  ASSERT_OK(SharedWalSyncer::GetForWalRoot(env_, root_b, &syncer));
+  ASSERT_NE(syncer_a, syncer);
+}
+
+// Concurrent syncs from many logs are coalesced into fewer filesystem syncs.
+TEST_F(SharedWalSyncerTest, TestConcurrentSyncsAreCoalesced) {
+  unique_ptr<SharedWalSyncer> syncer;
+  if (!CreateSyncer(GetTestPath("wals"), &syncer)) {
+    return;
+  }
+  ASSERT_OK(syncer->Sync());
+  ASSERT_EQ(1, syncer->num_syncs());
+
+  constexpr int kNumThreads = 16;
+  constexpr int kSyncsPerThread = 20;
+  std::atomic<int> num_failed(0);
+  vector<thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kSyncsPerThread; j++) {
+        if (!syncer->Sync().ok()) {
+          num_failed++;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(0, num_failed);
+  const int64_t num_syncs = syncer->num_syncs() - 1;
+  LOG(INFO) << kNumThreads * kSyncsPerThread << " syncs took " << num_syncs
+            << " filesystem syncs";
+  ASSERT_GT(num_syncs, 0);
+  ASSERT_LE(num_syncs, kNumThreads * kSyncsPerThread);
+}
+
+// A writeback error of the WAL filesystem is returned to every log waiting on
+// the sync, and to all later syncs, even once the filesystem recovers.
+TEST_F(SharedWalSyncerTest, TestSyncErrorsArePropagated) {
+  const string root = GetTestPath("wals");
+  unique_ptr<SharedWalSyncer> syncer;
+  if (!CreateSyncer(root, &syncer)) {
+    return;
+  }
+  ASSERT_OK(syncer->Sync());
+
+  FLAGS_env_inject_eio_globs = root;
+  FLAGS_env_inject_eio = 1.0;
+  constexpr int kNumThreads = 8;
+  std::atomic<int> num_io_errors(0);
+  vector<thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      if (syncer->Sync().IsIOError()) {
+        num_io_errors++;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(kNumThreads, num_io_errors);
+
+  FLAGS_env_inject_eio = 0;
+  Status s = syncer->Sync();
+  ASSERT_TRUE(s.IsIOError()) << s.ToString();
+  ASSERT_STR_CONTAINS(s.ToString(), Env::kInjectedFailureStatusMsg);
+}
+
+} // namespace log
+} // namespace kudu
@@ -0,0 +1,109 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/consensus/shared_wal_syncer.h"
+
+#include <map>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "kudu/gutil/map-util.h"
+#include "kudu/gutil/port.h"
+#include "kudu/util/debug/trace_event.h"
+#include "kudu/util/env.h"
+
+using std::map;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+
+namespace kudu {
+namespace log {
+
+Status SharedWalSyncer::GetForWalRoot(Env* env,
+                                      const string& wal_root,
+                                      shared_ptr<SharedWalSyncer>* syncer) {
+  static std::mutex registry_lock;
+  static map<string, shared_ptr<SharedWalSyncer>>* registry =
+      new map<string, shared_ptr<SharedWalSyncer>>();
+  std::lock_guard<std::mutex> l(registry_lock);
+  shared_ptr<SharedWalSyncer>* existing = FindOrNull(*registry, wal_root);
+  if (existing) {
+    *syncer = *existing;
+    return Status::OK();
+  }
+  unique_ptr<FilesystemSyncer> fs_syncer;
+  RETURN_NOT_OK_PREPEND(env->NewFilesystemSyncer(wal_root, &fs_syncer),
+                        "unable to sync the WAL filesystem");
+  *syncer = std::make_shared<SharedWalSyncer>(wal_root, std::move(fs_syncer));
+  InsertOrDie(registry, wal_root, *syncer);
+  return Status::OK();
+}
+
+SharedWalSyncer::SharedWalSyncer(string wal_root, unique_ptr<FilesystemSyncer> fs_syncer)
+    : wal_root_(std::move(wal_root)),
+      fs_syncer_(std::move(fs_syncer)) {
+}
+
+SharedWalSyncer::~SharedWalSyncer() {
+}
+
+Status SharedWalSyncer::Sync() {
+  std::unique_lock<std::mutex> l(lock_);
+  const int64_t ticket = next_ticket_++;
+  while (true) {
+    RETURN_NOT_OK(error_);
+    if (synced_through_ticket_ >= ticket) {
+      return Status::OK();
+    }
+    if (!sync_in_progress_) {
+      break;
+    }
+    // A sync is running, but it may have started before our writes completed.
+    // Wait for it and check again.
+    cond_.wait(l);
+  }
+
+  // Become the leader of a sync covering every ticket taken so far.
+  sync_in_progress_ = true;
+  const int64_t sync_through_ticket = next_ticket_ - 1;
+  num_syncs_++;
+  l.unlock();
+
+  Status s;
+  {
+    TRACE_EVENT1("log", "SharedWalSyncer::Sync", "wal_root", wal_root_);
+    s = fs_syncer_->Sync();
+  }
+
+  l.lock();
+  sync_in_progress_ = false;
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG(ERROR) << "Failed to sync WAL filesystem of " << wal_root_ << ": " << s.ToString();
+    if (error_.ok()) {
+      error_ = s;
+    }
+  } else {
+    synced_through_ticket_ = sync_through_ticket;
+  }
+  cond_.notify_all();
+  return error_;
+}
+
+} // namespace log
+} // namespace kudu
@@ -0,0 +1,106 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "kudu/gutil/macros.h"
+#include "kudu/util/status.h"
+
+namespace kudu {
+
+class Env;
+class FilesystemSyncer;
+
+namespace log {
+
+// Makes the appends of all the tablet logs sharing a WAL root durable with
+// group commits of the whole WAL filesystem, rather than with one fsync() per
+// log segment.
+//
+// With many tablets per tablet server and --log_force_fsync_all, each log's
+// append thread otherwise issues its own small fsync() after every group of
+// appends. Instead, a log waiting on Sync() either starts a syncfs(2) of the
+// WAL filesystem, or, if one is already running, waits for it and then for
+// a next one which covers its writes. All the logs waiting in the meantime
+// share that next sync, so the sync rate is bounded by the device's sync
+// latency rather than by the number of tablets.
+//
+// Since syncfs(2) flushes everything written to the filesystem, this is best
+// used when the WAL root is on a filesystem of its own. It is only supported
+// where syncfs(2) reports writeback errors; see
+// Env::IsFilesystemSyncSupported().
+//
+// This class is thread-safe.
+class SharedWalSyncer {
+ public:
+  // Returns the syncer shared by the logs under 'wal_root' in 'syncer',
+  // creating it if necessary. Once created, a syncer lives as long as the
+  // process, so that it reports any writeback error of the WAL filesystem
+  // from then on.
+  static Status GetForWalRoot(Env* env,
+                              const std::string& wal_root,
+                              std::shared_ptr<SharedWalSyncer>* syncer) WARN_UNUSED_RESULT;
+
+  // Creates a syncer of the WAL filesystem of 'wal_root', which is synced
+  // with 'fs_syncer'.
+  SharedWalSyncer(std::string wal_root, std::unique_ptr<FilesystemSyncer> fs_syncer);
+
+  ~SharedWalSyncer();
+
+  // Blocks until all writes to the WAL filesystem which completed before the
+  // call are durable.
+  //
+  // Once a sync fails, this and all subsequent calls return the error: the
+  // state of data whose writeback failed is unknown.
+  Status Sync();
+
+  // Returns the number of filesystem syncs issued.
+  int64_t num_syncs() const {
+    std::lock_guard<std::mutex> l(lock_);
+    return num_syncs_;
+  }
+
+ private:
+  const std::string wal_root_;
+
+  // Opened before any of the writes this syncer is used for, so that it
+  // reports all of their writeback errors.
+  const std::unique_ptr<FilesystemSyncer> fs_syncer_;
+
+  mutable std::mutex lock_;
+  std::condition_variable cond_;
+
+  // Each call to Sync() takes the next ticket. A sync started once tickets up
+  // to N were taken makes the writes of all those callers durable.
+  int64_t next_ticket_ = 1;
+  int64_t synced_through_ticket_ = 0;
+  bool sync_in_progress_ = false;
+  int64_t num_syncs_ = 0;
+
+  // The error of the first failed sync, if any.
+  Status error_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedWalSyncer);
+};
+
+} // namespace log
+} // namespace kudu
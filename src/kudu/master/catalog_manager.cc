@@ -128,6 +128,7 @@
 #include "kudu/tserver/tserver_admin.pb.h"
 #include "kudu/tserver/tserver_admin.proxy.h"
 #include "kudu/util/cache_metrics.h"
+#include "kudu/util/compression/compression_codec.h"
 #include "kudu/util/condition_variable.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/fault_injection.h"
@@ -1507,10 +1508,57 @@ Status ValidateClientSchema(const optional<string>& name,
     if (!s.ok()) {
       return s.CloneAndPrepend(Substitute("invalid encoding for column '$0'", col.name()));
     }
+
+    // Check that the compression level is valid for the codec. The level is
+    // otherwise first checked when the column is flushed, and a bad one would
+    // fail every flush and compaction of the column.
+    s = ValidateCompressionLevel(col.attributes().compression,
+                                 col.attributes().compression_level);
+    if (!s.ok()) {
+      return s.CloneAndPrepend(Substitute("invalid compression level for column '$0'",
+                                          col.name()));
+    }
+  }
+  return Status::OK();
+}
+
+// Validate that the TTL column of the table's extra configuration, if any, is
+// a UNIXTIME_MICROS column of 'schema'. Tablets would otherwise silently
+// ignore the TTL.
+Status ValidateTtlColumn(const TableExtraConfigPB& extra_config, const Schema& schema) {
+  if (!extra_config.has_ttl_column()) {
+    return Status::OK();
+  }
+  const string& name = extra_config.ttl_column();
+  int col_idx = schema.find_column(name);
+  if (col_idx == Schema::kColumnNotFound) {
+    return Status::InvalidArgument(Substitute("TTL column '$0' does not exist", name));
+  }
+  const ColumnSchema& col = schema.column(col_idx);
+  if (col.type_info()->type() != UNIXTIME_MICROS) {
+    return Status::InvalidArgument(Substitute(
+        "TTL column '$0' must be of type UNIXTIME_MICROS, not $1",
+        name, col.type_info()->name()));
   }
   return Status::OK();
 }
 
+// Returns the name that the column 'name' has after applying 'steps', which
+// may rename it.
+string ColumnNameAfterAlter(const vector<AlterTableRequestPB::Step>& steps, string name) {
+  for (const auto& step : steps) {
+    if (step.type() == AlterTableRequestPB::RENAME_COLUMN &&
+        step.rename_column().old_name() == name) {
+      name = step.rename_column().new_name();
+    } else if (step.type() == AlterTableRequestPB::ALTER_COLUMN &&
+               step.alter_column().delta().name() == name &&
+               step.alter_column().delta().has_new_name()) {
+      name = step.alter_column().delta().new_name();
+    }
+  }
+  return name;
+}
+
 } // anonymous namespace
 
 // Create a new table.
@@ -1705,6 +1753,8 @@ Status CatalogManager::CreateTable(const CreateTableRequestPB* orig_req,
   // Verify the table's extra configuration properties.
   TableExtraConfigPB extra_config_pb;
   RETURN_NOT_OK(ExtraConfigPBFromPBMap(req.extra_configs(), &extra_config_pb));
+  RETURN_NOT_OK(SetupError(ValidateTtlColumn(extra_config_pb, schema),
+                           resp, MasterErrorPB::INVALID_SCHEMA));
 
   scoped_refptr<TableInfo> table;
   {
@@ -2727,6 +2777,17 @@ Status CatalogManager::AlterTable(const AlterTableRequestPB& req,
                                          l.mutable_data()->pb.mutable_extra_config()));
   }
 
+  // The TTL column follows renames, unless the request also names a new one.
+  // Dropping it requires unsetting the TTL column, possibly in the same request.
+  const TableExtraConfigPB& extra_config = l.mutable_data()->pb.extra_config();
+  if (extra_config.has_ttl_column() &&
+      extra_config.ttl_column() == l.data().pb.extra_config().ttl_column()) {
+    l.mutable_data()->pb.mutable_extra_config()->set_ttl_column(
+        ColumnNameAfterAlter(alter_schema_steps, extra_config.ttl_column()));
+  }
+  RETURN_NOT_OK(SetupError(ValidateTtlColumn(extra_config, new_schema),
+                           resp, MasterErrorPB::INVALID_SCHEMA));
+
   // Set to true if columns are altered, added or dropped.
   bool has_schema_changes = !alter_schema_steps.empty();
   // Set to true if there are schema changes, the table is renamed, the owner changed,
@@ -738,8 +738,10 @@ typedef ::testing::Types<NumTypeRowOps<KeyTypeWrapper<INT8, BIT_SHUFFLE>>,
                          // NumTypeRowOps<KeyTypeWrapper<INT128, RLE>>,
                          NumTypeRowOps<KeyTypeWrapper<FLOAT, BIT_SHUFFLE>>,
                          NumTypeRowOps<KeyTypeWrapper<FLOAT, PLAIN_ENCODING>>,
+                         NumTypeRowOps<KeyTypeWrapper<FLOAT, ALP>>,
                          NumTypeRowOps<KeyTypeWrapper<DOUBLE, BIT_SHUFFLE>>,
                          NumTypeRowOps<KeyTypeWrapper<DOUBLE, PLAIN_ENCODING>>,
+                         NumTypeRowOps<KeyTypeWrapper<DOUBLE, ALP>>,
                          SliceTypeRowOps<KeyTypeWrapper<STRING, DICT_ENCODING>>,
                          SliceTypeRowOps<KeyTypeWrapper<STRING, PLAIN_ENCODING>>,
                          SliceTypeRowOps<KeyTypeWrapper<STRING, PREFIX_ENCODING>>,
@@ -15,6 +15,7 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -28,6 +29,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/gutil/endian.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/concurrent_btree.h"
@@ -37,8 +39,10 @@
 #include "kudu/util/hexdump.h"
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/memory/overwrite.h"
+#include "kudu/util/random.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
 using std::string;
@@ -181,6 +185,28 @@ struct RacyTraits : public SmallFanoutTraits {
   static const size_t kDebugRaciness = 100;
 };
 
+// Small fanout, with key slots wide enough that the test keys are a mix
+// of inline keys and indirect keys with an inline prefix.
+struct WideKeySlotTraits : public BTreeTraits {
+  static const size_t kInternalNodeSize = 140;
+  static const size_t kLeafNodeSize = 140;
+  static const size_t kKeySlotSize = 16;
+};
+
+struct RacyWideKeySlotTraits : public WideKeySlotTraits {
+  static const size_t kDebugRaciness = 100;
+};
+
+TEST_F(TestCBTree, TestWideKeySlotNodeSizes) {
+  ThreadSafeArena arena(1024);
+
+  LeafNode<WideKeySlotTraits> lnode(false);
+  ASSERT_LE(sizeof(lnode), static_cast<size_t>(WideKeySlotTraits::kLeafNodeSize));
+
+  InternalNode<WideKeySlotTraits> inode(Slice("split"), &lnode, &lnode, &arena);
+  ASSERT_LE(sizeof(inode), static_cast<size_t>(WideKeySlotTraits::kInternalNodeSize));
+}
+
 void MakeKey(char *kbuf, size_t len, int i) {
   snprintf(kbuf, len, "key_%d%d", i % 10, i / 10);
 }
@@ -434,6 +460,15 @@ TEST_F(TestCBTree, TestRacyConcurrentInsert) {
   DoTestConcurrentInsert<RacyTraits>();
 }
 
+// Same, but with key slots that keep a prefix of indirect keys inline.
+TEST_F(TestCBTree, TestConcurrentInsertWideKeySlots) {
+  DoTestConcurrentInsert<WideKeySlotTraits>();
+}
+
+TEST_F(TestCBTree, TestRacyConcurrentInsertWideKeySlots) {
+  DoTestConcurrentInsert<RacyWideKeySlotTraits>();
+}
+
 template<class TraitsClass>
 void TestCBTree::DoTestConcurrentInsert() {
   unique_ptr<CBTree<TraitsClass>> tree;
@@ -888,6 +923,105 @@ TEST_F(TestCBTree, TestIteratorSeekAtOrBefore) {
   }
 }
 
+// Test that ordering is preserved when keys straddle the boundary between
+// inline keys and indirect keys, and share the prefix kept in the key slot.
+TEST_F(TestCBTree, TestWideKeySlotOrdering) {
+  CBTree<WideKeySlotTraits> t;
+  vector<string> keys;
+  for (int len = 0; len < 40; len++) {
+    string key(len, 'x');
+    keys.push_back(key);
+    if (len > 0) {
+      key[len - 1] = 'a';
+      keys.push_back(key);
+      key[len - 1] = 'z';
+      keys.push_back(key);
+      key[0] = '\0';
+      keys.push_back(key);
+    }
+  }
+  std::random_shuffle(keys.begin(), keys.end());
+  for (const string& key : keys) {
+    ASSERT_TRUE(t.Insert(Slice(key), Slice("val")));
+  }
+  for (const string& key : keys) {
+    ASSERT_FALSE(t.Insert(Slice(key), Slice("dup"))) << key;
+    NO_FATALS(VerifyGet(t, Slice(key), Slice("val")));
+  }
+
+  std::sort(keys.begin(), keys.end());
+  unique_ptr<CBTreeIterator<WideKeySlotTraits>> iter(t.NewIterator());
+  bool exact;
+  ASSERT_TRUE(iter->SeekAtOrAfter(Slice(""), &exact));
+  for (const string& key : keys) {
+    ASSERT_TRUE(iter->IsValid());
+    Slice k, v;
+    iter->GetCurrentEntry(&k, &v);
+    ASSERT_EQ(key, k.ToString());
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->IsValid());
+}
+
+template<size_t KEY_SLOT_SIZE, size_t LEAF_NODE_SIZE>
+struct BenchmarkTraits : public BTreeTraits {
+  static const size_t kKeySlotSize = KEY_SLOT_SIZE;
+  static const size_t kLeafNodeSize = LEAF_NODE_SIZE;
+};
+
+template<class Traits>
+void BenchmarkInsertAndGet(const string& desc, const vector<string>& keys) {
+  CBTree<Traits> tree;
+  LOG_TIMING(INFO, Substitute("$0: insert $1 keys", desc, keys.size())) {
+    for (const string& key : keys) {
+      tree.Insert(Slice(key), Slice("val"));
+    }
+  }
+  LOG_TIMING(INFO, Substitute("$0: get $1 keys", desc, keys.size())) {
+    char vbuf[64];
+    for (const string& key : keys) {
+      size_t len = sizeof(vbuf);
+      CHECK_EQ(CBTree<Traits>::GET_SUCCESS, tree.GetCopy(Slice(key), vbuf, &len));
+    }
+  }
+  LOG(INFO) << Substitute("$0: $1 bytes per key", desc,
+                          tree.estimate_memory_usage() / keys.size());
+}
+
+// Compare the default key slots with wider ones, for 8-byte keys (like an
+// encoded INT64 primary key) and for 22-byte keys (like a STRING+INT64
+// composite key, with long shared prefixes).
+TEST_F(TestCBTree, TestKeySlotSizePerformance) {
+#ifndef NDEBUG
+  int n_keys = 10000;
+#else
+  int n_keys = 1000000;
+#endif
+  if (AllowSlowTests()) {
+    n_keys = 4000000;
+  }
+  Random rng(SeedRandom());
+  for (bool wide_keys : { false, true }) {
+    vector<string> keys;
+    keys.reserve(n_keys);
+    for (int i = 0; i < n_keys; i++) {
+      uint64_t v = rng.Next64();
+      faststring key;
+      if (wide_keys) {
+        key.append(StringPrintf("tenant-%05d", static_cast<int>(v % 64)));
+        key.append("\0\0", 2);
+      }
+      uint64_t v_be = BigEndian::FromHost64(v);
+      key.append(&v_be, sizeof(v_be));
+      keys.emplace_back(key.ToString());
+    }
+    const string kind = wide_keys ? "22-byte keys" : "8-byte keys";
+    BenchmarkInsertAndGet<BTreeTraits>(kind + ", 8-byte slots", keys);
+    BenchmarkInsertAndGet<BenchmarkTraits<16, 512>>(kind + ", 16-byte slots", keys);
+    BenchmarkInsertAndGet<BenchmarkTraits<24, 512>>(kind + ", 24-byte slots", keys);
+  }
+}
+
 } // namespace btree
 } // namespace tablet
 } // namespace kudu
@@ -58,6 +58,7 @@
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 
+DECLARE_bool(consult_zone_maps);
 DECLARE_int32(cfile_default_block_size);
 
 using std::shared_ptr;
@@ -254,7 +255,15 @@ class TestCFileSet : public KuduRowSetTest {
                            size_t col_idx,
                            ColumnBlock *cb) {
     SelectionVector sel(cb->nrows());
-    ColumnMaterializationContext ctx(col_idx, nullptr, cb, &sel);
+    sel.SetAllTrue();
+    return MaterializeColumn(iter, col_idx, cb, &sel);
+  }
+
+  Status MaterializeColumn(CFileSet::Iterator *iter,
+                           size_t col_idx,
+                           ColumnBlock *cb,
+                           SelectionVector *sel) {
+    ColumnMaterializationContext ctx(col_idx, nullptr, cb, sel);
     return iter->MaterializeColumn(&ctx);
   }
 
@@ -265,9 +274,8 @@ class TestCFileSet : public KuduRowSetTest {
     return attr;
   }
 
-  static const int kRatio[];
-
  protected:
+  static const int kRatio[];
   static const int32_t kNoBound;
   google::FlagSaver saver;
 };
@@ -358,6 +366,60 @@ TEST_F(TestCFileSet, TestPartiallyMaterialize) {
   ASSERT_LT(stats[1].cells_read, kNumRows * 3 / 4);
 }
 
+// Tests that values of rows which are already deselected aren't needed to
+// materialize the selected rows correctly, even when whole data blocks are
+// skipped in the middle of a batch.
+TEST_F(TestCFileSet, TestSkipDeselectedRows) {
+  const int kNumRows = 100000;
+  const int kBatchSize = 1000;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
+                           nullptr, &fileset));
+
+  unique_ptr<CFileSet::Iterator> iter(fileset->NewIterator(&schema_, nullptr));
+  ASSERT_OK(iter->Init(nullptr));
+
+  Arena arena(4096);
+  RowBlock block(&schema_, kBatchSize, &arena);
+  rowid_t row_idx = 0;
+  while (iter->HasNext()) {
+    arena.Reset();
+
+    size_t n = block.nrows();
+    ASSERT_OK_FAST(iter->PrepareBatch(&n));
+    block.Resize(n);
+
+    // Select only the first and last few rows of each batch, and no rows at
+    // all in every third batch.
+    const bool skip_batch = (row_idx / kBatchSize) % 3 == 1;
+    SelectionVector* sel = block.selection_vector();
+    sel->SetAllFalse();
+    for (int i = 0; i < n && !skip_batch; i++) {
+      if (i < 10 || i >= n - 10) {
+        sel->SetRowSelected(i);
+      }
+    }
+    const size_t num_selected = sel->CountSelected();
+
+    for (int col_idx = 0; col_idx < schema_.num_columns(); col_idx++) {
+      ColumnBlock col(block.column_block(col_idx));
+      ASSERT_OK_FAST(MaterializeColumn(iter.get(), col_idx, &col, sel));
+      for (int i = 0; i < n; i++) {
+        if (!sel->IsRowSelected(i)) continue;
+        int32_t got = *reinterpret_cast<const int32_t *>(col.cell_ptr(i));
+        ASSERT_EQ((row_idx + i) * kRatio[col_idx], got) << "at row index " << (row_idx + i);
+      }
+    }
+    ASSERT_EQ(num_selected, sel->CountSelected());
+
+    ASSERT_OK_FAST(iter->FinishBatch());
+    row_idx += n;
+  }
+  ASSERT_EQ(kNumRows, row_idx);
+}
+
 TEST_F(TestCFileSet, TestIteratePartialSchema) {
   const int kNumRows = 100;
   WriteTestRowSet(kNumRows);
@@ -472,6 +534,57 @@ TEST_F(TestCFileSet, TestRangePredicates2) {
   DoTestRangeScan(fileset, kNumRows * 10, kNoBound);
 }
 
+// Test that the per-block zone maps deselect the rows of blocks which cannot
+// match a predicate on a non-key column.
+TEST_F(TestCFileSet, TestZoneMapPruning) {
+  const int kNumRows = 10000;
+  WriteTestRowSet(kNumRows);
+
+  shared_ptr<CFileSet> fileset;
+  ASSERT_OK(CFileSet::Open(rowset_meta_, MemTracker::GetRootTracker(), MemTracker::GetRootTracker(),
+                           nullptr, &fileset));
+
+  // Returns the number of rows left selected after zone map pruning, for a
+  // range predicate on column 'c1'.
+  auto count_selected = [&](int32_t lower, int32_t upper, int* selected) -> Status {
+    unique_ptr<CFileSet::Iterator> iter(fileset->NewIterator(&schema_, nullptr));
+    ScanSpec spec;
+    spec.AddPredicate(ColumnPredicate::Range(schema_.column(1), &lower, &upper));
+    RETURN_NOT_OK(iter->Init(&spec));
+
+    *selected = 0;
+    while (iter->HasNext()) {
+      size_t n = 100;
+      RETURN_NOT_OK(iter->PrepareBatch(&n));
+      SelectionVector sel(n);
+      RETURN_NOT_OK(iter->InitializeSelectionVector(&sel));
+      RETURN_NOT_OK(iter->DeselectRowsExcludedByZoneMaps(&sel));
+      *selected += sel.CountSelected();
+      RETURN_NOT_OK(iter->FinishBatch());
+    }
+    return Status::OK();
+  };
+
+  // Column 'c1' holds the row index * 10.
+  const int32_t kC1Ratio = 10;
+
+  // Rows 1000 through 1009 match. They should all be kept, along with no more
+  // than the couple of blocks that contain them.
+  int selected;
+  ASSERT_OK(count_selected(1000 * kC1Ratio, 1010 * kC1Ratio, &selected));
+  ASSERT_GE(selected, 10);
+  ASSERT_LT(selected, kNumRows / 10);
+
+  // A range entirely outside of the data is excluded by the file-level zone map.
+  ASSERT_OK(count_selected(kNumRows * kC1Ratio, kNumRows * kC1Ratio * 2, &selected));
+  ASSERT_EQ(0, selected);
+
+  // With zone maps disabled, nothing is pruned.
+  FLAGS_consult_zone_maps = false;
+  ASSERT_OK(count_selected(1000 * kC1Ratio, 1010 * kC1Ratio, &selected));
+  ASSERT_EQ(kNumRows, selected);
+}
+
 TEST_F(TestCFileSet, TestBloomFilterPredicates) {
   const int kNumRows = 100;
   Arena arena(1024);
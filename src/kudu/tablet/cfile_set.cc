@@ -30,8 +30,10 @@
 #include <glog/logging.h>
 
 #include "kudu/cfile/bloomfile.h"
+#include "kudu/cfile/cfile.pb.h"
 #include "kudu/cfile/cfile_reader.h"
 #include "kudu/cfile/cfile_util.h"
+#include "kudu/cfile/zone_map.h"
 #include "kudu/common/column_materialization_context.h"
 #include "kudu/common/columnblock.h"
 #include "kudu/common/encoded_key.h"
@@ -52,6 +54,7 @@
 #include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/rowset.h"
 #include "kudu/tablet/rowset_metadata.h"
+#include "kudu/util/bloom_filter.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/slice.h"
@@ -60,6 +63,12 @@
 DEFINE_bool(consult_bloom_filters, true, "Whether to consult bloom filters on row presence checks");
 TAG_FLAG(consult_bloom_filters, hidden);
 
+DEFINE_bool(consult_zone_maps, true,
+            "Whether scans should consult the zone maps (per-block min/max/null-count "
+            "statistics) of predicated columns to skip data that cannot match");
+TAG_FLAG(consult_zone_maps, runtime);
+TAG_FLAG(consult_zone_maps, advanced);
+
 DECLARE_bool(rowset_metadata_store_keys);
 
 namespace kudu {
@@ -68,12 +77,15 @@ class MemTracker;
 
 namespace tablet {
 
+using cfile::BlockZoneMapsPB;
 using cfile::BloomFileReader;
 using cfile::CFileIterator;
 using cfile::CFileReader;
 using cfile::ColumnIterator;
 using cfile::ReaderOptions;
 using cfile::DefaultColumnValueIterator;
+using cfile::ZoneMapMayMatch;
+using cfile::ZoneMapPB;
 using fs::IOContext;
 using fs::ReadableBlock;
 using std::shared_ptr;
@@ -334,6 +346,68 @@ Status CFileSet::CheckRowPresent(const RowSetKeyProbe& probe, const IOContext* i
   return Status::OK();
 }
 
+Status CFileSet::CheckRowsPresent(const RowSetKeyProbe* const* probes,
+                                  int num_probes,
+                                  const IOContext* io_context,
+                                  bool* present,
+                                  rowid_t* rowids,
+                                  ProbeStats* const* stats) const {
+  // Every key is a candidate unless the bloom filter rules it out.
+  std::fill(present, present + num_probes, true);
+  if (FLAGS_consult_bloom_filters) {
+    // Fully open the BloomFileReader if it was lazily opened earlier.
+    //
+    // If it's already initialized, this is a no-op.
+    RETURN_NOT_OK(bloom_reader_->Init(io_context));
+
+    vector<const BloomKeyProbe*> bloom_probes(num_probes);
+    for (int i = 0; i < num_probes; i++) {
+      bloom_probes[i] = &probes[i]->bloom_probe();
+      stats[i]->blooms_consulted++;
+    }
+    Status s = bloom_reader_->CheckKeysPresent(bloom_probes.data(), num_probes,
+                                               io_context, present);
+    if (!s.ok()) {
+      KLOG_EVERY_N_SECS(WARNING, 1) << Substitute("Unable to query bloom in $0: $1",
+          rowset_metadata_->bloom_block().ToString(), s.ToString());
+      if (PREDICT_FALSE(s.IsDiskFailure())) {
+        // If the bloom lookup failed because of a disk failure, return early
+        // since I/O to the tablet should be stopped.
+        return s;
+      }
+      // Continue with the slow path for all the keys.
+      std::fill(present, present + num_probes, true);
+    }
+  }
+
+  // Since the keys are sorted, the key index iterator only moves forward
+  // and can be reused for all the candidates.
+  unique_ptr<CFileIterator> key_iter;
+  for (int i = 0; i < num_probes; i++) {
+    if (!present[i]) {
+      continue;
+    }
+    stats[i]->keys_consulted++;
+    if (!key_iter) {
+      RETURN_NOT_OK(NewKeyIterator(io_context, &key_iter));
+    }
+    bool exact;
+    Status s = key_iter->SeekAtOrAfter(probes[i]->encoded_key(), &exact);
+    if (s.IsNotFound()) {
+      // The key is past the end of the file, and so are the rest of the keys.
+      std::fill(present + i, present + num_probes, false);
+      break;
+    }
+    RETURN_NOT_OK(s);
+    if (!exact) {
+      present[i] = false;
+      continue;
+    }
+    rowids[i] = key_iter->GetCurrentOrdinal();
+  }
+  return Status::OK();
+}
+
 Status CFileSet::NewKeyIterator(const IOContext* io_context,
                                 unique_ptr<CFileIterator>* key_iter) const {
   RETURN_NOT_OK(key_index_reader()->Init(io_context));
@@ -401,6 +475,8 @@ Status CFileSet::Iterator::Init(ScanSpec *spec) {
   // ordinal range.
   RETURN_NOT_OK(PushdownRangeScanPredicate(spec));
 
+  RETURN_NOT_OK(SetupZoneMapPredicates(spec));
+
   initted_ = true;
 
   // Don't actually seek -- we'll seek when we first actually read the
@@ -470,6 +546,84 @@ Status CFileSet::Iterator::PushdownRangeScanPredicate(ScanSpec *spec) {
   return Status::OK();
 }
 
+Status CFileSet::Iterator::SetupZoneMapPredicates(const ScanSpec* spec) {
+  zone_map_predicates_.clear();
+  zone_maps_exclude_all_ = false;
+  if (spec == nullptr || !FLAGS_consult_zone_maps) {
+    return Status::OK();
+  }
+
+  for (const auto& col_and_pred : spec->predicates()) {
+    const ColumnPredicate& pred = col_and_pred.second;
+    int proj_col_idx = projection_->find_column(col_and_pred.first);
+    if (proj_col_idx == Schema::kColumnNotFound) {
+      continue;
+    }
+    ColumnId col_id = projection_->column_id(proj_col_idx);
+    if (!base_data_->has_data_for_column_id(col_id)) {
+      continue;
+    }
+    CFileReader* reader = FindOrDie(base_data_->readers_by_col_id_, col_id).get();
+    RETURN_NOT_OK(reader->Init(io_context_));
+    const ZoneMapPB* zone_map = reader->zone_map();
+    if (zone_map == nullptr) {
+      continue;
+    }
+    if (!ZoneMapMayMatch(pred, *zone_map)) {
+      VLOG(1) << "Zone map of " << reader->ToString() << " excludes all rows for predicate "
+              << pred.ToString();
+      zone_maps_exclude_all_ = true;
+    }
+    zone_map_predicates_.emplace_back(pred, reader);
+  }
+  return Status::OK();
+}
+
+Status CFileSet::Iterator::DeselectRowsExcludedByZoneMaps(SelectionVector* sel_vec) {
+  DCHECK_EQ(prepared_count_, sel_vec->nrows());
+  if (zone_map_predicates_.empty()) {
+    return Status::OK();
+  }
+  if (zone_maps_exclude_all_) {
+    sel_vec->SetAllFalse();
+    return Status::OK();
+  }
+
+  const rowid_t batch_start = cur_idx_;
+  const rowid_t batch_end = cur_idx_ + prepared_count_;
+  SelectionVectorView sel_view(sel_vec);
+  for (const auto& pred_and_reader : zone_map_predicates_) {
+    const ColumnPredicate& pred = pred_and_reader.first;
+    const BlockZoneMapsPB* block_zone_maps;
+    RETURN_NOT_OK(pred_and_reader.second->GetBlockZoneMaps(io_context_, &block_zone_maps));
+    const auto& zone_maps = block_zone_maps->zone_maps();
+
+    // Find the block containing the first row of the batch: the last one
+    // starting at or before it.
+    auto it = std::upper_bound(zone_maps.begin(), zone_maps.end(), batch_start,
+                               [](rowid_t row, const ZoneMapPB& zone_map) {
+                                 return row < zone_map.first_row();
+                               });
+    if (it != zone_maps.begin()) {
+      --it;
+    }
+    for (; it != zone_maps.end() && it->first_row() < batch_end; ++it) {
+      if (ZoneMapMayMatch(pred, *it)) {
+        continue;
+      }
+      rowid_t start = std::max<rowid_t>(it->first_row(), batch_start);
+      rowid_t end = std::min<rowid_t>(it->first_row() + it->num_rows(), batch_end);
+      if (start < end) {
+        sel_view.ClearBits(end - start, start - batch_start);
+      }
+    }
+    if (!sel_vec->AnySelected()) {
+      break;
+    }
+  }
+  return Status::OK();
+}
+
 void CFileSet::Iterator::Unprepare() {
   prepared_count_ = 0;
   prepared_iters_.clear();
@@ -30,6 +30,7 @@
 #include <gtest/gtest_prod.h>
 
 #include "kudu/cfile/cfile_reader.h"
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/iterator.h"
 #include "kudu/common/rowid.h"
 #include "kudu/common/schema.h"
@@ -124,6 +125,17 @@ class CFileSet :
   Status CheckRowPresent(const RowSetKeyProbe& probe, const fs::IOContext* io_context,
                          bool* present, rowid_t* rowid, ProbeStats* stats) const;
 
+  // Batch version of CheckRowPresent() for keys sorted by encoded key, setting
+  // present[i] and rowids[i] for probes[i]. The bloom filter is probed for all
+  // the keys at once, and the remaining candidates are looked up using a single
+  // key index iterator.
+  Status CheckRowsPresent(const RowSetKeyProbe* const* probes,
+                          int num_probes,
+                          const fs::IOContext* io_context,
+                          bool* present,
+                          rowid_t* rowids,
+                          ProbeStats* const* stats) const;
+
   // Return true if there exists a CFile for the given column ID.
   bool has_data_for_column_id(ColumnId col_id) const {
     return ContainsKey(readers_by_col_id_, col_id);
@@ -220,6 +232,13 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   // Collect the IO statistics for each of the underlying columns.
   virtual void GetIteratorStats(std::vector<IteratorStats> *stats) const OVERRIDE;
 
+  // Deselect the rows of the prepared batch which, according to the zone maps
+  // of the predicated columns, cannot satisfy the scan's predicates.
+  //
+  // The zone maps only describe the base data, so this must only be called
+  // when no deltas will be applied to the batch.
+  Status DeselectRowsExcludedByZoneMaps(SelectionVector* sel_vec);
+
   virtual ~Iterator();
  private:
   DISALLOW_COPY_AND_ASSIGN(Iterator);
@@ -234,7 +253,8 @@ class CFileSet::Iterator : public ColumnwiseIterator {
         initted_(false),
         cur_idx_(0),
         prepared_count_(0),
-        io_context_(io_context) {}
+        io_context_(io_context),
+        zone_maps_exclude_all_(false) {}
 
   // Fill in col_iters_ for each of the requested columns.
   Status CreateColumnIterators(const ScanSpec* spec);
@@ -244,6 +264,10 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   // store it in member fields.
   Status PushdownRangeScanPredicate(ScanSpec *spec);
 
+  // Collect the predicates in 'spec' which can be checked against the zone
+  // maps of their columns' cfiles.
+  Status SetupZoneMapPredicates(const ScanSpec* spec);
+
   void Unprepare();
 
   // Prepare the given column. The column must not have been prepared yet.
@@ -281,6 +305,13 @@ class CFileSet::Iterator : public ColumnwiseIterator {
   // stored in 'col_iters_'.
   std::vector<cfile::ColumnIterator*> prepared_iters_;
 
+  // Predicates on columns whose cfiles carry zone maps, along with the
+  // corresponding readers.
+  std::vector<std::pair<ColumnPredicate, cfile::CFileReader*>> zone_map_predicates_;
+
+  // Whether the file-level zone map of some column already rules out every
+  // row in this rowset.
+  bool zone_maps_exclude_all_;
 };
 
 } // namespace tablet
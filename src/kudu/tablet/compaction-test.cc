@@ -34,6 +34,7 @@
 
 #include "kudu/clock/logical_clock.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/encoded_key.h"
 #include "kudu/common/partial_row.h"
 #include "kudu/common/row.h"
 #include "kudu/common/row_changelist.h"
@@ -50,6 +51,7 @@
 #include "kudu/fs/log_block_manager.h"
 #include "kudu/gutil/casts.h"
 #include "kudu/gutil/ref_counted.h"
+#include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/local_tablet_writer.h"
@@ -547,6 +549,51 @@ TEST_F(TestCompaction, TestFlushMRSWithRolling) {
             rows[1]);
 }
 
+// Flush a MemRowSet in which runs of never-mutated rows, which are copied into
+// the output column-at-a-time, are interleaved with updated and deleted rows.
+TEST_F(TestCompaction, TestFlushMRSWithMixedMutatedRows) {
+  constexpr int kNumRows = 3000;
+  shared_ptr<MemRowSet> mrs;
+  ASSERT_OK(MemRowSet::Create(0, schema_, log_anchor_registry_.get(),
+                              mem_trackers_.tablet_tracker, &mrs));
+  NO_FATALS(InsertRows(mrs.get(), kNumRows, 0));
+  int num_deleted = 0;
+  for (int i = 0; i < kNumRows; i++) {
+    if (i % 7 == 3) {
+      NO_FATALS(UpdateRow(mrs.get(), i * 10, -1));
+    } else if (i % 11 == 5) {
+      NO_FATALS(DeleteRow(mrs.get(), i * 10));
+      num_deleted++;
+    }
+  }
+
+  shared_ptr<DiskRowSet> rs;
+  NO_FATALS(FlushMRSAndReopenNoRoll(*mrs, schema_, &rs));
+  uint64_t count = 0;
+  ASSERT_OK(rs->CountLiveRows(&count));
+  ASSERT_EQ(kNumRows - num_deleted, count);
+
+  vector<string> rows;
+  rs->DebugDump(&rows);
+  ASSERT_EQ(kNumRows, rows.size());
+  for (int i = 0; i < kNumRows; i++) {
+    SCOPED_TRACE(i);
+    if (i % 7 == 3) {
+      ASSERT_STR_CONTAINS(rows[i], Substitute(
+          R"(Base: (string key="$0", int32 val=-1, int32 nullable_val=-1); )",
+          StringPrintf(kRowKeyFormat, i * 10)));
+      ASSERT_STR_CONTAINS(rows[i], "Redo Mutations: [];");
+    } else {
+      ASSERT_STR_CONTAINS(rows[i], Substitute(
+          R"(Base: (string key="$0", int32 val=$1, int32 nullable_val=$2); )"
+          "Undo Mutations: [@$3(DELETE)]; ",
+          StringPrintf(kRowKeyFormat, i * 10), i, i % 2 == 0 ? std::to_string(i) : "NULL",
+          i + 1));
+      ASSERT_STR_CONTAINS(rows[i], i % 11 == 5 ? "Redo Mutations: [@" : "Redo Mutations: [];");
+    }
+  }
+}
+
 TEST_F(TestCompaction, TestRowSetInput) {
   // Create a memrowset with a bunch of rows, flush and reopen.
   shared_ptr<DiskRowSet> rs;
@@ -585,6 +632,48 @@ TEST_F(TestCompaction, TestRowSetInput) {
             out[9]);
 }
 
+// Test a DiskRowSet compaction input restricted to a range of keys, making sure
+// the rows' deltas line up with the first row in the range.
+TEST_F(TestCompaction, TestRowSetInputWithKeyRange) {
+  shared_ptr<DiskRowSet> rs;
+  {
+    shared_ptr<MemRowSet> mrs;
+    ASSERT_OK(MemRowSet::Create(0, schema_, log_anchor_registry_.get(),
+                                mem_trackers_.tablet_tracker, &mrs));
+    NO_FATALS(InsertRows(mrs.get(), 1000, 0));
+    NO_FATALS(FlushMRSAndReopenNoRoll(*mrs, schema_, &rs));
+  }
+  NO_FATALS(UpdateRows(rs.get(), 1000, 0, 1));
+
+  // The encoded form of a single string key is the string itself.
+  Arena arena(1024);
+  EncodedKey* lower_bound;
+  EncodedKey* upper_bound;
+  ASSERT_OK(EncodedKey::DecodeEncodedString(schema_, &arena, "hello 00001000", &lower_bound));
+  ASSERT_OK(EncodedKey::DecodeEncodedString(schema_, &arena, "hello 00001995", &upper_bound));
+
+  vector<string> out;
+  unique_ptr<CompactionInput> input;
+  ASSERT_OK(CompactionInput::Create(*rs, &schema_, MvccSnapshot(mvcc_), nullptr,
+                                    lower_bound, upper_bound, &input));
+  IterateInput(input.get(), &out);
+  ASSERT_EQ(100, out.size());
+  ASSERT_STR_CONTAINS(out[0], R"(key="hello 00001000", int32 val=100, )");
+  ASSERT_STR_CONTAINS(out[0], "Undo Mutations: [@101(DELETE)]; "
+                              "Redo Mutations: [@1101(SET val=1, nullable_val=1)];");
+  ASSERT_STR_CONTAINS(out[99], R"(key="hello 00001990", int32 val=199, )");
+  ASSERT_STR_CONTAINS(out[99], "Undo Mutations: [@200(DELETE)]; "
+                               "Redo Mutations: [@1200(SET val=1, nullable_val=1)];");
+
+  // An unbounded lower end starts at the first row.
+  out.clear();
+  ASSERT_OK(CompactionInput::Create(*rs, &schema_, MvccSnapshot(mvcc_), nullptr,
+                                    nullptr, lower_bound, &input));
+  IterateInput(input.get(), &out);
+  ASSERT_EQ(100, out.size());
+  ASSERT_STR_CONTAINS(out[0], R"(key="hello 00000000", int32 val=0, )");
+}
+
 // Tests that the same rows, duplicated in three DRSs, ghost in two of them
 // appears only once on the compaction output but that the resulting row
 // includes reinserts for the ghost and all its mutations.
@@ -109,14 +109,22 @@ class MemRowSetCompactionInput : public CompactionInput {
   }
 
   Status PrepareBlock(vector<CompactionInputRow> *block) override {
+    // Copy as many whole leaves as fit in a block of kCompactionOutputBlockNumRows
+    // rows (but at least one leaf), so that the rows we hand out form long runs
+    // within 'row_block_', which FlushCompactionInput() can copy to its output
+    // column-at-a-time.
     int num_in_block = iter_->remaining_in_leaf();
-    block->resize(num_in_block);
 
     // Realloc the internal block storage if we don't have enough space to
     // copy the whole leaf node's worth of data into it.
-    if (PREDICT_FALSE(!row_block_ || num_in_block > row_block_->nrows())) {
-      row_block_.reset(new RowBlock(&iter_->schema(), num_in_block, nullptr));
+    if (PREDICT_FALSE(!row_block_ || num_in_block > row_block_->row_capacity())) {
+      row_block_.reset(new RowBlock(&iter_->schema(),
+                                    std::max(num_in_block, kCompactionOutputBlockNumRows),
+                                    nullptr));
+      row_block_->selection_vector()->SetAllTrue();
     }
+    const int capacity = row_block_->row_capacity();
+    block->resize(capacity);
 
     arena_.Reset();
     RowChangeListEncoder undo_encoder(&buffer_);
@@ -157,12 +165,18 @@ class MemRowSetCompactionInput : public CompactionInput {
       undo_encoder.Reset();
       ++next_row_index;
       iter_->Next();
-    }
 
-    if (PREDICT_FALSE(next_row_index < num_in_block)) {
-      block->resize(next_row_index);
+      // Move on to the next leaf if all of it fits in the block.
+      if (i == num_in_block - 1 && iter_->HasNext()) {
+        int next_leaf_rows = iter_->remaining_in_leaf();
+        if (next_row_index + next_leaf_rows <= capacity) {
+          num_in_block = i + 1 + next_leaf_rows;
+        }
+      }
     }
 
+    block->resize(next_row_index);
+
     has_more_blocks_ = iter_->HasNext();
     return Status::OK();
   }
@@ -196,12 +210,20 @@ class MemRowSetCompactionInput : public CompactionInput {
 // CompactionInput yielding rows and mutations from an on-disk DiskRowSet.
 class DiskRowSetCompactionInput : public CompactionInput {
  public:
+  // 'base_cfile_iter' is the iterator over the base data which is wrapped
+  // by 'base_iter'.
   DiskRowSetCompactionInput(unique_ptr<RowwiseIterator> base_iter,
+                            const CFileSet::Iterator* base_cfile_iter,
                             unique_ptr<DeltaIterator> redo_delta_iter,
-                            unique_ptr<DeltaIterator> undo_delta_iter)
+                            unique_ptr<DeltaIterator> undo_delta_iter,
+                            const EncodedKey* lower_bound,
+                            const EncodedKey* exclusive_upper_bound)
       : base_iter_(std::move(base_iter)),
+        base_cfile_iter_(base_cfile_iter),
         redo_delta_iter_(std::move(redo_delta_iter)),
         undo_delta_iter_(std::move(undo_delta_iter)),
+        lower_bound_(lower_bound),
+        exclusive_upper_bound_(exclusive_upper_bound),
         arena_(32 * 1024),
         block_(&base_iter_->schema(), kRowsPerBlock, &arena_),
         redo_mutation_block_(kRowsPerBlock, static_cast<Mutation *>(nullptr)),
@@ -210,11 +232,21 @@ class DiskRowSetCompactionInput : public CompactionInput {
   Status Init() override {
     ScanSpec spec;
     spec.set_cache_blocks(false);
+    if (lower_bound_) {
+      spec.SetLowerBoundKey(lower_bound_);
+    }
+    if (exclusive_upper_bound_) {
+      spec.SetExclusiveUpperBoundKey(exclusive_upper_bound_);
+    }
     RETURN_NOT_OK(base_iter_->Init(&spec));
+
+    // The base data iterator converts the key bounds into a range of row
+    // ordinals: position the delta iterators at the start of that range.
+    const rowid_t first_row = base_cfile_iter_->cur_ordinal_idx();
     RETURN_NOT_OK(redo_delta_iter_->Init(&spec));
-    RETURN_NOT_OK(redo_delta_iter_->SeekToOrdinal(0));
+    RETURN_NOT_OK(redo_delta_iter_->SeekToOrdinal(first_row));
     RETURN_NOT_OK(undo_delta_iter_->Init(&spec));
-    RETURN_NOT_OK(undo_delta_iter_->SeekToOrdinal(0));
+    RETURN_NOT_OK(undo_delta_iter_->SeekToOrdinal(first_row));
     return Status::OK();
   }
 
@@ -261,9 +293,13 @@ class DiskRowSetCompactionInput : public CompactionInput {
  private:
   DISALLOW_COPY_AND_ASSIGN(DiskRowSetCompactionInput);
   unique_ptr<RowwiseIterator> base_iter_;
+  const CFileSet::Iterator* base_cfile_iter_;
   unique_ptr<DeltaIterator> redo_delta_iter_;
   unique_ptr<DeltaIterator> undo_delta_iter_;
 
+  const EncodedKey* lower_bound_;
+  const EncodedKey* exclusive_upper_bound_;
+
   Arena arena_;
 
   // The current block of data which has come from the input iterator
@@ -851,10 +887,22 @@ Status CompactionInput::Create(const DiskRowSet &rowset,
                                const MvccSnapshot &snap,
                                const IOContext* io_context,
                                unique_ptr<CompactionInput>* out) {
+  return Create(rowset, projection, snap, io_context, nullptr, nullptr, out);
+}
+
+Status CompactionInput::Create(const DiskRowSet &rowset,
+                               const Schema* projection,
+                               const MvccSnapshot &snap,
+                               const IOContext* io_context,
+                               const EncodedKey* lower_bound,
+                               const EncodedKey* exclusive_upper_bound,
+                               unique_ptr<CompactionInput>* out) {
   CHECK(projection->has_column_ids());
 
-  unique_ptr<ColumnwiseIterator> base_cwise(rowset.base_data_->NewIterator(projection, io_context));
-  unique_ptr<RowwiseIterator> base_iter(NewMaterializingIterator(std::move(base_cwise)));
+  unique_ptr<CFileSet::Iterator> base_cfile_iter(
+      rowset.base_data_->NewIterator(projection, io_context));
+  const CFileSet::Iterator* base_cfile_iter_ptr = base_cfile_iter.get();
+  unique_ptr<RowwiseIterator> base_iter(NewMaterializingIterator(std::move(base_cfile_iter)));
 
   // Creates a DeltaIteratorMerger that will only include the relevant REDO deltas.
   RowIteratorOptions redo_opts;
@@ -875,8 +923,11 @@ Status CompactionInput::Create(const DiskRowSet &rowset,
       undo_opts, DeltaTracker::UNDOS_ONLY, &undo_deltas), "Could not open UNDOs");
 
   out->reset(new DiskRowSetCompactionInput(std::move(base_iter),
+                                           base_cfile_iter_ptr,
                                            std::move(redo_deltas),
-                                           std::move(undo_deltas)));
+                                           std::move(undo_deltas),
+                                           lower_bound,
+                                           exclusive_upper_bound));
   return Status::OK();
 }
 
@@ -918,6 +969,35 @@ Status RowSetsInCompaction::CreateCompactionInput(const MvccSnapshot &snap,
   return Status::OK();
 }
 
+Status RowSetsInCompaction::CreateCompactionInput(const MvccSnapshot &snap,
+                                                  const Schema* schema,
+                                                  const IOContext* io_context,
+                                                  const EncodedKey* lower_bound,
+                                                  const EncodedKey* exclusive_upper_bound,
+                                                  shared_ptr<CompactionInput> *out) const {
+  CHECK(schema->has_column_ids());
+
+  vector<shared_ptr<CompactionInput> > inputs;
+  for (const shared_ptr<RowSet> &rs : rowsets_) {
+    unique_ptr<CompactionInput> input;
+    RETURN_NOT_OK_PREPEND(CompactionInput::Create(*down_cast<DiskRowSet*>(rs.get()),
+                                                  schema, snap, io_context,
+                                                  lower_bound, exclusive_upper_bound,
+                                                  &input),
+                          Substitute("Could not create compaction input for rowset $0",
+                                     rs->ToString()));
+    inputs.push_back(shared_ptr<CompactionInput>(input.release()));
+  }
+
+  if (inputs.size() == 1) {
+    *out = std::move(inputs[0]);
+  } else {
+    out->reset(CompactionInput::Merge(inputs, schema));
+  }
+
+  return Status::OK();
+}
+
 void RowSetsInCompaction::DumpToLog() const {
   VLOG(1) << "Selected " << rowsets_.size() << " rowsets to compact:";
   // Dump the selected rowsets to the log, and collect corresponding iterators.
@@ -1093,6 +1173,34 @@ Status ApplyMutationsAndGenerateUndos(const MvccSnapshot& snap,
   #undef ERROR_LOG_CONTEXT
 }
 
+namespace {
+
+// Returns the number of rows, starting at rows[start] and up to 'max_rows',
+// which have no REDOs and no ghosts, and which are stored consecutively in
+// the same RowBlock with schema 'schema'.
+int UnmutatedRunLength(const vector<CompactionInputRow>& rows, int start, int max_rows,
+                       const Schema& schema) {
+  const RowBlock* row_block = rows[start].row.row_block();
+  if (!row_block->schema()->Equals(schema)) {
+    return 0;
+  }
+  const size_t first_idx = rows[start].row.row_index();
+  int run = 0;
+  for (int i = start; i < rows.size() && run < max_rows; i++, run++) {
+    const CompactionInputRow& row = rows[i];
+    if (row.redo_head != nullptr ||
+        row.previous_ghost != nullptr ||
+        row.row.row_block() != row_block ||
+        row.row.row_index() != first_idx + run ||
+        !row_block->selection_vector()->IsRowSelected(first_idx + run)) {
+      break;
+    }
+  }
+  return run;
+}
+
+} // anonymous namespace
+
 Status FlushCompactionInput(CompactionInput* input,
                             const MvccSnapshot& snap,
                             const HistoryGcOpts& history_gc_opts,
@@ -1113,6 +1221,34 @@ Status FlushCompactionInput(CompactionInput* input,
       CompactionInputRow* input_row = &rows[i];
       RETURN_NOT_OK(out->RollIfNecessary());
 
+      // Rows which were never mutated, e.g. most rows of a MemRowSet flush,
+      // need no per-row merging: copy runs of them into the output block
+      // column-at-a-time, and only append their UNDOs row by row.
+      int run = UnmutatedRunLength(rows, i, block.nrows() - n, *block.schema());
+      if (run > 1) {
+        RETURN_NOT_OK(input_row->row.row_block()->CopyTo(&block, input_row->row.row_index(),
+                                                         n, run));
+        for (int j = 0; j < run; j++) {
+          Mutation* new_undos_head = rows[i + j].undo_head;
+          bool is_garbage_collected;
+          RemoveAncientUndos(history_gc_opts, &new_undos_head, nullptr, &is_garbage_collected);
+          DCHECK(!is_garbage_collected);
+          if (new_undos_head != nullptr) {
+            rowid_t index_in_current_drs;
+            out->AppendUndoDeltas(n + j, new_undos_head, &index_in_current_drs);
+          }
+        }
+        n += run;
+        live_row_count += run;
+        i += run - 1;
+        if (n == block.nrows()) {
+          RETURN_NOT_OK(out->AppendBlock(block, live_row_count));
+          live_row_count = 0;
+          n = 0;
+        }
+        continue;
+      }
+
       const Schema* schema = input_row->row.schema();
       DCHECK_SCHEMA_EQ(*schema, out->schema());
       DCHECK(schema->has_column_ids());
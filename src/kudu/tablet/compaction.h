@@ -33,6 +33,7 @@
 namespace kudu {
 
 class Arena;
+class EncodedKey;
 class Schema;
 
 namespace fs {
@@ -109,6 +110,18 @@ class CompactionInput {
                        const fs::IOContext* io_context,
                        std::unique_ptr<CompactionInput>* out);
 
+  // Same as above, but only yields the rows whose keys fall in the range
+  // ['lower_bound', 'exclusive_upper_bound'). Either bound may be null, in
+  // which case the range is unbounded on that side. The bounds must remain
+  // valid until the input is initialized.
+  static Status Create(const DiskRowSet &rowset,
+                       const Schema* projection,
+                       const MvccSnapshot &snap,
+                       const fs::IOContext* io_context,
+                       const EncodedKey* lower_bound,
+                       const EncodedKey* exclusive_upper_bound,
+                       std::unique_ptr<CompactionInput>* out);
+
   // Create an input which reads from the given memrowset, yielding base rows and updates
   // prior to the given snapshot.
   static CompactionInput *Create(const MemRowSet &memrowset,
@@ -157,6 +170,17 @@ class RowSetsInCompaction {
                                const fs::IOContext* io_context,
                                std::shared_ptr<CompactionInput> *out) const;
 
+  // Like the above, but only yields the rows whose keys fall in the range
+  // ['lower_bound', 'exclusive_upper_bound'); see CompactionInput::Create().
+  //
+  // All of the rowsets in the compaction must be DiskRowSets.
+  Status CreateCompactionInput(const MvccSnapshot &snap,
+                               const Schema* schema,
+                               const fs::IOContext* io_context,
+                               const EncodedKey* lower_bound,
+                               const EncodedKey* exclusive_upper_bound,
+                               std::shared_ptr<CompactionInput> *out) const;
+
   // Dump a log message indicating the chosen rowsets.
   void DumpToLog() const;
 
@@ -18,6 +18,7 @@
 #include "kudu/tablet/compaction_policy.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <initializer_list>
 #include <limits>
 #include <memory>
@@ -31,6 +32,7 @@
 #include <glog/stl_logging.h>
 #include <gtest/gtest.h>
 
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/stringprintf.h"
 #include "kudu/gutil/strings/numbers.h"
 #include "kudu/gutil/strings/split.h"
@@ -47,6 +49,7 @@
 #include "kudu/util/test_macros.h"
 #include "kudu/util/test_util.h"
 
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -635,5 +638,274 @@ TEST_F(TestCompactionPolicy, TestKUDU2704) {
   ASSERT_EQ(2, picked.size());
   ASSERT_GT(quality, 0.0);
 }
+
+// Test that the tiered policy waits for a run of rowsets of the same tier
+// before compacting, and only picks that run.
+TEST_F(TestCompactionPolicy, TestTieredSelectsRunOfSameTier) {
+  constexpr auto kBudgetMb = 128;
+  constexpr auto kMb = 1024 * 1024;
+  TieredCompactionPolicy policy(kBudgetMb);
+
+  // [ 16MiB ][ 4MiB ][ 4MiB ][ 4MiB ]...
+  RowSetVector rowsets = {
+    std::make_shared<MockDiskRowSet>(StringPrintf("%010d", 0),
+                                     StringPrintf("%010d", 99),
+                                     16 * kMb),
+  };
+  for (int i = 1; i <= 4; i++) {
+    CompactionSelection picked;
+    double quality = 0.0;
+    RowSetTree tree;
+    ASSERT_OK(tree.Reset(rowsets));
+    ASSERT_OK(policy.PickRowSets(tree, &picked, &quality, /*log=*/nullptr));
+    ASSERT_TRUE(picked.empty());
+    ASSERT_EQ(0.0, quality);
+
+    rowsets.push_back(std::make_shared<MockDiskRowSet>(
+        StringPrintf("%010d", i * 100),
+        StringPrintf("%010d", i * 100 + 99),
+        4 * kMb));
+  }
+
+  // Now that there are four 4MiB rowsets, they are compacted together, but
+  // the larger rowset is left alone.
+  CompactionSelection picked;
+  double quality = 0.0;
+  RowSetTree tree;
+  ASSERT_OK(tree.Reset(rowsets));
+  ASSERT_OK(policy.PickRowSets(tree, &picked, &quality, /*log=*/nullptr));
+  ASSERT_EQ(4, picked.size());
+  for (const auto* rowset : picked) {
+    ASSERT_EQ(4 * kMb, rowset->OnDiskSize());
+  }
+  ASSERT_GT(quality, 0.0);
+}
+
+// Test that the tiered policy leaves full-size rowsets alone unless enough of
+// them overlap.
+TEST_F(TestCompactionPolicy, TestTieredFullSizeRowSets) {
+  constexpr auto kBudgetMb = 128;
+  const auto size_bytes = FLAGS_budgeted_compaction_target_rowset_size;
+  TieredCompactionPolicy policy(kBudgetMb);
+
+  // [0 - 1] [2 - 3] ... [18 - 19], all of the target size.
+  RowSetVector rowsets;
+  for (int i = 0; i < 10; i++) {
+    rowsets.emplace_back(new MockDiskRowSet(
+        StringPrintf("%010d", i * 2),
+        StringPrintf("%010d", i * 2 + 1),
+        size_bytes));
+  }
+  CompactionSelection picked;
+  double quality = 0.0;
+  RowSetTree tree;
+  ASSERT_OK(tree.Reset(rowsets));
+  ASSERT_OK(policy.PickRowSets(tree, &picked, &quality, /*log=*/nullptr));
+  ASSERT_TRUE(picked.empty());
+  ASSERT_EQ(0.0, quality);
+
+  // Stack three more rowsets on top of [0 - 1], so that four overlap.
+  for (int i = 0; i < 3; i++) {
+    rowsets.emplace_back(new MockDiskRowSet(StringPrintf("%010d", 0),
+                                            StringPrintf("%010d", 1),
+                                            size_bytes));
+  }
+  ASSERT_OK(tree.Reset(rowsets));
+  ASSERT_OK(policy.PickRowSets(tree, &picked, &quality, /*log=*/nullptr));
+  ASSERT_EQ(4, picked.size());
+  for (const auto* rowset : picked) {
+    string min_key, max_key;
+    ASSERT_OK(rowset->GetBounds(&min_key, &max_key));
+    ASSERT_EQ(StringPrintf("%010d", 0), min_key);
+  }
+  ASSERT_GT(quality, 0.0);
+}
+
+// A compaction simulator. It replays flushes into a tablet made of mock
+// rowsets and runs the compactions picked by a policy, keeping track of the
+// resulting write amplification and average rowset height.
+class CompactionSimulator {
+ public:
+  explicit CompactionSimulator(CompactionPolicy* policy)
+      : policy_(policy) {
+  }
+
+  // Add 'rowset' to the tablet as if it had been flushed from a MemRowSet.
+  void Flush(shared_ptr<RowSet> rowset) {
+    bytes_flushed_ += rowset->OnDiskBaseDataSizeWithRedos();
+    rowsets_.emplace_back(std::move(rowset));
+  }
+
+  // Run the compactions picked by the policy until it picks no more, or until
+  // 'max_compactions' compactions have run.
+  void CompactUntilQuiescent(int max_compactions, int size_budget_mb) {
+    for (int i = 0; i < max_compactions; i++) {
+      RowSetTree tree;
+      ASSERT_OK(tree.Reset(rowsets_));
+      CompactionSelection picked;
+      double quality = 0.0;
+      ASSERT_OK(policy_->PickRowSets(tree, &picked, &quality, /*log=*/nullptr));
+      if (picked.empty()) {
+        return;
+      }
+      NO_FATALS(Compact(picked, size_budget_mb));
+    }
+  }
+
+  // The ratio of all the data written by flushes and compactions to the data
+  // written by flushes.
+  double write_amplification() const {
+    return bytes_flushed_ == 0 ? 0.0 :
+        static_cast<double>(bytes_flushed_ + bytes_compacted_) / bytes_flushed_;
+  }
+
+  double average_height() const {
+    RowSetTree tree;
+    CHECK_OK(tree.Reset(rowsets_));
+    double rowset_total_height, rowset_total_width;
+    RowSetInfo::ComputeCdfAndCollectOrdered(tree,
+                                            &rowset_total_height,
+                                            &rowset_total_width,
+                                            nullptr,
+                                            nullptr);
+    return rowset_total_width > 0 ? rowset_total_height / rowset_total_width : 0.0;
+  }
+
+  int num_compactions() const { return num_compactions_; }
+  int num_rowsets() const { return rowsets_.size(); }
+
+ private:
+  // Replace the rowsets in 'picked' by the output of compacting them. The
+  // data of each input is assumed to be spread evenly over the intervals
+  // between the input endpoints it spans, and the output is cut at those
+  // endpoints into rowsets of about the target size, like the rolling
+  // DiskRowSet writer does.
+  void Compact(const CompactionSelection& picked, int size_budget_mb) {
+    struct Input {
+      string min_key;
+      string max_key;
+      uint64_t size;
+    };
+    vector<Input> inputs;
+    vector<string> endpoints;
+    uint64_t total_size = 0;
+    RowSetVector remaining;
+    for (auto& rs : rowsets_) {
+      if (!ContainsKey(picked, rs.get())) {
+        remaining.emplace_back(std::move(rs));
+        continue;
+      }
+      Input input;
+      ASSERT_OK(rs->GetBounds(&input.min_key, &input.max_key));
+      input.size = rs->OnDiskBaseDataSizeWithRedos();
+      endpoints.push_back(input.min_key);
+      endpoints.push_back(input.max_key);
+      total_size += input.size;
+      inputs.emplace_back(std::move(input));
+    }
+    ASSERT_EQ(picked.size(), inputs.size());
+    ASSERT_LE(total_size / 1024 / 1024, size_budget_mb);
+    std::sort(endpoints.begin(), endpoints.end());
+    endpoints.erase(std::unique(endpoints.begin(), endpoints.end()), endpoints.end());
+
+    // The amount of data between each pair of consecutive endpoints.
+    vector<double> interval_sizes(std::max<size_t>(endpoints.size() - 1, 1), 0.0);
+    for (const auto& input : inputs) {
+      const int lo = std::lower_bound(endpoints.begin(), endpoints.end(), input.min_key) -
+          endpoints.begin();
+      const int hi = std::lower_bound(endpoints.begin(), endpoints.end(), input.max_key) -
+          endpoints.begin();
+      if (lo == hi) {
+        interval_sizes[std::min<int>(lo, interval_sizes.size() - 1)] += input.size;
+        continue;
+      }
+      for (int i = lo; i < hi; i++) {
+        interval_sizes[i] += static_cast<double>(input.size) / (hi - lo);
+      }
+    }
+
+    const double target_size = policy_->target_rowset_size();
+    int start = 0;
+    double output_size = 0.0;
+    for (int i = 0; i < interval_sizes.size(); i++) {
+      output_size += interval_sizes[i];
+      if (output_size >= target_size || i == interval_sizes.size() - 1) {
+        const int end = std::min<int>(i + 1, endpoints.size() - 1);
+        remaining.emplace_back(new MockDiskRowSet(endpoints[start], endpoints[end],
+                                                  static_cast<uint64_t>(output_size)));
+        start = end;
+        output_size = 0.0;
+      }
+    }
+
+    bytes_compacted_ += total_size;
+    num_compactions_++;
+    rowsets_ = std::move(remaining);
+  }
+
+  CompactionPolicy* const policy_;
+  RowSetVector rowsets_;
+  uint64_t bytes_flushed_ = 0;
+  uint64_t bytes_compacted_ = 0;
+  int num_compactions_ = 0;
+};
+
+// Simulate an append-only table, such as a time series, where every flush
+// holds keys greater than all the previous ones. The budgeted policy keeps
+// merging the newest rowsets into the growing most recent one, while the
+// tiered policy rewrites each row once per tier.
+TEST_F(TestCompactionPolicy, TestSimulateAppendOnlyWriteAmplification) {
+  constexpr auto kBudgetMb = 128;
+  constexpr auto kNumFlushes = 64;
+  constexpr auto kFlushSizeBytes = 4 * 1024 * 1024;
+
+  BudgetedCompactionPolicy budgeted(kBudgetMb);
+  TieredCompactionPolicy tiered(kBudgetMb);
+  vector<double> write_amplification;
+  for (CompactionPolicy* policy : vector<CompactionPolicy*>{ &budgeted, &tiered }) {
+    CompactionSimulator sim(policy);
+    for (int i = 0; i < kNumFlushes; i++) {
+      sim.Flush(std::make_shared<MockDiskRowSet>(StringPrintf("%010d", i * 1000),
+                                                 StringPrintf("%010d", i * 1000 + 999),
+                                                 kFlushSizeBytes));
+      NO_FATALS(sim.CompactUntilQuiescent(/*max_compactions=*/100, kBudgetMb));
+    }
+    LOG(INFO) << strings::Substitute("write amplification: $0, average height: $1, "
+                                     "compactions: $2, rowsets: $3",
+                                     sim.write_amplification(), sim.average_height(),
+                                     sim.num_compactions(), sim.num_rowsets());
+    // The rowsets never overlap.
+    ASSERT_LE(sim.average_height(), 1.0 + 1e-6);
+    write_amplification.push_back(sim.write_amplification());
+  }
+
+  // With 4MiB flushes, 32MiB target rowsets and a size ratio of 4, each row is
+  // flushed, then rewritten into a 16MiB rowset, then into a 32MiB one.
+  ASSERT_LE(write_amplification[1], 3.0 + 1e-6);
+  ASSERT_LT(write_amplification[1], write_amplification[0]);
+}
+
+// Replay the rowset layout of a real YCSB tablet through the tiered policy.
+// This can be used as a benchmark of the policy on a layout with heavy overlap
+// between full-size rowsets.
+TEST_F(TestCompactionPolicy, TestSimulateTieredYcsbCompaction) {
+  if (!AllowSlowTests()) {
+    LOG(WARNING) << "test is skipped; set KUDU_ALLOW_SLOW_TESTS=1 to run";
+    return;
+  }
+  constexpr auto kBudgetMb = 1024;
+  TieredCompactionPolicy policy(kBudgetMb);
+  CompactionSimulator sim(&policy);
+  for (const auto& rs : LoadFile("testdata/ycsb-test-rowsets.tsv")) {
+    sim.Flush(rs);
+  }
+  const double initial_height = sim.average_height();
+  LOG_TIMING(INFO, "simulating tiered compactions") {
+    NO_FATALS(sim.CompactUntilQuiescent(/*max_compactions=*/20, kBudgetMb));
+  }
+  LOG(INFO) << strings::Substitute("average height: $0 -> $1, compactions: $2, rowsets: $3",
+                                   initial_height, sim.average_height(),
+                                   sim.num_compactions(), sim.num_rowsets());
+}
 } // namespace tablet
 } // namespace kudu
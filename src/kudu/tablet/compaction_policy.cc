@@ -18,8 +18,10 @@
 #include "kudu/tablet/compaction_policy.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <ostream>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -36,6 +38,8 @@
 #include "kudu/util/knapsack_solver.h"
 #include "kudu/util/status.h"
 
+using std::pair;
+using std::set;
 using std::vector;
 using strings::Substitute;
 
@@ -58,6 +62,30 @@ DEFINE_double(compaction_minimum_improvement, 0.01f,
               "compaction will be considered ineligible.");
 TAG_FLAG(compaction_minimum_improvement, advanced);
 
+DEFINE_int32(tiered_compaction_size_ratio, 4,
+             "The size ratio between successive tiers of the tiered compaction "
+             "policy. This is also the number of rowsets of one tier, or of "
+             "overlapping full-size rowsets, that triggers a compaction.");
+TAG_FLAG(tiered_compaction_size_ratio, advanced);
+TAG_FLAG(tiered_compaction_size_ratio, experimental);
+
+DEFINE_int32(tiered_compaction_min_tier_size_mb, 1,
+             "The upper bound in MB of the smallest tier of the tiered compaction "
+             "policy. Rowsets of at most this size all belong to the first tier.");
+TAG_FLAG(tiered_compaction_min_tier_size_mb, advanced);
+TAG_FLAG(tiered_compaction_min_tier_size_mb, experimental);
+
+DECLARE_double(compaction_small_rowset_tradeoff);
+
+static bool ValidateTieredCompactionSizeRatio(const char* flagname, int32_t value) {
+  if (value < 2) {
+    LOG(ERROR) << Substitute("$0 must be at least 2, value $1 is invalid", flagname, value);
+    return false;
+  }
+  return true;
+}
+DEFINE_validator(tiered_compaction_size_ratio, &ValidateTieredCompactionSizeRatio);
+
 namespace kudu {
 namespace tablet {
 
@@ -513,5 +541,213 @@ Status BudgetedCompactionPolicy::PickRowSets(
   return Status::OK();
 }
 
+////////////////////////////////////////////////////////////
+// TieredCompactionPolicy
+////////////////////////////////////////////////////////////
+
+namespace {
+
+// The tier of rowsets which have reached the target rowset size.
+constexpr int kFullTier = std::numeric_limits<int>::max();
+
+// Return the tier of the rowset described by 'rsi'. A rowset is full-size once
+// compacting it with another rowset of the same size could no longer reduce
+// the number of rowsets.
+int RowSetTier(const RowSetInfo& rsi, int target_size_mb) {
+  const int size_mb = rsi.base_and_redos_size_mb();
+  if (2 * size_mb > target_size_mb) {
+    return kFullTier;
+  }
+  // Tier 'n' holds the rowsets of size in (min * ratio^(n-1), min * ratio^n].
+  int tier = 0;
+  int64_t tier_max_size_mb = std::max(FLAGS_tiered_compaction_min_tier_size_mb, 1);
+  while (size_mb > tier_max_size_mb) {
+    tier_max_size_mb *= FLAGS_tiered_compaction_size_ratio;
+    tier++;
+  }
+  return tier;
+}
+
+struct TieredSelection {
+  vector<const RowSetInfo*> rowsets;
+  double quality = 0.0;
+};
+
+// Select the longest prefix of 'group' that fits in 'size_budget_mb', and
+// score it. The score is the reduction in
+// tablet height plus the small rowset tradeoff for every rowset the compaction
+// removes from the tablet, so a selection that reduces neither scores zero.
+void SelectPrefixWithinBudget(const vector<const RowSetInfo*>& group,
+                              size_t size_budget_mb,
+                              int target_size_mb,
+                              TieredSelection* selection) {
+  selection->rowsets.clear();
+  selection->quality = 0.0;
+  size_t total_size_mb = 0;
+  double sum_width = 0.0;
+  double union_min = std::numeric_limits<double>::max();
+  double union_max = 0.0;
+  for (const RowSetInfo* rsi : group) {
+    if (total_size_mb + rsi->base_and_redos_size_mb() > size_budget_mb) {
+      break;
+    }
+    total_size_mb += rsi->base_and_redos_size_mb();
+    sum_width += rsi->width();
+    union_min = std::min(union_min, rsi->cdf_min_key());
+    union_max = std::max(union_max, rsi->cdf_max_key());
+    selection->rowsets.push_back(rsi);
+  }
+  if (selection->rowsets.size() < 2) {
+    selection->rowsets.clear();
+    return;
+  }
+  const double union_width = union_max - union_min;
+  const int num_outputs = (total_size_mb + target_size_mb - 1) / target_size_mb;
+  const int num_removed = static_cast<int>(selection->rowsets.size()) - num_outputs;
+  selection->quality = std::max(sum_width - union_width, 0.0) +
+      FLAGS_compaction_small_rowset_tradeoff * std::max(num_removed, 0);
+}
+
+} // anonymous namespace
+
+TieredCompactionPolicy::TieredCompactionPolicy(int budget)
+  : size_budget_mb_(budget) {
+  CHECK_GT(budget, 0);
+}
+
+uint64_t TieredCompactionPolicy::target_rowset_size() const {
+  CHECK_GT(FLAGS_budgeted_compaction_target_rowset_size, 0);
+  return FLAGS_budgeted_compaction_target_rowset_size;
+}
+
+Status TieredCompactionPolicy::PickRowSets(
+    const RowSetTree& tree,
+    CompactionSelection* picked,
+    double* quality,
+    std::vector<std::string>* log) {
+  DCHECK(picked);
+  DCHECK(quality);
+  *quality = 0.0;
+
+  vector<RowSetInfo> asc_min_key, asc_max_key;
+  RowSetInfo::ComputeCdfAndCollectOrdered(tree,
+                                          /*rowset_total_height=*/nullptr,
+                                          /*rowset_total_width=*/nullptr,
+                                          &asc_min_key,
+                                          &asc_max_key);
+  if (asc_min_key.size() < 2) {
+    if (log) {
+      LOG_STRING(INFO, log) << "No rowsets to compact";
+    }
+    return Status::OK();
+  }
+
+  const size_t ratio = FLAGS_tiered_compaction_size_ratio;
+  const int target_size_mb = std::max<int>(target_rowset_size() / 1024 / 1024, 1);
+  vector<int> tiers;
+  tiers.reserve(asc_min_key.size());
+  set<int> partial_tiers;
+  for (const RowSetInfo& rsi : asc_min_key) {
+    tiers.push_back(RowSetTier(rsi, target_size_mb));
+    if (tiers.back() != kFullTier) {
+      partial_tiers.insert(tiers.back());
+    }
+  }
+
+  TieredSelection best;
+  TieredSelection candidate;
+  vector<const RowSetInfo*> group;
+  const auto consider_group = [&]() {
+    if (group.size() >= ratio) {
+      SelectPrefixWithinBudget(group, size_budget_mb_, target_size_mb, &candidate);
+      if (candidate.quality > best.quality) {
+        std::swap(best, candidate);
+      }
+    }
+    group.clear();
+  };
+
+  // Consider runs of rowsets of the same tier in min key order. A run is
+  // broken by any smaller rowset, but not by larger ones: in append-mostly
+  // tables those hold older keys outside of the run, and in tables with random
+  // writes the run overlaps them anyway.
+  for (int tier : partial_tiers) {
+    for (int i = 0; i < asc_min_key.size(); i++) {
+      if (tiers[i] < tier) {
+        consider_group();
+      } else if (tiers[i] == tier) {
+        group.push_back(&asc_min_key[i]);
+      }
+    }
+    consider_group();
+  }
+
+  // Full-size rowsets are left alone until enough of them pile up over the
+  // same keys. Find the point of the keyspace covered by the most full-size
+  // rowsets and consider those rowsets, narrowest first so that the output
+  // stretches over as few other rowsets as possible.
+  vector<pair<double, int>> endpoints;
+  for (int i = 0; i < asc_min_key.size(); i++) {
+    if (tiers[i] == kFullTier) {
+      // Rowsets which merely touch don't overlap: a rowset's end sorts before
+      // another's start at the same point.
+      endpoints.emplace_back(asc_min_key[i].cdf_min_key(), 1);
+      endpoints.emplace_back(asc_min_key[i].cdf_max_key(), -1);
+    }
+  }
+  std::sort(endpoints.begin(), endpoints.end());
+  int depth = 0;
+  int max_depth = 0;
+  double max_depth_point = 0.0;
+  for (const auto& endpoint : endpoints) {
+    depth += endpoint.second;
+    if (depth > max_depth) {
+      max_depth = depth;
+      max_depth_point = endpoint.first;
+    }
+  }
+  if (max_depth >= ratio) {
+    for (int i = 0; i < asc_min_key.size(); i++) {
+      const RowSetInfo& rsi = asc_min_key[i];
+      if (tiers[i] == kFullTier &&
+          rsi.cdf_min_key() <= max_depth_point && max_depth_point < rsi.cdf_max_key()) {
+        group.push_back(&rsi);
+      }
+    }
+    std::stable_sort(group.begin(), group.end(),
+                     [](const RowSetInfo* a, const RowSetInfo* b) {
+                       return a->width() < b->width();
+                     });
+    consider_group();
+  }
+
+  CompactionSelection selection;
+  for (const RowSetInfo* rsi : best.rowsets) {
+    selection.insert(rsi->rowset());
+  }
+
+  // Log the input and output of the selection.
+  if (VLOG_IS_ON(1) || log != nullptr) {
+    LOG_STRING(INFO, log) << "Tiered compaction selection:";
+    for (int i = 0; i < asc_min_key.size(); i++) {
+      const RowSetInfo& cand = asc_min_key[i];
+      const char* checkbox = ContainsKey(selection, cand.rowset()) ? "[x]" : "[ ]";
+      LOG_STRING(INFO, log) << "  " << checkbox << " "
+                            << (tiers[i] == kFullTier ? "full" : std::to_string(tiers[i]))
+                            << " " << cand.ToString();
+    }
+    LOG_STRING(INFO, log) << "Solution value: " << best.quality;
+  }
+
+  if (selection.empty()) {
+    return Status::OK();
+  }
+  *quality = best.quality;
+  picked->swap(selection);
+  DumpCompactionSVGToFile(asc_min_key, *picked);
+
+  return Status::OK();
+}
+
 } // namespace tablet
 } // namespace kudu
@@ -127,6 +127,33 @@ class BudgetedCompactionPolicy : public CompactionPolicy {
   const size_t size_budget_mb_;
 };
 
+// A size-tiered compaction policy which bounds write amplification rather than
+// minimizing the average rowset height.
+//
+// Rowsets smaller than the target rowset size are grouped into tiers whose
+// sizes grow geometrically by --tiered_compaction_size_ratio. A compaction is
+// only picked once that many rowsets of the same tier sit next to each other
+// in key order, so each row is rewritten about once per tier on its way to a
+// full-size rowset. Full-size rowsets are compacted again only once that many
+// of them overlap. This suits append-mostly tables, where the budgeted policy
+// repeatedly re-merges the most recent rowsets as they grow.
+//
+// Each compaction selection is limited to 'size_budget_mb' of input.
+class TieredCompactionPolicy : public CompactionPolicy {
+ public:
+  explicit TieredCompactionPolicy(int size_budget_mb);
+
+  Status PickRowSets(const RowSetTree& tree,
+                     CompactionSelection* picked,
+                     double* quality,
+                     std::vector<std::string>* log) override;
+
+  uint64_t target_rowset_size() const override;
+
+ private:
+  const size_t size_budget_mb_;
+};
+
 } // namespace tablet
 } // namespace kudu
 #endif
@@ -80,6 +80,15 @@ struct BTreeTraits {
     // Number of bytes used by a leaf node.
     kLeafNodeSize = 4 * CACHELINE_SIZE,
 
+    // Number of bytes used per key slot in both internal and leaf nodes.
+    // Keys shorter than this are stored inline in the node. Longer keys are
+    // stored in the arena, and the slot keeps a pointer to them followed by
+    // (kKeySlotSize - sizeof(void*)) bytes of key prefix, which lets most
+    // comparisons during a node search avoid a cache miss on the pointer.
+    //
+    // Must be a multiple of the pointer size, to keep the pointers aligned.
+    kKeySlotSize = sizeof(void*),
+
     // Tests can set this trait to a non-zero value, which inserts
     // some pause-loops in key parts of the code to try to simulate
     // races.
@@ -323,9 +332,7 @@ size_t FindInSliceArray(const InlineSlice<N, true> *array, ssize_t num_entries,
 
   while (left < right) {
     int mid = (left + right + 1) / 2;
-    // TODO: inline slices with more than 8 bytes will store a prefix of the
-    // slice inline, which we could use to short circuit some of these comparisons.
-    int compare = array[mid].as_slice().compare(key);
+    int compare = array[mid].compare(key);
     if (compare < 0) { // mid < key
       left = mid;
     } else if (compare > 0) { // mid > search
@@ -336,7 +343,7 @@ size_t FindInSliceArray(const InlineSlice<N, true> *array, ssize_t num_entries,
     }
   }
 
-  int compare = array[left].as_slice().compare(key);
+  int compare = array[left].compare(key);
   *exact = compare == 0;
   if (compare < 0) { // key > left
     left++;
@@ -653,7 +660,9 @@ class PACKED InternalNode : public NodeBase<Traits> {
     return num_children_ - 1;
   }
 
-  typedef InlineSlice<sizeof(void*), true> KeyInlineSlice;
+  typedef InlineSlice<Traits::kKeySlotSize, true> KeyInlineSlice;
+  static_assert(Traits::kKeySlotSize % sizeof(void*) == 0,
+                "key slots must keep pointers aligned");
 
   enum SpaceConstants {
     constant_overhead = sizeof(NodeBase<Traits>) // base class
@@ -806,7 +815,9 @@ class LeafNode : public NodeBase<Traits> {
   friend class InternalNode<Traits>;
   friend class CBTreeIterator<Traits>;
 
-  typedef InlineSlice<sizeof(void*), true> KeyInlineSlice;
+  typedef InlineSlice<Traits::kKeySlotSize, true> KeyInlineSlice;
+  static_assert(Traits::kKeySlotSize % sizeof(void*) == 0,
+                "key slots must keep pointers aligned");
 
   // It is necessary to name this enum so that DCHECKs can use its
   // constants (the macros may attempt to specialize templates
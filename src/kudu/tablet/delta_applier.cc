@@ -122,6 +122,11 @@ Status DeltaApplier::InitializeSelectionVector(SelectionVector *sel_vec) {
     deltas.ToSelectionVector(sel_vec);
   } else {
     RETURN_NOT_OK(base_iter_->InitializeSelectionVector(sel_vec));
+    // The zone maps only describe the base data: if an update may change
+    // the value of a row, they cannot be used to rule the row out.
+    if (!delta_iter_->MayHaveDeltas()) {
+      RETURN_NOT_OK(base_iter_->DeselectRowsExcludedByZoneMaps(sel_vec));
+    }
   }
   if (!opts_.include_deleted_rows) {
     RETURN_NOT_OK(delta_iter_->ApplyDeletes(sel_vec));
@@ -65,6 +65,10 @@ class Mutation;
 struct RowIteratorOptions;
 
 struct DMSTreeTraits : public btree::BTreeTraits {
+  // Encoded DeltaKeys (a row ID and a varint timestamp) always fit inline
+  // in a 16-byte key slot.
+  static const size_t kLeafNodeSize = 8 * CACHELINE_SIZE;
+  static const size_t kKeySlotSize = 16;
   typedef ThreadSafeMemoryTrackingArena ArenaType;
 };
 
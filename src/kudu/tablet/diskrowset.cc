@@ -18,6 +18,8 @@
 #include "kudu/tablet/diskrowset.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <map>
 #include <ostream>
 #include <vector>
@@ -30,6 +32,7 @@
 #include "kudu/cfile/bloomfile.h"
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h"
+#include "kudu/common/columnblock.h"
 #include "kudu/common/common.pb.h"
 #include "kudu/common/generic_iterators.h"
 #include "kudu/common/iterator.h"
@@ -39,6 +42,7 @@
 #include "kudu/common/types.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/tablet/cfile_set.h"
 #include "kudu/tablet/compaction.h"
@@ -131,6 +135,12 @@ Status DiskRowSetWriter::Open() {
     RETURN_NOT_OK(InitAdHocIndexWriter());
   }
 
+  for (int i = 0; i < schema_->num_columns(); i++) {
+    if (schema_->column(i).type_info()->type() == UNIXTIME_MICROS) {
+      unixtime_col_idxs_.push_back(i);
+    }
+  }
+
   return Status::OK();
 }
 
@@ -203,6 +213,8 @@ Status DiskRowSetWriter::AppendBlock(const RowBlock &block, int live_row_count)
   // Increase the live row count if necessary.
   rowset_metadata_->IncrementLiveRows(live_row_count);
 
+  UpdateMaxUnixtimeMicros(block);
+
 #ifndef NDEBUG
     faststring prev_key;
 #endif
@@ -237,6 +249,34 @@ Status DiskRowSetWriter::AppendBlock(const RowBlock &block, int live_row_count)
   return Status::OK();
 }
 
+void DiskRowSetWriter::UpdateMaxUnixtimeMicros(const RowBlock& block) {
+  if (block.nrows() == 0) return;
+  for (int col_idx : unixtime_col_idxs_) {
+    const ColumnId col_id = schema_->column_id(col_idx);
+    if (ContainsKey(unixtime_cols_with_nulls_, col_id)) continue;
+    ColumnBlock cblock = block.column_block(col_idx);
+    int64_t max_val = std::numeric_limits<int64_t>::min();
+    bool has_null = false;
+    for (size_t i = 0; i < block.nrows(); i++) {
+      if (cblock.is_null(i)) {
+        has_null = true;
+        break;
+      }
+      max_val = std::max(max_val, *reinterpret_cast<const int64_t*>(cblock.cell_ptr(i)));
+    }
+    if (has_null) {
+      // A null never expires, so neither does a rowset holding one.
+      unixtime_cols_with_nulls_.insert(col_id);
+      max_unixtime_micros_.erase(col_id);
+      continue;
+    }
+    auto ins = max_unixtime_micros_.emplace(col_id, max_val);
+    if (!ins.second) {
+      ins.first->second = std::max(ins.first->second, max_val);
+    }
+  }
+}
+
 Status DiskRowSetWriter::Finish() {
   TRACE_EVENT0("tablet", "DiskRowSetWriter::Finish");
   BlockManager* bm = rowset_metadata_->fs_manager()->block_manager();
@@ -275,6 +315,7 @@ Status DiskRowSetWriter::FinishAndReleaseBlocks(BlockCreationTransaction* transa
   std::map<ColumnId, BlockId> flushed_blocks;
   col_writer_->GetFlushedBlocksByColumnId(&flushed_blocks);
   rowset_metadata_->SetColumnDataBlocks(flushed_blocks);
+  rowset_metadata_->SetColumnMaxUnixtimeMicros(max_unixtime_micros_);
 
   if (ad_hoc_index_writer_ != nullptr) {
     Status s = ad_hoc_index_writer_->FinishAndReleaseBlock(transaction);
@@ -735,6 +776,29 @@ Status DiskRowSet::CheckRowPresent(const RowSetKeyProbe &probe,
   return Status::OK();
 }
 
+Status DiskRowSet::CheckRowsPresent(const RowSetKeyProbe* const* probes,
+                                    int num_probes,
+                                    const IOContext* io_context,
+                                    bool* present,
+                                    ProbeStats* const* stats) const {
+  DCHECK(open_);
+  shared_lock<rw_spinlock> l(component_lock_);
+
+  vector<rowid_t> row_idxs(num_probes);
+  RETURN_NOT_OK(base_data_->CheckRowsPresent(probes, num_probes, io_context,
+                                             present, row_idxs.data(), stats));
+  // The rows found in the base data might have been deleted since.
+  for (int i = 0; i < num_probes; i++) {
+    if (!present[i]) {
+      continue;
+    }
+    bool deleted = false;
+    RETURN_NOT_OK(delta_tracker_->CheckRowDeleted(row_idxs[i], io_context, &deleted, stats[i]));
+    present[i] = !deleted;
+  }
+  return Status::OK();
+}
+
 Status DiskRowSet::CountRows(const IOContext* io_context, rowid_t *count) const {
   DCHECK(open_);
   rowid_t num_rows = num_rows_.load();
@@ -882,6 +946,20 @@ Status DiskRowSet::IsDeletedAndFullyAncient(Timestamp ancient_history_mark,
   return Status::OK();
 }
 
+Status DiskRowSet::IsExpired(const ColumnId& col_id, int64_t cutoff_micros, bool* expired) {
+  DCHECK(expired);
+  // The recorded max only covers the base data: an update may have moved a
+  // value past the cutoff, so a rowset with any REDOs is never expired; that
+  // includes the DELETEs which expire its rows. No max is recorded if the
+  // column holds any nulls, so neither is such a rowset.
+  boost::optional<int64_t> max_micros = rowset_metadata_->column_max_unixtime_micros(col_id);
+  *expired = max_micros &&
+             *max_micros < cutoff_micros &&
+             delta_tracker_->DeltaMemStoreEmpty() &&
+             delta_tracker_->CountRedoDeltaStores() == 0;
+  return Status::OK();
+}
+
 Status DiskRowSet::InitUndoDeltas(Timestamp ancient_history_mark,
                                   MonoTime deadline,
                                   const IOContext* io_context,
@@ -23,8 +23,10 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -140,6 +142,10 @@ class DiskRowSetWriter {
   // (the ad-hoc writer for composite keys, otherwise the key column writer)
   cfile::CFileWriter *key_index_writer();
 
+  // Fold the values of the UNIXTIME_MICROS columns of 'block' into
+  // 'max_unixtime_micros_', unless they hold nulls.
+  void UpdateMaxUnixtimeMicros(const RowBlock& block);
+
   RowSetMetadata* rowset_metadata_;
   const Schema* const schema_;
 
@@ -153,6 +159,17 @@ class DiskRowSetWriter {
 
   // The last encoded key written.
   faststring last_encoded_key_;
+
+  // Indexes of the UNIXTIME_MICROS columns of 'schema_'.
+  std::vector<int> unixtime_col_idxs_;
+
+  // The greatest value written to each UNIXTIME_MICROS column without any
+  // nulls, keyed by column ID. Recorded in the rowset metadata to estimate
+  // how much data a table TTL expires (see Tablet::GetBytesInExpiredRowsets()).
+  std::map<ColumnId, int64_t> max_unixtime_micros_;
+
+  // The UNIXTIME_MICROS columns to which any nulls were written.
+  std::set<ColumnId> unixtime_cols_with_nulls_;
 };
 
 
@@ -356,6 +373,14 @@ class DiskRowSet :
   Status CheckRowPresent(const RowSetKeyProbe &probe, const fs::IOContext* io_context,
                          bool *present, ProbeStats* stats) const override;
 
+  // Probes the bloom filter for all the keys at once, and then looks up
+  // the candidates in the key index and the delta stores.
+  Status CheckRowsPresent(const RowSetKeyProbe* const* probes,
+                          int num_probes,
+                          const fs::IOContext* io_context,
+                          bool* present,
+                          ProbeStats* const* stats) const override;
+
   ////////////////////
   // Read functions.
   ////////////////////
@@ -404,6 +429,9 @@ class DiskRowSet :
   Status IsDeletedAndFullyAncient(Timestamp ancient_history_mark,
                                   bool* deleted_and_ancient) override;
 
+  Status IsExpired(const ColumnId& col_id, int64_t cutoff_micros,
+                   bool* expired) override;
+
   Status InitUndoDeltas(Timestamp ancient_history_mark,
                         MonoTime deadline,
                         const fs::IOContext* io_context,
@@ -136,6 +136,32 @@ class LocalTabletWriter {
     return Status::OK();
   }
 
+  // Insert the given rows as a bulk load (see WriteRequestPB::bulk_load).
+  // If they are sorted by key and don't overlap any data in the tablet they
+  // are written straight into new DiskRowSets; otherwise they are inserted
+  // as usual. Returns a bad Status if any of the inserts failed.
+  Status BulkLoad(const std::vector<const KuduPartialRow*>& rows) {
+    std::vector<RowOp> ops;
+    ops.reserve(rows.size());
+    for (const KuduPartialRow* row : rows) {
+      ops.emplace_back(RowOperationsPB::INSERT, row);
+    }
+    req_.set_bulk_load(true);
+    Status s = WriteBatch(ops);
+    req_.clear_bulk_load();
+    return s;
+  }
+
+  // Delete the given row if its value of the table's TTL column is older than
+  // 'cutoff_micros' (see WriteRequestPB::ttl_expiry_cutoff_micros). Returns
+  // NotFound if the row doesn't exist or hasn't expired.
+  Status Expire(const KuduPartialRow& row, int64_t cutoff_micros) {
+    req_.set_ttl_expiry_cutoff_micros(cutoff_micros);
+    Status s = Write(RowOperationsPB::DELETE, row);
+    req_.clear_ttl_expiry_cutoff_micros();
+    return s;
+  }
+
   // Return the result of the last row operation run against the tablet.
   const OperationResultPB& last_op_result() {
     CHECK_GE(result_->ops_size(), 1);
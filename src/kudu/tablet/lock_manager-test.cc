@@ -62,6 +62,15 @@ class LockManagerTest : public KuduTest {
               lock_manager_.TryLock(key, kFakeTransaction, LockManager::LOCK_EXCLUSIVE, &entry));
   }
 
+  static LockManager::LockStatus TryLock(LockManager* manager, const Slice& key,
+                                         LockEntry** entry) {
+    return manager->TryLock(key, kFakeTransaction, LockManager::LOCK_EXCLUSIVE, entry);
+  }
+
+  static void Release(LockManager* manager, LockEntry* entry) {
+    manager->Release(entry, LockManager::LOCK_ACQUIRED);
+  }
+
   LockManager lock_manager_;
 };
 
@@ -117,6 +126,38 @@ TEST_F(LockManagerTest, TestMoveLock) {
   ASSERT_FALSE(row_lock.acquired()); // NOLINT(bugprone-use-after-move)
 }
 
+TEST_F(LockManagerTest, TestShardCount) {
+  ASSERT_EQ(1, LockManager(1).num_shards());
+  ASSERT_EQ(4, LockManager(3).num_shards());
+  ASSERT_EQ(16, LockManager(16).num_shards());
+  ASSERT_EQ(256, LockManager(100000).num_shards());
+}
+
+// Lock enough rows that every shard holds some and resizes its table.
+TEST_F(LockManagerTest, TestLockRowsAcrossShards) {
+  LockManager manager(16);
+  vector<string> key_strings;
+  for (int i = 0; i < 1000; i++) {
+    key_strings.push_back(StringPrintf("key%04d", i));
+  }
+  {
+    vector<ScopedRowLock> locks;
+    for (const string& key : key_strings) {
+      locks.emplace_back(&manager, kFakeTransaction, Slice(key), LockManager::LOCK_EXCLUSIVE);
+    }
+    for (const string& key : key_strings) {
+      LockEntry* entry;
+      ASSERT_EQ(LockManager::LOCK_BUSY, TryLock(&manager, key, &entry));
+    }
+  }
+  // All of the locks were released.
+  for (const string& key : key_strings) {
+    LockEntry* entry;
+    ASSERT_EQ(LockManager::LOCK_ACQUIRED, TryLock(&manager, key, &entry));
+    Release(&manager, entry);
+  }
+}
+
 class LmTestResource {
  public:
   explicit LmTestResource(const Slice* id)
@@ -22,21 +22,33 @@
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <utility>
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "kudu/gutil/atomicops.h"
 #include "kudu/gutil/dynamic_annotations.h"
 #include "kudu/gutil/hash/city.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/sysinfo.h"
 #include "kudu/gutil/walltime.h"
 #include "kudu/util/faststring.h"
+#include "kudu/util/flag_tags.h"
 #include "kudu/util/locks.h"
 #include "kudu/util/logging.h"
+#include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/semaphore.h"
 #include "kudu/util/trace.h"
 
+DEFINE_int32(tablet_lock_manager_shards, 0,
+             "Number of shards of each tablet's row lock table, rounded up to a "
+             "power of two. Each shard is locked and resized independently, which "
+             "reduces contention between concurrent writes to the same tablet. "
+             "If 0, the number of CPUs is used.");
+TAG_FLAG(tablet_lock_manager_shards, advanced);
+
 using base::subtle::NoBarrier_Load;
 using std::string;
 using std::unique_ptr;
@@ -54,10 +66,10 @@ class OpState;
 // Callers should generally use ScopedRowLock (see below).
 class LockEntry {
  public:
-  explicit LockEntry(const Slice& key)
+  LockEntry(const Slice& key, uint64_t key_hash)
   : sem(1),
     recursion_(0) {
-    key_hash_ = util_hash::CityHash64(reinterpret_cast<const char *>(key.data()), key.size());
+    key_hash_ = key_hash;
     key_ = key;
     refs_ = 1;
   }
@@ -126,7 +138,7 @@ class LockTable {
     }
   }
 
-  LockEntry *GetLockEntry(const Slice &key);
+  LockEntry *GetLockEntry(const Slice &key, uint64_t key_hash);
   void ReleaseLockEntry(LockEntry *entry);
 
  private:
@@ -160,8 +172,9 @@ class LockTable {
   void Resize();
 
  private:
-  // table rwlock used as write on resize
-  percpu_rwlock lock_;
+  // table rwlock used as write on resize. This is a single lock rather than a
+  // percpu_rwlock: readers are already spread over the LockManager's shards.
+  rw_spinlock lock_;
   // size - 1 used to lookup the bucket (hash & mask_)
   uint64_t mask_;
   // number of buckets in the table
@@ -172,12 +185,12 @@ class LockTable {
   base::subtle::Atomic64 item_count_;
 };
 
-LockEntry *LockTable::GetLockEntry(const Slice& key) {
-  auto new_entry = new LockEntry(key);
+LockEntry *LockTable::GetLockEntry(const Slice& key, uint64_t key_hash) {
+  auto new_entry = new LockEntry(key, key_hash);
   LockEntry *old_entry;
 
   {
-    shared_lock<rw_spinlock> l(lock_.get_lock());
+    shared_lock<rw_spinlock> l(lock_);
     Bucket *bucket = FindBucket(new_entry->key_hash_);
     {
       std::lock_guard<simple_spinlock> bucket_lock(bucket->lock);
@@ -199,9 +212,9 @@ LockEntry *LockTable::GetLockEntry(const Slice& key) {
   }
 
   if (base::subtle::NoBarrier_AtomicIncrement(&item_count_, 1) > size_) {
-    std::unique_lock<percpu_rwlock> table_wrlock(lock_, std::try_to_lock);
+    std::unique_lock<rw_spinlock> table_wrlock(lock_, std::try_to_lock);
     // if we can't take the lock, means that someone else is resizing.
-    // (The percpu_rwlock try_lock waits for readers to complete)
+    // (The rw_spinlock try_lock waits for readers to complete)
     if (table_wrlock.owns_lock()) {
       Resize();
     }
@@ -213,7 +226,7 @@ LockEntry *LockTable::GetLockEntry(const Slice& key) {
 void LockTable::ReleaseLockEntry(LockEntry *entry) {
   bool removed = false;
   {
-    std::lock_guard<rw_spinlock> table_rdlock(lock_.get_lock());
+    shared_lock<rw_spinlock> table_rdlock(lock_);
     Bucket *bucket = FindBucket(entry->key_hash_);
     {
       std::lock_guard<simple_spinlock> bucket_lock(bucket->lock);
@@ -278,9 +291,17 @@ ScopedRowLock::ScopedRowLock(LockManager *manager,
                              const OpState* op,
                              const Slice &key,
                              LockManager::LockMode mode)
+  : ScopedRowLock(manager, op, key, LockManager::HashKey(key), mode) {
+}
+
+ScopedRowLock::ScopedRowLock(LockManager *manager,
+                             const OpState* op,
+                             const Slice &key,
+                             uint64_t key_hash,
+                             LockManager::LockMode mode)
   : manager_(DCHECK_NOTNULL(manager)),
     acquired_(false) {
-  ls_ = manager_->Lock(key, op, mode, &entry_);
+  ls_ = manager_->Lock(key, key_hash, op, mode, &entry_);
 
   if (ls_ == LockManager::LOCK_ACQUIRED) {
     acquired_ = true;
@@ -327,18 +348,43 @@ void ScopedRowLock::Release() {
 // ============================================================================
 
 LockManager::LockManager()
-  : locks_(new LockTable()) {
+  : LockManager(FLAGS_tablet_lock_manager_shards > 0 ? FLAGS_tablet_lock_manager_shards
+                                                     : base::NumCPUs()) {
+}
+
+LockManager::LockManager(int num_shards)
+  : shard_bits_(0) {
+  // Cap the shard count: each shard is only a few cache lines, but a tablet
+  // server may host thousands of tablets.
+  while ((1 << shard_bits_) < num_shards && shard_bits_ < 8) {
+    shard_bits_++;
+  }
+  shards_.reset(new LockTable[1 << shard_bits_]);
 }
 
 LockManager::~LockManager() {
-  delete locks_;
+}
+
+uint64_t LockManager::HashKey(const Slice& key) {
+  return util_hash::CityHash64(reinterpret_cast<const char *>(key.data()), key.size());
+}
+
+void LockManager::SetMetrics(scoped_refptr<Counter> wait_count,
+                             scoped_refptr<Histogram> wait_duration) {
+  wait_count_ = std::move(wait_count);
+  wait_duration_ = std::move(wait_duration);
+}
+
+LockTable* LockManager::shard(uint64_t key_hash) const {
+  return shard_bits_ == 0 ? &shards_[0] : &shards_[key_hash >> (64 - shard_bits_)];
 }
 
 LockManager::LockStatus LockManager::Lock(const Slice& key,
+                                          uint64_t key_hash,
                                           const OpState* op,
                                           LockManager::LockMode mode,
                                           LockEntry** entry) {
-  *entry = locks_->GetLockEntry(key);
+  *entry = shard(key_hash)->GetLockEntry(key, key_hash);
 
   // We expect low contention, so just try to try_lock first. This is faster
   // than a timed_lock, since we don't have to do a syscall to get the current
@@ -360,8 +406,6 @@ LockManager::LockStatus LockManager::Lock(const Slice& key,
 
     // If we couldn't immediately acquire the lock, do a timed lock so we can
     // warn if it takes a long time.
-    // TODO: would be nice to hook in some histogram metric about lock acquisition
-    // time. For now we just associate with per-request metrics.
     TRACE_COUNTER_INCREMENT("row_lock_wait_count", 1);
     MicrosecondsInt64 start_wait_us = GetMonoTimeMicros();
     int waited_seconds = 0;
@@ -375,6 +419,10 @@ LockManager::LockStatus LockManager::Lock(const Slice& key,
     }
     MicrosecondsInt64 wait_us = GetMonoTimeMicros() - start_wait_us;
     TRACE_COUNTER_INCREMENT("row_lock_wait_us", wait_us);
+    if (wait_count_) {
+      wait_count_->Increment();
+      wait_duration_->Increment(wait_us);
+    }
     if (wait_us > 100 * 1000) {
       TRACE("Waited $0us for lock on $1", wait_us, KUDU_REDACT(key.ToDebugString()));
     }
@@ -388,10 +436,11 @@ LockManager::LockStatus LockManager::TryLock(const Slice& key,
                                              const OpState* op,
                                              LockManager::LockMode mode,
                                              LockEntry **entry) {
-  *entry = locks_->GetLockEntry(key);
+  const uint64_t key_hash = HashKey(key);
+  *entry = shard(key_hash)->GetLockEntry(key, key_hash);
   bool locked = (*entry)->sem.TryAcquire();
   if (!locked) {
-    locks_->ReleaseLockEntry(*entry);
+    shard(key_hash)->ReleaseLockEntry(*entry);
     return LOCK_BUSY;
   }
   (*entry)->holder_ = op;
@@ -407,7 +456,7 @@ void LockManager::Release(LockEntry *lock, LockStatus ls) {
       lock->sem.Release();
     }
   }
-  locks_->ReleaseLockEntry(lock);
+  shard(lock->key_hash_)->ReleaseLockEntry(lock);
 }
 
 } // namespace tablet
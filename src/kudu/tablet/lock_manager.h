@@ -18,11 +18,19 @@
 #define KUDU_TABLET_LOCK_MANAGER_H
 
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 
 #include "kudu/gutil/macros.h"
+#include "kudu/gutil/ref_counted.h"
 #include "kudu/util/slice.h"
 
-namespace kudu { namespace tablet {
+namespace kudu {
+
+class Counter;
+class Histogram;
+
+namespace tablet {
 
 class LockTable;
 class LockEntry;
@@ -35,11 +43,35 @@ class OpState;
 // In the future when we want to support multi-row transactions of some kind
 // we'll have to implement a proper lock manager with all its trappings,
 // but this should be enough for the single-row use case.
+//
+// The locks are spread over a number of independent lock table shards by the
+// hash of their key, so that concurrent writers to a hot tablet rarely share
+// a shard's locks. Ops which lock several rows should lock them in increasing
+// order of HashKey() so that two such ops can't deadlock; see
+// Tablet::AcquireRowLocks().
 class LockManager {
  public:
+  // Creates a lock manager with --tablet_lock_manager_shards shards.
   LockManager();
+
+  // Creates a lock manager with 'num_shards' shards, rounded up to a power
+  // of two.
+  explicit LockManager(int num_shards);
+
   ~LockManager();
 
+  // Returns the hash by which the lock on 'key' is found.
+  static uint64_t HashKey(const Slice& key);
+
+  // Sets the metrics updated when a lock can't be acquired immediately.
+  // Must be called before any lock is taken.
+  void SetMetrics(scoped_refptr<Counter> wait_count,
+                  scoped_refptr<Histogram> wait_duration);
+
+  int num_shards() const {
+    return 1 << shard_bits_;
+  }
+
   enum LockStatus {
     LOCK_ACQUIRED = 0,
     LOCK_BUSY = 1,
@@ -53,13 +85,23 @@ class LockManager {
   friend class ScopedRowLock;
   friend class LockManagerTest;
 
-  LockStatus Lock(const Slice& key, const OpState* op,
+  LockStatus Lock(const Slice& key, uint64_t key_hash, const OpState* op,
                   LockMode mode, LockEntry **entry);
   LockStatus TryLock(const Slice& key, const OpState* op,
                      LockMode mode, LockEntry **entry);
   void Release(LockEntry *lock, LockStatus ls);
 
-  LockTable *locks_;
+  // Returns the shard holding the locks of keys with hash 'key_hash'. The
+  // shard is chosen by the high bits of the hash, since the low bits select
+  // the bucket within the shard.
+  LockTable* shard(uint64_t key_hash) const;
+
+  // log2 of the number of shards.
+  int shard_bits_;
+  std::unique_ptr<LockTable[]> shards_;
+
+  scoped_refptr<Counter> wait_count_;
+  scoped_refptr<Histogram> wait_duration_;
 
   DISALLOW_COPY_AND_ASSIGN(LockManager);
 };
@@ -103,6 +145,10 @@ class ScopedRowLock {
   ScopedRowLock(LockManager *manager, const OpState* ctx,
                 const Slice &key, LockManager::LockMode mode);
 
+  // As above, for a key whose LockManager::HashKey() was already computed.
+  ScopedRowLock(LockManager *manager, const OpState* ctx,
+                const Slice &key, uint64_t key_hash, LockManager::LockMode mode);
+
   // Move constructor and assignment.
   ScopedRowLock(ScopedRowLock&& other) noexcept;
   ScopedRowLock& operator=(ScopedRowLock&& other) noexcept;
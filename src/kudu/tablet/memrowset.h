@@ -182,6 +182,13 @@ class MRSRow {
 };
 
 struct MSBTreeTraits : public btree::BTreeTraits {
+  // Encoded primary keys of up to 23 bytes (e.g. a short STRING plus an
+  // INT64) are stored inline in the tree, and longer ones keep their first
+  // 16 bytes inline. This saves a pointer chase per key comparison, and the
+  // separate arena copy of the key. Leaves are made larger to keep their
+  // fanout with the wider key slots.
+  static const size_t kLeafNodeSize = 8 * CACHELINE_SIZE;
+  static const size_t kKeySlotSize = 24;
   typedef ThreadSafeMemoryTrackingArena ArenaType;
 };
 
@@ -402,6 +409,13 @@ class MemRowSet : public RowSet,
     return Status::OK();
   }
 
+  Status IsExpired(const ColumnId& /*col_id*/, int64_t /*cutoff_micros*/,
+                   bool* expired) override {
+    DCHECK(expired);
+    *expired = false;
+    return Status::OK();
+  }
+
   Status InitUndoDeltas(Timestamp /*ancient_history_mark*/,
                         MonoTime /*deadline*/,
                         const fs::IOContext* /*io_context*/,
@@ -153,6 +153,12 @@ class MockRowSet : public RowSet {
     return Status::OK();
   }
 
+  virtual Status IsExpired(const ColumnId& /*col_id*/, int64_t /*cutoff_micros*/,
+                           bool* /*expired*/) override {
+    LOG(FATAL) << "Unimplemented";
+    return Status::OK();
+  }
+
   virtual Status EstimateBytesInPotentiallyAncientUndoDeltas(Timestamp /*ancient_history_mark*/,
                                                              int64_t* /*bytes*/) override {
     LOG(FATAL) << "Unimplemented";
@@ -0,0 +1,177 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "kudu/tablet/multi_column_writer.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags_declare.h>
+#include <gtest/gtest.h>
+
+#include "kudu/common/columnblock.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/types.h"
+#include "kudu/fs/block_id.h"
+#include "kudu/fs/block_manager.h"
+#include "kudu/fs/data_dirs.h"
+#include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/memory/arena.h"
+#include "kudu/util/slice.h"
+#include "kudu/util/status.h"
+#include "kudu/util/test_macros.h"
+#include "kudu/util/test_util.h"
+
+DECLARE_int32(column_encode_threads);
+DECLARE_int32(column_encode_min_columns_per_task);
+
+using std::map;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using strings::Substitute;
+
+namespace kudu {
+namespace tablet {
+
+static const char* const kTabletId = "test-tablet";
+
+class MultiColumnWriterTest : public KuduTest {
+ public:
+  void SetUp() override {
+    KuduTest::SetUp();
+    fs_manager_.reset(new FsManager(env_, FsManagerOpts(GetTestPath("fs_root"))));
+    ASSERT_OK(fs_manager_->CreateInitialFileSystemLayout());
+    ASSERT_OK(fs_manager_->Open());
+    ASSERT_OK(fs_manager_->dd_manager()->CreateDataDirGroup(kTabletId));
+
+    // A wide schema mixing fixed-size, nullable and indirect columns.
+    SchemaBuilder builder;
+    ASSERT_OK(builder.AddKeyColumn("key", INT32));
+    for (int i = 1; i < kNumColumns; i++) {
+      switch (i % 3) {
+        case 0:
+          ASSERT_OK(builder.AddColumn(Substitute("c$0", i), INT64));
+          break;
+        case 1:
+          ASSERT_OK(builder.AddNullableColumn(Substitute("c$0", i), INT32));
+          break;
+        default:
+          ASSERT_OK(builder.AddColumn(Substitute("c$0", i), STRING));
+          break;
+      }
+    }
+    schema_ = builder.Build();
+  }
+
+ protected:
+  // Write kNumRows rows with the current flags, and return the contents of
+  // the written blocks, in column order.
+  void WriteRows(vector<string>* contents) {
+    MultiColumnWriter writer(fs_manager_.get(), &schema_, kTabletId);
+    ASSERT_OK(writer.Open());
+
+    Arena arena(1024);
+    RowBlock block(&schema_, kRowsPerBlock, &arena);
+    for (int row = 0; row < kNumRows; row += kRowsPerBlock) {
+      arena.Reset();
+      for (int i = 0; i < kRowsPerBlock; i++) {
+        const int32_t val = row + i;
+        RowBlockRow dst = block.row(i);
+        for (int col = 0; col < schema_.num_columns(); col++) {
+          const ColumnSchema& col_schema = schema_.column(col);
+          uint8_t* cell = dst.mutable_cell_ptr(col);
+          if (col_schema.is_nullable()) {
+            dst.cell(col).set_null(val % 7 == 0);
+          }
+          switch (col_schema.type_info()->type()) {
+            case INT32:
+              *reinterpret_cast<int32_t*>(cell) = val * col;
+              break;
+            case INT64:
+              *reinterpret_cast<int64_t*>(cell) = static_cast<int64_t>(val) << col;
+              break;
+            case STRING: {
+              Slice s;
+              ASSERT_TRUE(arena.RelocateSlice(Substitute("row $0 col $1", val, col), &s));
+              *reinterpret_cast<Slice*>(cell) = s;
+              break;
+            }
+            default:
+              FAIL() << "Unexpected type";
+          }
+        }
+      }
+      ASSERT_OK(writer.AppendBlock(block));
+    }
+
+    unique_ptr<fs::BlockCreationTransaction> transaction =
+        fs_manager_->block_manager()->NewCreationTransaction();
+    ASSERT_OK(writer.FinishAndReleaseBlocks(transaction.get()));
+    ASSERT_OK(transaction->CommitCreatedBlocks());
+
+    map<ColumnId, BlockId> blocks;
+    writer.GetFlushedBlocksByColumnId(&blocks);
+    ASSERT_EQ(schema_.num_columns(), blocks.size());
+    contents->clear();
+    for (const auto& e : blocks) {
+      unique_ptr<fs::ReadableBlock> rblock;
+      ASSERT_OK(fs_manager_->OpenBlock(e.second, &rblock));
+      uint64_t size;
+      ASSERT_OK(rblock->Size(&size));
+      string data(size, '\0');
+      ASSERT_OK(rblock->Read(0, Slice(&data[0], size)));
+      contents->emplace_back(std::move(data));
+    }
+  }
+
+  static constexpr int kNumColumns = 64;
+  static constexpr int kNumRows = 20000;
+  static constexpr int kRowsPerBlock = 100;
+
+  unique_ptr<FsManager> fs_manager_;
+  Schema schema_;
+};
+
+// Columns encoded in parallel must produce exactly the same files as columns
+// encoded serially.
+TEST_F(MultiColumnWriterTest, TestParallelEncodingMatchesSerial) {
+  vector<string> serial;
+  FLAGS_column_encode_threads = 0;
+  NO_FATALS(WriteRows(&serial));
+
+  for (int min_columns_per_task : { 1, 5, 16 }) {
+    SCOPED_TRACE(min_columns_per_task);
+    FLAGS_column_encode_threads = 8;
+    FLAGS_column_encode_min_columns_per_task = min_columns_per_task;
+    vector<string> parallel;
+    NO_FATALS(WriteRows(&parallel));
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (int i = 0; i < serial.size(); i++) {
+      SCOPED_TRACE(schema_.column(i).ToString());
+      ASSERT_EQ(serial[i], parallel[i]);
+    }
+  }
+}
+
+} // namespace tablet
+} // namespace kudu
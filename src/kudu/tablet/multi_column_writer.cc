@@ -17,10 +17,14 @@
 
 #include "kudu/tablet/multi_column_writer.h"
 
+#include <algorithm>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
 
 #include "kudu/cfile/cfile_util.h"
 #include "kudu/cfile/cfile_writer.h"
@@ -30,8 +34,26 @@
 #include "kudu/fs/block_id.h"
 #include "kudu/fs/block_manager.h"
 #include "kudu/fs/fs_manager.h"
+#include "kudu/gutil/once.h"
 #include "kudu/gutil/stl_util.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/util/debug/leak_annotations.h"
+#include "kudu/util/flag_tags.h"
+#include "kudu/util/threadpool.h"
+
+DEFINE_int32(column_encode_threads, 8,
+             "Number of threads in the process-wide pool used to encode and "
+             "compress the columns of flushed and compacted rowsets in parallel. "
+             "If 0, the columns are written serially by the flush or compaction "
+             "thread.");
+TAG_FLAG(column_encode_threads, advanced);
+
+DEFINE_int32(column_encode_min_columns_per_task, 16,
+             "Minimum number of columns appended by each column encoding task. "
+             "Rowsets with fewer than twice this many columns are written "
+             "serially, since the cost of handing off small blocks to other "
+             "threads would outweigh the benefit.");
+TAG_FLAG(column_encode_min_columns_per_task, advanced);
 
 namespace kudu {
 namespace tablet {
@@ -41,6 +63,24 @@ using fs::BlockCreationTransaction;
 using fs::CreateBlockOptions;
 using fs::WritableBlock;
 using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+GoogleOnceType encode_pool_once = GOOGLE_ONCE_INIT;
+ThreadPool* encode_pool = nullptr;
+
+void CreateEncodePool() {
+  unique_ptr<ThreadPool> pool;
+  CHECK_OK(ThreadPoolBuilder("col-encode")
+           .set_min_threads(0)
+           .set_max_threads(FLAGS_column_encode_threads)
+           .Build(&pool));
+  encode_pool = pool.release();
+  ANNOTATE_LEAKING_OBJECT_PTR(encode_pool);
+}
+
+} // anonymous namespace
 
 MultiColumnWriter::MultiColumnWriter(FsManager* fs,
                                      const Schema* schema,
@@ -48,7 +88,8 @@ MultiColumnWriter::MultiColumnWriter(FsManager* fs,
   : fs_(fs),
     schema_(schema),
     finished_(false),
-    tablet_id_(std::move(tablet_id)) {
+    tablet_id_(std::move(tablet_id)),
+    num_encode_tasks_(1) {
 }
 
 MultiColumnWriter::~MultiColumnWriter() {
@@ -72,6 +113,10 @@ Status MultiColumnWriter::Open() {
     /// Set the column storage attributes.
     opts.storage_attributes = col.attributes();
 
+    // Keep per-block statistics so scans can skip blocks that can't match
+    // their predicates.
+    opts.write_zone_maps = true;
+
     // If the schema has a single PK and this is the PK col
     if (i == 0 && schema_->num_key_columns() == 1) {
       opts.write_validx = true;
@@ -98,11 +143,56 @@ Status MultiColumnWriter::Open() {
   VLOG(1) << strings::Substitute("Opened CFile writers for $0 column(s)",
                                  cfile_writers_.size());
 
+  // The calling thread appends one share of the columns itself.
+  if (FLAGS_column_encode_threads > 0) {
+    num_encode_tasks_ = std::min(
+        FLAGS_column_encode_threads + 1,
+        static_cast<int>(schema_->num_columns()) /
+            std::max(FLAGS_column_encode_min_columns_per_task, 1));
+  }
+  if (num_encode_tasks_ > 1) {
+    GoogleOnceInit(&encode_pool_once, &CreateEncodePool);
+    encode_token_ = encode_pool->NewToken(ThreadPool::ExecutionMode::CONCURRENT);
+  } else {
+    num_encode_tasks_ = 1;
+  }
+
   return Status::OK();
 }
 
 Status MultiColumnWriter::AppendBlock(const RowBlock& block) {
-  for (int i = 0; i < schema_->num_columns(); i++) {
+  const int num_columns = schema_->num_columns();
+  if (!encode_token_) {
+    return AppendColumns(block, 0, num_columns);
+  }
+
+  // Split the columns into contiguous ranges of roughly equal size. Each
+  // column is appended by exactly one task, and we wait for all of them
+  // before returning, so the writers see the same sequence of appends as
+  // they would if written serially.
+  vector<Status> statuses(num_encode_tasks_);
+  for (int t = 1; t < num_encode_tasks_; t++) {
+    const int start_col = num_columns * t / num_encode_tasks_;
+    const int end_col = num_columns * (t + 1) / num_encode_tasks_;
+    Status* status = &statuses[t];
+    Status s = encode_token_->Submit([this, &block, start_col, end_col, status]() {
+      *status = AppendColumns(block, start_col, end_col);
+    });
+    if (PREDICT_FALSE(!s.ok())) {
+      statuses[t] = AppendColumns(block, start_col, end_col);
+    }
+  }
+  statuses[0] = AppendColumns(block, 0, num_columns / num_encode_tasks_);
+  encode_token_->Wait();
+
+  for (const Status& s : statuses) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
+Status MultiColumnWriter::AppendColumns(const RowBlock& block, int start_col, int end_col) {
+  for (int i = start_col; i < end_col; i++) {
     ColumnBlock column = block.column_block(i);
     if (column.is_nullable()) {
       RETURN_NOT_OK(cfile_writers_[i]->AppendNullableEntries(column.non_null_bitmap(),
@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,7 @@ namespace kudu {
 class FsManager;
 class RowBlock;
 class Schema;
+class ThreadPoolToken;
 struct ColumnId;
 
 namespace cfile {
@@ -47,6 +49,11 @@ namespace tablet {
 
 // Wrapper which writes several columns in parallel corresponding to some
 // Schema. Written blocks will fall in the tablet_id's data dir group.
+//
+// For schemas with many columns, the columns of each appended block are
+// encoded and compressed concurrently on a process-wide thread pool. Each
+// column is still appended by a single thread at a time and in the same
+// order, so the output is identical to that of a serial write.
 class MultiColumnWriter {
  public:
   MultiColumnWriter(FsManager* fs,
@@ -58,7 +65,8 @@ class MultiColumnWriter {
   // Open and start writing the columns.
   Status Open();
 
-  // Append the given block to the output columns.
+  // Append the given block to the output columns. Returns once all of the
+  // columns have been appended, so 'block' may be reused afterwards.
   //
   // Note that the selection vector here is ignored.
   Status AppendBlock(const RowBlock& block);
@@ -81,6 +89,9 @@ class MultiColumnWriter {
   void GetFlushedBlocksByColumnId(std::map<ColumnId, BlockId>* ret) const;
 
  private:
+  // Append the columns [start_col, end_col) of 'block' to their writers.
+  Status AppendColumns(const RowBlock& block, int start_col, int end_col);
+
   FsManager* const fs_;
   const Schema* const schema_;
 
@@ -91,6 +102,13 @@ class MultiColumnWriter {
   std::vector<cfile::CFileWriter *> cfile_writers_;
   std::vector<BlockId> block_ids_;
 
+  // Token for the column encoding pool, or null if columns are appended
+  // serially on the calling thread.
+  std::unique_ptr<ThreadPoolToken> encode_token_;
+
+  // The number of tasks each appended block is split into.
+  int num_encode_tasks_;
+
   DISALLOW_COPY_AND_ASSIGN(MultiColumnWriter);
 };
 
@@ -17,6 +17,7 @@
 
 #include "kudu/tablet/mvcc.h"
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <ostream>
@@ -39,6 +40,7 @@
 
 using std::thread;
 using std::unique_ptr;
+using std::vector;
 
 METRIC_DECLARE_entity(server);
 
@@ -781,5 +783,83 @@ TEST_F(MvccTest, TestCorrectInitWithNoTxns) {
   EXPECT_EQ(snap2.committed_timestamps_.size(), 0);
 }
 
+// Snapshots taken without the lock must match the manager's current snapshot,
+// both while the committed set fits the published form and once it doesn't.
+TEST_F(MvccTest, TestPublishedSnapshotMatchesCurrent) {
+  MvccManager mgr;
+  constexpr int kNumOps = 20;
+  vector<unique_ptr<ScopedOp>> ops;
+  for (int i = 0; i < kNumOps; i++) {
+    ops.emplace_back(new ScopedOp(&mgr, clock_.Now()));
+    ops.back()->StartApplying();
+  }
+
+  // Commit all but the earliest op in reverse order, so the clean time can't
+  // move and the committed set keeps growing.
+  for (int i = kNumOps - 1; i > 0; i--) {
+    SCOPED_TRACE(i);
+    ops[i]->Commit();
+    MvccSnapshot published;
+    const int num_committed = kNumOps - i;
+    ASSERT_EQ(num_committed <= MvccManager::kMaxPublishedCommitted,
+              mgr.ReadPublishedSnapshot(&published));
+    if (num_committed <= MvccManager::kMaxPublishedCommitted) {
+      ASSERT_TRUE(published.Equals(mgr.cur_snap_)) << published.ToString();
+    }
+    ASSERT_TRUE(MvccSnapshot(mgr).Equals(mgr.cur_snap_));
+  }
+
+  // Once everything is committed the snapshot is clean again.
+  mgr.AdjustNewOpLowerBound(ops.back()->timestamp());
+  ops[0]->Commit();
+  MvccSnapshot published;
+  ASSERT_TRUE(mgr.ReadPublishedSnapshot(&published));
+  ASSERT_TRUE(published.is_clean());
+  ASSERT_TRUE(published.Equals(mgr.cur_snap_)) << published.ToString();
+  ASSERT_EQ(mgr.GetCleanTimestamp(), published.all_committed_before_);
+}
+
+// Readers taking snapshots while ops commit out of order must always see a
+// consistent snapshot, and a clean time which never moves backwards.
+TEST_F(MvccTest, TestConcurrentSnapshotsAreConsistent) {
+  MvccManager mgr;
+  std::atomic<bool> done(false);
+  vector<thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&]() {
+      Timestamp last_clean_time = Timestamp::kMin;
+      while (!done.load()) {
+        MvccSnapshot snap(mgr);
+        CHECK_GE(snap.all_committed_before_, last_clean_time);
+        CHECK_LE(snap.all_committed_before_, snap.none_committed_at_or_after_);
+        for (Timestamp::val_type ts : snap.committed_timestamps_) {
+          CHECK_GE(ts, snap.all_committed_before_.value());
+          CHECK_LT(ts, snap.none_committed_at_or_after_.value());
+        }
+        last_clean_time = snap.all_committed_before_;
+      }
+    });
+  }
+
+  for (int round = 0; round < 2000; round++) {
+    // Start a few ops and commit them latest first, sometimes enough that the
+    // committed set no longer fits the published form.
+    const int num_ops = 1 + round % 16;
+    vector<unique_ptr<ScopedOp>> ops;
+    for (int i = 0; i < num_ops; i++) {
+      ops.emplace_back(new ScopedOp(&mgr, clock_.Now()));
+      ops.back()->StartApplying();
+    }
+    mgr.AdjustNewOpLowerBound(ops.back()->timestamp());
+    for (int i = num_ops - 1; i >= 0; i--) {
+      ops[i]->Commit();
+    }
+  }
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+}
+
 } // namespace tablet
 } // namespace kudu
@@ -18,6 +18,8 @@
 #include "kudu/tablet/mvcc.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <ostream>
 #include <utility>
@@ -47,12 +49,18 @@ namespace tablet {
 
 using strings::Substitute;
 
+constexpr int MvccManager::kMaxPublishedCommitted;
+constexpr uint32_t MvccManager::kPublishedOverflow;
+
 MvccManager::MvccManager()
-  : new_op_timestamp_exc_lower_bound_(Timestamp::kMin),
+  : published_seq_(0),
+    new_op_timestamp_exc_lower_bound_(Timestamp::kMin),
     earliest_in_flight_(Timestamp::kMax),
     open_(true) {
   cur_snap_.all_committed_before_ = Timestamp::kInitialTimestamp;
   cur_snap_.none_committed_at_or_after_ = Timestamp::kInitialTimestamp;
+  std::lock_guard<LockType> l(lock_);
+  PublishSnapshotUnlocked();
 }
 
 Status MvccManager::CheckIsCleanTimeInitialized() const {
@@ -176,6 +184,7 @@ void MvccManager::CommitOpUnlocked(Timestamp timestamp,
 
   // Add to snapshot's committed list
   cur_snap_.AddCommittedTimestamp(timestamp);
+  PublishSnapshotUnlocked();
 
   // If we're committing the earliest op that was in flight,
   // update our cached value.
@@ -274,6 +283,7 @@ void MvccManager::AdjustCleanTimeUnlocked() {
   if (cur_snap_.committed_timestamps_.empty()) {
     cur_snap_.none_committed_at_or_after_ = cur_snap_.all_committed_before_;
   }
+  PublishSnapshotUnlocked();
 
   // it may also have unblocked some waiters.
   // Check if someone is waiting for ops to be committed.
@@ -367,10 +377,89 @@ bool MvccManager::AnyApplyingAtOrBeforeUnlocked(Timestamp ts) const {
 }
 
 void MvccManager::TakeSnapshot(MvccSnapshot *snap) const {
+  if (PREDICT_TRUE(ReadPublishedSnapshot(snap))) {
+    return;
+  }
   std::lock_guard<LockType> l(lock_);
   *snap = cur_snap_;
 }
 
+void MvccManager::PublishSnapshotUnlocked() {
+  DCHECK(lock_.is_locked());
+  const auto& committed = cur_snap_.committed_timestamps_;
+  const Timestamp::val_type clean_time = cur_snap_.all_committed_before_.value();
+  uint32_t offsets[kMaxPublishedCommitted];
+  uint32_t num_committed = committed.size();
+  if (num_committed > kMaxPublishedCommitted) {
+    num_committed = kPublishedOverflow;
+  } else {
+    for (uint32_t i = 0; i < num_committed; i++) {
+      // Committed timestamps are never below the clean time.
+      const Timestamp::val_type offset = committed[i] - clean_time;
+      if (offset >= kPublishedOverflow) {
+        num_committed = kPublishedOverflow;
+        break;
+      }
+      offsets[i] = offset;
+    }
+  }
+
+  const uint64_t seq = published_seq_.load(std::memory_order_relaxed);
+  published_seq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  published_all_committed_before_.store(clean_time, std::memory_order_relaxed);
+  published_none_committed_at_or_after_.store(
+      cur_snap_.none_committed_at_or_after_.value(), std::memory_order_relaxed);
+  published_num_committed_.store(num_committed, std::memory_order_relaxed);
+  if (num_committed != kPublishedOverflow) {
+    for (uint32_t i = 0; i < num_committed; i++) {
+      published_committed_offsets_[i].store(offsets[i], std::memory_order_relaxed);
+    }
+  }
+  published_seq_.store(seq + 2, std::memory_order_release);
+}
+
+bool MvccManager::ReadPublishedSnapshot(MvccSnapshot* snap) const {
+  // The writer's critical section is a handful of stores, so a reader which
+  // raced with it only needs a few retries. Give up eventually rather than
+  // spin against a steady stream of commits.
+  static constexpr int kMaxAttempts = 16;
+  for (int attempt = 0; attempt < kMaxAttempts; attempt++) {
+    const uint64_t seq = published_seq_.load(std::memory_order_acquire);
+    if (seq & 1) {
+      continue;
+    }
+    const Timestamp::val_type clean_time =
+        published_all_committed_before_.load(std::memory_order_relaxed);
+    const Timestamp::val_type none_committed_at_or_after =
+        published_none_committed_at_or_after_.load(std::memory_order_relaxed);
+    const uint32_t num_committed = published_num_committed_.load(std::memory_order_relaxed);
+    if (num_committed == kPublishedOverflow) {
+      return false;
+    }
+    uint32_t offsets[kMaxPublishedCommitted];
+    // The count may be torn if a writer raced with us; only trust it once the
+    // sequence number has been rechecked.
+    const uint32_t num_read = std::min<uint32_t>(num_committed, kMaxPublishedCommitted);
+    for (uint32_t i = 0; i < num_read; i++) {
+      offsets[i] = published_committed_offsets_[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (published_seq_.load(std::memory_order_relaxed) != seq) {
+      continue;
+    }
+
+    snap->all_committed_before_ = Timestamp(clean_time);
+    snap->none_committed_at_or_after_ = Timestamp(none_committed_at_or_after);
+    snap->committed_timestamps_.resize(num_read);
+    for (uint32_t i = 0; i < num_read; i++) {
+      snap->committed_timestamps_[i] = clean_time + offsets[i];
+    }
+    return true;
+  }
+  return false;
+}
+
 Status MvccManager::WaitForSnapshotWithAllCommitted(Timestamp timestamp,
                                                     MvccSnapshot* snapshot,
                                                     const MonoTime& deadline) const {
@@ -407,8 +496,7 @@ Status MvccManager::WaitForApplyingOpsToCommit() const {
 }
 
 Timestamp MvccManager::GetCleanTimestamp() const {
-  std::lock_guard<LockType> l(lock_);
-  return cur_snap_.all_committed_before_;
+  return Timestamp(published_all_committed_before_.load(std::memory_order_acquire));
 }
 
 void MvccManager::GetApplyingOpsTimestamps(std::vector<Timestamp>* timestamps) const {
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -121,6 +122,8 @@ class MvccSnapshot {
   FRIEND_TEST(MvccTest, TestMayHaveUncommittedOpsBefore);
   FRIEND_TEST(MvccTest, TestWaitUntilAllCommitted_SnapAtTimestampWithInFlights);
   FRIEND_TEST(MvccTest, TestCorrectInitWithNoTxns);
+  FRIEND_TEST(MvccTest, TestPublishedSnapshotMatchesCurrent);
+  FRIEND_TEST(MvccTest, TestConcurrentSnapshotsAreConsistent);
 
   bool IsCommittedFallback(const Timestamp& timestamp) const;
 
@@ -262,6 +265,7 @@ class MvccManager {
   friend class MvccTest;
   friend class ScopedOp;
   FRIEND_TEST(MvccTest, TestAutomaticCleanTimeMoveToSafeTimeOnCommit);
+  FRIEND_TEST(MvccTest, TestPublishedSnapshotMatchesCurrent);
   FRIEND_TEST(MvccTest, TestIllegalStateTransitionsCrash);
   FRIEND_TEST(MvccTest, TestTxnAbort);
 
@@ -304,8 +308,19 @@ class MvccManager {
 
   // Take a snapshot of the current MVCC state, which indicates which ops have
   // been committed at the time of this call.
+  //
+  // This usually doesn't take 'lock_': see PublishSnapshotUnlocked().
   void TakeSnapshot(MvccSnapshot *snapshot) const;
 
+  // Publishes a copy of 'cur_snap_' which readers may take without locking.
+  // Must be called with 'lock_' held, whenever 'cur_snap_' changes.
+  void PublishSnapshotUnlocked();
+
+  // Copies the published snapshot into 'snapshot' without locking. Returns
+  // false if the snapshot couldn't be published in compact form, in which
+  // case the caller must copy 'cur_snap_' under 'lock_'.
+  bool ReadPublishedSnapshot(MvccSnapshot* snapshot) const;
+
   bool InitOpUnlocked(const Timestamp& timestamp);
 
   // TODO(dralves) ponder merging these since the new ALL_COMMITTED path no longer
@@ -370,6 +385,21 @@ class MvccManager {
 
   MvccSnapshot cur_snap_;
 
+  // A compact copy of 'cur_snap_' published for readers, as a seqlock: the
+  // writer makes 'published_seq_' odd while it updates the copy, and readers
+  // retry if the sequence number was odd or changed while they read. The
+  // committed timestamps above the clean time are stored in order, as 32-bit
+  // offsets from the clean time. If there are too many or they span too wide
+  // a range, 'published_num_committed_' is kPublishedOverflow and readers
+  // take 'lock_' instead.
+  static constexpr int kMaxPublishedCommitted = 12;
+  static constexpr uint32_t kPublishedOverflow = UINT32_MAX;
+  std::atomic<uint64_t> published_seq_;
+  std::atomic<Timestamp::val_type> published_all_committed_before_;
+  std::atomic<Timestamp::val_type> published_none_committed_at_or_after_;
+  std::atomic<uint32_t> published_num_committed_;
+  std::atomic<uint32_t> published_committed_offsets_[kMaxPublishedCommitted];
+
   // The set of timestamps corresponding to currently in-flight ops.
   typedef std::unordered_map<Timestamp::val_type, TxnState> InFlightMap;
   InFlightMap timestamps_in_flight_;
@@ -26,6 +26,7 @@
 
 #include "kudu/common/wire_protocol.h"
 #include "kudu/tablet/tablet.pb.h"
+#include "kudu/tablet/tablet_metadata.h"
 #include "kudu/util/pb_util.h"
 #include "kudu/util/status.h"
 
@@ -55,6 +56,17 @@ void RowOp::SetInsertSucceeded(int mrs_id) {
   result->add_mutated_stores()->set_mrs_id(mrs_id);
 }
 
+void RowOp::SetBulkLoadSucceeded(int64_t rs_id) {
+  DCHECK(!result) << SecureDebugString(*result);
+  result = google::protobuf::Arena::CreateMessage<OperationResultPB>(pb_arena_);
+  // The row isn't in any of the rowset's delta stores. Naming none of them
+  // lets bootstrap treat the row as flushed for as long as the rowset is
+  // in the tablet metadata, which it is by the time the op commits.
+  MemStoreTargetPB* target = result->add_mutated_stores();
+  target->set_rs_id(rs_id);
+  target->set_dms_id(kNoDurableMemStore);
+}
+
 void RowOp::SetErrorIgnored() {
   DCHECK(!result) << SecureDebugString(*result);
   result = google::protobuf::Arena::CreateMessage<OperationResultPB>(pb_arena_);
@@ -16,6 +16,7 @@
 // under the License.
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 #include "kudu/common/row_operations.h"
@@ -44,11 +45,15 @@ struct RowOp {
   ~RowOp() = default;
 
   // Functions to set the result of the mutation.
-  // Only one of the following four functions must be called, at most once.
+  // Only one of the following five functions must be called, at most once.
   void SetFailed(const Status& s);
   void SetInsertSucceeded(int mrs_id);
   void SetErrorIgnored();
 
+  // Sets the result of an insert which was bulk loaded straight into the
+  // DiskRowSet with ID 'rs_id'.
+  void SetBulkLoadSucceeded(int64_t rs_id);
+
   // REQUIRES: result must be allocated from the same protobuf::Arena associated
   // with this RowOp.
   void SetMutateSucceeded(OperationResultPB* result);
@@ -49,6 +49,17 @@ RowIteratorOptions::RowIteratorOptions()
       order(OrderMode::UNORDERED),
       include_deleted_rows(false) {}
 
+Status RowSet::CheckRowsPresent(const RowSetKeyProbe* const* probes,
+                                int num_probes,
+                                const IOContext* io_context,
+                                bool* present,
+                                ProbeStats* const* stats) const {
+  for (int i = 0; i < num_probes; i++) {
+    RETURN_NOT_OK(CheckRowPresent(*probes[i], io_context, &present[i], stats[i]));
+  }
+  return Status::OK();
+}
+
 Status RowSet::NewRowIteratorWithBounds(const RowIteratorOptions& opts,
                                         IterWithBounds* out) const {
   // Get the iterator.
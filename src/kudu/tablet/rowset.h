@@ -120,6 +120,18 @@ class RowSet {
   virtual Status CheckRowPresent(const RowSetKeyProbe &probe, const fs::IOContext* io_context,
                                  bool *present, ProbeStats* stats) const = 0;
 
+  // Check if each of the given row keys is present in this rowset, setting
+  // present[i] and accounting the lookups in stats[i] for probes[i]. The
+  // probes must be sorted by encoded key.
+  //
+  // The default implementation calls CheckRowPresent() for each key. Rowsets
+  // may override it to amortize the per-key overhead across the batch.
+  virtual Status CheckRowsPresent(const RowSetKeyProbe* const* probes,
+                                  int num_probes,
+                                  const fs::IOContext* io_context,
+                                  bool* present,
+                                  ProbeStats* const* stats) const;
+
   // Update/delete a row in this rowset.
   // The 'update_schema' is the client schema used to encode the 'update' RowChangeList.
   //
@@ -226,6 +238,15 @@ class RowSet {
   virtual Status IsDeletedAndFullyAncient(Timestamp ancient_history_mark,
                                           bool* deleted_and_ancient) = 0;
 
+  // Returns whether every value of the UNIXTIME_MICROS column 'col_id' in the
+  // rowset is older than 'cutoff_micros', such that the rowset as a whole has
+  // outlived the table's TTL. Only used to estimate how much data expiring
+  // rows would delete (see Tablet::GetBytesInExpiredRowsets()).
+  //
+  // This may return false negatives, but should not return false positives.
+  virtual Status IsExpired(const ColumnId& col_id, int64_t cutoff_micros,
+                           bool* expired) = 0;
+
   // Estimate the number of bytes in ancient undo delta stores. This may be an
   // overestimate. The argument 'ancient_history_mark' must be valid (it may
   // not be equal to Timestamp::kInvalidTimestamp).
@@ -478,6 +499,13 @@ class DuplicatingRowSet : public RowSet {
     return Status::OK();
   }
 
+  Status IsExpired(const ColumnId& /*col_id*/, int64_t /*cutoff_micros*/,
+                   bool* expired) override {
+    DCHECK(expired);
+    *expired = false;
+    return Status::OK();
+  }
+
   Status InitUndoDeltas(Timestamp /*ancient_history_mark*/,
                         MonoTime /*deadline*/,
                         const fs::IOContext* /*io_context*/,
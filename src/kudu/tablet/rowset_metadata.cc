@@ -100,9 +100,13 @@ void RowSetMetadata::LoadFromPB(const RowSetDataPB& pb) {
 
   // Load Column Files.
   blocks_by_col_id_.clear();
+  max_unixtime_micros_by_col_id_.clear();
   for (const ColumnDataPB& col_pb : pb.columns()) {
     ColumnId col_id = ColumnId(col_pb.column_id());
     blocks_by_col_id_[col_id] = BlockId::FromPB(col_pb.block());
+    if (col_pb.has_max_unixtime_micros()) {
+      max_unixtime_micros_by_col_id_[col_id] = col_pb.max_unixtime_micros();
+    }
   }
 
   // Load redo delta files.
@@ -138,6 +142,10 @@ void RowSetMetadata::ToProtobuf(RowSetDataPB *pb) {
     ColumnDataPB *col_data = pb->add_columns();
     block_id.CopyToPB(col_data->mutable_block());
     col_data->set_column_id(col_id);
+    int64_t max_micros;
+    if (FindCopy(max_unixtime_micros_by_col_id_, col_id, &max_micros)) {
+      col_data->set_max_unixtime_micros(max_micros);
+    }
   }
 
   // Write Delta Files
@@ -186,6 +194,15 @@ void RowSetMetadata::SetColumnDataBlocks(const std::map<ColumnId, BlockId>& bloc
   blocks_by_col_id_ = std::move(new_map);
 }
 
+void RowSetMetadata::SetColumnMaxUnixtimeMicros(
+    const std::map<ColumnId, int64_t>& max_by_col_id) {
+  boost::container::flat_map<ColumnId, int64_t> new_map(max_by_col_id.begin(),
+                                                        max_by_col_id.end());
+  new_map.shrink_to_fit();
+  std::lock_guard<LockType> l(lock_);
+  max_unixtime_micros_by_col_id_ = std::move(new_map);
+}
+
 Status RowSetMetadata::CommitRedoDeltaDataBlock(int64_t dms_id,
                                                 int64_t num_deleted_rows,
                                                 const BlockId& block_id) {
@@ -268,11 +285,15 @@ void RowSetMetadata::CommitUpdate(const RowSetMetadataUpdate& update,
       if (UpdateReturnCopy(&blocks_by_col_id_, e.first, e.second, &old_block_id)) {
         removed->push_back(old_block_id);
       }
+      // The rewritten base data may hold greater values, e.g. if the column
+      // was updated, so its maximum is no longer known.
+      max_unixtime_micros_by_col_id_.erase(e.first);
     }
 
     for (const ColumnId& col_id : update.col_ids_to_remove_) {
       BlockId old = FindOrDie(blocks_by_col_id_, col_id);
       CHECK_EQ(1, blocks_by_col_id_.erase(col_id));
+      max_unixtime_micros_by_col_id_.erase(col_id);
       removed->push_back(old);
     }
   }
@@ -117,6 +117,21 @@ class RowSetMetadata {
 
   void SetColumnDataBlocks(const std::map<ColumnId, BlockId>& blocks_by_col_id);
 
+  // Record the greatest value written to each of the given UNIXTIME_MICROS
+  // columns of this rowset.
+  void SetColumnMaxUnixtimeMicros(const std::map<ColumnId, int64_t>& max_by_col_id);
+
+  // Returns the greatest value written to the UNIXTIME_MICROS column 'col_id'
+  // of this rowset, or boost::none if it isn't known.
+  boost::optional<int64_t> column_max_unixtime_micros(const ColumnId& col_id) const {
+    std::lock_guard<LockType> l(lock_);
+    int64_t max_micros;
+    if (!FindCopy(max_unixtime_micros_by_col_id_, col_id, &max_micros)) {
+      return boost::none;
+    }
+    return max_micros;
+  }
+
   // Atomically commit the new redo delta block to RowSetMetadata.
   // This atomic operation includes updates to last_durable_redo_dms_id_ and live_row_count_.
   Status CommitRedoDeltaDataBlock(int64_t dms_id,
@@ -278,6 +293,9 @@ class RowSetMetadata {
 
   // Map of column ID to block ID.
   ColumnIdToBlockIdMap blocks_by_col_id_;
+  // Map of UNIXTIME_MICROS column ID to the greatest value in its base data,
+  // for the columns where it is known.
+  boost::container::flat_map<ColumnId, int64_t> max_unixtime_micros_by_col_id_;
   std::vector<BlockId> redo_delta_blocks_;
   std::vector<BlockId> undo_delta_blocks_;
 
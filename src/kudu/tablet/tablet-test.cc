@@ -77,6 +77,9 @@ DEFINE_int32(testiterator_num_inserts, 1000,
 DEFINE_int32(testcompaction_num_rows, 1000,
              "Number of rows per rowset in TestCompaction");
 
+DECLARE_int32(compaction_max_parallel_ranges);
+DECLARE_int32(compaction_min_range_size_mb);
+
 using kudu::cfile::ReaderOptions;
 using kudu::fs::ReadableBlock;
 using std::make_shared;
@@ -795,6 +798,52 @@ TYPED_TEST(TestTablet, TestInsertIgnore) {
   EXPECT_EQ(vector<string>{ this->setup_.FormatDebugRow(0, 1011, false) }, rows);
 }
 
+// Write a single batch whose operations arrive out of key order, some of them
+// hitting the same key, some hitting rows already flushed to a DiskRowSet.
+// The batch is applied in key order internally, so this verifies that the
+// reordering preserves the per-key order of operations.
+TYPED_TEST(TestTablet, TestUnsortedBatch) {
+  LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+  this->InsertTestRows(0, 10, 0);
+  ASSERT_OK(this->tablet()->Flush());
+
+  vector<unique_ptr<KuduPartialRow>> rows;
+  vector<LocalTabletWriter::RowOp> ops;
+  auto add_op = [&](RowOperationsPB::Type type, int64_t key_idx, int32_t val) {
+    rows.emplace_back(new KuduPartialRow(&this->client_schema_));
+    this->setup_.BuildRow(rows.back().get(), key_idx, val);
+    ops.emplace_back(type, rows.back().get());
+  };
+  for (int64_t i = 14; i >= 10; i--) {
+    add_op(RowOperationsPB::INSERT, i, 1);
+  }
+  for (int64_t i = 9; i >= 5; i--) {
+    add_op(RowOperationsPB::UPSERT, i, 2);
+  }
+  add_op(RowOperationsPB::INSERT, 20, 3);
+  add_op(RowOperationsPB::UPSERT, 20, 4);
+  add_op(RowOperationsPB::INSERT_IGNORE, 0, 5);
+  ASSERT_OK(writer.WriteBatch(ops));
+
+  vector<string> expected;
+  for (int64_t i = 0; i < 5; i++) {
+    expected.emplace_back(this->setup_.FormatDebugRow(i, 0, false));
+  }
+  for (int64_t i = 5; i < 10; i++) {
+    expected.emplace_back(this->setup_.FormatDebugRow(i, 2, false));
+  }
+  for (int64_t i = 10; i < 15; i++) {
+    expected.emplace_back(this->setup_.FormatDebugRow(i, 1, false));
+  }
+  expected.emplace_back(this->setup_.FormatDebugRow(20, 4, false));
+
+  vector<string> out_rows;
+  ASSERT_OK(this->IterateToStringList(&out_rows));
+  std::sort(expected.begin(), expected.end());
+  std::sort(out_rows.begin(), out_rows.end());
+  ASSERT_EQ(expected, out_rows);
+}
+
 TYPED_TEST(TestTablet, TestUpsert) {
   vector<string> rows;
   const auto& upserts_as_updates = this->tablet()->metrics()->upserts_as_updates;
@@ -947,6 +996,52 @@ TYPED_TEST(TestTablet, TestCompaction) {
   }
 }
 
+// Compact overlapping rowsets with updates and deletes, split into key ranges
+// which are merged in parallel.
+TYPED_TEST(TestTablet, TestParallelRangeCompaction) {
+  FLAGS_compaction_max_parallel_ranges = 4;
+  FLAGS_compaction_min_range_size_mb = 0;
+  const int64_t n_rows = this->ClampRowCount(FLAGS_testcompaction_num_rows);
+
+  // Interleave the keys of three rowsets, so that each of them spans the
+  // whole key space and every range boundary falls within all of them.
+  LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+  for (int rs = 0; rs < 3; rs++) {
+    for (int64_t i = rs; i < n_rows * 3; i += 3) {
+      ASSERT_OK(this->InsertTestRow(&writer, i, 0));
+    }
+    ASSERT_OK(this->tablet()->Flush());
+  }
+  for (int64_t i = 0; i < n_rows * 3; i += 7) {
+    ASSERT_OK(this->UpdateTestRow(&writer, i, 1));
+  }
+  const int64_t n_deleted = n_rows / 2;
+  this->DeleteTestRows(0, n_deleted);
+
+  ASSERT_OK(this->tablet()->Compact(Tablet::FORCE_COMPACT_ALL));
+  ASSERT_GT(this->tablet()->num_rowsets(), 1);
+  ASSERT_EQ(n_rows * 3 - n_deleted, this->TabletCount());
+  NO_FATALS(this->CheckLiveRowsCount(n_rows * 3 - n_deleted));
+  NO_FATALS(this->VerifyTestRows(n_deleted, n_rows * 3 - n_deleted));
+
+  // The output rowsets must not overlap.
+  RowSetVector rowsets;
+  this->tablet()->GetRowSetsForTests(&rowsets);
+  std::sort(rowsets.begin(), rowsets.end(),
+            [](const shared_ptr<RowSet>& a, const shared_ptr<RowSet>& b) {
+              string a_min, a_max, b_min, b_max;
+              CHECK_OK(a->GetBounds(&a_min, &a_max));
+              CHECK_OK(b->GetBounds(&b_min, &b_max));
+              return a_min < b_min;
+            });
+  for (int i = 1; i < rowsets.size(); i++) {
+    string prev_min, prev_max, min, max;
+    ASSERT_OK(rowsets[i - 1]->GetBounds(&prev_min, &prev_max));
+    ASSERT_OK(rowsets[i]->GetBounds(&min, &max));
+    ASSERT_LT(prev_max, min);
+  }
+}
+
 TYPED_TEST(TestTablet, TestCountLiveRowsAfterShutdown) {
   // Insert 1000 rows into memrowset
   uint64_t max_rows = this->ClampRowCount(FLAGS_testflush_num_inserts);
@@ -1494,6 +1589,80 @@ TEST_F(TestTabletStringKey, TestSplitKeyRangeWithMinimumValueRowSet) {
   }
 }
 
+// Test bulk loading rows straight into DiskRowSets. The keys of this setup
+// are "hello <idx>", so indexes with the same number of digits sort in order.
+TEST_F(TestTabletStringKey, TestBulkLoad) {
+  LocalTabletWriter writer(this->tablet().get(), &this->client_schema_);
+  auto build_rows = [&](int64_t first, int64_t count,
+                        vector<unique_ptr<KuduPartialRow>>* rows) {
+    rows->clear();
+    for (int64_t i = first; i < first + count; i++) {
+      rows->emplace_back(new KuduPartialRow(&this->client_schema_));
+      this->setup_.BuildRow(rows->back().get(), i, i);
+    }
+  };
+  auto bulk_load = [&](const vector<unique_ptr<KuduPartialRow>>& rows) {
+    vector<const KuduPartialRow*> ptrs;
+    for (const auto& row : rows) {
+      ptrs.push_back(row.get());
+    }
+    return writer.BulkLoad(ptrs);
+  };
+
+  // Load into an empty tablet. The rows land in a DiskRowSet and the
+  // MemRowSet stays empty.
+  const Timestamp before_load = this->clock()->Now();
+  vector<unique_ptr<KuduPartialRow>> rows;
+  build_rows(1000, 1000, &rows);
+  ASSERT_OK(bulk_load(rows));
+  ASSERT_EQ(1, this->tablet()->num_rowsets());
+  ASSERT_TRUE(this->tablet()->MemRowSetEmpty());
+  NO_FATALS(this->VerifyTestRows(1000, 1000));
+  ASSERT_EQ(1000, this->tablet()->metrics()->rows_bulk_loaded->value());
+
+  // Snapshots from before the load don't see the rows.
+  NO_FATALS(this->VerifyTestRowsWithTimestampAndVerifier(1000, 0, before_load, boost::none));
+
+  // The loaded rows behave like any other: they can be updated, and
+  // inserting them again fails.
+  ASSERT_OK(this->UpdateTestRow(&writer, 1500, 0));
+  Status s = this->InsertTestRow(&writer, 1500, 0);
+  ASSERT_TRUE(s.IsAlreadyPresent()) << s.ToString();
+
+  // Unsorted rows are inserted through the MemRowSet instead.
+  build_rows(2000, 10, &rows);
+  std::swap(rows[0], rows[1]);
+  ASSERT_OK(bulk_load(rows));
+  ASSERT_FALSE(this->tablet()->MemRowSetEmpty());
+  ASSERT_EQ(1000, this->tablet()->metrics()->rows_bulk_loaded->value());
+
+  // So are sorted rows once the MemRowSet is non-empty, since it is unbounded.
+  build_rows(2010, 990, &rows);
+  ASSERT_OK(bulk_load(rows));
+  ASSERT_EQ(1000, this->tablet()->metrics()->rows_bulk_loaded->value());
+
+  // After a flush, loads go straight to disk again.
+  ASSERT_OK(this->tablet()->Flush());
+  build_rows(3000, 1000, &rows);
+  ASSERT_OK(bulk_load(rows));
+  ASSERT_TRUE(this->tablet()->MemRowSetEmpty());
+  ASSERT_EQ(3, this->tablet()->num_rowsets());
+  ASSERT_EQ(2000, this->tablet()->metrics()->rows_bulk_loaded->value());
+  NO_FATALS(this->VerifyTestRows(1000, 3000));
+
+  // The loaded rowsets are persisted in the tablet metadata.
+  this->TabletReOpen();
+  ASSERT_EQ(3, this->tablet()->num_rowsets());
+  NO_FATALS(this->VerifyTestRows(1000, 3000));
+
+  // Loads that overlap existing rows fall back too, and report the duplicate
+  // keys as usual while inserting the rest.
+  build_rows(3990, 20, &rows);
+  s = bulk_load(rows);
+  ASSERT_TRUE(s.IsAlreadyPresent()) << s.ToString();
+  NO_FATALS(this->VerifyTestRows(1000, 3010));
+}
+
 TYPED_TEST(TestTablet, TestDiffScanUnobservableOperations) {
   LocalTabletWriter writer(this->tablet().get(), &this->client_schema());
   vector<LocalTabletWriter::RowOp> ops;
@@ -39,10 +39,12 @@
 #include "kudu/common/encoded_key.h"
 #include "kudu/common/generic_iterators.h"
 #include "kudu/common/iterator.h"
+#include "kudu/common/key_range.h"
 #include "kudu/common/partition.h"
 #include "kudu/common/row.h"
 #include "kudu/common/row_changelist.h"
 #include "kudu/common/row_operations.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/rowid.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
@@ -57,11 +59,13 @@
 #include "kudu/gutil/strings/human_readable.h"
 #include "kudu/gutil/strings/substitute.h"
 #include "kudu/gutil/threading/thread_collision_warner.h"
+#include "kudu/gutil/walltime.h"
 #include "kudu/tablet/compaction.h"
 #include "kudu/tablet/compaction_policy.h"
 #include "kudu/tablet/delta_tracker.h"
 #include "kudu/tablet/diskrowset.h"
 #include "kudu/tablet/memrowset.h"
+#include "kudu/tablet/mutation.h"
 #include "kudu/tablet/ops/alter_schema_op.h"
 #include "kudu/tablet/ops/write_op.h"
 #include "kudu/tablet/row_op.h"
@@ -86,8 +90,11 @@
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/process_memory.h"
+#include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/slice.h"
 #include "kudu/util/status_callback.h"
+#include "kudu/util/string_case.h"
+#include "kudu/util/threadpool.h"
 #include "kudu/util/throttler.h"
 #include "kudu/util/trace.h"
 #include "kudu/util/url-coding.h"
@@ -96,6 +103,14 @@ DEFINE_int32(tablet_compaction_budget_mb, 128,
              "Budget for a single compaction");
 TAG_FLAG(tablet_compaction_budget_mb, experimental);
 
+DEFINE_string(tablet_compaction_policy, "budgeted",
+              "The policy used to pick the rowsets to compact in tablets whose "
+              "table doesn't set the 'kudu.table.compaction_policy' extra "
+              "configuration property. Either 'budgeted', which minimizes the "
+              "average rowset height, or 'tiered', which merges rowsets of "
+              "similar size and bounds write amplification.");
+TAG_FLAG(tablet_compaction_policy, experimental);
+
 DEFINE_int32(tablet_bloom_block_size, 4096,
              "Block size of the bloom filters used for tablet keys.");
 TAG_FLAG(tablet_bloom_block_size, advanced);
@@ -151,6 +166,18 @@ DEFINE_int32(max_encoded_key_size_bytes, 16 * 1024,
              "result in an error.");
 TAG_FLAG(max_encoded_key_size_bytes, unsafe);
 
+DEFINE_int32(compaction_max_parallel_ranges, 4,
+             "Maximum number of disjoint key ranges a rowset compaction is split "
+             "into, each of which is merged and written by its own thread. "
+             "If 1, compactions are merged serially.");
+TAG_FLAG(compaction_max_parallel_ranges, experimental);
+
+DEFINE_int32(compaction_min_range_size_mb, 256,
+             "Minimum amount of input data, in MB, per key range of a parallel "
+             "rowset compaction. Compactions of less than twice this much data "
+             "are merged serially.");
+TAG_FLAG(compaction_min_range_size_mb, experimental);
+
 METRIC_DEFINE_entity(tablet);
 METRIC_DEFINE_gauge_size(tablet, memrowset_size, "MemRowSet Memory Usage",
                          kudu::MetricUnit::kBytes,
@@ -194,14 +221,32 @@ using strings::Substitute;
 
 namespace kudu {
 
-class RowBlock;
 struct IteratorStats;
 
 namespace tablet {
 
-static CompactionPolicy *CreateCompactionPolicy() {
-  return new BudgetedCompactionPolicy(FLAGS_tablet_compaction_budget_mb);
+static bool ParseCompactionPolicyFlag(const string& value,
+                                      TableExtraConfigPB::CompactionPolicy* policy) {
+  string upper;
+  ToUpperCase(value, &upper);
+  return TableExtraConfigPB::CompactionPolicy_Parse(upper, policy) &&
+      *policy != TableExtraConfigPB::UNKNOWN_COMPACTION_POLICY;
+}
+
+static bool ValidateCompactionPolicy(const char* flagname, const string& value) {
+  TableExtraConfigPB::CompactionPolicy policy;
+  if (!ParseCompactionPolicyFlag(value, &policy)) {
+    LOG(ERROR) << Substitute("$0 must be either 'budgeted' or 'tiered', value $1 is invalid",
+                             flagname, value);
+    return false;
+  }
+  return true;
 }
+DEFINE_validator(tablet_compaction_policy, &ValidateCompactionPolicy);
+
+// The number of rows buffered per block appended to the DiskRowSet writer
+// during a bulk load.
+static const int kBulkLoadBlockNumRows = 1000;
 
 ////////////////////////////////////////////////////////////
 // TabletComponents
@@ -231,7 +276,10 @@ Tablet::Tablet(scoped_refptr<TabletMetadata> metadata,
     last_write_time_(MonoTime::Now()),
     last_read_time_(MonoTime::Now()) {
       CHECK(schema()->has_column_ids());
-  compaction_policy_.reset(CreateCompactionPolicy());
+  budgeted_compaction_policy_.reset(
+      new BudgetedCompactionPolicy(FLAGS_tablet_compaction_budget_mb));
+  tiered_compaction_policy_.reset(
+      new TieredCompactionPolicy(FLAGS_tablet_compaction_budget_mb));
 
   if (metric_registry) {
     MetricEntity::AttributeMap attrs;
@@ -241,6 +289,7 @@ Tablet::Tablet(scoped_refptr<TabletMetadata> metadata,
                                                                             *schema());
     metric_entity_ = METRIC_ENTITY_tablet.Instantiate(metric_registry, tablet_id(), attrs);
     metrics_.reset(new TabletMetrics(metric_entity_));
+    lock_manager_.SetMetrics(metrics_->row_lock_waits, metrics_->row_lock_wait_duration);
     METRIC_memrowset_size.InstantiateFunctionGauge(
         metric_entity_, [this]() { return this->MemRowSetSize(); })
         ->AutoDetach(&metric_detacher_);
@@ -486,9 +535,33 @@ Status Tablet::AcquireRowLocks(WriteOpState* op_state) {
   TRACE_EVENT1("tablet", "Tablet::AcquireRowLocks",
                "num_locks", op_state->row_ops().size());
   TRACE("Acquiring locks for $0 operations", op_state->row_ops().size());
+
+  // Probe the keys of all the ops first, then lock their rows in the order of
+  // their lock hashes. Every op locking in the same order means that two ops
+  // sharing rows can't deadlock, and keys falling in the same lock manager
+  // shard are locked back-to-back.
+  vector<pair<uint64_t, RowOp*>> to_lock;
+  to_lock.reserve(op_state->row_ops().size());
   for (RowOp* op : op_state->row_ops()) {
     if (op->has_result()) continue;
-    RETURN_NOT_OK(AcquireLockForOp(op_state, op));
+    bool valid;
+    RETURN_NOT_OK(PrepareKeyProbe(op_state, op, &valid));
+    if (!valid) continue;
+    to_lock.emplace_back(LockManager::HashKey(op->key_probe->encoded_key_slice()), op);
+  }
+  std::sort(to_lock.begin(), to_lock.end(),
+            [](const pair<uint64_t, RowOp*>& a, const pair<uint64_t, RowOp*>& b) {
+              if (a.first != b.first) return a.first < b.first;
+              return a.second->key_probe->encoded_key_slice().compare(
+                  b.second->key_probe->encoded_key_slice()) < 0;
+            });
+  for (const auto& e : to_lock) {
+    RowOp* op = e.second;
+    op->row_lock = ScopedRowLock(&lock_manager_,
+                                 op_state,
+                                 op->key_probe->encoded_key_slice(),
+                                 e.first,
+                                 LockManager::LOCK_EXCLUSIVE);
   }
   TRACE("Locks acquired");
   return Status::OK();
@@ -510,20 +583,15 @@ Status Tablet::CheckRowInTablet(const ConstContiguousRow& row) const {
   return Status::OK();
 }
 
-Status Tablet::AcquireLockForOp(WriteOpState* op_state, RowOp* op) {
+Status Tablet::PrepareKeyProbe(WriteOpState* op_state, RowOp* op, bool* valid) {
   ConstContiguousRow row_key(&key_schema_, op->decoded_op.row_data);
   Arena* arena = op_state->arena();
   op->key_probe = arena->NewObject<RowSetKeyProbe>(row_key, arena);
-  if (PREDICT_FALSE(!ValidateOpOrMarkFailed(op))) {
+  *valid = ValidateOpOrMarkFailed(op);
+  if (PREDICT_FALSE(!*valid)) {
     return Status::OK();
   }
-  RETURN_NOT_OK(CheckRowInTablet(row_key));
-
-  op->row_lock = ScopedRowLock(&lock_manager_,
-                               op_state,
-                               op->key_probe->encoded_key_slice(),
-                               LockManager::LOCK_EXCLUSIVE);
-  return Status::OK();
+  return CheckRowInTablet(row_key);
 }
 
 void Tablet::AssignTimestampAndStartOpForTests(WriteOpState* op_state) {
@@ -814,44 +882,65 @@ void Tablet::StartApplying(WriteOpState* op_state) {
   op_state->set_tablet_components(components_);
 }
 
-Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_state) {
+void Tablet::SortOpsByKey(WriteOpState* op_state,
+                          vector<pair<Slice, int>>* keys_and_indexes) {
   int num_ops = op_state->row_ops().size();
-
-  // TODO(todd) determine why we sometimes get empty writes!
-  if (PREDICT_FALSE(num_ops == 0)) return Status::OK();
-
-  // The compiler seems to be bad at hoisting this load out of the loops,
-  // so load it up top.
   RowOp* const * row_ops_base = op_state->row_ops().data();
 
-  // Run all of the ops through the RowSetTree.
-  vector<pair<Slice, int>> keys_and_indexes;
-  keys_and_indexes.reserve(num_ops);
+  keys_and_indexes->clear();
+  keys_and_indexes->reserve(num_ops);
+  bool sorted = true;
   for (int i = 0; i < num_ops; i++) {
     RowOp* op = row_ops_base[i];
-    // If the op already failed in validation, or if we've got the original result
-    // filled in already during replay, then we don't need to consult the RowSetTree.
-    if (op->has_result() || op->orig_result_from_log) continue;
-    keys_and_indexes.emplace_back(op->key_probe->encoded_key_slice(), i);
+    // Ops which already failed in validation are not applied.
+    if (op->has_result()) continue;
+    Slice key = op->key_probe->encoded_key_slice();
+    if (sorted && !keys_and_indexes->empty()) {
+      sorted = keys_and_indexes->back().first.compare(key) <= 0;
+    }
+    keys_and_indexes->emplace_back(key, i);
   }
+  // Clients commonly send batches which are already in key order, in which
+  // case there is nothing to do.
+  if (sorted) return;
 
-  // Sort the query points by their probe keys, retaining the equivalent indexes.
+  // Sort the ops by their keys, retaining the equivalent indexes.
   //
-  // It's important to do a stable-sort here so that the 'unique' call
-  // below retains only the _first_ op the user specified, instead of
-  // an arbitrary one.
+  // It's important to do a stable-sort here so that multiple ops for the same
+  // row are applied in the order the user specified them, and so that the
+  // 'unique' call in BulkCheckPresence() retains only the _first_ op the user
+  // specified, instead of an arbitrary one.
   //
   // TODO(todd): benchmark stable_sort vs using sort() and falling back to
   // comparing 'a.second' when a.first == b.first. Some microbenchmarks
   // seem to indicate stable_sort is actually faster.
-  // TODO(todd): could also consider weaving in a check in the loop above to
-  // see if the incoming batch is already totally-ordered and in that case
-  // skip this sort and std::unique call.
-  std::stable_sort(keys_and_indexes.begin(), keys_and_indexes.end(),
+  std::stable_sort(keys_and_indexes->begin(), keys_and_indexes->end(),
                    [](const pair<Slice, int>& a,
                       const pair<Slice, int>& b) {
                      return a.first.compare(b.first) < 0;
                    });
+}
+
+Status Tablet::BulkCheckPresence(const IOContext* io_context,
+                                 WriteOpState* op_state,
+                                 const vector<pair<Slice, int>>& sorted_ops) {
+  // TODO(todd) determine why we sometimes get empty writes!
+  if (PREDICT_FALSE(sorted_ops.empty())) return Status::OK();
+
+  // The compiler seems to be bad at hoisting this load out of the loops,
+  // so load it up top.
+  RowOp* const * row_ops_base = op_state->row_ops().data();
+
+  // Run all of the ops through the RowSetTree. If we've got the original
+  // result filled in already during replay, then we don't need to consult
+  // the RowSetTree.
+  vector<pair<Slice, int>> keys_and_indexes;
+  keys_and_indexes.reserve(sorted_ops.size());
+  for (const auto& key_and_index : sorted_ops) {
+    if (row_ops_base[key_and_index.second]->orig_result_from_log) continue;
+    keys_and_indexes.emplace_back(key_and_index);
+  }
+
   // If the batch has more than one operation for the same row, then we can't
   // use the up-front presence optimization on those operations, since the
   // first operation may change the result of the later presence-checks.
@@ -877,8 +966,12 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
   // We want to process each such "group" (set of subsequent calls for the same
   // RowSet) one at a time. So, the callback itself aggregates results into
   // 'pending_group' and then calls 'ProcessPendingGroup' when the next group
-  // begins.
+  // begins. The keys of a group are checked against the RowSet as a batch.
   vector<pair<RowSet*, int>> pending_group;
+  vector<RowOp*> group_ops;
+  vector<const RowSetKeyProbe*> group_probes;
+  vector<ProbeStats*> group_stats;
+  unique_ptr<bool[]> group_present(new bool[keys.size()]);
   Status s;
   const auto& ProcessPendingGroup = [&]() {
     if (pending_group.empty() || !s.ok()) return;
@@ -892,6 +985,9 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
                             return s_a.compare(s_b) < 0;
                           }));
     RowSet* rs = pending_group[0].first;
+    group_ops.clear();
+    group_probes.clear();
+    group_stats.clear();
     for (auto it = pending_group.begin();
          it != pending_group.end();
          ++it) {
@@ -902,17 +998,21 @@ Status Tablet::BulkCheckPresence(const IOContext* io_context, WriteOpState* op_s
         // Already found this op present somewhere.
         continue;
       }
+      group_ops.push_back(op);
+      group_probes.push_back(op->key_probe);
+      group_stats.push_back(op_state->mutable_op_stats(op_idx));
+    }
 
-      bool present = false;
-      s = rs->CheckRowPresent(*op->key_probe, io_context,
-                              &present, op_state->mutable_op_stats(op_idx));
-      if (PREDICT_FALSE(!s.ok())) {
-        LOG(WARNING) << Substitute("Tablet $0 failed to check row presence for op $1: $2",
-            tablet_id(), op->ToString(key_schema_), s.ToString());
-        return;
-      }
-      if (present) {
-        op->present_in_rowset = rs;
+    s = rs->CheckRowsPresent(group_probes.data(), group_probes.size(), io_context,
+                             group_present.get(), group_stats.data());
+    if (PREDICT_FALSE(!s.ok())) {
+      LOG(WARNING) << Substitute("Tablet $0 failed to check row presence for $1 ops in $2: $3",
+          tablet_id(), group_ops.size(), rs->ToString(), s.ToString());
+      return;
+    }
+    for (int i = 0; i < group_ops.size(); i++) {
+      if (group_present[i]) {
+        group_ops[i]->present_in_rowset = rs;
       }
     }
     pending_group.clear();
@@ -962,10 +1062,36 @@ Status Tablet::ApplyRowOperations(WriteOpState* op_state) {
   StartApplying(op_state);
 
   IOContext io_context({ tablet_id() });
-  RETURN_NOT_OK(BulkCheckPresence(&io_context, op_state));
-
-  // Actually apply the ops.
-  for (int op_idx = 0; op_idx < num_ops; op_idx++) {
+  if (op_state->request()->bulk_load() && state_ == kOpen) {
+    // Bulk loading is only an optimization: if the rows don't qualify, apply
+    // them as usual. Either way, every row op ends up with the same result,
+    // so replicas that take different paths still agree.
+    Status s = BulkLoadRowOperations(&io_context, op_state);
+    if (s.ok()) {
+      std::lock_guard<rw_spinlock> l(last_rw_time_lock_);
+      last_write_time_ = MonoTime::Now();
+      return Status::OK();
+    }
+    // A stopped tablet may have failed partway through; don't apply anything.
+    RETURN_NOT_OK(CheckHasNotBeenStopped());
+    VLOG_WITH_PREFIX(1) << "Applying bulk load of " << num_ops
+                        << " rows through the MemRowSet: " << s.ToString();
+  }
+
+  // Process the batch in key order: this lets the presence checks below be
+  // batched per RowSet, and makes the inserts into the MemRowSet and the
+  // lookups in the DiskRowSets walk their indexes in order rather than
+  // jumping around.
+  vector<pair<Slice, int>> sorted_ops;
+  SortOpsByKey(op_state, &sorted_ops);
+
+  RETURN_NOT_OK(BulkCheckPresence(&io_context, op_state, sorted_ops));
+
+  // Actually apply the ops. The results are tracked per op, and ops for the
+  // same row are still applied in their original order, so the outcome is
+  // the same as applying them in the order the user specified.
+  for (const auto& key_and_index : sorted_ops) {
+    int op_idx = key_and_index.second;
     RowOp* row_op = op_state->row_ops()[op_idx];
     if (row_op->has_result()) continue;
     RETURN_NOT_OK(ApplyRowOperation(&io_context, op_state, row_op,
@@ -1033,6 +1159,20 @@ Status Tablet::ApplyRowOperation(const IOContext* io_context,
 
     case RowOperationsPB::UPDATE:
     case RowOperationsPB::DELETE:
+      // When replaying, the DELETEs of an expiry whose rows hadn't expired
+      // have already been filtered out as failed.
+      if (op_state->request()->has_ttl_expiry_cutoff_micros() &&
+          !row_op->orig_result_from_log) {
+        bool expired = false;
+        RETURN_NOT_OK_PREPEND(CheckRowExpired(io_context, op_state, *row_op,
+                                              op_state->request()->ttl_expiry_cutoff_micros(),
+                                              &expired),
+                              "Failed to check if row has expired");
+        if (!expired) {
+          row_op->SetFailed(Status::NotFound("row has not expired"));
+          return Status::OK();
+        }
+      }
       s = MutateRowUnlocked(io_context, op_state, row_op, stats);
       if (s.IsNotFound()) {
         return Status::OK();
@@ -1045,6 +1185,188 @@ Status Tablet::ApplyRowOperation(const IOContext* io_context,
   return Status::OK();
 }
 
+Status Tablet::BulkLoadRowOperations(const IOContext* io_context,
+                                     WriteOpState* op_state) {
+  TRACE_EVENT1("tablet", "Tablet::BulkLoadRowOperations", "tablet_id", tablet_id());
+  RETURN_IF_STOPPED_OR_CHECK_STATE(kOpen);
+
+  const Schema* schema = op_state->schema_at_decode_time();
+  const auto& row_ops = op_state->row_ops();
+  if (row_ops.empty()) {
+    return Status::InvalidArgument("no rows to bulk load");
+  }
+
+  // Validate the input: only well-formed INSERTs, in strictly increasing key
+  // order, none of which has already been given a result.
+  for (int i = 0; i < row_ops.size(); i++) {
+    const RowOp* row_op = row_ops[i];
+    const DecodedRowOperation& op = row_op->decoded_op;
+    DCHECK(row_op->has_row_lock()) << "RowOp must hold the row lock.";
+    if (PREDICT_FALSE(row_op->has_result())) {
+      return Status::InvalidArgument("bulk load rows must not have failed already",
+                                     op.ToString(*schema));
+    }
+    if (PREDICT_FALSE(op.type != RowOperationsPB::INSERT)) {
+      return Status::InvalidArgument("bulk load only supports INSERT operations",
+                                     op.ToString(*schema));
+    }
+    if (i > 0 &&
+        schema->Compare(ConstContiguousRow(schema, row_ops[i - 1]->decoded_op.row_data),
+                        ConstContiguousRow(schema, op.row_data)) >= 0) {
+      return Status::InvalidArgument("bulk load rows must be sorted by key with no duplicates",
+                                     op.ToString(*schema));
+    }
+  }
+
+  // The [lower, upper) interval of encoded keys covered by the load. Appending
+  // a zero byte to the last key yields the smallest key that sorts after it.
+  faststring lower_buf;
+  faststring upper_buf;
+  schema->EncodeComparableKey(ConstContiguousRow(schema, row_ops.front()->decoded_op.row_data),
+                              &lower_buf);
+  schema->EncodeComparableKey(ConstContiguousRow(schema, row_ops.back()->decoded_op.row_data),
+                              &upper_buf);
+  upper_buf.push_back('\0');
+  const Slice lower(lower_buf);
+  const Slice upper(upper_buf);
+
+  // Returns IllegalState if any rowset other than an empty MemRowSet may hold
+  // keys within the loaded range. Requires component_lock_.
+  //
+  // Since we hold the row locks of all the loaded keys, no other op can
+  // insert any of them concurrently; passing this check therefore means none
+  // of the keys is present in the tablet.
+  auto check_no_overlap = [&]() {
+    vector<RowSet*> overlapping;
+    components_->rowsets->FindRowSetsIntersectingInterval(lower, upper, &overlapping);
+    for (const RowSet* rs : overlapping) {
+      if (rs == components_->memrowset.get() && components_->memrowset->empty()) {
+        continue;
+      }
+      return Status::IllegalState(Substitute(
+          "bulk load key range overlaps existing rowset $0", rs->ToString()));
+    }
+    return Status::OK();
+  };
+
+  // Fail early, before writing anything.
+  {
+    shared_lock<rw_spinlock> l(component_lock_);
+    RETURN_NOT_OK(check_no_overlap());
+  }
+
+  // Write the rows out. Every row gets an UNDO delete at the op timestamp,
+  // just as if it had been inserted into the MemRowSet and flushed.
+  Arena arena(256);
+  faststring undo_buf;
+  RowChangeListEncoder undo_encoder(&undo_buf);
+  undo_encoder.SetToDelete();
+  Mutation* undo = Mutation::CreateInArena(&arena, op_state->timestamp(),
+                                           undo_encoder.as_changelist());
+
+  RollingDiskRowSetWriter drsw(metadata_.get(), *schema, DefaultBloomSizing(),
+                               compaction_policy()->target_rowset_size());
+  RETURN_NOT_OK_PREPEND(drsw.Open(), "Failed to open DiskRowSet for bulk load");
+  RowBlock block(schema, kBulkLoadBlockNumRows, nullptr);
+  // The ordinal of the written rowset that each row ends up in.
+  vector<int> drs_ordinals;
+  drs_ordinals.reserve(row_ops.size());
+  int cur_drs_ordinal = 0;
+  int n = 0;
+  for (const RowOp* op : row_ops) {
+    // The writer may only roll between blocks, or the UNDOs of the pending
+    // rows would end up in a different rowset than the rows themselves.
+    if (n == 0) {
+      RETURN_NOT_OK(drsw.RollIfNecessary());
+    }
+    RowBlockRow dst_row = block.row(n);
+    RETURN_NOT_OK(CopyRow(ConstContiguousRow(schema, op->decoded_op.row_data), &dst_row,
+                          static_cast<Arena*>(nullptr)));
+    rowid_t index_in_current_drs;
+    RETURN_NOT_OK(drsw.AppendUndoDeltas(n, undo, &index_in_current_drs));
+    if (index_in_current_drs == 0 && !drs_ordinals.empty()) {
+      cur_drs_ordinal++;
+    }
+    drs_ordinals.push_back(cur_drs_ordinal);
+    if (++n == block.nrows()) {
+      RETURN_NOT_OK(drsw.AppendBlock(block, n));
+      n = 0;
+    }
+  }
+  if (n > 0) {
+    block.Resize(n);
+    RETURN_NOT_OK(drsw.AppendBlock(block, n));
+  }
+  RETURN_NOT_OK_PREPEND(drsw.Finish(), "Failed to finish DRS writer");
+
+  RowSetMetadataVector new_drs_metas;
+  drsw.GetWrittenRowSetMetadata(&new_drs_metas);
+  if (metrics_.get()) metrics_->AddBytesWritten(drsw.written_size(), /*is_compaction=*/false);
+
+  // Blocks we wrote are unreferenced until the metadata is flushed; make sure
+  // they get cleaned up if we bail out before then.
+  auto orphan_written_blocks = MakeScopedCleanup([&]() {
+    for (const auto& meta : new_drs_metas) {
+      metadata_->AddOrphanedBlocks(meta->GetAllBlocks());
+    }
+  });
+  if (PREDICT_FALSE(new_drs_metas.size() != cur_drs_ordinal + 1)) {
+    return Status::IllegalState(Substitute("bulk load wrote $0 rowsets, expected $1",
+                                           new_drs_metas.size(), cur_drs_ordinal + 1));
+  }
+
+  RowSetVector new_disk_rowsets;
+  for (const shared_ptr<RowSetMetadata>& meta : new_drs_metas) {
+    shared_ptr<DiskRowSet> new_rowset;
+    RETURN_NOT_OK_PREPEND(DiskRowSet::Open(meta,
+                                           log_anchor_registry_.get(),
+                                           mem_trackers_,
+                                           io_context,
+                                           &new_rowset),
+                          Substitute("Unable to open bulk loaded rowset $0",
+                                     meta->ToString()));
+    new_disk_rowsets.emplace_back(std::move(new_rowset));
+  }
+
+  // Swap the new rowsets in. Ops that applied while we were writing may have
+  // inserted other keys of the loaded range into the MemRowSet; that would be
+  // harmless, but keep the layout simple and let the caller fall back. The
+  // loaded rows stay invisible to readers until our op commits, since their
+  // UNDOs only get skipped for snapshots that include the op.
+  {
+    std::lock_guard<rw_spinlock> lock(component_lock_);
+    RETURN_NOT_OK(check_no_overlap());
+    AtomicSwapRowSetsUnlocked({}, new_disk_rowsets);
+  }
+
+  // If we crash after this but before the op's commit message is durable,
+  // bootstrap replays the op against the flushed rowsets and every row comes
+  // back as AlreadyPresent: the data is the same either way.
+  //
+  // The in-memory metadata references the new rowsets even if flushing it
+  // fails, so their blocks must not be orphaned and their rows must not be
+  // inserted again. Like a failed flush or compaction, this is only
+  // recoverable if the tablet has been stopped (e.g. due to a disk failure).
+  orphan_written_blocks.cancel();
+  Status s = FlushMetadata({}, new_drs_metas, TabletMetadata::kNoMrsFlushed);
+  if (PREDICT_FALSE(!s.ok())) {
+    CHECK(HasBeenStopped()) << "Unrecoverable bulk load failure caused by error: "
+                            << s.ToString();
+    return s.CloneAndPrepend("Failed to flush new tablet metadata");
+  }
+  UpdateAverageRowsetHeight();
+
+  for (int i = 0; i < row_ops.size(); i++) {
+    row_ops[i]->SetBulkLoadSucceeded(new_drs_metas[drs_ordinals[i]]->id());
+  }
+  if (metrics_) {
+    metrics_->rows_bulk_loaded->IncrementBy(row_ops.size());
+  }
+  LOG_WITH_PREFIX(INFO) << Substitute("Bulk loaded $0 rows into $1 new rowset(s)",
+                                      row_ops.size(), new_disk_rowsets.size());
+  return Status::OK();
+}
+
 void Tablet::ModifyRowSetTree(const RowSetTree& old_tree,
                               const RowSetVector& rowsets_to_remove,
                               const RowSetVector& rowsets_to_add,
@@ -1389,10 +1711,10 @@ Status Tablet::PickRowSetsToCompact(RowSetsInCompaction *picked,
   } else {
     // Let the policy decide which rowsets to compact.
     double quality = 0.0;
-    RETURN_NOT_OK(compaction_policy_->PickRowSets(*rowsets_copy,
-                                                  &picked_set,
-                                                  &quality,
-                                                  /*log=*/nullptr));
+    RETURN_NOT_OK(compaction_policy()->PickRowSets(*rowsets_copy,
+                                                   &picked_set,
+                                                   &quality,
+                                                   /*log=*/nullptr));
     VLOG_WITH_PREFIX(2) << "Compaction quality: " << quality;
   }
 
@@ -1569,27 +1891,34 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
                           "PostTakeMvccSnapshot hook failed");
   }
 
-  shared_ptr<CompactionInput> merge;
-  RETURN_NOT_OK(input.CreateCompactionInput(flush_snap, schema(), &io_context, &merge));
-
-  RollingDiskRowSetWriter drsw(metadata_.get(), merge->schema(), DefaultBloomSizing(),
-                               compaction_policy_->target_rowset_size());
-  RETURN_NOT_OK_PREPEND(drsw.Open(), "Failed to open DiskRowSet for flush");
-
   HistoryGcOpts history_gc_opts = GetHistoryGcOpts();
-  RETURN_NOT_OK_PREPEND(FlushCompactionInput(merge.get(), flush_snap, history_gc_opts, &drsw),
-                        "Flush to disk failed");
-  RETURN_NOT_OK_PREPEND(drsw.Finish(), "Failed to finish DRS writer");
+  vector<unique_ptr<RollingDiskRowSetWriter>> writers;
+  RETURN_NOT_OK(WriteCompactionOutput(input, flush_snap, history_gc_opts,
+                                      mrs_being_flushed != TabletMetadata::kNoMrsFlushed,
+                                      &io_context, &writers));
 
   if (common_hooks_) {
     RETURN_NOT_OK_PREPEND(common_hooks_->PostWriteSnapshot(),
                           "PostWriteSnapshot hook failed");
   }
 
+  int64_t rows_written = 0;
+  int64_t drs_written = 0;
+  uint64_t bytes_written = 0;
+  RowSetMetadataVector new_drs_metas;
+  for (const auto& drsw : writers) {
+    rows_written += drsw->rows_written_count();
+    drs_written += drsw->drs_written_count();
+    bytes_written += drsw->written_size();
+    RowSetMetadataVector metas;
+    drsw->GetWrittenRowSetMetadata(&metas);
+    new_drs_metas.insert(new_drs_metas.end(), metas.begin(), metas.end());
+  }
+
   // Though unlikely, it's possible that no rows were written because all of
   // the input rows were GCed in this compaction. In that case, we don't
   // actually want to reopen.
-  if (drsw.rows_written_count() == 0) {
+  if (rows_written == 0) {
     LOG_WITH_PREFIX(INFO) << op_name << " resulted in no output rows (all input rows "
                           << "were GCed!)  Removing all input rowsets.";
     return HandleEmptyCompactionOrFlush(input.rowsets(), mrs_being_flushed);
@@ -1598,10 +1927,10 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
   // The RollingDiskRowSet writer wrote out one or more RowSets as the
   // output. Open these into 'new_rowsets'.
   vector<shared_ptr<RowSet> > new_disk_rowsets;
-  RowSetMetadataVector new_drs_metas;
-  drsw.GetWrittenRowSetMetadata(&new_drs_metas);
-
-  if (metrics_.get()) metrics_->bytes_flushed->IncrementBy(drsw.written_size());
+  if (metrics_.get()) {
+    metrics_->AddBytesWritten(bytes_written,
+                              mrs_being_flushed == TabletMetadata::kNoMrsFlushed);
+  }
   CHECK(!new_drs_metas.empty());
   {
     TRACE_EVENT0("tablet", "Opening compaction results");
@@ -1708,6 +2037,7 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
   VLOG_WITH_PREFIX(1) << Substitute("$0: Phase 2: carrying over any updates "
                                     "which arrived during Phase 1. Snapshot: $1",
                                     op_name, non_duplicated_ops_snap.ToString());
+  shared_ptr<CompactionInput> merge;
   RETURN_NOT_OK_PREPEND(
       input.CreateCompactionInput(non_duplicated_ops_snap, schema(), &io_context, &merge),
           Substitute("Failed to create $0 inputs", op_name).c_str());
@@ -1756,9 +2086,6 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
   AtomicSwapRowSets({ inprogress_rowset }, new_disk_rowsets);
   UpdateAverageRowsetHeight();
 
-  const auto rows_written = drsw.rows_written_count();
-  const auto drs_written = drsw.drs_written_count();
-  const auto bytes_written = drsw.written_size();
   TRACE_COUNTER_INCREMENT("rows_written", rows_written);
   TRACE_COUNTER_INCREMENT("drs_written", drs_written);
   TRACE_COUNTER_INCREMENT("bytes_written", bytes_written);
@@ -1776,6 +2103,97 @@ Status Tablet::DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
   return Status::OK();
 }
 
+Status Tablet::WriteCompactionOutput(const RowSetsInCompaction& input,
+                                     const MvccSnapshot& snap,
+                                     const HistoryGcOpts& history_gc_opts,
+                                     bool is_flush,
+                                     const IOContext* io_context,
+                                     vector<unique_ptr<RollingDiskRowSetWriter>>* writers) {
+  // Split large compactions into key ranges of roughly equal size, using the
+  // same estimates of the input rowsets' key distributions as SplitKeyRange().
+  // Flushes and small compactions are written as a single range.
+  vector<KeyRange> ranges;
+  if (!is_flush && FLAGS_compaction_max_parallel_ranges > 1) {
+    uint64_t input_size = 0;
+    for (const auto& rs : input.rowsets()) {
+      input_size += rs->OnDiskBaseDataSizeWithRedos();
+    }
+    const uint64_t num_ranges = std::min<uint64_t>(
+        FLAGS_compaction_max_parallel_ranges,
+        input_size / std::max<int64_t>(FLAGS_compaction_min_range_size_mb * 1024 * 1024, 1));
+    if (num_ranges > 1) {
+      RowSetTree tree;
+      RETURN_NOT_OK(tree.Reset(input.rowsets()));
+      RowSetInfo::SplitKeyRange(tree, Slice(), Slice(), {}, input_size / num_ranges, &ranges);
+    }
+  }
+
+  auto write_range = [&](const EncodedKey* lower_bound,
+                         const EncodedKey* exclusive_upper_bound,
+                         RollingDiskRowSetWriter* drsw) -> Status {
+    shared_ptr<CompactionInput> merge;
+    if (lower_bound || exclusive_upper_bound) {
+      RETURN_NOT_OK(input.CreateCompactionInput(snap, schema(), io_context,
+                                                lower_bound, exclusive_upper_bound, &merge));
+    } else {
+      RETURN_NOT_OK(input.CreateCompactionInput(snap, schema(), io_context, &merge));
+    }
+    RETURN_NOT_OK_PREPEND(drsw->Open(), "Failed to open DiskRowSet for flush");
+    RETURN_NOT_OK_PREPEND(FlushCompactionInput(merge.get(), snap, history_gc_opts, drsw),
+                          "Flush to disk failed");
+    RETURN_NOT_OK_PREPEND(drsw->Finish(), "Failed to finish DRS writer");
+    return Status::OK();
+  };
+
+  writers->clear();
+  const int num_writers = std::max<int>(ranges.size(), 1);
+  for (int i = 0; i < num_writers; i++) {
+    writers->emplace_back(new RollingDiskRowSetWriter(
+        metadata_.get(), *schema(), DefaultBloomSizing(),
+        compaction_policy()->target_rowset_size()));
+  }
+  if (num_writers == 1) {
+    return write_range(nullptr, nullptr, (*writers)[0].get());
+  }
+
+  // Decode the range boundaries. Each boundary is the exclusive upper bound
+  // of one range and the inclusive lower bound of the next; the first and
+  // last ranges are unbounded.
+  Arena arena(1024);
+  vector<EncodedKey*> bounds(num_writers + 1, nullptr);
+  for (int i = 1; i < num_writers; i++) {
+    RETURN_NOT_OK(EncodedKey::DecodeEncodedString(
+        *schema(), &arena, ranges[i].start_primary_key(), &bounds[i]));
+  }
+
+  VLOG_WITH_PREFIX(1) << Substitute("Compaction: writing $0 key ranges in parallel",
+                                    num_writers);
+  unique_ptr<ThreadPool> pool;
+  RETURN_NOT_OK(ThreadPoolBuilder("compact-range")
+                .set_max_threads(num_writers - 1)
+                .Build(&pool));
+  vector<Status> statuses(num_writers);
+  for (int i = 1; i < num_writers; i++) {
+    RollingDiskRowSetWriter* drsw = (*writers)[i].get();
+    Status* status = &statuses[i];
+    const EncodedKey* lower_bound = bounds[i];
+    const EncodedKey* exclusive_upper_bound = bounds[i + 1];
+    Status s = pool->Submit([&, drsw, status, lower_bound, exclusive_upper_bound]() {
+      *status = write_range(lower_bound, exclusive_upper_bound, drsw);
+    });
+    if (PREDICT_FALSE(!s.ok())) {
+      statuses[i] = write_range(lower_bound, exclusive_upper_bound, drsw);
+    }
+  }
+  statuses[0] = write_range(nullptr, bounds[1], (*writers)[0].get());
+  pool->Wait();
+
+  for (const Status& s : statuses) {
+    RETURN_NOT_OK(s);
+  }
+  return Status::OK();
+}
+
 Status Tablet::HandleEmptyCompactionOrFlush(const RowSetVector& rowsets,
                                             int mrs_being_flushed) {
   // Write out the new Tablet Metadata and remove old rowsets.
@@ -1789,6 +2207,18 @@ Status Tablet::HandleEmptyCompactionOrFlush(const RowSetVector& rowsets,
   return Status::OK();
 }
 
+CompactionPolicy* Tablet::compaction_policy() const {
+  TableExtraConfigPB::CompactionPolicy policy = TableExtraConfigPB::UNKNOWN_COMPACTION_POLICY;
+  const auto& extra_config = metadata_->extra_config();
+  if (extra_config && extra_config->has_compaction_policy()) {
+    policy = extra_config->compaction_policy();
+  } else {
+    CHECK(ParseCompactionPolicyFlag(FLAGS_tablet_compaction_policy, &policy));
+  }
+  return policy == TableExtraConfigPB::TIERED ? tiered_compaction_policy_.get()
+                                              : budgeted_compaction_policy_.get();
+}
+
 void Tablet::UpdateAverageRowsetHeight() {
   if (!metrics_) {
     return;
@@ -1855,7 +2285,8 @@ void Tablet::UpdateCompactionStats(MaintenanceOpStats* stats) {
 
   {
     std::lock_guard<std::mutex> compact_lock(compact_select_lock_);
-    WARN_NOT_OK(compaction_policy_->PickRowSets(*rowsets_copy, &picked_set_ignored, &quality, NULL),
+    WARN_NOT_OK(compaction_policy()->PickRowSets(*rowsets_copy, &picked_set_ignored, &quality,
+                                                 NULL),
                 Substitute("Couldn't determine compaction quality for $0", tablet_id()));
   }
 
@@ -2336,6 +2767,112 @@ Status Tablet::InitAncientUndoDeltas(MonoDelta time_budget, int64_t* bytes_in_an
   return Status::OK();
 }
 
+bool Tablet::GetTtlCutoff(ColumnId* col_id, int64_t* cutoff_micros) const {
+  const auto& extra_config = metadata_->extra_config();
+  if (!extra_config || !extra_config->has_ttl_column() || !extra_config->has_ttl_sec()) {
+    return false;
+  }
+  const Schema* s = schema();
+  int col_idx = s->find_column(extra_config->ttl_column());
+  if (col_idx == Schema::kColumnNotFound ||
+      s->column(col_idx).type_info()->type() != UNIXTIME_MICROS) {
+    KLOG_EVERY_N_SECS(WARNING, 60) << LogPrefix() << "Ignoring TTL: column "
+                                   << extra_config->ttl_column()
+                                   << " is not a UNIXTIME_MICROS column of the table";
+    return false;
+  }
+  *col_id = s->column_id(col_idx);
+  *cutoff_micros = GetCurrentTimeMicros() -
+                   static_cast<int64_t>(extra_config->ttl_sec()) * 1000000;
+  return true;
+}
+
+Status Tablet::GetBytesInExpiredRowsets(int64_t* bytes_in_expired_rowsets) {
+  *bytes_in_expired_rowsets = 0;
+  ColumnId ttl_col_id;
+  int64_t cutoff_micros;
+  if (!GetTtlCutoff(&ttl_col_id, &cutoff_micros)) {
+    return Status::OK();
+  }
+
+  scoped_refptr<TabletComponents> comps;
+  GetComponents(&comps);
+  int64_t bytes = 0;
+  for (const auto& rowset : comps->rowsets->all_rowsets()) {
+    bool expired = false;
+    RETURN_NOT_OK(rowset->IsExpired(ttl_col_id, cutoff_micros, &expired));
+    if (expired) {
+      bytes += rowset->OnDiskSize();
+    }
+  }
+  *bytes_in_expired_rowsets = bytes;
+  return Status::OK();
+}
+
+Status Tablet::CheckRowExpired(const IOContext* io_context,
+                               const WriteOpState* op_state,
+                               const RowOp& row_op,
+                               int64_t cutoff_micros,
+                               bool* expired) const {
+  DCHECK(row_op.checked_present);
+  *expired = false;
+  const auto& extra_config = metadata_->extra_config();
+  if (!extra_config || !extra_config->has_ttl_column()) {
+    return Status::OK();
+  }
+  const Schema* schema = op_state->schema_at_decode_time();
+  int col_idx = schema->find_column(extra_config->ttl_column());
+  if (col_idx == Schema::kColumnNotFound ||
+      schema->column(col_idx).type_info()->type() != UNIXTIME_MICROS) {
+    return Status::OK();
+  }
+
+  // The row lock is held, so every earlier op on the row has been applied,
+  // and no later one can be: reading the latest version of the row yields
+  // the same result on every replica.
+  Schema projection;
+  RETURN_NOT_OK(schema->CreateProjectionByNames({ extra_config->ttl_column() }, &projection));
+  RowIteratorOptions opts;
+  opts.projection = &projection;
+  opts.snap_to_include = MvccSnapshot::CreateSnapshotIncludingAllOps();
+  opts.io_context = io_context;
+  const RowSet* rowset = row_op.present_in_rowset ?
+      row_op.present_in_rowset : op_state->tablet_components()->memrowset.get();
+  unique_ptr<RowwiseIterator> iter;
+  RETURN_NOT_OK(rowset->NewRowIterator(opts, &iter));
+
+  // Scan [key, successor of key). The successor doesn't exist if every key
+  // column already holds its greatest value; the lower bound alone then
+  // selects the row.
+  Arena arena(256);
+  EncodedKey* upper_bound;
+  RETURN_NOT_OK(EncodedKey::DecodeEncodedString(*schema, &arena,
+                                                row_op.key_probe->encoded_key_slice(),
+                                                &upper_bound));
+  ScanSpec spec;
+  spec.SetLowerBoundKey(&row_op.key_probe->encoded_key());
+  if (EncodedKey::IncrementEncodedKey(*schema, &upper_bound, &arena).ok()) {
+    spec.SetExclusiveUpperBoundKey(upper_bound);
+  }
+  RETURN_NOT_OK(iter->Init(&spec));
+
+  RowBlock block(&iter->schema(), 1, &arena);
+  while (iter->HasNext()) {
+    RETURN_NOT_OK(iter->NextBlock(&block));
+    for (size_t i = 0; i < block.nrows(); i++) {
+      if (!block.selection_vector()->IsRowSelected(i)) {
+        continue;
+      }
+      // A null never expires.
+      const RowBlockRow row = block.row(i);
+      *expired = !row.is_null(0) &&
+                 *reinterpret_cast<const int64_t*>(row.cell_ptr(0)) < cutoff_micros;
+      return Status::OK();
+    }
+  }
+  return Status::OK();
+}
+
 Status Tablet::GetBytesInAncientDeletedRowsets(int64_t* bytes_in_ancient_deleted_rowsets) {
   Timestamp ancient_history_mark;
   if (!Tablet::GetTabletAncientHistoryMark(&ancient_history_mark)) {
@@ -2518,7 +3055,7 @@ void Tablet::PrintRSLayout(ostream* o) {
   vector<string> log;
   unordered_set<const RowSet*> picked;
   double quality;
-  Status s = compaction_policy_->PickRowSets(*rowsets_copy, &picked, &quality, &log);
+  Status s = compaction_policy()->PickRowSets(*rowsets_copy, &picked, &quality, &log);
   if (!s.ok()) {
     out << "<b>Error:</b> " << EscapeForHtmlToString(s.ToString());
     return;
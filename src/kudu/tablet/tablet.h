@@ -25,6 +25,7 @@
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <glog/logging.h>
@@ -49,6 +50,7 @@
 #include "kudu/util/monotime.h"
 #include "kudu/util/rw_semaphore.h"
 #include "kudu/util/semaphore.h"
+#include "kudu/util/slice.h"
 #include "kudu/util/status.h"
 
 namespace kudu {
@@ -81,6 +83,7 @@ class AlterSchemaOpState;
 class CompactionPolicy;
 class HistoryGcOpts;
 class MemRowSet;
+class RollingDiskRowSetWriter;
 class RowSetTree;
 class RowSetsInCompaction;
 class WriteOpState;
@@ -160,23 +163,10 @@ class Tablet {
   // don't boot a tablet server.
   void AssignTimestampAndStartOpForTests(WriteOpState* op_state);
 
-  // Insert a new row into the tablet.
-  //
-  // The provided 'data' slice should have length equivalent to this
-  // tablet's Schema.byte_size().
-  //
-  // After insert, the row and any referred-to memory (eg for strings)
-  // have been copied into internal memory, and thus the provided memory
-  // buffer may safely be re-used or freed.
-  //
-  // Returns Status::AlreadyPresent() if an entry with the same key is already
-  // present in the tablet.
-  // Returns Status::OK unless allocation fails.
-  //
-  // Acquires the row lock for the given operation, setting it in the
-  // RowOp struct. This also sets the row op's RowSetKeyProbe.
-  Status AcquireLockForOp(WriteOpState* op_state,
-                          RowOp* op);
+  // Sets the row op's RowSetKeyProbe and validates the op, setting 'valid' to
+  // false if the op was marked as failed. Returns an error if the row doesn't
+  // belong to this tablet.
+  Status PrepareKeyProbe(WriteOpState* op_state, RowOp* op, bool* valid);
 
   // Signal that the given op is about to Apply.
   void StartApplying(WriteOpState* op_state);
@@ -361,6 +351,22 @@ class Tablet {
   // state is change.
   Status DeleteAncientDeletedRowsets();
 
+  // Resolves the table's TTL (see TableExtraConfigPB::ttl_column) against the
+  // current schema. Returns true and sets 'col_id' and 'cutoff_micros' iff the
+  // table has a TTL on an existing UNIXTIME_MICROS column: rows whose value of
+  // that column is older than 'cutoff_micros' have expired.
+  //
+  // Expired rows are deleted through replicated DELETEs (see
+  // WriteRequestPB::ttl_expiry_cutoff_micros), issued by the leader's
+  // ExpireRowsOp; once fully deleted and ancient, their rowsets are then
+  // dropped by DeleteAncientDeletedRowsets() like any other.
+  bool GetTtlCutoff(ColumnId* col_id, int64_t* cutoff_micros) const;
+
+  // Returns the number of bytes of the DiskRowSets whose rows have all expired
+  // by the table's TTL (see RowSet::IsExpired()) but haven't been deleted yet.
+  // Zero if the table has no TTL.
+  Status GetBytesInExpiredRowsets(int64_t* bytes_in_expired_rowsets);
+
   // Counts the number of deltas in the tablet. Only used for tests.
   int64_t CountUndoDeltasForTests() const;
   int64_t CountRedoDeltasForTests() const;
@@ -593,11 +599,36 @@ class Tablet {
   static std::vector<RowSet*> FindRowSetsToCheck(const RowOp* op,
                                                  const TabletComponents* comps);
 
-  // For each of the operations in 'op_state', check for the presence of their
-  // row keys in the RowSets in the current RowSetTree (as determined by the op's
-  // captured TabletComponents).
+  // Collect the encoded keys and indexes of the operations in 'op_state' which
+  // are yet to be applied into 'keys_and_indexes', stable-sorted by key.
+  static void SortOpsByKey(WriteOpState* op_state,
+                           std::vector<std::pair<Slice, int>>* keys_and_indexes);
+
+  // For each of the operations in 'sorted_ops' (as returned by SortOpsByKey()),
+  // check for the presence of their row keys in the RowSets in the current
+  // RowSetTree (as determined by the op's captured TabletComponents).
   Status BulkCheckPresence(const fs::IOContext* io_context,
-                           WriteOpState* op_state) WARN_UNUSED_RESULT;
+                           WriteOpState* op_state,
+                           const std::vector<std::pair<Slice, int>>& sorted_ops)
+      WARN_UNUSED_RESULT;
+
+  // Try to apply the row operations of a bulk-load op (see
+  // WriteRequestPB::bulk_load) by writing the rows straight into new
+  // DiskRowSets which are then added to the tablet and its metadata in a
+  // single step, bypassing the MemRowSet.
+  //
+  // This only succeeds if the ops are all INSERTs, sorted by primary key with
+  // no duplicates, and their key range doesn't intersect any existing rowset
+  // or a non-empty MemRowSet. Each loaded row carries an UNDO delete at the
+  // op's timestamp, so snapshots taken before it don't see the rows. The row
+  // locks of the op must be held, so no other op can touch the same keys; the
+  // overlap check is repeated under 'component_lock_' when the new rowsets are
+  // swapped in, so this never waits on other ops.
+  //
+  // On error the tablet is left unchanged and none of the row results are set,
+  // so the caller may apply the ops through the regular path instead.
+  Status BulkLoadRowOperations(const fs::IOContext* io_context,
+                               WriteOpState* op_state) WARN_UNUSED_RESULT;
 
   // Capture a set of iterators which, together, reflect all of the data in the tablet.
   //
@@ -619,12 +650,42 @@ class Tablet {
   Status DoMergeCompactionOrFlush(const RowSetsInCompaction &input,
                                   int64_t mrs_being_flushed);
 
+  // Phase 1 of a merge compaction or flush: writes the rows of 'input' as of
+  // 'snap' to new DiskRowSets, using one finished writer per key range in
+  // 'writers'. The writers' outputs are in key order.
+  //
+  // Compactions of enough data are split into disjoint key ranges which are
+  // written concurrently; see --compaction_max_parallel_ranges.
+  Status WriteCompactionOutput(
+      const RowSetsInCompaction& input,
+      const MvccSnapshot& snap,
+      const HistoryGcOpts& history_gc_opts,
+      bool is_flush,
+      const fs::IOContext* io_context,
+      std::vector<std::unique_ptr<RollingDiskRowSetWriter>>* writers);
+
   // Handle the case in which a compaction or flush yielded no output rows.
   // In this case, we just need to remove the rowsets in 'rowsets' from the
   // metadata and flush it.
   Status HandleEmptyCompactionOrFlush(const RowSetVector& rowsets,
                                       int mrs_being_flushed);
 
+  // Return the compaction policy selected by the table's extra configuration,
+  // or by --tablet_compaction_policy if the table doesn't set one. This is
+  // re-evaluated on every call so that altering the table takes effect on
+  // the next compaction.
+  CompactionPolicy* compaction_policy() const;
+
+  // Sets 'expired' to whether the row targeted by 'row_op' holds a non-null
+  // value older than 'cutoff_micros' in the table's TTL column, as of the
+  // latest applied op. The row lock of 'row_op' must be held, and its
+  // presence checked.
+  Status CheckRowExpired(const fs::IOContext* io_context,
+                         const WriteOpState* op_state,
+                         const RowOp& row_op,
+                         int64_t cutoff_micros,
+                         bool* expired) const WARN_UNUSED_RESULT;
+
   // Updates the average rowset height metric. Acquires the tablet's
   // compact_select_lock_.
   void UpdateAverageRowsetHeight();
@@ -753,7 +814,9 @@ class Tablet {
   MvccManager mvcc_;
   LockManager lock_manager_;
 
-  std::unique_ptr<CompactionPolicy> compaction_policy_;
+  // The compaction policies a tablet may use. See compaction_policy().
+  std::unique_ptr<CompactionPolicy> budgeted_compaction_policy_;
+  std::unique_ptr<CompactionPolicy> tiered_compaction_policy_;
 
   // Lock protecting the selection of rowsets for compaction.
   // Only one thread may run the compaction selection algorithm at a time
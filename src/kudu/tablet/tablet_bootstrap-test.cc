@@ -26,6 +26,7 @@
 #include <vector>
 
 #include <boost/optional/optional.hpp>
+#include <gflags/gflags_declare.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -75,6 +76,8 @@
 #include "kudu/util/status.h"
 #include "kudu/util/test_macros.h"
 
+DECLARE_int32(tablet_bootstrap_log_prefetch_mb);
+
 using kudu::consensus::ConsensusBootstrapInfo;
 using kudu::consensus::ConsensusMetadata;
 using kudu::consensus::ConsensusMetadataManager;
@@ -260,6 +263,44 @@ TEST_F(BootstrapTest, TestBootstrapHighOpIdIndex) {
   ASSERT_OPID_EQ(last_opid, boot_info.last_committed_id);
 }
 
+// Tests that a log spanning several segments replays the same way whether its
+// entries are prefetched on a separate thread or read by the replaying thread.
+TEST_F(BootstrapTest, TestBootstrapWithAndWithoutLogPrefetch) {
+  const int kNumSegments = 5;
+  const int kEntryPairsPerSegment = 10;
+  ASSERT_OK(BuildLog());
+  for (int i = 0; i < kNumSegments; i++) {
+    ASSERT_OK(AppendReplicateBatchAndCommitEntryPairsToLog(kEntryPairsPerSegment));
+    ASSERT_OK(RollLog());
+  }
+  OpId last_opid = MakeOpId(1, current_index_ - 1);
+
+  scoped_refptr<TabletMetadata> meta;
+  ASSERT_OK(LoadTestTabletMetadata(/*mrs_id=*/ -1, /*delta_id=*/ -1, &meta));
+  ASSERT_OK(CreateConsensusMetadata(meta));
+
+  // Each bootstrap replays the log written by the previous one.
+  for (int prefetch_mb : { 8, 0 }) {
+    SCOPED_TRACE(prefetch_mb);
+    FLAGS_tablet_bootstrap_log_prefetch_mb = prefetch_mb;
+    shared_ptr<Tablet> tablet;
+    ConsensusBootstrapInfo boot_info;
+    ASSERT_OK(RunBootstrapOnTestTablet(meta, &tablet, &boot_info));
+    ASSERT_OPID_EQ(last_opid, boot_info.last_id);
+    ASSERT_OPID_EQ(last_opid, boot_info.last_committed_id);
+    ASSERT_TRUE(boot_info.orphaned_replicates.empty());
+
+    vector<string> results;
+    IterateTabletRows(tablet.get(), &results);
+    ASSERT_EQ(kNumSegments * kEntryPairsPerSegment, results.size());
+
+    // Untrack the tablet in the data dir manager so that the next bootstrap
+    // can load the tablet metadata's data dir group.
+    fs_manager_->dd_manager()->DeleteDataDirGroup(tablet->tablet_id());
+    ASSERT_OK(LoadTestTabletMetadata(/*mrs_id=*/ -1, /*delta_id=*/ -1, &meta));
+  }
+}
+
 // Tests attempting a local bootstrap of a tablet that was in the middle of a
 // tablet copy before "crashing".
 TEST_F(BootstrapTest, TestIncompleteTabletCopy) {
@@ -17,6 +17,8 @@
 
 #include "kudu/tablet/tablet_bootstrap.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
@@ -75,9 +77,11 @@
 #include "kudu/tablet/tablet.h"
 #include "kudu/tablet/tablet.pb.h"
 #include "kudu/tablet/tablet_metadata.h"
+#include "kudu/tablet/tablet_metrics.h"
 #include "kudu/tablet/tablet_replica.h"
 #include "kudu/tserver/tserver.pb.h"
 #include "kudu/tserver/tserver_admin.pb.h"
+#include "kudu/util/blocking_queue.h"
 #include "kudu/util/debug/trace_event.h"
 #include "kudu/util/env.h"
 #include "kudu/util/env_util.h"
@@ -90,6 +94,7 @@
 #include "kudu/util/pb_util.h"
 #include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/stopwatch.h"
+#include "kudu/util/thread.h"
 
 DECLARE_int32(group_commit_queue_size_bytes);
 
@@ -99,6 +104,13 @@ DEFINE_double(fault_crash_during_log_replay, 0.0,
               "(For testing only!)");
 TAG_FLAG(fault_crash_during_log_replay, unsafe);
 
+DEFINE_int32(tablet_bootstrap_log_prefetch_mb, 8,
+             "Amount of WAL data, in MiB, that tablet bootstrap reads, decompresses "
+             "and decodes ahead of replay on a separate thread, overlapping log "
+             "reads with the replay of earlier entries. If 0, log entries are "
+             "read on the replaying thread.");
+TAG_FLAG(tablet_bootstrap_log_prefetch_mb, advanced);
+
 DECLARE_int32(max_clock_sync_error_usec);
 
 using kudu::clock::Clock;
@@ -120,6 +132,7 @@ using kudu::fs::IOContext;
 using kudu::log::Log;
 using kudu::log::LogAnchorRegistry;
 using kudu::log::LogEntryPB;
+using kudu::log::LogEntryReader;
 using kudu::log::LogIndex;
 using kudu::log::LogOptions;
 using kudu::log::LogReader;
@@ -176,6 +189,79 @@ class FlushedStoresSnapshot {
   DISALLOW_COPY_AND_ASSIGN(FlushedStoresSnapshot);
 };
 
+// Reads the entries of a sequence of log segments, in order.
+//
+// If 'max_buffered_bytes' is positive, the segments are read, decompressed and
+// decoded on a separate thread which stays up to that many bytes of log data
+// ahead of the caller, so that reading the log overlaps with replaying it.
+// Otherwise, the entries are read by the calling thread in ReadNext().
+class LogEntryPrefetcher {
+ public:
+  struct Result {
+    // The entry read, if 'status' is OK.
+    unique_ptr<LogEntryPB> entry;
+
+    // OK if an entry was read, EndOfFile at the end of a segment, or the error
+    // encountered while reading the segment.
+    Status status;
+
+    // The index of the segment in the sequence.
+    int segment_idx;
+
+    // The offset of the segment's next entry and the offset up to which the
+    // segment is read.
+    int64_t offset;
+    int64_t read_up_to_offset;
+
+    // The number of bytes of the segment consumed to produce this result.
+    int64_t bytes;
+  };
+
+  LogEntryPrefetcher(log::SegmentSequence segments, int64_t max_buffered_bytes);
+  ~LogEntryPrefetcher();
+
+  // Starts the prefetching thread, if any.
+  Status Start();
+
+  // Returns the next result. The entries of each segment are followed by an
+  // EndOfFile result. Must not be called after the EndOfFile result of the
+  // last segment, nor after a result with any other non-OK status.
+  void ReadNext(Result* result);
+
+  // The total time spent reading and decoding entries so far.
+  MonoDelta read_time() const {
+    return MonoDelta::FromNanoseconds(read_nanos_.load(std::memory_order_relaxed));
+  }
+
+ private:
+  struct ResultLogicalSize {
+    static size_t logical_size(const Result& result) {
+      return result.bytes;
+    }
+  };
+
+  // Reads the next entry of the 'segment_idx'-th segment from 'reader'.
+  void ReadEntry(LogEntryReader* reader, int segment_idx, Result* result);
+
+  // Body of the prefetching thread.
+  void PrefetchThread();
+
+  const log::SegmentSequence segments_;
+  const int64_t max_buffered_bytes_;
+
+  // The segment being read, when entries are read by the calling thread.
+  int cur_segment_idx_;
+  unique_ptr<LogEntryReader> cur_reader_;
+
+  // Results read ahead by the prefetching thread.
+  BlockingQueue<Result, ResultLogicalSize> queue_;
+  scoped_refptr<Thread> thread_;
+
+  std::atomic<int64_t> read_nanos_;
+
+  DISALLOW_COPY_AND_ASSIGN(LogEntryPrefetcher);
+};
+
 // Bootstraps an existing tablet by opening the metadata from disk, and rebuilding soft
 // state by playing log segments. A bootstrapped tablet can then be added to an existing
 // consensus configuration as a LEARNER, which will bring its state up to date with the
@@ -641,7 +727,12 @@ Status TabletBootstrap::OpenTablet(bool* has_blocks) {
   // doing nothing for now except opening a tablet locally.
   {
     SCOPED_LOG_SLOW_EXECUTION_PREFIX(INFO, 100, LogPrefix(), "opening tablet");
+    const MonoTime start = MonoTime::Now();
     RETURN_NOT_OK(tablet->Open());
+    if (tablet->metrics()) {
+      tablet->metrics()->bootstrap_open_duration->set_value(
+          (MonoTime::Now() - start).ToMilliseconds());
+    }
   }
   *has_blocks = tablet->num_rowsets() != 0;
   tablet_ = std::move(tablet);
@@ -1181,27 +1272,31 @@ Status TabletBootstrap::PlaySegments(const IOContext* io_context,
   // writing.
   RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
 
-  auto last_status_update = MonoTime::Now();
+  LogEntryPrefetcher prefetcher(
+      segments, static_cast<int64_t>(FLAGS_tablet_bootstrap_log_prefetch_mb) * 1024 * 1024);
+  RETURN_NOT_OK_PREPEND(prefetcher.Start(), "Failed to start log prefetch thread");
+
+  const auto replay_start = MonoTime::Now();
+  auto last_status_update = replay_start;
   const auto kStatusUpdateInterval = MonoDelta::FromSeconds(5);
   int segment_count = 0;
 
   for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
-    log::LogEntryReader reader(segment.get());
-
+    LogEntryPrefetcher::Result result;
     int entry_count = 0;
     while (true) {
       {
-        unique_ptr<LogEntryPB> entry;
-        Status s = reader.ReadNextEntry(&entry);
-        if (PREDICT_FALSE(!s.ok())) {
-          if (s.IsEndOfFile()) {
+        prefetcher.ReadNext(&result);
+        DCHECK_EQ(segment_count, result.segment_idx);
+        if (PREDICT_FALSE(!result.status.ok())) {
+          if (result.status.IsEndOfFile()) {
             break;
           }
           return Status::Corruption(
               Substitute("Error reading Log Segment of tablet $0: $1 "
                          "(Read up to entry $2 of segment $3, in path $4)",
                          tablet_->tablet_id(),
-                         s.ToString(),
+                         result.status.ToString(),
                          entry_count,
                          segment->header().sequence_number(),
                          segment->path()));
@@ -1209,7 +1304,7 @@ Status TabletBootstrap::PlaySegments(const IOContext* io_context,
         entry_count++;
 
         string entry_debug_info;
-        s = HandleEntry(io_context, &state, std::move(entry), &entry_debug_info);
+        Status s = HandleEntry(io_context, &state, std::move(result.entry), &entry_debug_info);
         if (!s.ok()) {
           DumpReplayStateToLog(state);
           RETURN_NOT_OK_PREPEND(s, DebugInfo(tablet_->tablet_id(),
@@ -1224,8 +1319,8 @@ Status TabletBootstrap::PlaySegments(const IOContext* io_context,
         SetStatusMessage(Substitute("Bootstrap replaying log segment $0/$1 "
                                     "($2/$3 this segment, stats: $4)",
                                     segment_count + 1, log_reader_->num_segments(),
-                                    HumanReadableNumBytes::ToString(reader.offset()),
-                                    HumanReadableNumBytes::ToString(reader.read_up_to_offset()),
+                                    HumanReadableNumBytes::ToString(result.offset),
+                                    HumanReadableNumBytes::ToString(result.read_up_to_offset),
                                     stats_.ToString()));
         last_status_update = now;
       }
@@ -1239,6 +1334,16 @@ Status TabletBootstrap::PlaySegments(const IOContext* io_context,
     segment_count++;
   }
 
+  const MonoDelta replay_time = MonoTime::Now() - replay_start;
+  const MonoDelta read_time = prefetcher.read_time();
+  LOG_WITH_PREFIX(INFO) << Substitute("Replayed $0 log segments in $1 ($2 reading log entries)",
+                                      segment_count, replay_time.ToString(),
+                                      read_time.ToString());
+  if (tablet_->metrics()) {
+    tablet_->metrics()->bootstrap_log_read_duration->set_value(read_time.ToMilliseconds());
+    tablet_->metrics()->bootstrap_log_replay_duration->set_value(replay_time.ToMilliseconds());
+  }
+
   // If we have non-applied commits they all must belong to pending operations and
   // they should only pertain to stores which are still active.
   if (!state.pending_commits.empty()) {
@@ -1728,5 +1833,78 @@ bool FlushedStoresSnapshot::IsMemStoreActive(const MemStoreTargetPB& target) con
   }
 }
 
+LogEntryPrefetcher::LogEntryPrefetcher(log::SegmentSequence segments,
+                                       int64_t max_buffered_bytes)
+    : segments_(std::move(segments)),
+      max_buffered_bytes_(max_buffered_bytes),
+      cur_segment_idx_(0),
+      queue_(std::max<int64_t>(max_buffered_bytes, 1)),
+      read_nanos_(0) {
+}
+
+LogEntryPrefetcher::~LogEntryPrefetcher() {
+  // Unblocks the prefetching thread if it's waiting for room in the queue.
+  queue_.Shutdown();
+  if (thread_) {
+    thread_->Join();
+  }
+}
+
+Status LogEntryPrefetcher::Start() {
+  if (max_buffered_bytes_ <= 0 || segments_.empty()) {
+    return Status::OK();
+  }
+  return Thread::Create("tablet", "bootstrap-log-prefetch",
+                        [this]() { this->PrefetchThread(); }, &thread_);
+}
+
+void LogEntryPrefetcher::ReadNext(Result* result) {
+  if (thread_) {
+    // The prefetching thread produces every result up to the end of the log or
+    // the first error, and the queue is only shut down on destruction.
+    CHECK_OK(queue_.BlockingGet(result));
+    return;
+  }
+  DCHECK_LT(cur_segment_idx_, segments_.size());
+  if (!cur_reader_) {
+    cur_reader_.reset(new LogEntryReader(segments_[cur_segment_idx_].get()));
+  }
+  ReadEntry(cur_reader_.get(), cur_segment_idx_, result);
+  if (!result->status.ok()) {
+    cur_reader_.reset();
+    cur_segment_idx_++;
+  }
+}
+
+void LogEntryPrefetcher::ReadEntry(LogEntryReader* reader, int segment_idx, Result* result) {
+  const int64_t start_offset = reader->offset();
+  const MonoTime start = MonoTime::Now();
+  result->status = reader->ReadNextEntry(&result->entry);
+  read_nanos_.fetch_add((MonoTime::Now() - start).ToNanoseconds(), std::memory_order_relaxed);
+  result->segment_idx = segment_idx;
+  result->offset = reader->offset();
+  result->read_up_to_offset = reader->read_up_to_offset();
+  result->bytes = result->offset - start_offset;
+}
+
+void LogEntryPrefetcher::PrefetchThread() {
+  for (int i = 0; i < segments_.size(); i++) {
+    LogEntryReader reader(segments_[i].get());
+    while (true) {
+      Result result;
+      ReadEntry(&reader, i, &result);
+      const bool end_of_segment = !result.status.ok();
+      const bool failed = end_of_segment && !result.status.IsEndOfFile();
+      // Fails only if the prefetcher is being destroyed.
+      if (!queue_.BlockingPut(std::move(result)).ok() || failed) {
+        return;
+      }
+      if (end_of_segment) {
+        break;
+      }
+    }
+  }
+}
+
 } // namespace tablet
 } // namespace kudu
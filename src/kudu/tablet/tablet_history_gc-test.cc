@@ -19,9 +19,11 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/optional/optional.hpp>
@@ -34,10 +36,13 @@
 #include "kudu/clock/mock_ntp.h"
 #include "kudu/clock/time_service.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/iterator.h"
 #include "kudu/common/partial_row.h"
+#include "kudu/common/rowblock.h"
 #include "kudu/common/schema.h"
 #include "kudu/common/timestamp.h"
 #include "kudu/gutil/casts.h"
+#include "kudu/gutil/map-util.h"
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/gutil/strings/join.h"
@@ -54,6 +59,7 @@
 #include "kudu/tablet/tablet.h"
 #include "kudu/tablet/tablet_metadata.h"
 #include "kudu/tablet/tablet_metrics.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/monotime.h"
 #include "kudu/util/status.h"
@@ -64,7 +70,9 @@ DECLARE_int32(tablet_history_max_age_sec);
 DECLARE_string(time_source);
 
 using kudu::clock::HybridClock;
+using std::map;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 using strings::Substitute;
 
@@ -745,5 +753,330 @@ TEST_F(TabletHistoryGcNoMaintMgrTest, TestGCDeletedRowsetsAfterMajorCompaction)
   NO_FATALS(TryRunningDeletedRowsetGC());
 }
 
+class TabletRowSetTtlTest : public KuduTabletTest {
+ public:
+  TabletRowSetTtlTest()
+      : KuduTabletTest(Schema({ ColumnSchema("key", INT64),
+                                ColumnSchema("ts", UNIXTIME_MICROS, /*is_nullable=*/true) },
+                              1),
+                       TabletHarness::Options::HYBRID_CLOCK) {
+    FLAGS_time_source = "mock";
+  }
+
+  void SetUp() override {
+    NO_FATALS(KuduTabletTest::SetUp());
+    SetMockTime(GetCurrentTimeMicros());
+  }
+
+ protected:
+  void SetMockTime(int64_t micros) {
+    auto* hybrid_clock = down_cast<HybridClock*>(clock());
+    auto* ntp = down_cast<clock::MockNtp*>(hybrid_clock->time_service());
+    ntp->SetMockClockWallTimeForTests(micros);
+  }
+
+  void AddTimeToHybridClock(MonoDelta delta) {
+    uint64_t now = HybridClock::GetPhysicalValueMicros(clock()->Now());
+    SetMockTime(now + delta.ToMicroseconds());
+  }
+
+  // Insert the row 'key' whose "ts" column is 'ts_micros', or null if unset.
+  Status InsertRow(int64_t key, boost::optional<int64_t> ts_micros) {
+    LocalTabletWriter writer(tablet().get(), &client_schema_);
+    KuduPartialRow row(&client_schema_);
+    RETURN_NOT_OK(row.SetInt64(0, key));
+    if (ts_micros) {
+      RETURN_NOT_OK(row.SetUnixTimeMicros(1, *ts_micros));
+    } else {
+      RETURN_NOT_OK(row.SetNull(1));
+    }
+    return writer.Insert(row);
+  }
+
+  // Insert and flush a rowset of rows ['first_key', 'first_key' + kRowsPerRowSet)
+  // whose "ts" column is 'ts_micros'.
+  void InsertAndFlushRowSet(int64_t first_key, int64_t ts_micros) {
+    for (int64_t key = first_key; key < first_key + kRowsPerRowSet; key++) {
+      ASSERT_OK(InsertRow(key, ts_micros));
+    }
+    ASSERT_OK(tablet()->Flush());
+  }
+
+  Status UpdateRow(int64_t key, int64_t ts_micros) {
+    LocalTabletWriter writer(tablet().get(), &client_schema_);
+    KuduPartialRow row(&client_schema_);
+    RETURN_NOT_OK(row.SetInt64(0, key));
+    RETURN_NOT_OK(row.SetUnixTimeMicros(1, ts_micros));
+    return writer.Update(row);
+  }
+
+  Status ExpireRow(int64_t key, int64_t cutoff_micros) {
+    LocalTabletWriter writer(tablet().get(), &client_schema_);
+    KuduPartialRow row(&client_schema_);
+    RETURN_NOT_OK(row.SetInt64(0, key));
+    return writer.Expire(row, cutoff_micros);
+  }
+
+  // Collect the "ts" value of every row, keyed by the row's key.
+  void ScanRows(map<int64_t, boost::optional<int64_t>>* rows) {
+    unique_ptr<RowwiseIterator> iter;
+    ASSERT_OK(tablet()->NewRowIterator(client_schema_, &iter));
+    ASSERT_OK(iter->Init(nullptr));
+    Arena arena(1024);
+    RowBlock block(&iter->schema(), 100, &arena);
+    while (iter->HasNext()) {
+      ASSERT_OK(iter->NextBlock(&block));
+      for (size_t i = 0; i < block.nrows(); i++) {
+        if (!block.selection_vector()->IsRowSelected(i)) {
+          continue;
+        }
+        const RowBlockRow row = block.row(i);
+        boost::optional<int64_t> ts_micros;
+        if (!row.is_null(1)) {
+          ts_micros = *reinterpret_cast<const int64_t*>(row.cell_ptr(1));
+        }
+        EmplaceOrDie(rows, *reinterpret_cast<const int64_t*>(row.cell_ptr(0)), ts_micros);
+      }
+    }
+  }
+
+  vector<int64_t> RowSetMaxMicros(const ColumnId& col_id) {
+    vector<int64_t> max_micros;
+    for (const auto& rs_meta : tablet()->metadata()->rowsets()) {
+      max_micros.emplace_back(rs_meta->column_max_unixtime_micros(col_id).value_or(-1));
+    }
+    return max_micros;
+  }
+
+  void SetTtl(int32_t ttl_sec) {
+    TableExtraConfigPB extra_config;
+    extra_config.set_ttl_column("ts");
+    extra_config.set_ttl_sec(ttl_sec);
+    NO_FATALS(AlterSchema(*tablet()->schema(), boost::make_optional(extra_config)));
+  }
+
+  static constexpr int kRowsPerRowSet = 10;
+  static constexpr int64_t kHourMicros = 3600LL * 1000000;
+};
+
+// Rowsets whose timestamps are all older than the TTL are counted as expired
+// until their rows get deleted.
+TEST_F(TabletRowSetTtlTest, TestExpiredRowSetsAreCounted) {
+  const int64_t now = GetCurrentTimeMicros();
+  const int64_t two_hours_ago = now - 2 * kHourMicros;
+  NO_FATALS(InsertAndFlushRowSet(0, two_hours_ago));
+  NO_FATALS(InsertAndFlushRowSet(kRowsPerRowSet, now));
+  NO_FATALS(InsertAndFlushRowSet(2 * kRowsPerRowSet, two_hours_ago));
+  ASSERT_EQ(3, tablet()->num_rowsets());
+
+  // The greatest timestamp of each rowset is recorded in its metadata, and
+  // survives a restart.
+  const ColumnId ts_col_id = tablet()->schema()->column_id(1);
+  ASSERT_EQ(vector<int64_t>({ two_hours_ago, now, two_hours_ago }),
+            RowSetMaxMicros(ts_col_id));
+  NO_FATALS(TabletReOpen());
+  ASSERT_EQ(vector<int64_t>({ two_hours_ago, now, two_hours_ago }),
+            RowSetMaxMicros(ts_col_id));
+
+  // Without a TTL nothing has expired.
+  ColumnId col_id;
+  int64_t cutoff_micros = 0;
+  ASSERT_FALSE(tablet()->GetTtlCutoff(&col_id, &cutoff_micros));
+  int64_t bytes = 0;
+  ASSERT_OK(tablet()->GetBytesInExpiredRowsets(&bytes));
+  ASSERT_EQ(0, bytes);
+
+  // Update a row in the last rowset: its recorded max no longer accounts for
+  // every value, so it isn't counted.
+  ASSERT_OK(UpdateRow(2 * kRowsPerRowSet, now));
+
+  NO_FATALS(SetTtl(3600));
+  ASSERT_TRUE(tablet()->GetTtlCutoff(&col_id, &cutoff_micros));
+  ASSERT_EQ(ts_col_id, col_id);
+  ASSERT_OK(tablet()->GetBytesInExpiredRowsets(&bytes));
+  ASSERT_GT(bytes, 0);
+
+  // Once its rows are deleted, the first rowset isn't counted either.
+  for (int64_t key = 0; key < kRowsPerRowSet; key++) {
+    ASSERT_OK(ExpireRow(key, cutoff_micros));
+  }
+  ASSERT_OK(tablet()->GetBytesInExpiredRowsets(&bytes));
+  ASSERT_EQ(0, bytes);
+
+  // The other rows of the last rowset are expired as well.
+  for (int64_t key = 2 * kRowsPerRowSet; key < 3 * kRowsPerRowSet; key++) {
+    Status s = ExpireRow(key, cutoff_micros);
+    if (key == 2 * kRowsPerRowSet) {
+      ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+    } else {
+      ASSERT_OK(s);
+    }
+  }
+  ASSERT_EQ(3, tablet()->num_rowsets());
+  uint64_t count = 0;
+  ASSERT_OK(tablet()->CountRows(&count));
+  ASSERT_EQ(kRowsPerRowSet + 1, count);
+}
+
+// Expiring a row only deletes it if, when applied, it holds a non-null
+// timestamp older than the cutoff.
+TEST_F(TabletRowSetTtlTest, TestOnlyExpiredRowsAreDeleted) {
+  const int64_t now = GetCurrentTimeMicros();
+  const int64_t two_hours_ago = now - 2 * kHourMicros;
+  const int64_t cutoff_micros = now - kHourMicros;
+  NO_FATALS(SetTtl(3600));
+  ASSERT_OK(InsertRow(0, two_hours_ago));
+  ASSERT_OK(InsertRow(1, now));
+  ASSERT_OK(InsertRow(2, boost::none));
+  ASSERT_OK(InsertRow(3, two_hours_ago));
+  ASSERT_OK(tablet()->Flush());
+  ASSERT_OK(UpdateRow(3, now));
+  // This one stays in the MemRowSet.
+  ASSERT_OK(InsertRow(4, two_hours_ago));
+
+  ASSERT_OK(ExpireRow(0, cutoff_micros));
+  for (int64_t key : { 1, 2, 3 }) {
+    Status s = ExpireRow(key, cutoff_micros);
+    ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+    ASSERT_STR_CONTAINS(s.ToString(), "row has not expired");
+  }
+  ASSERT_OK(ExpireRow(4, cutoff_micros));
+  // Neither a deleted row nor a missing one expires.
+  for (int64_t key : { 0, 5 }) {
+    Status s = ExpireRow(key, cutoff_micros);
+    ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+  }
+
+  map<int64_t, boost::optional<int64_t>> rows;
+  NO_FATALS(ScanRows(&rows));
+  map<int64_t, boost::optional<int64_t>> expected_rows = {
+    { 1, now }, { 2, boost::none }, { 3, now } };
+  ASSERT_EQ(expected_rows, rows);
+}
+
+// A null TTL value never expires, so a rowset holding one isn't counted as
+// expired even if all of its other values are older than the TTL.
+TEST_F(TabletRowSetTtlTest, TestRowSetsWithNullsAreNotCounted) {
+  const int64_t two_hours_ago = GetCurrentTimeMicros() - 2 * kHourMicros;
+  ASSERT_OK(InsertRow(0, boost::none));
+  for (int64_t key = 1; key < kRowsPerRowSet; key++) {
+    ASSERT_OK(InsertRow(key, two_hours_ago));
+  }
+  ASSERT_OK(tablet()->Flush());
+  ASSERT_EQ(1, tablet()->num_rowsets());
+
+  // No max is recorded for a column holding nulls.
+  ColumnId ts_col_id = tablet()->schema()->column_id(1);
+  ASSERT_EQ(vector<int64_t>({ -1 }), RowSetMaxMicros(ts_col_id));
+
+  NO_FATALS(SetTtl(3600));
+  int64_t bytes = 0;
+  ASSERT_OK(tablet()->GetBytesInExpiredRowsets(&bytes));
+  ASSERT_EQ(0, bytes);
+
+  // Its other rows still expire.
+  ColumnId col_id;
+  int64_t cutoff_micros;
+  ASSERT_TRUE(tablet()->GetTtlCutoff(&col_id, &cutoff_micros));
+  for (int64_t key = 0; key < kRowsPerRowSet; key++) {
+    Status s = ExpireRow(key, cutoff_micros);
+    if (key == 0) {
+      ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+    } else {
+      ASSERT_OK(s);
+    }
+  }
+  uint64_t count = 0;
+  ASSERT_OK(tablet()->CountRows(&count));
+  ASSERT_EQ(1, count);
+}
+
+// A TTL on a column that isn't a timestamp is ignored.
+TEST_F(TabletRowSetTtlTest, TestTtlOnNonTimestampColumnIsIgnored) {
+  NO_FATALS(InsertAndFlushRowSet(0, 0));
+  TableExtraConfigPB extra_config;
+  extra_config.set_ttl_column("key");
+  extra_config.set_ttl_sec(1);
+  NO_FATALS(AlterSchema(*tablet()->schema(), boost::make_optional(extra_config)));
+  ColumnId col_id;
+  int64_t cutoff_micros;
+  ASSERT_FALSE(tablet()->GetTtlCutoff(&col_id, &cutoff_micros));
+  int64_t bytes = 0;
+  ASSERT_OK(tablet()->GetBytesInExpiredRowsets(&bytes));
+  ASSERT_EQ(0, bytes);
+  Status s = ExpireRow(0, GetCurrentTimeMicros());
+  ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+  uint64_t count = 0;
+  ASSERT_OK(tablet()->CountRows(&count));
+  ASSERT_EQ(kRowsPerRowSet, count);
+}
+
+// Updates racing with the expiry of their rows, and with the GC of the
+// rowsets whose rows all expired, are never lost: either an update lands
+// first and moves its row past the cutoff, so the row doesn't expire, or it
+// fails to find the expired row.
+TEST_F(TabletRowSetTtlTest, TestExpiryRacingUpdates) {
+  FLAGS_tablet_history_max_age_sec = 1;
+  const int kNumRows = AllowSlowTests() ? 500 : 50;
+  const int64_t now = GetCurrentTimeMicros();
+  const int64_t two_hours_ago = now - 2 * kHourMicros;
+
+  // One rowset per row, so that a row's rowset can be dropped once it expired.
+  for (int64_t key = 0; key < kNumRows; key++) {
+    ASSERT_OK(InsertRow(key, two_hours_ago));
+    ASSERT_OK(tablet()->Flush());
+  }
+  NO_FATALS(SetTtl(3600));
+  ColumnId col_id;
+  int64_t cutoff_micros;
+  ASSERT_TRUE(tablet()->GetTtlCutoff(&col_id, &cutoff_micros));
+
+  vector<Status> update_results(kNumRows);
+  std::atomic<bool> done(false);
+  std::thread updater([&]() {
+    for (int64_t key = 0; key < kNumRows; key++) {
+      update_results[key] = UpdateRow(key, now);
+    }
+  });
+  std::thread expirer([&]() {
+    for (int64_t key = 0; key < kNumRows; key++) {
+      Status s = ExpireRow(key, cutoff_micros);
+      CHECK(s.ok() || s.IsNotFound()) << s.ToString();
+    }
+  });
+  std::thread gc([&]() {
+    while (!done) {
+      AddTimeToHybridClock(MonoDelta::FromSeconds(2));
+      CHECK_OK(tablet()->FlushBiggestDMS());
+      CHECK_OK(tablet()->DeleteAncientDeletedRowsets());
+    }
+  });
+  updater.join();
+  expirer.join();
+  done = true;
+  gc.join();
+
+  map<int64_t, boost::optional<int64_t>> rows;
+  NO_FATALS(ScanRows(&rows));
+  size_t num_updated = 0;
+  for (int64_t key = 0; key < kNumRows; key++) {
+    const Status& s = update_results[key];
+    if (s.ok()) {
+      ASSERT_EQ(boost::make_optional(now), FindOrDie(rows, key));
+      num_updated++;
+    } else {
+      ASSERT_TRUE(s.IsNotFound()) << s.ToString();
+      ASSERT_FALSE(ContainsKey(rows, key));
+    }
+  }
+  ASSERT_EQ(num_updated, rows.size());
+
+  // All the rowsets whose row expired get dropped.
+  AddTimeToHybridClock(MonoDelta::FromSeconds(2));
+  ASSERT_OK(tablet()->FlushAllDMSForTests());
+  ASSERT_OK(tablet()->DeleteAncientDeletedRowsets());
+  ASSERT_EQ(num_updated, tablet()->num_rowsets());
+}
+
 } // namespace tablet
 } // namespace kudu
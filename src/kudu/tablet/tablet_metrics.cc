@@ -36,6 +36,12 @@ METRIC_DEFINE_counter(tablet, insert_ignore_errors, "Insert Ignore Errors",
     "Number of insert ignore operations for this tablet which were "
     "ignored due to an error since service start",
     kudu::MetricLevel::kDebug);
+METRIC_DEFINE_counter(tablet, rows_bulk_loaded, "Rows Bulk Loaded",
+    kudu::MetricUnit::kRows,
+    "Number of rows bulk loaded into this tablet since service start. Bulk "
+    "loaded rows are written directly to new DiskRowSets and are not counted "
+    "in rows_inserted.",
+    kudu::MetricLevel::kInfo);
 METRIC_DEFINE_counter(tablet, rows_upserted, "Rows Upserted",
     kudu::MetricUnit::kRows,
     "Number of rows upserted into this tablet since service start",
@@ -150,6 +156,13 @@ METRIC_DEFINE_counter(tablet, bytes_flushed, "Bytes Flushed",
                       "Amount of data that has been flushed to disk by this tablet.",
                       kudu::MetricLevel::kDebug);
 
+METRIC_DEFINE_counter(tablet, bytes_compacted, "Bytes Compacted",
+                      kudu::MetricUnit::kBytes,
+                      "Amount of data that has been rewritten to disk by rowset "
+                      "compactions of this tablet. This is included in the "
+                      "bytes flushed.",
+                      kudu::MetricLevel::kDebug);
+
 METRIC_DEFINE_counter(tablet, undo_delta_block_gc_bytes_deleted,
                       "Undo Delta Block GC Bytes Deleted",
                       kudu::MetricUnit::kBytes,
@@ -212,6 +225,19 @@ METRIC_DEFINE_histogram(tablet, commit_wait_duration,
   kudu::MetricLevel::kDebug,
   60000000LU, 2);
 
+METRIC_DEFINE_counter(tablet, row_lock_waits, "Row Lock Waits",
+  kudu::MetricUnit::kOperations,
+  "Number of row locks which could not be acquired immediately because another "
+  "write op held them.",
+  kudu::MetricLevel::kDebug);
+
+METRIC_DEFINE_histogram(tablet, row_lock_wait_duration,
+  "Row Lock Wait Duration",
+  kudu::MetricUnit::kMicroseconds,
+  "Time spent by write ops waiting for row locks held by other write ops.",
+  kudu::MetricLevel::kDebug,
+  60000000LU, 2);
+
 METRIC_DEFINE_histogram(tablet, snapshot_read_inflight_wait_duration,
   "Time Waiting For Snapshot Reads",
   kudu::MetricUnit::kMicroseconds,
@@ -274,6 +300,27 @@ METRIC_DEFINE_gauge_int64(tablet, deleted_rowset_estimated_retained_bytes,
   "Estimated bytes of deletable data in deleted rowsets for this tablet.",
   kudu::MetricLevel::kDebug);
 
+METRIC_DEFINE_gauge_int64(tablet, bootstrap_open_duration,
+  "Bootstrap Open Duration",
+  kudu::MetricUnit::kMilliseconds,
+  "Time spent opening the tablet's rowsets during the last bootstrap.",
+  kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_gauge_int64(tablet, bootstrap_log_read_duration,
+  "Bootstrap Log Read Duration",
+  kudu::MetricUnit::kMilliseconds,
+  "Time spent reading, decompressing and decoding WAL entries during the "
+  "last bootstrap. When log entries are prefetched, this overlaps with the "
+  "replay of earlier entries.",
+  kudu::MetricLevel::kInfo);
+
+METRIC_DEFINE_gauge_int64(tablet, bootstrap_log_replay_duration,
+  "Bootstrap Log Replay Duration",
+  kudu::MetricUnit::kMilliseconds,
+  "Wall time spent replaying the WAL during the last bootstrap, including "
+  "time spent waiting for log entries to be read.",
+  kudu::MetricLevel::kInfo);
+
 METRIC_DEFINE_histogram(tablet, flush_dms_duration,
   "DeltaMemStore Flush Duration",
   kudu::MetricUnit::kMilliseconds,
@@ -349,6 +396,14 @@ METRIC_DEFINE_gauge_double(tablet, average_diskrowset_height, "Average DiskRowSe
                            "replica. The larger the average height, the more "
                            "uncompacted the tablet replica is.",
                            kudu::MetricLevel::kInfo);
+METRIC_DEFINE_gauge_double(tablet, write_amplification, "Write Amplification",
+                           kudu::MetricUnit::kUnits,
+                           "Ratio of the data written to disk by flushes and "
+                           "rowset compactions of this tablet replica to the "
+                           "data flushed from its MemRowSets or bulk loaded. "
+                           "The compaction policy determines how many times "
+                           "each row is rewritten.",
+                           kudu::MetricLevel::kInfo);
 METRIC_DECLARE_gauge_size(merged_entities_count_of_tablet);
 
 namespace kudu {
@@ -360,6 +415,7 @@ namespace tablet {
 #define HIDEINIT(x, v) x(METRIC_##x.InstantiateHidden(entity, v))
 TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
   : MINIT(rows_inserted),
+    MINIT(rows_bulk_loaded),
     MINIT(rows_upserted),
     MINIT(rows_updated),
     MINIT(rows_deleted),
@@ -380,6 +436,7 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(delta_file_lookups),
     MINIT(mrs_lookups),
     MINIT(bytes_flushed),
+    MINIT(bytes_compacted),
     MINIT(deleted_rowset_gc_bytes_deleted),
     MINIT(undo_delta_block_gc_bytes_deleted),
     MINIT(bloom_lookups_per_op),
@@ -389,6 +446,8 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(snapshot_read_inflight_wait_duration),
     MINIT(write_op_duration_client_propagated_consistency),
     MINIT(write_op_duration_commit_wait_consistency),
+    MINIT(row_lock_waits),
+    MINIT(row_lock_wait_duration),
     GINIT(flush_dms_running),
     GINIT(flush_mrs_running),
     GINIT(compact_rs_running),
@@ -398,6 +457,9 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     GINIT(delta_major_compact_rs_running),
     GINIT(undo_delta_block_gc_running),
     GINIT(undo_delta_block_estimated_retained_bytes),
+    GINIT(bootstrap_open_duration),
+    GINIT(bootstrap_log_read_duration),
+    GINIT(bootstrap_log_replay_duration),
     MINIT(flush_dms_duration),
     MINIT(flush_mrs_duration),
     MINIT(compact_rs_duration),
@@ -409,6 +471,7 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(undo_delta_block_gc_perform_duration),
     MINIT(leader_memory_pressure_rejections),
     MEANINIT(average_diskrowset_height),
+    MEANINIT(write_amplification),
     HIDEINIT(merged_entities_count_of_tablet, 1) {
 }
 #undef MINIT
@@ -416,6 +479,18 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
 #undef MEANINIT
 #undef HIDEINIT
 
+void TabletMetrics::AddBytesWritten(uint64_t bytes, bool is_compaction) {
+  bytes_flushed->IncrementBy(bytes);
+  if (is_compaction) {
+    bytes_compacted->IncrementBy(bytes);
+  }
+  const int64_t total = bytes_flushed->value();
+  const int64_t ingested = total - bytes_compacted->value();
+  if (ingested > 0) {
+    write_amplification->set_value(total, ingested);
+  }
+}
+
 void TabletMetrics::AddProbeStats(const ProbeStats* stats_array, int len,
                                   Arena* work_arena) {
   // In most cases, different operations within a batch will have the same
@@ -43,8 +43,14 @@ struct TabletMetrics {
   // This allocates temporary scratch space from work_arena.
   void AddProbeStats(const ProbeStats* stats_array, int len, Arena* work_arena);
 
+  // Account for 'bytes' written out to new DiskRowSets, either by a rowset
+  // compaction ('is_compaction') or by a MemRowSet flush or bulk load, and
+  // update the write amplification accordingly.
+  void AddBytesWritten(uint64_t bytes, bool is_compaction);
+
   // Operation rates.
   scoped_refptr<Counter> rows_inserted;
+  scoped_refptr<Counter> rows_bulk_loaded;
   scoped_refptr<Counter> rows_upserted;
   scoped_refptr<Counter> rows_updated;
   scoped_refptr<Counter> rows_deleted;
@@ -71,6 +77,7 @@ struct TabletMetrics {
 
   // Operation stats.
   scoped_refptr<Counter> bytes_flushed;
+  scoped_refptr<Counter> bytes_compacted;
   scoped_refptr<Counter> deleted_rowset_gc_bytes_deleted;
   scoped_refptr<Counter> undo_delta_block_gc_bytes_deleted;
 
@@ -83,6 +90,9 @@ struct TabletMetrics {
   scoped_refptr<Histogram> write_op_duration_client_propagated_consistency;
   scoped_refptr<Histogram> write_op_duration_commit_wait_consistency;
 
+  scoped_refptr<Counter> row_lock_waits;
+  scoped_refptr<Histogram> row_lock_wait_duration;
+
   scoped_refptr<AtomicGauge<uint32_t> > flush_dms_running;
   scoped_refptr<AtomicGauge<uint32_t> > flush_mrs_running;
   scoped_refptr<AtomicGauge<uint32_t> > compact_rs_running;
@@ -93,6 +103,11 @@ struct TabletMetrics {
   scoped_refptr<AtomicGauge<uint32_t> > undo_delta_block_gc_running;
   scoped_refptr<AtomicGauge<int64_t> > undo_delta_block_estimated_retained_bytes;
 
+  // Bootstrap metrics.
+  scoped_refptr<AtomicGauge<int64_t> > bootstrap_open_duration;
+  scoped_refptr<AtomicGauge<int64_t> > bootstrap_log_read_duration;
+  scoped_refptr<AtomicGauge<int64_t> > bootstrap_log_replay_duration;
+
   scoped_refptr<Histogram> flush_dms_duration;
   scoped_refptr<Histogram> flush_mrs_duration;
   scoped_refptr<Histogram> compact_rs_duration;
@@ -107,6 +122,7 @@ struct TabletMetrics {
 
   // Compaction metrics.
   scoped_refptr<MeanGauge> average_diskrowset_height;
+  scoped_refptr<MeanGauge> write_amplification;
 
   // Static metrics.
   scoped_refptr<AtomicGauge<size_t>> merged_entities_count_of_tablet;
@@ -752,6 +752,10 @@ void TabletReplica::RegisterMaintenanceOps(MaintenanceManager* maint_mgr) {
   maint_mgr->RegisterOp(log_gc.get());
   maintenance_ops.push_back(log_gc.release());
 
+  unique_ptr<MaintenanceOp> expire_rows_op(new ExpireRowsOp(this));
+  maint_mgr->RegisterOp(expire_rows_op.get());
+  maintenance_ops.push_back(expire_rows_op.release());
+
   std::shared_ptr<Tablet> tablet;
   {
     std::lock_guard<simple_spinlock> l(lock_);
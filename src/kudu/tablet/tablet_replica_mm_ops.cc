@@ -17,25 +17,45 @@
 
 #include "kudu/tablet/tablet_replica_mm_ops.h"
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <boost/optional/optional.hpp>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "kudu/common/column_predicate.h"
 #include "kudu/common/common.pb.h"
+#include "kudu/common/iterator.h"
+#include "kudu/common/partial_row.h"
+#include "kudu/common/row_operations.h"
+#include "kudu/common/rowblock.h"
+#include "kudu/common/scan_spec.h"
+#include "kudu/common/schema.h"
+#include "kudu/common/wire_protocol.h"
+#include "kudu/common/wire_protocol.pb.h"
+#include "kudu/consensus/metadata.pb.h"
+#include "kudu/consensus/raft_consensus.h"
 #include "kudu/gutil/macros.h"
 #include "kudu/gutil/port.h"
+#include "kudu/gutil/strings/stringpiece.h"
 #include "kudu/gutil/strings/substitute.h"
+#include "kudu/tablet/ops/op.h"
+#include "kudu/tablet/ops/write_op.h"
 #include "kudu/tablet/tablet_metadata.h"
 #include "kudu/tablet/tablet_metrics.h"
+#include "kudu/tserver/tserver.pb.h"
+#include "kudu/util/countdown_latch.h"
 #include "kudu/util/flag_tags.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/maintenance_manager.h"
+#include "kudu/util/memory/arena.h"
 #include "kudu/util/metrics.h"
 #include "kudu/util/scoped_cleanup.h"
 #include "kudu/util/status.h"
@@ -75,6 +95,12 @@ DEFINE_int32(flush_threshold_secs, 2 * 60,
 TAG_FLAG(flush_threshold_secs, experimental);
 TAG_FLAG(flush_threshold_secs, runtime);
 
+DEFINE_int32(ttl_expiry_interval_secs, 10 * 60,
+             "Number of seconds after which the leader replica of a tablet with a "
+             "TTL looks for expired rows to delete, even if none of its "
+             "DiskRowSets has fully expired.");
+TAG_FLAG(ttl_expiry_interval_secs, experimental);
+TAG_FLAG(ttl_expiry_interval_secs, runtime);
 
 METRIC_DEFINE_gauge_uint32(tablet, log_gc_running,
                            "Log GCs Running",
@@ -87,16 +113,41 @@ METRIC_DEFINE_histogram(tablet, log_gc_duration,
                         "Time spent garbage collecting the logs.",
                         kudu::MetricLevel::kInfo,
                         60000LU, 1);
+METRIC_DEFINE_gauge_uint32(tablet, expire_rows_running,
+                           "Row Expiries Running",
+                           kudu::MetricUnit::kOperations,
+                           "Number of operations deleting the rows expired by "
+                           "the table's TTL currently running.",
+                           kudu::MetricLevel::kInfo);
+METRIC_DEFINE_histogram(tablet, expire_rows_duration,
+                        "Row Expiry Duration",
+                        kudu::MetricUnit::kMilliseconds,
+                        "Time spent deleting the rows expired by the table's TTL.",
+                        kudu::MetricLevel::kInfo,
+                        60000LU, 1);
+METRIC_DEFINE_counter(tablet, rows_expired, "Rows Expired",
+                      kudu::MetricUnit::kRows,
+                      "Number of rows deleted because they expired by the "
+                      "table's TTL.",
+                      kudu::MetricLevel::kInfo);
 
 namespace kudu {
 namespace tablet {
 
+using consensus::RaftPeerPB;
 using std::map;
+using std::unique_ptr;
+using std::vector;
 using strings::Substitute;
+using tserver::WriteRequestPB;
+using tserver::WriteResponsePB;
 
 // Upper bound for how long it takes to reach "full perf improvement" in time-based flushing.
 const double kFlushUpperBoundMs = 60 * 60 * 1000;
 
+// Number of expired rows deleted by each write op.
+const int kExpireRowsBatchSize = 1000;
+
 //
 // FlushOpPerfImprovementPolicy.
 //
@@ -335,5 +386,178 @@ scoped_refptr<AtomicGauge<uint32_t> > LogGCOp::RunningGauge() const {
   return log_gc_running_;
 }
 
+//
+// ExpireRowsOp.
+//
+
+ExpireRowsOp::ExpireRowsOp(TabletReplica* tablet_replica)
+    : TabletReplicaOpBase(StringPrintf("ExpireRowsOp(%s)",
+                                       tablet_replica->tablet()->tablet_id().c_str()),
+                          MaintenanceOp::HIGH_IO_USAGE,
+                          tablet_replica),
+      expire_rows_duration_(METRIC_expire_rows_duration.Instantiate(
+                                tablet_replica->tablet()->GetMetricEntity())),
+      expire_rows_running_(METRIC_expire_rows_running.Instantiate(
+                               tablet_replica->tablet()->GetMetricEntity(), 0)),
+      rows_expired_(METRIC_rows_expired.Instantiate(
+                        tablet_replica->tablet()->GetMetricEntity())),
+      sem_(1) {
+  time_since_expiry_.start();
+}
+
+void ExpireRowsOp::UpdateStats(MaintenanceOpStats* stats) {
+  // Only the leader issues the deletes; the followers apply them.
+  std::shared_ptr<consensus::RaftConsensus> consensus = tablet_replica_->shared_consensus();
+  if (!consensus || consensus->role() != RaftPeerPB::LEADER) {
+    return;
+  }
+  Tablet* tablet = tablet_replica_->tablet();
+  ColumnId ttl_col_id;
+  int64_t cutoff_micros;
+  if (!tablet->GetTtlCutoff(&ttl_col_id, &cutoff_micros)) {
+    return;
+  }
+
+  int64_t expired_bytes = 0;
+  WARN_NOT_OK(tablet->GetBytesInExpiredRowsets(&expired_bytes),
+              Substitute("$0Unable to count bytes in expired rowsets", tablet->LogPrefix()));
+  double elapsed_ms;
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    elapsed_ms = time_since_expiry_.elapsed().wall_millis();
+  }
+  if (expired_bytes == 0) {
+    // Rows may also expire within rowsets that hold newer ones. Look for them
+    // every so often, but don't give it a large perf_improvement score.
+    if (elapsed_ms < FLAGS_ttl_expiry_interval_secs * 1000) {
+      return;
+    }
+    stats->set_perf_improvement(std::min(1.0, elapsed_ms / kFlushUpperBoundMs));
+  }
+  stats->set_data_retained_bytes(expired_bytes);
+  stats->set_runnable(sem_.GetValue() == 1);
+}
+
+bool ExpireRowsOp::Prepare() {
+  return sem_.try_lock();
+}
+
+void ExpireRowsOp::Perform() {
+  CHECK(!sem_.try_lock());
+  SCOPED_CLEANUP({
+    sem_.unlock();
+  });
+
+  Tablet* tablet = tablet_replica_->tablet();
+  ColumnId ttl_col_id;
+  int64_t cutoff_micros;
+  if (!tablet->GetTtlCutoff(&ttl_col_id, &cutoff_micros)) {
+    return;
+  }
+  int64_t rows_expired = 0;
+  Status s = ExpireRows(ttl_col_id, cutoff_micros, &rows_expired);
+  rows_expired_->IncrementBy(rows_expired);
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG(WARNING) << tablet->LogPrefix() << "failed to delete expired rows: " << s.ToString();
+    return;
+  }
+  VLOG(1) << tablet->LogPrefix() << Substitute("deleted $0 expired rows", rows_expired);
+
+  {
+    std::lock_guard<simple_spinlock> l(lock_);
+    time_since_expiry_.start();
+  }
+}
+
+Status ExpireRowsOp::ExpireRows(const ColumnId& ttl_col_id, int64_t cutoff_micros,
+                                int64_t* rows_expired) {
+  Tablet* tablet = tablet_replica_->tablet();
+  const Schema schema = tablet->schema()->CopyWithoutColumnIds();
+  const int ttl_col_idx = tablet->schema()->find_column_by_id(ttl_col_id);
+  if (ttl_col_idx == Schema::kColumnNotFound) {
+    return Status::OK();
+  }
+
+  // Scan the keys of the rows that have expired, along with the TTL column
+  // the predicate applies to.
+  vector<StringPiece> col_names;
+  for (int i = 0; i < schema.num_key_columns(); i++) {
+    col_names.emplace_back(schema.column(i).name());
+  }
+  col_names.emplace_back(schema.column(ttl_col_idx).name());
+  Schema projection;
+  RETURN_NOT_OK(schema.CreateProjectionByNames(col_names, &projection));
+  ScanSpec spec;
+  spec.AddPredicate(ColumnPredicate::Range(projection.column(schema.num_key_columns()),
+                                           nullptr, &cutoff_micros));
+  unique_ptr<RowwiseIterator> iter;
+  RETURN_NOT_OK(tablet->NewRowIterator(projection, &iter));
+  RETURN_NOT_OK(iter->Init(&spec));
+
+  WriteRequestPB req;
+  req.set_tablet_id(tablet_replica_->tablet_id());
+  RETURN_NOT_OK(SchemaToPB(schema, req.mutable_schema()));
+  req.set_ttl_expiry_cutoff_micros(cutoff_micros);
+  RowOperationsPBEncoder enc(req.mutable_row_operations());
+  int num_rows = 0;
+
+  Arena arena(32 * 1024);
+  RowBlock block(&iter->schema(), 512, &arena);
+  while (iter->HasNext()) {
+    arena.Reset();
+    RETURN_NOT_OK(iter->NextBlock(&block));
+    for (size_t i = 0; i < block.nrows(); i++) {
+      if (!block.selection_vector()->IsRowSelected(i)) {
+        continue;
+      }
+      const RowBlockRow row = block.row(i);
+      KuduPartialRow key(&schema);
+      for (int col_idx = 0; col_idx < schema.num_key_columns(); col_idx++) {
+        RETURN_NOT_OK(key.Set(col_idx, row.cell_ptr(col_idx)));
+      }
+      enc.Add(RowOperationsPB::DELETE, key);
+      if (++num_rows == kExpireRowsBatchSize) {
+        RETURN_NOT_OK(SyncWrite(req, num_rows, rows_expired));
+        req.mutable_row_operations()->Clear();
+        num_rows = 0;
+      }
+    }
+  }
+  if (num_rows > 0) {
+    RETURN_NOT_OK(SyncWrite(req, num_rows, rows_expired));
+  }
+  return Status::OK();
+}
+
+Status ExpireRowsOp::SyncWrite(const WriteRequestPB& req, int num_rows,
+                               int64_t* rows_expired) {
+  CountDownLatch latch(1);
+  WriteResponsePB resp;
+  unique_ptr<OpCompletionCallback> op_cb(
+      new LatchOpCompletionCallback<WriteResponsePB>(&latch, &resp));
+  unique_ptr<WriteOpState> op_state(
+      new WriteOpState(tablet_replica_,
+                       &req,
+                       nullptr, // RequestIdPB
+                       &resp));
+  op_state->set_completion_callback(std::move(op_cb));
+  RETURN_NOT_OK(tablet_replica_->SubmitWrite(std::move(op_state)));
+  latch.Wait();
+  if (resp.has_error()) {
+    return StatusFromPB(resp.error().status());
+  }
+
+  // Rows that were updated past the cutoff or deleted since they were
+  // scanned fail with NotFound and are left alone.
+  *rows_expired += num_rows - resp.per_row_errors_size();
+  for (const auto& error : resp.per_row_errors()) {
+    Status s = StatusFromPB(error.error());
+    if (!s.IsNotFound()) {
+      return s.CloneAndPrepend(Substitute("failed to delete expired row $0", error.row_index()));
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace tablet
 }  // namespace kudu
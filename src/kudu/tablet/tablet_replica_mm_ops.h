@@ -32,6 +32,13 @@
 #include "kudu/util/stopwatch.h"
 
 namespace kudu {
+
+struct ColumnId;
+
+namespace tserver {
+class WriteRequestPB;
+} // namespace tserver
+
 namespace tablet {
 
 class FlushOpPerfImprovementPolicy {
@@ -137,6 +144,48 @@ class LogGCOp : public TabletReplicaOpBase {
   mutable Semaphore sem_;
 };
 
+// Maintenance op which deletes the rows that have expired by the table's TTL
+// (see TableExtraConfigPB::ttl_column). It only runs on the leader, and deletes
+// the rows through DELETEs which only apply if the row is still expired when
+// the op is applied (see WriteRequestPB::ttl_expiry_cutoff_micros), so every
+// replica deletes the same rows regardless of its clock or rowset layout.
+//
+// Runnable when some DiskRowSet has fully expired, or every
+// --ttl_expiry_interval_secs otherwise. Only one can run at a time.
+class ExpireRowsOp : public TabletReplicaOpBase {
+ public:
+  explicit ExpireRowsOp(TabletReplica* tablet_replica);
+
+  void UpdateStats(MaintenanceOpStats* stats) override;
+
+  bool Prepare() override;
+
+  void Perform() override;
+
+  scoped_refptr<Histogram> DurationHistogram() const override;
+
+  scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+
+ private:
+  // Deletes the rows whose value of the column 'ttl_col_id' is older than
+  // 'cutoff_micros'. Sets 'rows_expired' to the number of rows deleted.
+  Status ExpireRows(const ColumnId& ttl_col_id, int64_t cutoff_micros,
+                    int64_t* rows_expired);
+
+  // Submits 'req', which holds 'num_rows' DELETEs, to the replica and waits
+  // for it to complete, adding the number of rows it deleted to 'rows_expired'.
+  Status SyncWrite(const tserver::WriteRequestPB& req, int num_rows, int64_t* rows_expired);
+
+  scoped_refptr<Histogram> expire_rows_duration_;
+  scoped_refptr<AtomicGauge<uint32_t> > expire_rows_running_;
+  scoped_refptr<Counter> rows_expired_;
+  mutable Semaphore sem_;
+
+  // Lock protecting time_since_expiry_.
+  mutable simple_spinlock lock_;
+  Stopwatch time_since_expiry_;
+};
+
 } // namespace tablet
 } // namespace kudu
 
@@ -947,6 +947,12 @@ Status ToClientEncodingType(
     case ColumnPB::BIT_SHUFFLE :
       *type = KuduColumnStorageAttributes::BIT_SHUFFLE;
       break;
+    case ColumnPB::FOR_DELTA :
+      *type = KuduColumnStorageAttributes::FOR_DELTA;
+      break;
+    case ColumnPB::ALP :
+      *type = KuduColumnStorageAttributes::ALP;
+      break;
     default :
       s = Status::InvalidArgument(Substitute("Unexpected encoding type: $0", type_pb));
   }
@@ -973,6 +979,9 @@ Status ToClientCompressionType(
     case ColumnPB::ZLIB :
       *type = KuduColumnStorageAttributes::ZLIB;
       break;
+    case ColumnPB::ZSTD :
+      *type = KuduColumnStorageAttributes::ZSTD;
+      break;
     default :
       s = Status::InvalidArgument(Substitute("Unexpected compression type: $0", type_pb));
   }
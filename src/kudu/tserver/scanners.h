@@ -29,6 +29,7 @@
 #include <glog/logging.h>
 #include <gtest/gtest_prod.h>
 
+#include "kudu/common/common.pb.h"
 #include "kudu/common/iterator_stats.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/gutil/macros.h"
@@ -338,6 +339,20 @@ class Scanner {
     return row_format_flags_;
   }
 
+  // Sets the aggregations to evaluate over the rows of this scan, in place of
+  // returning them.
+  void set_aggregate_spec(std::unique_ptr<AggregateSpecPB> spec) {
+    lock_.AssertAcquired();
+    aggregate_spec_ = std::move(spec);
+  }
+
+  // Returns the aggregations to evaluate over the rows of this scan, or
+  // nullptr if this is not an aggregating scan.
+  const AggregateSpecPB* aggregate_spec() const {
+    lock_.AssertAcquired();
+    return aggregate_spec_.get();
+  }
+
   void add_num_rows_returned(int64_t num_rows_added) {
     lock_.AssertAcquired();
     num_rows_returned_ += num_rows_added;
@@ -435,6 +450,10 @@ class Scanner {
   // this scanner.
   int64_t num_rows_returned_;
 
+  // The aggregations requested by the client, if any.
+  // Protected by lock_.
+  std::unique_ptr<AggregateSpecPB> aggregate_spec_;
+
   // The cumulative amounts of wall, user cpu, and system cpu time spent on
   // this scanner, in seconds.
   mutable RWMutex cpu_times_lock_;
@@ -54,6 +54,8 @@
 #include "kudu/common/wire_protocol-test-util.h"
 #include "kudu/common/wire_protocol.h"
 #include "kudu/common/wire_protocol.pb.h"
+#include "kudu/consensus/consensus.pb.h"
+#include "kudu/consensus/consensus.proxy.h"
 #include "kudu/consensus/log-test-base.h"
 #include "kudu/consensus/log.h"
 #include "kudu/consensus/metadata.pb.h"
@@ -123,7 +125,11 @@
 using google::protobuf::util::MessageDifferencer;
 using kudu::clock::Clock;
 using kudu::clock::HybridClock;
+using kudu::consensus::ConsensusRequestPB;
+using kudu::consensus::ConsensusResponsePB;
 using kudu::consensus::ConsensusStatePB;
+using kudu::consensus::MultiRaftConsensusRequestPB;
+using kudu::consensus::MultiRaftConsensusResponsePB;
 using kudu::fs::BlockManager;
 using kudu::fs::CreateCorruptBlock;
 using kudu::fs::DataDirManager;
@@ -883,6 +889,57 @@ TEST_F(TabletServerTest, TestEIODuringDelete) {
   ASSERT_OK(admin_proxy_->DeleteTablet(req, &resp, &rpc));
 }
 
+// Test that a replica stalled in the middle of an update doesn't hold up the
+// heartbeats of other replicas batched with its own: it is answered right
+// away with a retriable error instead.
+TEST_F(TabletServerTest, TestMultiRaftUpdateConsensusSkipsBusyReplica) {
+  const char* kOtherTablet = "fffffffffffffffffffffffffffffff1";
+  ASSERT_OK(mini_server_->AddTestTablet("footable", kOtherTablet, schema_));
+  ASSERT_OK(WaitForTabletRunning(kOtherTablet));
+
+  const string uuid = mini_server_->server()->fs_manager()->uuid();
+  MultiRaftConsensusRequestPB req;
+  req.set_dest_uuid(uuid);
+  for (const char* tablet_id : { kTabletId, kOtherTablet }) {
+    ConsensusRequestPB* tablet_req = req.add_consensus_requests();
+    tablet_req->set_dest_uuid(uuid);
+    tablet_req->set_tablet_id(tablet_id);
+    tablet_req->set_caller_uuid("fake-leader");
+    tablet_req->set_caller_term(0);
+  }
+
+  MultiRaftConsensusResponsePB resp;
+  {
+    // Make the replica of the first tablet look busy with another update.
+    std::lock_guard<simple_spinlock> l(
+        *tablet_replica_->consensus()->update_lock_for_tests());
+    RpcController rpc;
+    rpc.set_timeout(MonoDelta::FromSeconds(10));
+    ASSERT_OK(consensus_proxy_->MultiRaftUpdateConsensus(req, &resp, &rpc));
+  }
+  SCOPED_TRACE(SecureDebugString(resp));
+  ASSERT_FALSE(resp.has_error());
+  ASSERT_EQ(2, resp.consensus_responses_size());
+
+  const ConsensusResponsePB& busy_resp = resp.consensus_responses(0);
+  ASSERT_TRUE(busy_resp.has_error());
+  ASSERT_EQ(TabletServerErrorPB::THROTTLED, busy_resp.error().code());
+
+  // The other replica handled its request as usual. It's the leader of a
+  // later term, so it rejects the fake leader's term.
+  const ConsensusResponsePB& other_resp = resp.consensus_responses(1);
+  ASSERT_FALSE(other_resp.has_error());
+  ASSERT_EQ(uuid, other_resp.responder_uuid());
+  ASSERT_TRUE(other_resp.status().has_error());
+  ASSERT_EQ(consensus::ConsensusErrorPB::INVALID_TERM, other_resp.status().error().code());
+
+  // Once the replica is no longer busy, it is updated as usual too.
+  RpcController rpc;
+  ASSERT_OK(consensus_proxy_->MultiRaftUpdateConsensus(req, &resp, &rpc));
+  ASSERT_EQ(2, resp.consensus_responses_size());
+  ASSERT_FALSE(resp.consensus_responses(0).has_error());
+}
+
 // Test that adding a directories enables tablet placement in the new
 // directories, and that removing directories fails tablets that are striped
 // across the removed directories.
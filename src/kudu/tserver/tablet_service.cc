@@ -43,6 +43,7 @@
 #include "kudu/common/iterator_stats.h"
 #include "kudu/common/key_range.h"
 #include "kudu/common/partition.h"
+#include "kudu/common/row_aggregator.h"
 #include "kudu/common/rowblock.h"
 #include "kudu/common/scan_spec.h"
 #include "kudu/common/schema.h"
@@ -179,6 +180,8 @@ using kudu::consensus::GetNodeInstanceResponsePB;
 using kudu::consensus::LeaderStepDownMode;
 using kudu::consensus::LeaderStepDownRequestPB;
 using kudu::consensus::LeaderStepDownResponsePB;
+using kudu::consensus::MultiRaftConsensusRequestPB;
+using kudu::consensus::MultiRaftConsensusResponsePB;
 using kudu::consensus::OpId;
 using kudu::consensus::RaftConsensus;
 using kudu::consensus::RunLeaderElectionRequestPB;
@@ -259,11 +262,11 @@ bool LookupTabletReplicaOrRespond(TabletReplicaLookupIf* tablet_manager,
   return true;
 }
 
-template<class RespClass>
-void RespondTabletNotRunning(const scoped_refptr<TabletReplica>& replica,
-                             tablet::TabletStatePB tablet_state,
-                             RespClass* resp,
-                             rpc::RpcContext* context) {
+// Set 'error' to indicate why 'replica', in state 'tablet_state', can't
+// serve requests.
+void SetupTabletNotRunningError(const scoped_refptr<TabletReplica>& replica,
+                                tablet::TabletStatePB tablet_state,
+                                TabletServerErrorPB* error) {
   Status s = Status::IllegalState("Tablet not RUNNING",
                                   tablet::TabletStatePB_Name(tablet_state));
   auto error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
@@ -277,7 +280,17 @@ void RespondTabletNotRunning(const scoped_refptr<TabletReplica>& replica,
     s = s.CloneAndAppend(replica->error().ToString());
     error_code = TabletServerErrorPB::TABLET_FAILED;
   }
-  SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
+  StatusToPB(s, error->mutable_status());
+  error->set_code(error_code);
+}
+
+template<class RespClass>
+void RespondTabletNotRunning(const scoped_refptr<TabletReplica>& replica,
+                             tablet::TabletStatePB tablet_state,
+                             RespClass* resp,
+                             rpc::RpcContext* context) {
+  SetupTabletNotRunningError(replica, tablet_state, resp->mutable_error());
+  context->RespondNoCache();
 }
 
 // Check if the replica is running.
@@ -385,6 +398,45 @@ Status GetTabletRef(const scoped_refptr<TabletReplica>& replica,
   return Status::OK();
 }
 
+// Like ConsensusServiceImpl::UpdateConsensus(), but for one of the requests
+// of a MultiRaftUpdateConsensus() call: rather than failing the RPC, errors
+// are reported in 'resp'. If the replica is busy handling another update,
+// the request is answered right away with a THROTTLED error rather than
+// holding up the rest of the batch.
+void UpdateConsensusForTablet(TabletReplicaLookupIf* tablet_manager,
+                              const ConsensusRequestPB& req,
+                              ConsensusResponsePB* resp) {
+  scoped_refptr<TabletReplica> replica;
+  Status s = tablet_manager->GetTabletReplica(req.tablet_id(), &replica);
+  if (PREDICT_FALSE(!s.ok())) {
+    StatusToPB(s, resp->mutable_error()->mutable_status());
+    resp->mutable_error()->set_code(s.IsServiceUnavailable() ?
+        TabletServerErrorPB::UNKNOWN_ERROR : TabletServerErrorPB::TABLET_NOT_FOUND);
+    return;
+  }
+  tablet::TabletStatePB state = replica->state();
+  if (PREDICT_FALSE(state != tablet::RUNNING)) {
+    SetupTabletNotRunningError(replica, state, resp->mutable_error());
+    return;
+  }
+  shared_ptr<RaftConsensus> consensus = replica->shared_consensus();
+  if (PREDICT_FALSE(!consensus)) {
+    StatusToPB(Status::ServiceUnavailable("Raft Consensus unavailable",
+                                          "Tablet replica not initialized"),
+               resp->mutable_error()->mutable_status());
+    resp->mutable_error()->set_code(TabletServerErrorPB::TABLET_NOT_RUNNING);
+    return;
+  }
+  s = consensus->TryUpdate(&req, resp);
+  if (PREDICT_FALSE(!s.ok())) {
+    // Clear the response first, as UpdateConsensus() does.
+    resp->Clear();
+    StatusToPB(s, resp->mutable_error()->mutable_status());
+    resp->mutable_error()->set_code(s.IsServiceUnavailable() ?
+        TabletServerErrorPB::THROTTLED : TabletServerErrorPB::UNKNOWN_ERROR);
+  }
+}
+
 template <class RespType>
 void HandleUnknownError(const Status& s, RespType* resp, RpcContext* context) {
   resp->Clear();
@@ -897,6 +949,18 @@ class ScanResultCopier : public ScanResultCollector {
   }
 
   void HandleRowBlock(Scanner* scanner, const RowBlock& row_block) override {
+    if (scanner->aggregate_spec()) {
+      if (!aggregator_) {
+        // The spec was validated against the projection when the scanner was
+        // created.
+        CHECK_OK(RowAggregator::Create(*scanner->aggregate_spec(),
+                                       *scanner->client_projection_schema(),
+                                       &aggregator_));
+      }
+      aggregator_->AddRowBlock(row_block);
+      return;
+    }
+
     int num_selected = serializer_->SerializeRowBlock(
         row_block, scanner->client_projection_schema());
 
@@ -909,7 +973,8 @@ class ScanResultCopier : public ScanResultCollector {
 
   // Returns number of bytes buffered to return.
   int64_t ResponseSize() const override {
-    return serializer_->ResponseSize();
+    return serializer_->ResponseSize() +
+        (aggregator_ ? aggregator_->EstimatedResultSize() : 0);
   }
 
   int64_t NumRowsReturned() const override {
@@ -936,6 +1001,9 @@ class ScanResultCopier : public ScanResultCollector {
     if (serializer_) {
       serializer_->SetupResponse(context, resp);
     }
+    if (aggregator_) {
+      aggregator_->ToPB(resp->mutable_aggregate_result());
+    }
 
     // Set the last row found by the collector.
     //
@@ -952,6 +1020,10 @@ class ScanResultCopier : public ScanResultCollector {
   faststring last_primary_key_;
   unique_ptr<ResultSerializer> serializer_;
 
+  // For aggregating scans, the aggregates of the rows scanned while handling
+  // this request.
+  unique_ptr<RowAggregator> aggregator_;
+
   DISALLOW_COPY_AND_ASSIGN(ScanResultCopier);
 };
 
@@ -1466,6 +1538,24 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
   context->RespondSuccess();
 }
 
+void ConsensusServiceImpl::MultiRaftUpdateConsensus(const MultiRaftConsensusRequestPB* req,
+                                                    MultiRaftConsensusResponsePB* resp,
+                                                    rpc::RpcContext* context) {
+  DVLOG(3) << "Received Multi-Raft Consensus Update RPC: " << SecureDebugString(*req);
+  if (!CheckUuidMatchOrRespond(tablet_manager_, "MultiRaftUpdateConsensus",
+                               req, resp, context)) {
+    return;
+  }
+  // The requests are batched heartbeats, which are cheap to handle, so they
+  // are handled one after the other on this service thread. A replica that is
+  // busy with another update is skipped rather than waited for; see
+  // UpdateConsensusForTablet().
+  for (const auto& tablet_req : req->consensus_requests()) {
+    UpdateConsensusForTablet(tablet_manager_, tablet_req, resp->add_consensus_responses());
+  }
+  context->RespondSuccess();
+}
+
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
                                                 VoteResponsePB* resp,
                                                 rpc::RpcContext* context) {
@@ -2248,6 +2338,7 @@ bool TabletServiceImpl::SupportsFeature(uint32_t feature) const {
     case TabletServerFeatures::QUIESCING:
     case TabletServerFeatures::BLOOM_FILTER_PREDICATE:
     case TabletServerFeatures::COLUMNAR_LAYOUT_FEATURE:
+    case TabletServerFeatures::AGGREGATE_PUSHDOWN:
       return true;
     default:
       return false;
@@ -2433,6 +2524,22 @@ Status VerifyLegalSnapshotTimestamps(Tablet* tablet, ReadMode read_mode,
   }
   return Status::OK();
 }
+// Checks that the aggregations requested by 'scan_pb' are valid for a scan
+// whose client projection is 'client_projection'.
+Status ValidateAggregateSpec(const NewScanRequestPB& scan_pb,
+                             const Schema& client_projection) {
+  // Partial aggregates can't be resumed from a primary key, nor truncated to
+  // a number of rows.
+  if (scan_pb.order_mode() == ORDERED) {
+    return Status::InvalidArgument("aggregating scans may not be ordered");
+  }
+  if (scan_pb.has_limit()) {
+    return Status::InvalidArgument("aggregating scans may not have a limit");
+  }
+  unique_ptr<RowAggregator> aggregator;
+  return RowAggregator::Create(scan_pb.aggregate_spec(), client_projection, &aggregator);
+}
+
 } // anonymous namespace
 
 // Start a new scan.
@@ -2566,6 +2673,16 @@ Status TabletServiceImpl::HandleNewScanRequest(TabletReplica* replica,
     return s;
   }
 
+  if (scan_pb.has_aggregate_spec()) {
+    s = ValidateAggregateSpec(scan_pb, *client_projection);
+    if (PREDICT_FALSE(!s.ok())) {
+      *error_code = TabletServerErrorPB::INVALID_SCAN_SPEC;
+      return s;
+    }
+    scanner->set_aggregate_spec(unique_ptr<AggregateSpecPB>(
+        new AggregateSpecPB(scan_pb.aggregate_spec())));
+  }
+
   if (spec.CanShortCircuit()) {
     VLOG(1) << "short-circuiting without creating a server-side scanner.";
     *has_more_results = false;
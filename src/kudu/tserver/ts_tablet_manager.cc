@@ -39,6 +39,7 @@
 #include "kudu/consensus/log.h"
 #include "kudu/consensus/log_anchor_registry.h"
 #include "kudu/consensus/metadata.pb.h"
+#include "kudu/consensus/multi_raft_batcher.h"
 #include "kudu/consensus/opid.pb.h"
 #include "kudu/consensus/opid_util.h"
 #include "kudu/consensus/quorum_util.h"
@@ -200,6 +201,7 @@ using kudu::consensus::ConsensusMetadataManager;
 using kudu::consensus::ConsensusStatePB;
 using kudu::consensus::EXCLUDE_HEALTH_REPORT;
 using kudu::consensus::INCLUDE_HEALTH_REPORT;
+using kudu::consensus::MultiRaftManager;
 using kudu::consensus::OpId;
 using kudu::consensus::OpIdToString;
 using kudu::consensus::RECEIVED_OPID;
@@ -371,6 +373,9 @@ Status TSTabletManager::Init() {
                 .set_max_threads(max_delete_threads)
                 .Build(&delete_tablet_pool_));
 
+  multi_raft_manager_.reset(new MultiRaftManager(server_->messenger(),
+                                                  server_->dns_resolver()));
+
   // Search for tablets in the metadata dir.
   vector<string> tablet_ids;
   RETURN_NOT_OK(fs_manager_->ListTabletIds(&tablet_ids));
@@ -837,7 +842,8 @@ Status TSTabletManager::CreateAndRegisterTabletReplica(
                         }));
   Status s = replica->Init({ server_->mutable_quiescing(),
                              server_->num_raft_leaders(),
-                             server_->raft_pool() });
+                             server_->raft_pool(),
+                             multi_raft_manager_.get() });
   if (PREDICT_FALSE(!s.ok())) {
     replica->SetError(s);
     replica->Shutdown();
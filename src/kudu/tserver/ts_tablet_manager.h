@@ -60,6 +60,7 @@ class ThreadPool;
 
 namespace consensus {
 class ConsensusMetadataManager;
+class MultiRaftManager;
 class OpId;
 class StartTabletCopyRequestPB;
 } // namespace consensus
@@ -398,6 +399,10 @@ class TSTabletManager : public tserver::TabletReplicaLookupIf {
   // Thread pool used to delete tablets asynchronously.
   std::unique_ptr<ThreadPool> delete_tablet_pool_;
 
+  // Batches the heartbeats the replicas hosted by this server send to the
+  // replicas hosted by each other server.
+  std::unique_ptr<consensus::MultiRaftManager> multi_raft_manager_;
+
   // Ensures that we only update stats from a single thread at a time.
   mutable rw_spinlock lock_update_;
   MonoTime next_update_time_;
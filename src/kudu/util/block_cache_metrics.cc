@@ -17,6 +17,8 @@
 
 #include "kudu/util/block_cache_metrics.h"
 
+#include <cstdint>
+
 #include "kudu/util/metrics.h"
 
 METRIC_DEFINE_counter(server, block_cache_inserts,
@@ -56,6 +58,13 @@ METRIC_DEFINE_gauge_uint64(server, block_cache_usage, "Block Cache Memory Usage"
                            kudu::MetricUnit::kBytes,
                            "Memory consumed by the block cache",
                            kudu::MetricLevel::kInfo);
+METRIC_DEFINE_gauge_double(server, block_cache_hit_ratio, "Block Cache Hit Ratio",
+                           kudu::MetricUnit::kUnits,
+                           "Fraction of the lookups expecting a block that found one, "
+                           "i.e. block_cache_hits_caching divided by the sum of "
+                           "block_cache_hits_caching and block_cache_misses_caching. "
+                           "It is 0 if there have been no such lookups yet.",
+                           kudu::MetricLevel::kInfo);
 
 namespace kudu {
 
@@ -70,8 +79,17 @@ BlockCacheMetrics::BlockCacheMetrics(const scoped_refptr<MetricEntity>& entity)
   MINIT(cache_misses, block_cache_misses);
   MINIT(cache_misses_caching, block_cache_misses_caching);
   GINIT(cache_usage, block_cache_usage);
+  METRIC_block_cache_hit_ratio.InstantiateFunctionGauge(
+      entity, [this]() { return this->HitRatio(); })
+      ->AutoDetach(&metric_detacher_);
 }
 #undef MINIT
 #undef GINIT
 
+double BlockCacheMetrics::HitRatio() const {
+  const int64_t hits = cache_hits_caching->value();
+  const int64_t total = hits + cache_misses_caching->value();
+  return total == 0 ? 0 : static_cast<double>(hits) / total;
+}
+
 } // namespace kudu
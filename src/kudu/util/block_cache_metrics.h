@@ -19,6 +19,7 @@
 
 #include "kudu/gutil/ref_counted.h"
 #include "kudu/util/cache_metrics.h"
+#include "kudu/util/metrics.h"
 
 namespace kudu {
 
@@ -26,6 +27,12 @@ class MetricEntity;
 
 struct BlockCacheMetrics : public CacheMetrics {
   explicit BlockCacheMetrics(const scoped_refptr<MetricEntity>& entity);
+
+  // Fraction of the lookups expecting to find a block which did find one.
+  double HitRatio() const;
+
+ private:
+  FunctionGaugeDetacher metric_detacher_;
 };
 
 } // namespace kudu
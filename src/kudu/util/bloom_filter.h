@@ -196,6 +196,11 @@ class BloomFilter {
   // Return true if the filter may contain the given key.
   bool MayContainKey(const BloomKeyProbe &probe) const;
 
+  // Prefetch the part of the bitmap holding the first bit tested by
+  // MayContainKey() for the given key. Used to overlap the cache misses
+  // when checking a batch of keys.
+  void Prefetch(const BloomKeyProbe &probe) const;
+
  private:
   friend class BloomFilterBuilder;
   static uint32_t PickBit(uint32_t hash, size_t n_bits);
@@ -233,6 +238,11 @@ inline void BloomFilterBuilder::AddKey(const BloomKeyProbe &probe) {
   n_inserted_++;
 }
 
+inline void BloomFilter::Prefetch(const BloomKeyProbe &probe) const {
+  uint32_t bitpos = PickBit(probe.initial_hash(), n_bits_);
+  prefetch(reinterpret_cast<const char *>(&bitmap_[bitpos >> 3]), PREFETCH_HINT_T0);
+}
+
 inline bool BloomFilter::MayContainKey(const BloomKeyProbe &probe) const {
   uint32_t h = probe.initial_hash();
 
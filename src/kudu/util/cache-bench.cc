@@ -15,6 +15,7 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <cstring>
@@ -59,6 +60,8 @@ static constexpr int kEntrySize = 4 * 1024;
 
 // Test parameterization.
 struct BenchSetup {
+  Cache::EvictionPolicy policy;
+
   enum class Pattern {
     // Zipfian distribution -- a small number of items make up the
     // vast majority of lookups.
@@ -76,6 +79,11 @@ struct BenchSetup {
 
   string ToString() const {
     string ret;
+    switch (policy) {
+      case Cache::EvictionPolicy::LRU: ret += "LRU "; break;
+      case Cache::EvictionPolicy::CLOCK: ret += "CLOCK "; break;
+      default: ret += "UNKNOWN "; break;
+    }
     switch (pattern) {
       case Pattern::ZIPFIAN: ret += "ZIPFIAN"; break;
       case Pattern::UNIFORM: ret += "UNIFORM"; break;
@@ -95,7 +103,16 @@ class CacheBench : public KuduTest,
  public:
   void SetUp() override {
     KuduTest::SetUp();
-    cache_.reset(NewCache(kCacheCapacity, "test-cache"));
+    switch (GetParam().policy) {
+      case Cache::EvictionPolicy::LRU:
+        cache_.reset(NewCache<Cache::EvictionPolicy::LRU>(kCacheCapacity, "test-cache"));
+        break;
+      case Cache::EvictionPolicy::CLOCK:
+        cache_.reset(NewCache<Cache::EvictionPolicy::CLOCK>(kCacheCapacity, "test-cache"));
+        break;
+      default:
+        FAIL() << "unsupported cache eviction policy";
+    }
   }
 
   // Run queries against the cache until '*done' becomes true.
@@ -155,12 +172,18 @@ class CacheBench : public KuduTest,
 };
 
 // Test both distributions, and for each, test both the case where the data
-// fits in the cache and where it is a bit larger.
+// fits in the cache and where it is a bit larger. Compare the LRU policy, which
+// reorders entries under an exclusive lock upon every lookup, with CLOCK, whose
+// lookups run under a shared lock.
 INSTANTIATE_TEST_CASE_P(Patterns, CacheBench, testing::ValuesIn(std::vector<BenchSetup>{
-      {BenchSetup::Pattern::ZIPFIAN, 1.0},
-      {BenchSetup::Pattern::ZIPFIAN, 3.0},
-      {BenchSetup::Pattern::UNIFORM, 1.0},
-      {BenchSetup::Pattern::UNIFORM, 3.0}
+      {Cache::EvictionPolicy::LRU, BenchSetup::Pattern::ZIPFIAN, 1.0},
+      {Cache::EvictionPolicy::LRU, BenchSetup::Pattern::ZIPFIAN, 3.0},
+      {Cache::EvictionPolicy::LRU, BenchSetup::Pattern::UNIFORM, 1.0},
+      {Cache::EvictionPolicy::LRU, BenchSetup::Pattern::UNIFORM, 3.0},
+      {Cache::EvictionPolicy::CLOCK, BenchSetup::Pattern::ZIPFIAN, 1.0},
+      {Cache::EvictionPolicy::CLOCK, BenchSetup::Pattern::ZIPFIAN, 3.0},
+      {Cache::EvictionPolicy::CLOCK, BenchSetup::Pattern::UNIFORM, 1.0},
+      {Cache::EvictionPolicy::CLOCK, BenchSetup::Pattern::UNIFORM, 3.0}
     }));
 
 TEST_P(CacheBench, RunBench) {
@@ -184,4 +207,25 @@ TEST_P(CacheBench, RunBench) {
   LOG(INFO) << test_case << ": " << StringPrintf("%.1f", hit_rate * 100.0) << "% hit rate";
 }
 
+// Run the benchmark with 1, 2, 4, ... up to --num_threads threads to show how
+// the lookup throughput scales with the number of threads accessing the cache.
+TEST_P(CacheBench, ThreadScaling) {
+  const BenchSetup& setup = GetParam();
+
+  LOG(INFO) << "Warming up...";
+  RunQueryThreads(FLAGS_num_threads, 1);
+
+  const string test_case = setup.ToString();
+  for (int n_threads = 1; ; n_threads = std::min(n_threads * 2, FLAGS_num_threads)) {
+    pair<int64_t, int64_t> hits_lookups = RunQueryThreads(n_threads, FLAGS_run_seconds);
+    int64_t l_per_sec = hits_lookups.second / FLAGS_run_seconds;
+    LOG(INFO) << test_case << ": " << n_threads << " threads: "
+              << HumanReadableNum::ToString(l_per_sec) << " lookups/sec ("
+              << HumanReadableNum::ToString(l_per_sec / n_threads) << " per thread)";
+    if (n_threads == FLAGS_num_threads) {
+      break;
+    }
+  }
+}
+
 } // namespace kudu
@@ -8,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -34,6 +35,7 @@ DECLARE_bool(cache_force_single_shard);
 DECLARE_string(nvm_cache_path);
 
 DECLARE_double(cache_memtracker_approximation_ratio);
+DECLARE_double(cache_slru_protected_ratio);
 
 using std::make_tuple;
 using std::tuple;
@@ -145,6 +147,24 @@ class CacheBaseTest : public KuduTest,
         }
         MemTracker::FindTracker("cache_test-sharded_lru_cache", &mem_tracker_);
         break;
+      case Cache::EvictionPolicy::SLRU:
+        if (mem_type != Cache::MemoryType::DRAM) {
+          FAIL() << "SLRU cache can only be of DRAM type";
+        }
+        cache_.reset(NewCache<Cache::EvictionPolicy::SLRU,
+                              Cache::MemoryType::DRAM>(cache_size(),
+                                                       "cache_test"));
+        MemTracker::FindTracker("cache_test-sharded_slru_cache", &mem_tracker_);
+        break;
+      case Cache::EvictionPolicy::CLOCK:
+        if (mem_type != Cache::MemoryType::DRAM) {
+          FAIL() << "CLOCK cache can only be of DRAM type";
+        }
+        cache_.reset(NewCache<Cache::EvictionPolicy::CLOCK,
+                              Cache::MemoryType::DRAM>(cache_size(),
+                                                       "cache_test"));
+        MemTracker::FindTracker("cache_test-sharded_clock_cache", &mem_tracker_);
+        break;
       default:
         FAIL() << "unrecognized cache eviction policy";
         break;
@@ -162,6 +182,7 @@ class CacheBaseTest : public KuduTest,
       scoped_refptr<MetricEntity> entity = METRIC_ENTITY_server.Instantiate(
           &metric_registry_, "test");
       unique_ptr<BlockCacheMetrics> metrics(new BlockCacheMetrics(entity));
+      metrics_ = metrics.get();
       cache_->SetMetrics(std::move(metrics));
     }
   }
@@ -172,6 +193,8 @@ class CacheBaseTest : public KuduTest,
   shared_ptr<MemTracker> mem_tracker_;
   unique_ptr<Cache> cache_;
   MetricRegistry metric_registry_;
+  // Owned by 'cache_'.
+  BlockCacheMetrics* metrics_ = nullptr;
 };
 
 class CacheTest :
@@ -207,6 +230,18 @@ INSTANTIATE_TEST_CASE_P(
         make_tuple(Cache::MemoryType::DRAM,
                    Cache::EvictionPolicy::LRU,
                    ShardingPolicy::SingleShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::SLRU,
+                   ShardingPolicy::MultiShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::SLRU,
+                   ShardingPolicy::SingleShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::CLOCK,
+                   ShardingPolicy::MultiShard),
+        make_tuple(Cache::MemoryType::DRAM,
+                   Cache::EvictionPolicy::CLOCK,
+                   ShardingPolicy::SingleShard),
         make_tuple(Cache::MemoryType::NVM,
                    Cache::EvictionPolicy::LRU,
                    ShardingPolicy::MultiShard),
@@ -423,6 +458,16 @@ TEST_P(CacheTest, InvalidateOddKeyEntries) {
   }
 }
 
+TEST_P(CacheTest, HitRatio) {
+  RETURN_IF_NO_NVM_CACHE(std::get<0>(GetParam()));
+  ASSERT_EQ(0, metrics_->HitRatio());
+  Insert(100, 101);
+  ASSERT_EQ(101, Lookup(100));
+  ASSERT_EQ(-1, Lookup(200));
+  ASSERT_EQ(101, Lookup(100));
+  ASSERT_DOUBLE_EQ(2.0 / 3, metrics_->HitRatio());
+}
+
 // This class is dedicated for scenarios specific for FIFOCache.
 // The scenarios use a single-shard cache for simpler logic.
 class FIFOCacheTest : public CacheBaseTest {
@@ -532,4 +577,131 @@ TEST_P(LRUCacheTest, EvictionPolicy) {
   ASSERT_EQ(-1, Lookup(200));
 }
 
+// This class is dedicated for scenarios specific for SLRUCache.
+// The scenarios use a single-shard cache for simpler logic.
+class SLRUCacheTest : public CacheBaseTest {
+ public:
+  SLRUCacheTest()
+      : CacheBaseTest(10 * 1024) {
+  }
+
+  void SetUp() override {
+    SetupWithParameters(Cache::MemoryType::DRAM,
+                        Cache::EvictionPolicy::SLRU,
+                        ShardingPolicy::SingleShard);
+  }
+};
+
+// Verify that entries which have been looked up survive a flood of entries
+// which are never looked up, and that the protected segment is bounded.
+TEST_F(SLRUCacheTest, EvictionPolicy) {
+  static constexpr int kNumElems = 100;
+  static constexpr int kNumHotElems = 20;
+  const int size_per_elem = cache_size() / kNumElems;
+  const int protected_capacity = FLAGS_cache_slru_protected_ratio * cache_size();
+  const int num_protected_elems = protected_capacity / size_per_elem;
+  ASSERT_GT(num_protected_elems, kNumHotElems);
+
+  // Insert the hot entries and look them up to promote them into the
+  // protected segment.
+  for (int i = 0; i < kNumHotElems; ++i) {
+    Insert(i, i, size_per_elem);
+    ASSERT_EQ(i, Lookup(i));
+  }
+
+  // Scan through many more entries than the cache can fit, never looking
+  // any of them up again.
+  for (int i = 0; i < 5 * kNumElems; ++i) {
+    Insert(1000 + i, 1000 + i, size_per_elem);
+  }
+  ASSERT_FALSE(evicted_keys_.empty());
+  for (int i = 0; i < kNumHotElems; ++i) {
+    SCOPED_TRACE(Substitute("hot entry: index $0", i));
+    ASSERT_EQ(i, Lookup(i));
+  }
+
+  // Promote a new set of entries which doesn't fit into the protected segment.
+  // The hot entries are the oldest in the protected segment, so they should be
+  // demoted into the probationary segment and evicted by the next scan.
+  for (int i = 0; i < kNumElems; ++i) {
+    Insert(2000 + i, 2000 + i, size_per_elem);
+    ASSERT_EQ(2000 + i, Lookup(2000 + i));
+  }
+  for (int i = 0; i < 5 * kNumElems; ++i) {
+    Insert(3000 + i, 3000 + i, size_per_elem);
+  }
+  for (int i = kNumElems - num_protected_elems; i < kNumElems; ++i) {
+    SCOPED_TRACE(Substitute("protected entry: index $0", i));
+    ASSERT_EQ(2000 + i, Lookup(2000 + i));
+  }
+  for (int i = 0; i < kNumHotElems; ++i) {
+    SCOPED_TRACE(Substitute("demoted entry: index $0", i));
+    ASSERT_EQ(-1, Lookup(i));
+  }
+}
+
+// This class is dedicated for scenarios specific for CLOCKCache.
+// The scenarios use a single-shard cache for simpler logic.
+class CLOCKCacheTest : public CacheBaseTest {
+ public:
+  CLOCKCacheTest()
+      : CacheBaseTest(10 * 1024) {
+  }
+
+  void SetUp() override {
+    SetupWithParameters(Cache::MemoryType::DRAM,
+                        Cache::EvictionPolicy::CLOCK,
+                        ShardingPolicy::SingleShard);
+  }
+};
+
+TEST_F(CLOCKCacheTest, EvictionPolicy) {
+  static constexpr int kNumElems = 100;
+  const int size_per_elem = cache_size() / kNumElems;
+
+  Insert(100, 101);
+  Insert(200, 201);
+
+  // Loop adding new entries, but repeatedly accessing key 100: its reference
+  // bit is set every time, so the entry should not be evicted.
+  for (int i = 0; i < kNumElems + 1000; i++) {
+    Insert(1000 + i, 2000 + i, size_per_elem);
+    ASSERT_EQ(101, Lookup(100));
+  }
+  ASSERT_EQ(101, Lookup(100));
+  // Since '200' wasn't accessed in the loop above, it should have
+  // been evicted.
+  ASSERT_EQ(-1, Lookup(200));
+}
+
+// Run concurrent lookups and inserts to exercise the shared locking
+// of the lookup path.
+TEST_F(CLOCKCacheTest, ConcurrentLookupsAndInserts) {
+  static constexpr int kNumThreads = 8;
+  static constexpr int kNumIterations = 10000;
+  static constexpr int kNumKeys = 200;
+  const int size_per_elem = cache_size() / 100;
+
+  vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumIterations; i++) {
+        const std::string key = EncodeInt((i * (t + 1)) % kNumKeys);
+        auto h(cache_->Lookup(key, Cache::EXPECT_IN_CACHE));
+        if (h) {
+          CHECK_EQ(key, cache_->Value(h).ToString());
+          continue;
+        }
+        auto ph(cache_->Allocate(key, key.size(), size_per_elem));
+        memcpy(cache_->MutableValue(&ph), key.data(), key.size());
+        cache_->Insert(std::move(ph), nullptr);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_LE(mem_tracker_->consumption(), cache_size());
+}
+
 }  // namespace kudu
@@ -11,6 +11,7 @@
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -45,6 +46,25 @@ DEFINE_double(cache_memtracker_approximation_ratio, 0.01,
               "this ratio to improve performance. For tests.");
 TAG_FLAG(cache_memtracker_approximation_ratio, hidden);
 
+DEFINE_double(cache_slru_protected_ratio, 0.8,
+              "For caches using the SLRU eviction policy, the fraction of each "
+              "cache shard's capacity reserved for the protected segment, i.e. "
+              "for entries which have been looked up at least once since they "
+              "were inserted. The rest of the capacity is used by the probationary "
+              "segment, where newly inserted entries are placed.");
+TAG_FLAG(cache_slru_protected_ratio, advanced);
+TAG_FLAG(cache_slru_protected_ratio, experimental);
+
+static bool ValidateSLRUProtectedRatio(const char* flagname, double value) {
+  if (value < 0.0 || value > 1.0) {
+    LOG(ERROR) << strings::Substitute("$0 must be in range [0.0, 1.0], value $1 is invalid",
+                                      flagname, value);
+    return false;
+  }
+  return true;
+}
+DEFINE_validator(cache_slru_protected_ratio, &ValidateSLRUProtectedRatio);
+
 using std::atomic;
 using std::shared_ptr;
 using std::string;
@@ -73,6 +93,7 @@ namespace {
 // Recency list handle. An entry is a variable length heap-allocated structure.
 // Entries are kept in a circular doubly linked list ordered by some recency
 // criterion (e.g., access time for LRU policy, insertion time for FIFO policy).
+// The SLRU policy keeps two such lists: the probationary and the protected one.
 struct RLHandle {
   Cache::EvictionCallback* eviction_callback;
   RLHandle* next_hash;
@@ -83,6 +104,8 @@ struct RLHandle {
   uint32_t val_length;
   std::atomic<int32_t> refs;
   uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
+  bool in_protected;  // Whether the entry is in the SLRU protected segment
+  std::atomic<bool> referenced; // CLOCK reference bit: set by lookups
 
   // The storage for the key/value pair itself. The data is stored as:
   //   [key bytes ...] [padding up to 8-byte boundary] [value bytes ...]
@@ -198,6 +221,10 @@ string ToString(Cache::EvictionPolicy p) {
       return "fifo";
     case Cache::EvictionPolicy::LRU:
       return "lru";
+    case Cache::EvictionPolicy::SLRU:
+      return "slru";
+    case Cache::EvictionPolicy::CLOCK:
+      return "clock";
     default:
       LOG(FATAL) << "unexpected cache eviction policy: " << static_cast<int>(p);
       break;
@@ -215,6 +242,7 @@ class CacheShard {
   // Separate from constructor so caller can easily make an array of CacheShard
   void SetCapacity(size_t capacity) {
     capacity_ = capacity;
+    protected_capacity_ = capacity * FLAGS_cache_slru_protected_ratio;
     max_deferred_consumption_ = capacity * FLAGS_cache_memtracker_approximation_ratio;
   }
 
@@ -229,7 +257,13 @@ class CacheShard {
 
  private:
   void RL_Remove(RLHandle* e);
+  // Append the entry as the newest one in the recency list. For the SLRU
+  // policy, that's the newest entry in the probationary segment.
   void RL_Append(RLHandle* e);
+  // Append the entry as the newest one in the SLRU protected segment.
+  void RL_AppendProtected(RLHandle* e);
+  // Return the next entry to evict, or nullptr if the shard is empty.
+  RLHandle* RL_Oldest();
   // Update the recency list after a lookup operation.
   void RL_UpdateAfterLookup(RLHandle* e);
   // Just reduce the reference count by 1.
@@ -264,15 +298,25 @@ class CacheShard {
 
   // Initialized before use.
   size_t capacity_;
+  // Capacity of the protected segment: used only by the SLRU policy.
+  size_t protected_capacity_;
 
-  // mutex_ protects the following state.
-  simple_spinlock mutex_;
+  // mutex_ protects the following state. With the CLOCK policy lookups don't
+  // modify the recency list, so they hold the mutex in shared mode only.
+  typename std::conditional<policy == Cache::EvictionPolicy::CLOCK,
+                            rw_spinlock, simple_spinlock>::type mutex_;
   size_t usage_;
 
   // Dummy head of recency list.
   // rl.prev is newest entry, rl.next is oldest entry.
   RLHandle rl_;
 
+  // Dummy head of the protected segment's recency list and the total charge
+  // of the entries in there: used only by the SLRU policy, where 'rl_' is
+  // the probationary segment and 'usage_' accounts for both segments.
+  RLHandle protected_rl_;
+  size_t protected_usage_;
+
   HandleTable table_;
 
   MemTracker* mem_tracker_;
@@ -288,23 +332,28 @@ class CacheShard {
 template<Cache::EvictionPolicy policy>
 CacheShard<policy>::CacheShard(MemTracker* tracker)
     : usage_(0),
+      protected_usage_(0),
       mem_tracker_(tracker),
       metrics_(nullptr) {
-  // Make empty circular linked list.
+  // Make empty circular linked lists.
   rl_.next = &rl_;
   rl_.prev = &rl_;
+  protected_rl_.next = &protected_rl_;
+  protected_rl_.prev = &protected_rl_;
 }
 
 template<Cache::EvictionPolicy policy>
 CacheShard<policy>::~CacheShard() {
-  for (RLHandle* e = rl_.next; e != &rl_; ) {
-    RLHandle* next = e->next;
-    DCHECK_EQ(e->refs.load(std::memory_order_relaxed), 1)
-        << "caller has an unreleased handle";
-    if (Unref(e)) {
-      FreeEntry(e);
+  for (RLHandle* head : { &rl_, &protected_rl_ }) {
+    for (RLHandle* e = head->next; e != head; ) {
+      RLHandle* next = e->next;
+      DCHECK_EQ(e->refs.load(std::memory_order_relaxed), 1)
+          << "caller has an unreleased handle";
+      if (Unref(e)) {
+        FreeEntry(e);
+      }
+      e = next;
     }
-    e = next;
   }
   mem_tracker_->Consume(deferred_consumption_);
 }
@@ -367,6 +416,10 @@ void CacheShard<policy>::RL_Remove(RLHandle* e) {
   e->prev->next = e->next;
   DCHECK_GE(usage_, e->charge);
   usage_ -= e->charge;
+  if (e->in_protected) {
+    DCHECK_GE(protected_usage_, e->charge);
+    protected_usage_ -= e->charge;
+  }
 }
 
 template<Cache::EvictionPolicy policy>
@@ -376,9 +429,52 @@ void CacheShard<policy>::RL_Append(RLHandle* e) {
   e->prev = rl_.prev;
   e->prev->next = e;
   e->next->prev = e;
+  e->in_protected = false;
   usage_ += e->charge;
 }
 
+template<Cache::EvictionPolicy policy>
+void CacheShard<policy>::RL_AppendProtected(RLHandle* e) {
+  e->next = &protected_rl_;
+  e->prev = protected_rl_.prev;
+  e->prev->next = e;
+  e->next->prev = e;
+  e->in_protected = true;
+  usage_ += e->charge;
+  protected_usage_ += e->charge;
+}
+
+template<Cache::EvictionPolicy policy>
+RLHandle* CacheShard<policy>::RL_Oldest() {
+  // Entries in the probationary segment are evicted first; the protected
+  // segment is non-empty only for the SLRU policy.
+  if (rl_.next != &rl_) {
+    return rl_.next;
+  }
+  if (protected_rl_.next != &protected_rl_) {
+    return protected_rl_.next;
+  }
+  return nullptr;
+}
+
+// The list is the clock, and its oldest entry is under the clock hand.
+// Referenced entries get a second chance: their reference bit is cleared
+// and the hand advances past them. Since lookups are excluded while this runs,
+// the sweep is bounded by a single turn of the clock.
+template<>
+RLHandle* CacheShard<Cache::EvictionPolicy::CLOCK>::RL_Oldest() {
+  while (rl_.next != &rl_) {
+    RLHandle* e = rl_.next;
+    if (!e->referenced.load(std::memory_order_relaxed)) {
+      return e;
+    }
+    e->referenced.store(false, std::memory_order_relaxed);
+    RL_Remove(e);
+    RL_Append(e);
+  }
+  return nullptr;
+}
+
 template<>
 void CacheShard<Cache::EvictionPolicy::FIFO>::RL_UpdateAfterLookup(RLHandle* /* e */) {
 }
@@ -389,6 +485,33 @@ void CacheShard<Cache::EvictionPolicy::LRU>::RL_UpdateAfterLookup(RLHandle* e) {
   RL_Append(e);
 }
 
+// A lookup promotes the entry into the protected segment (or makes it the
+// newest one there if it's already protected). If the protected segment
+// overflows as a result, its oldest entries are demoted back into
+// the probationary segment, becoming the newest entries there. This way
+// a burst of entries which are never looked up again (e.g., a large scan)
+// evicts only probationary entries, keeping the frequently accessed ones.
+template<>
+void CacheShard<Cache::EvictionPolicy::SLRU>::RL_UpdateAfterLookup(RLHandle* e) {
+  RL_Remove(e);
+  RL_AppendProtected(e);
+  while (protected_usage_ > protected_capacity_ && protected_rl_.next != e) {
+    RLHandle* old = protected_rl_.next;
+    RL_Remove(old);
+    RL_Append(old);
+  }
+}
+
+// Only the reference bit is set, so this is safe to run concurrently with
+// other lookups. The bit is checked first to avoid dirtying the cache line
+// of a hot entry on every lookup.
+template<>
+void CacheShard<Cache::EvictionPolicy::CLOCK>::RL_UpdateAfterLookup(RLHandle* e) {
+  if (!e->referenced.load(std::memory_order_relaxed)) {
+    e->referenced.store(true, std::memory_order_relaxed);
+  }
+}
+
 template<Cache::EvictionPolicy policy>
 Cache::Handle* CacheShard<policy>::Lookup(const Slice& key,
                                           uint32_t hash,
@@ -409,6 +532,28 @@ Cache::Handle* CacheShard<policy>::Lookup(const Slice& key,
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
+template<>
+Cache::Handle* CacheShard<Cache::EvictionPolicy::CLOCK>::Lookup(const Slice& key,
+                                                                uint32_t hash,
+                                                                bool caching) {
+  RLHandle* e;
+  {
+    // The hash table and the recency list are modified only under the mutex
+    // held in exclusive mode, so concurrent lookups don't serialize.
+    shared_lock<decltype(mutex_)> l(mutex_);
+    e = table_.Lookup(key, hash);
+    if (e != nullptr) {
+      e->refs.fetch_add(1, std::memory_order_relaxed);
+      RL_UpdateAfterLookup(e);
+    }
+  }
+
+  // Do the metrics outside of the lock.
+  UpdateMetricsLookup(e != nullptr, caching);
+
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
 template<Cache::EvictionPolicy policy>
 void CacheShard<policy>::Release(Cache::Handle* handle) {
   RLHandle* e = reinterpret_cast<RLHandle*>(handle);
@@ -427,6 +572,7 @@ Cache::Handle* CacheShard<policy>::Insert(
   handle->eviction_callback = eviction_callback;
   // Two refs for the handle: one from CacheShard, one for the returned handle.
   handle->refs.store(2, std::memory_order_relaxed);
+  handle->referenced.store(false, std::memory_order_relaxed);
   UpdateMemTracker(handle->charge);
   if (PREDICT_TRUE(metrics_)) {
     metrics_->cache_usage->IncrementBy(handle->charge);
@@ -448,8 +594,11 @@ Cache::Handle* CacheShard<policy>::Insert(
       }
     }
 
-    while (usage_ > capacity_ && rl_.next != &rl_) {
-      RLHandle* old = rl_.next;
+    while (usage_ > capacity_) {
+      RLHandle* old = RL_Oldest();
+      if (PREDICT_FALSE(old == nullptr)) {
+        break;
+      }
       RL_Remove(old);
       table_.Remove(old->key(), old->hash);
       if (Unref(old)) {
@@ -499,27 +648,31 @@ size_t CacheShard<policy>::Invalidate(const Cache::InvalidationControl& ctl) {
     std::lock_guard<decltype(mutex_)> l(mutex_);
 
     // rl_.next is the oldest (a.k.a. least relevant) entry in the recency list.
-    RLHandle* h = rl_.next;
-    while (h != nullptr && h != &rl_ &&
-           ctl.iteration_func(valid_entry_count, invalid_entry_count)) {
-      if (ctl.validity_func(h->key(), h->value())) {
-        // Continue iterating over the list.
+    // For the SLRU policy, entries of the probationary segment are less
+    // relevant than entries of the protected one, so the former go first.
+    for (RLHandle* head : { &rl_, &protected_rl_ }) {
+      RLHandle* h = head->next;
+      while (h != nullptr && h != head &&
+             ctl.iteration_func(valid_entry_count, invalid_entry_count)) {
+        if (ctl.validity_func(h->key(), h->value())) {
+          // Continue iterating over the list.
+          h = h->next;
+          ++valid_entry_count;
+          continue;
+        }
+        // Copy the handle slated for removal.
+        RLHandle* h_to_remove = h;
+        // Prepare for next iteration of the cycle.
         h = h->next;
-        ++valid_entry_count;
-        continue;
-      }
-      // Copy the handle slated for removal.
-      RLHandle* h_to_remove = h;
-      // Prepare for next iteration of the cycle.
-      h = h->next;
-
-      RL_Remove(h_to_remove);
-      table_.Remove(h_to_remove->key(), h_to_remove->hash);
-      if (Unref(h_to_remove)) {
-        h_to_remove->next = to_remove_head;
-        to_remove_head = h_to_remove;
+
+        RL_Remove(h_to_remove);
+        table_.Remove(h_to_remove->key(), h_to_remove->hash);
+        if (Unref(h_to_remove)) {
+          h_to_remove->next = to_remove_head;
+          to_remove_head = h_to_remove;
+        }
+        ++invalid_entry_count;
       }
-      ++invalid_entry_count;
     }
   }
   // Once removed from the lookup table and the recency list, the entries
@@ -693,6 +846,18 @@ Cache* NewCache<Cache::EvictionPolicy::LRU,
   return new ShardedCache<Cache::EvictionPolicy::LRU>(capacity, id);
 }
 
+template<>
+Cache* NewCache<Cache::EvictionPolicy::SLRU,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id) {
+  return new ShardedCache<Cache::EvictionPolicy::SLRU>(capacity, id);
+}
+
+template<>
+Cache* NewCache<Cache::EvictionPolicy::CLOCK,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id) {
+  return new ShardedCache<Cache::EvictionPolicy::CLOCK>(capacity, id);
+}
+
 std::ostream& operator<<(std::ostream& os, Cache::MemoryType mem_type) {
   switch (mem_type) {
     case Cache::MemoryType::DRAM:
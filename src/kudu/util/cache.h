@@ -49,6 +49,20 @@ class Cache {
 
     // The least-recently-used items are evicted.
     LRU,
+
+    // Segmented LRU: newly inserted items are placed into a probationary
+    // segment and promoted into a protected segment upon a subsequent lookup.
+    // The least-recently-used items of the probationary segment are evicted
+    // first, so a burst of items which are never looked up again (e.g.,
+    // blocks read by a large scan) doesn't flush frequently accessed ones.
+    SLRU,
+
+    // An approximation of LRU: a lookup only sets the entry's reference bit,
+    // and the eviction sweeps the entries in insertion order, evicting the
+    // first one not referenced since the previous sweep. Since lookups don't
+    // reorder entries, they run concurrently under a shared lock, which
+    // scales better than LRU with many threads accessing the cache.
+    CLOCK,
   };
 
   // Callback interface which is called when an entry is evicted from the
@@ -357,6 +371,19 @@ template<>
 Cache* NewCache<Cache::EvictionPolicy::LRU,
                 Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
 
+// Create a new SLRU cache with a fixed size capacity. This implementation
+// of Cache uses the segmented least-recently-used eviction policy and stored
+// in DRAM.
+template<>
+Cache* NewCache<Cache::EvictionPolicy::SLRU,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
+
+// Create a new CLOCK cache with a fixed size capacity. This implementation
+// of Cache uses the CLOCK (second chance) eviction policy and stored in DRAM.
+template<>
+Cache* NewCache<Cache::EvictionPolicy::CLOCK,
+                Cache::MemoryType::DRAM>(size_t capacity, const std::string& id);
+
 // A helper method to output cache memory type into ostream.
 std::ostream& operator<<(std::ostream& os, Cache::MemoryType mem_type);
 
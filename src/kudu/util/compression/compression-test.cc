@@ -148,14 +148,79 @@ TEST_F(TestCompression, TestNoCompressionCodec) {
 }
 
 TEST_F(TestCompression, TestSnappyCompressionCodec) {
-  for (auto type : { SNAPPY, LZ4, ZLIB }) {
+  for (auto type : { SNAPPY, LZ4, ZLIB, ZSTD }) {
     NO_FATALS(TestCompressionCodec(type));
   }
 }
 
+TEST_F(TestCompression, TestZstdCompressionLevels) {
+  // Compressible input: random words drawn from a small vocabulary.
+  Random r(SeedRandom());
+  vector<string> words;
+  for (int i = 0; i < 64; i++) {
+    words.emplace_back(RandomString(8, &r));
+  }
+  string input;
+  while (input.size() < 64 * 1024) {
+    input.append(words[r.Uniform(words.size())]);
+  }
+
+  const CompressionCodec* default_codec;
+  ASSERT_OK(GetCompressionCodec(ZSTD, &default_codec));
+  size_t max_compressed = default_codec->MaxCompressedLength(input.size());
+  unique_ptr<uint8_t[]> cbuffer(new uint8_t[max_compressed]);
+  unique_ptr<uint8_t[]> ubuffer(new uint8_t[input.size()]);
+
+  size_t fastest_size = 0;
+  size_t smallest_size = 0;
+  for (int level : { 1, 3, 19 }) {
+    SCOPED_TRACE(level);
+    const CompressionCodec* codec;
+    ASSERT_OK(GetCompressionCodec(ZSTD, level, &codec));
+    ASSERT_EQ(ZSTD, codec->type());
+    size_t compressed;
+    ASSERT_OK(codec->Compress(Slice(input), cbuffer.get(), &compressed));
+    ASSERT_LT(compressed, input.size());
+    // Data compressed at any level is readable by the default codec.
+    ASSERT_OK(default_codec->Uncompress(Slice(cbuffer.get(), compressed),
+                                        ubuffer.get(), input.size()));
+    ASSERT_EQ(0, memcmp(input.data(), ubuffer.get(), input.size()));
+    if (level == 1) fastest_size = compressed;
+    smallest_size = compressed;
+  }
+  ASSERT_LE(smallest_size, fastest_size);
+
+  // A truncated buffer or a wrong uncompressed length is detected.
+  size_t compressed;
+  ASSERT_OK(default_codec->Compress(Slice(input), cbuffer.get(), &compressed));
+  Status s = default_codec->Uncompress(Slice(cbuffer.get(), compressed / 2),
+                                       ubuffer.get(), input.size());
+  ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+  s = default_codec->Uncompress(Slice(cbuffer.get(), compressed),
+                                ubuffer.get(), input.size() - 1);
+  ASSERT_TRUE(s.IsCorruption()) << s.ToString();
+
+  const CompressionCodec* codec;
+  s = GetCompressionCodec(ZSTD, 1000, &codec);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  s = GetCompressionCodec(ZSTD, -1, &codec);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  ASSERT_EQ(ZSTD, GetCompressionCodecType("zstd"));
+
+  // Only ZSTD supports levels other than the default.
+  ASSERT_OK(ValidateCompressionLevel(ZSTD, 19));
+  ASSERT_OK(ValidateCompressionLevel(LZ4, 0));
+  s = ValidateCompressionLevel(LZ4, 3);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  s = ValidateCompressionLevel(DEFAULT_COMPRESSION, 3);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+  s = ValidateCompressionLevel(ZSTD, 1000);
+  ASSERT_TRUE(s.IsInvalidArgument()) << s.ToString();
+}
+
 TEST_F(TestCompression, TestSimpleBenchmark) {
   Random r(SeedRandom());
-  for (auto type : { SNAPPY, LZ4, ZLIB }) {
+  for (auto type : { SNAPPY, LZ4, ZLIB, ZSTD }) {
     NO_FATALS(Benchmark(r, type));
   }
 }
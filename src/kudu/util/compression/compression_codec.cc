@@ -26,17 +26,22 @@
 #include <snappy-sinksource.h>
 #include <snappy.h>
 #include <zlib.h>
+#include <zstd.h>
 
 #include "kudu/gutil/port.h"
 #include "kudu/gutil/singleton.h"
 #include "kudu/gutil/stringprintf.h"
+#include "kudu/gutil/strings/substitute.h"
 #include "kudu/util/faststring.h"
 #include "kudu/util/logging.h"
 #include "kudu/util/string_case.h"
+#include "kudu/util/threadlocal.h"
 
 namespace kudu {
 
+using std::unique_ptr;
 using std::vector;
+using strings::Substitute;
 
 CompressionCodec::CompressionCodec() {
 }
@@ -245,8 +250,134 @@ class ZlibCodec : public CompressionCodec {
   }
 };
 
+class ZstdCodec : public CompressionCodec {
+ public:
+  // Returns the codec for the given level, which must be between 0 (the
+  // default level) and ZSTD_maxCLevel().
+  static const ZstdCodec* GetForLevel(int level) {
+    // The codecs are stateless apart from their level, so one instance per
+    // level is shared by all callers.
+    static const vector<unique_ptr<ZstdCodec>>* codecs = [] {
+      auto* codecs = new vector<unique_ptr<ZstdCodec>>();
+      for (int l = 0; l <= ZSTD_maxCLevel(); l++) {
+        codecs->emplace_back(new ZstdCodec(l));
+      }
+      return codecs;
+    }();
+    DCHECK_GE(level, 0);
+    DCHECK_LT(level, codecs->size());
+    return (*codecs)[level].get();
+  }
+
+  Status Compress(const Slice& input,
+                  uint8_t *compressed, size_t *compressed_length) const OVERRIDE {
+    size_t n = ZSTD_compressCCtx(GetContexts()->cctx, compressed,
+                                 MaxCompressedLength(input.size()),
+                                 input.data(), input.size(), level_);
+    if (ZSTD_isError(n)) {
+      return Status::IOError("unable to compress the buffer", ZSTD_getErrorName(n));
+    }
+    *compressed_length = n;
+    return Status::OK();
+  }
+
+  Status Compress(const vector<Slice>& input_slices,
+                  uint8_t *compressed, size_t *compressed_length) const OVERRIDE {
+    if (input_slices.size() == 1) {
+      return Compress(input_slices[0], compressed, compressed_length);
+    }
+
+    // Stream the slices through the compressor rather than copying them into
+    // a contiguous buffer first.
+    ZSTD_CCtx* cctx = GetContexts()->cctx;
+    size_t input_size = 0;
+    for (const Slice& input : input_slices) {
+      input_size += input.size();
+    }
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level_);
+    ZSTD_CCtx_setPledgedSrcSize(cctx, input_size);
+    ZSTD_outBuffer out = { compressed, MaxCompressedLength(input_size), 0 };
+    for (size_t i = 0; i < input_slices.size(); i++) {
+      const Slice& input = input_slices[i];
+      ZSTD_inBuffer in = { input.data(), input.size(), 0 };
+      ZSTD_EndDirective mode = i == input_slices.size() - 1 ? ZSTD_e_end : ZSTD_e_continue;
+      size_t remaining;
+      do {
+        remaining = ZSTD_compressStream2(cctx, &out, &in, mode);
+        if (ZSTD_isError(remaining)) {
+          return Status::IOError("unable to compress the buffer",
+                                 ZSTD_getErrorName(remaining));
+        }
+      } while (mode == ZSTD_e_end ? remaining != 0 : in.pos < in.size);
+    }
+    *compressed_length = out.pos;
+    return Status::OK();
+  }
+
+  Status Uncompress(const Slice& compressed,
+                    uint8_t *uncompressed, size_t uncompressed_length) const OVERRIDE {
+    size_t n = ZSTD_decompressDCtx(GetContexts()->dctx, uncompressed, uncompressed_length,
+                                   compressed.data(), compressed.size());
+    if (ZSTD_isError(n)) {
+      return Status::Corruption("unable to uncompress the buffer", ZSTD_getErrorName(n));
+    }
+    if (n != uncompressed_length) {
+      return Status::Corruption(Substitute(
+          "unable to uncompress the buffer: expected $0 bytes, got $1",
+          uncompressed_length, n));
+    }
+    return Status::OK();
+  }
+
+  size_t MaxCompressedLength(size_t source_bytes) const OVERRIDE {
+    return ZSTD_compressBound(source_bytes);
+  }
+
+  CompressionType type() const override {
+    return ZSTD;
+  }
+
+ private:
+  // Compression and decompression contexts. These hold sizeable buffers, so
+  // each thread allocates them once and reuses them across calls.
+  struct Contexts {
+    Contexts()
+        : cctx(ZSTD_createCCtx()),
+          dctx(ZSTD_createDCtx()) {
+      CHECK(cctx && dctx) << "unable to allocate ZSTD contexts";
+    }
+    ~Contexts() {
+      ZSTD_freeCCtx(cctx);
+      ZSTD_freeDCtx(dctx);
+    }
+    ZSTD_CCtx* const cctx;
+    ZSTD_DCtx* const dctx;
+  };
+
+  static Contexts* GetContexts() {
+    BLOCK_STATIC_THREAD_LOCAL(Contexts, contexts);
+    return contexts;
+  }
+
+  explicit ZstdCodec(int level)
+      : level_(level) {
+  }
+
+  const int level_;
+};
+
 Status GetCompressionCodec(CompressionType compression,
                            const CompressionCodec** codec) {
+  return GetCompressionCodec(compression, 0, codec);
+}
+
+Status GetCompressionCodec(CompressionType compression,
+                           int level,
+                           const CompressionCodec** codec) {
+  if (compression == ZSTD) {
+    RETURN_NOT_OK(ValidateCompressionLevel(compression, level));
+  }
   switch (compression) {
     case NO_COMPRESSION:
       *codec = nullptr;
@@ -260,12 +391,32 @@ Status GetCompressionCodec(CompressionType compression,
     case ZLIB:
       *codec = ZlibCodec::GetSingleton();
       break;
+    case ZSTD:
+      *codec = ZstdCodec::GetForLevel(level);
+      break;
     default:
       return Status::NotFound("bad compression type");
   }
   return Status::OK();
 }
 
+Status ValidateCompressionLevel(CompressionType compression, int level) {
+  if (level == 0) {
+    return Status::OK();
+  }
+  if (compression != ZSTD) {
+    return Status::InvalidArgument(Substitute(
+        "compression type $0 does not support compression levels, got level $1",
+        CompressionType_Name(compression), level));
+  }
+  if (level < 0 || level > ZSTD_maxCLevel()) {
+    return Status::InvalidArgument(Substitute(
+        "ZSTD compression level must be between 0 and $0, got $1",
+        ZSTD_maxCLevel(), level));
+  }
+  return Status::OK();
+}
+
 CompressionType GetCompressionCodecType(const std::string& name) {
   std::string uname;
   ToUpperCase(name, &uname);
@@ -276,6 +427,8 @@ CompressionType GetCompressionCodecType(const std::string& name) {
     return LZ4;
   if (uname == "ZLIB")
     return ZLIB;
+  if (uname == "ZSTD")
+    return ZSTD;
   if (uname == "NO_COMPRESSION")
     return NO_COMPRESSION;
 
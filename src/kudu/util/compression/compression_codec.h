@@ -71,6 +71,18 @@ class CompressionCodec {
 Status GetCompressionCodec(CompressionType compression,
                            const CompressionCodec** codec);
 
+// Like the above, but the returned codec compresses at the given level, with
+// 0 selecting the codec's default. Codecs which don't support levels ignore
+// it. Returns InvalidArgument if the level is out of range for the codec.
+Status GetCompressionCodec(CompressionType compression,
+                           int level,
+                           const CompressionCodec** codec);
+
+// Returns InvalidArgument unless 'level' is a valid compression level for
+// 'compression'. Level 0, the codec's default, is valid for any codec; other
+// levels are only valid for codecs which support levels.
+Status ValidateCompressionLevel(CompressionType compression, int level);
+
 // Returns the compression codec type given the name
 CompressionType GetCompressionCodecType(const std::string& name);
 
@@ -28,6 +28,7 @@ namespace kudu {
 class faststring;
 class Fifo;
 class FileLock;
+class FilesystemSyncer;
 class RandomAccessFile;
 class RWFile;
 class SequentialFile;
@@ -178,6 +179,17 @@ class Env {
   // Synchronize the entry for a specific directory.
   virtual Status SyncDir(const std::string& dirname) = 0;
 
+  // Returns whether filesystem syncs (see FilesystemSyncer) are supported:
+  // this requires syncfs(2) to report writeback errors, which it only does on
+  // Linux 5.8 and later.
+  virtual bool IsFilesystemSyncSupported() = 0;
+
+  // Opens a handle for syncing the filesystem containing 'path'.
+  //
+  // Returns Status::NotSupported() if IsFilesystemSyncSupported() is false.
+  virtual Status NewFilesystemSyncer(const std::string& path,
+                                     std::unique_ptr<FilesystemSyncer>* syncer) = 0;
+
   // Recursively delete the specified directory.
   // This should operate safely, not following any symlinks, etc.
   virtual Status DeleteRecursively(const std::string &dirname) = 0;
@@ -406,6 +418,22 @@ class Fifo : public File {
   virtual int write_fd() const = 0;
 };
 
+// A handle on a filesystem, used to make all of the writes to it durable.
+//
+// The handle only reports writeback errors which occurred after it was
+// opened, so it should be opened before the writes it is meant to cover, and
+// kept open for as long as they are being synced.
+class FilesystemSyncer : public File {
+ public:
+  // Flush all buffered data and metadata of the filesystem to disk, as with
+  // syncfs(2). This covers writes to any file on that filesystem, made by any
+  // thread, which completed before the call.
+  //
+  // Returns an error if the writeback of any data of the filesystem failed
+  // since the previous call, or since the handle was opened.
+  virtual Status Sync() = 0;
+};
+
 // A file abstraction for reading sequentially through a file
 class SequentialFile : public File {
  public:
@@ -611,6 +611,49 @@ class PosixFifo : public Fifo {
   int write_fd_ = -1;
 };
 
+#if defined(__linux__)
+// Returns whether syncfs(2) reports writeback errors on the given kernel
+// release. Before Linux 5.8 it returned 0 no matter what.
+bool SyncfsReportsErrors(const string& kernel_release) {
+  int major = 0;
+  int minor = 0;
+  if (sscanf(kernel_release.c_str(), "%d.%d", &major, &minor) != 2) {
+    return false;
+  }
+  return major > 5 || (major == 5 && minor >= 8);
+}
+
+class PosixFilesystemSyncer : public FilesystemSyncer {
+ public:
+  PosixFilesystemSyncer(string path, int fd)
+      : path_(std::move(path)),
+        fd_(fd) {}
+
+  ~PosixFilesystemSyncer() {
+    DoClose(fd_);
+  }
+
+  const string& filename() const override {
+    return path_;
+  }
+
+  Status Sync() override {
+    TRACE_EVENT1("io", "PosixFilesystemSyncer::Sync", "path", path_);
+    MAYBE_RETURN_EIO(path_, IOError(Env::kInjectedFailureStatusMsg, EIO));
+    ThreadRestrictions::AssertIOAllowed();
+    if (FLAGS_never_fsync) return Status::OK();
+    if (syncfs(fd_) != 0) {
+      return IOError(path_, errno);
+    }
+    return Status::OK();
+  }
+
+ private:
+  const string path_;
+  const int fd_;
+};
+#endif
+
 class PosixSequentialFile: public SequentialFile {
  private:
   const string filename_;
@@ -1330,6 +1373,34 @@ class PosixEnv : public Env {
     return Status::OK();
   }
 
+  bool IsFilesystemSyncSupported() override {
+#if defined(__linux__)
+    return SyncfsReportsErrors(GetKernelRelease());
+#else
+    return false;
+#endif
+  }
+
+  Status NewFilesystemSyncer(const string& path,
+                             unique_ptr<FilesystemSyncer>* syncer) override {
+    TRACE_EVENT1("io", "PosixEnv::NewFilesystemSyncer", "path", path);
+#if defined(__linux__)
+    if (!IsFilesystemSyncSupported()) {
+      return Status::NotSupported(
+          "filesystem syncs require Linux 5.8 or later, for syncfs(2) to report "
+          "writeback errors", Substitute("kernel release: $0", GetKernelRelease()));
+    }
+    MAYBE_RETURN_EIO(path, IOError(Env::kInjectedFailureStatusMsg, EIO));
+    ThreadRestrictions::AssertIOAllowed();
+    int fd;
+    RETURN_NOT_OK(DoOpen(path, O_RDONLY, "filesystem syncs", &fd));
+    syncer->reset(new PosixFilesystemSyncer(path, fd));
+    return Status::OK();
+#else
+    return Status::NotSupported("filesystem syncs are not supported on this platform");
+#endif
+  }
+
   virtual Status DeleteRecursively(const string &name) OVERRIDE {
     return Walk(
         name, POST_ORDER,
@@ -26,6 +26,7 @@
 #include "kudu/util/memory/arena.h"
 #include "kudu/util/slice.h"
 
+using std::string;
 using std::unique_ptr;
 
 namespace kudu {
@@ -48,6 +49,28 @@ static void TestRoundTrip(InlineSlice<N> *slice,
     << "ret        = " << ret.ToDebugString() << "\n"
     << "test_input = " << test_input.ToDebugString();
 
+  // compare() must agree with comparing the full slices, including against
+  // keys which differ inside or after the prefix kept inline for indirect
+  // data, and against shorter and longer keys.
+  ASSERT_EQ(0, slice->compare(test_input));
+  for (size_t i = 0; i < test_size; i++) {
+    // Check the bytes around the inline prefix and the last byte.
+    if (i >= 32 && i != test_size - 1) continue;
+    string other = test_input.ToString();
+    uint8_t b = test_input[i];
+    if (b != 0xff) {
+      other[i] = b + 1;
+      ASSERT_LT(slice->compare(Slice(other)), 0) << "test_size = " << test_size << " i = " << i;
+    }
+    if (b != 0) {
+      other[i] = b - 1;
+      ASSERT_GT(slice->compare(Slice(other)), 0) << "test_size = " << test_size << " i = " << i;
+    }
+    ASSERT_GT(slice->compare(Slice(test_input.data(), i)), 0);
+  }
+  string longer = test_input.ToString() + "x";
+  ASSERT_LT(slice->compare(Slice(longer)), 0);
+
   // If the data is small enough to fit inline, then
   // the returned slice should point directly into the
   // InlineSlice object.
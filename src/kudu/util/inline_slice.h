@@ -17,6 +17,9 @@
 #ifndef KUDU_UTIL_INLINE_SLICE_H
 #define KUDU_UTIL_INLINE_SLICE_H
 
+#include <algorithm>
+#include <cstring>
+
 #include "kudu/gutil/atomicops.h"
 #include "kudu/gutil/casts.h"
 #include "kudu/util/memory/arena.h"
@@ -38,9 +41,8 @@ namespace kudu {
 //   buf_[1..1 + buf_[0]] == inline data
 // If buf_[0] == 0xff:
 //   buf_[1..sizeof(uint8_t *)] == pointer to indirect data, minus the MSB.
-//   buf_[sizeof(uint8_t *)..] = unused
-//     TODO: we could store a prefix of the indirect data in this unused space
-//     in the future, which might be able to short-circuit some comparisons
+//   buf_[sizeof(uint8_t *)..] = the first bytes of the indirect data. These
+//     let compare() decide most comparisons without following the pointer.
 //
 // The indirect data which is pointed to is stored as a 4 byte length followed by
 // the actual data.
@@ -64,7 +66,8 @@ class InlineSlice {
   enum {
     kPointerByteWidth = sizeof(uintptr_t),
     kPointerBitWidth = kPointerByteWidth * 8,
-    kMaxInlineData = STORAGE_SIZE - 1
+    kMaxInlineData = STORAGE_SIZE - 1,
+    kIndirectPrefixSize = STORAGE_SIZE - kPointerByteWidth
   };
 
   static_assert(STORAGE_SIZE >= kPointerByteWidth,
@@ -89,6 +92,36 @@ class InlineSlice {
     return Slice(&buf_[1], len);
   }
 
+  // Three-way comparison against 'other', with the same result as
+  // as_slice().compare(other). When the data is stored indirectly, the
+  // prefix kept inline is compared first, and the pointer is only followed
+  // if the prefix is equal.
+  //
+  // With ATOMIC, the same caveats as for as_slice() apply: a concurrent
+  // writer may cause a bogus result, but never an invalid memory access.
+  int compare(const Slice& other) const {
+    DiscriminatedPointer dptr = LoadValue();
+    if (!dptr.is_indirect()) {
+      return Slice(&buf_[1], dptr.discriminator).compare(other);
+    }
+    if (kIndirectPrefixSize > 0) {
+      size_t n = std::min<size_t>(kIndirectPrefixSize, other.size());
+      int r = memcmp(&buf_[kPointerByteWidth], other.data(), n);
+      if (r != 0) {
+        return r;
+      }
+      // Indirect data is always longer than the prefix.
+      if (other.size() <= kIndirectPrefixSize) {
+        return 1;
+      }
+    }
+    const uint8_t *indir_data = reinterpret_cast<const uint8_t *>(dptr.pointer);
+    uint32_t len = *reinterpret_cast<const uint32_t *>(indir_data);
+    indir_data += sizeof(uint32_t);
+    return Slice(indir_data + kIndirectPrefixSize, len - kIndirectPrefixSize).compare(
+        Slice(other.data() + kIndirectPrefixSize, other.size() - kIndirectPrefixSize));
+  }
+
   template<class ArenaType>
   void set(const Slice &src, ArenaType *alloc_arena) {
     set(src.data(), src.size(), alloc_arena);
@@ -122,6 +155,9 @@ class InlineSlice {
       void *in_arena = CHECK_NOTNULL(alloc_arena->AllocateBytes(len + sizeof(uint32_t)));
       *reinterpret_cast<uint32_t *>(in_arena) = len;
       memcpy(reinterpret_cast<uint8_t *>(in_arena) + sizeof(uint32_t), src, len);
+      // The prefix is written before the pointer is published, so with ATOMIC
+      // a reader that sees the new pointer also sees the new prefix.
+      memcpy(&buf_[kPointerByteWidth], src, kIndirectPrefixSize);
       set_ptr(in_arena);
     }
   }